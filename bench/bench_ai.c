@@ -0,0 +1,203 @@
+/* bench_ai.c — intercept predictor + AI tiers: checks, queries/sec, win rates
+ * Usage: bench_ai [matches_per_cell]
+ * Checks the unfolded intercept against stepping the ball through the wall
+ * bounces, and that the cache only recomputes on velocity changes (exit 1
+ * on failure). Then reports predictor queries/sec (raw and cached) and a
+ * headless win-rate matrix: every tier and the built-in blend AI against
+ * each other, first to SIM_WIN_SCORE.
+ */
+
+#include "bench_util.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "ai.h"
+#include "sim.h"
+
+static float urand(uint32_t* s){ return (float)(bench_rng_next(s) >> 8) / 16777216.0f; }
+
+/* Random in-play ball heading right, unit velocity like the sim keeps it. */
+static void random_ball(uint32_t* s, float* x, float* y, float* dx, float* dy){
+  *x = 60.0f + urand(s)*600.0f;
+  *y = SIM_BALL_R + urand(s)*(SIM_HEIGHT - 2.0f*SIM_BALL_R);
+  *dy = (urand(s)*2.0f - 1.0f)*0.95f;
+  *dx = sqrtf(1.0f - (*dy)*(*dy));
+}
+
+/* -------------------------------- Checks -------------------------------- */
+static void check_intercept(void){
+  uint32_t s = 0xABCDEFu;
+  const float face = SIM_WIDTH - 40 - SIM_BAT_HALF_W - SIM_BALL_R;
+  float worst = 0.0f;
+  for(int i=0;i<20000;i++){
+    float x, y, dx, dy; random_ball(&s, &x, &y, &dx, &dy);
+    float pred = ai_intercept_y(x, y, dx, dy, face);
+    /* walls as sim.c handles them (snap to the wall, flip dy), in double so
+       only the snapping differs from the unfolded line */
+    int bounces = 0;
+    double bx = x, by = y, bdy = dy;
+    while(bx + dx < face){
+      bx += dx; by += bdy;
+      if(by - SIM_BALL_R <= 0.0){ bdy = fabs(bdy); by = SIM_BALL_R; bounces++; }
+      else if(by + SIM_BALL_R >= SIM_HEIGHT){ bdy = -fabs(bdy); by = SIM_HEIGHT - SIM_BALL_R; bounces++; }
+    }
+    by += bdy*((face - bx)/dx);   /* the last partial microstep */
+    float err = (float)fabs(pred - by);
+    /* each snap drops up to one microstep of |dy|, and the last partial step
+       may cross a wall the stepper only checks on the next one */
+    if(err > 0.05f + 2.0f*(float)(bounces+1)*fabsf(dy)){ fails++; fprintf(stderr, "intercept off by %.3f (%d bounces)\n", err, bounces); }
+    if(err > worst) worst = err;
+  }
+  printf("intercept: 20000 random flights, worst |error| %.2f px vs stepping the walls\n", worst);
+}
+
+/* the cache must be invisible: every cached answer matches a predictor
+ * queried from scratch, through bounces, returns and serves */
+static int same_answer(AiPredictor* p, const Game* g, int side){
+  AiPredictor fresh; ai_predictor_reset(&fresh);
+  float y = NAN, fy = NAN;
+  int v = ai_predict(p, g, side, &y), fv = ai_predict(&fresh, g, side, &fy);
+  /* a ball past the face on a missed return stays "heading" until it changes */
+  if(v != fv) return v && !fv && (side==0 ? g->ball.x <= ai_face_x(g, 0) : g->ball.x >= ai_face_x(g, 1));
+  return !v || fabsf(y - fy) < 0.05f;
+}
+
+static void check_cache(void){
+  Game g; sim_init(&g, 99u); sim_new_game(&g, 1);
+  AiPredictor p[2]; ai_predictor_reset(&p[0]); ai_predictor_reset(&p[1]);
+  long wrong = 0, steps = 0;
+  for(int i=0;i<20000 && g.state==ST_PLAY;i++, steps++){
+    for(int k=0;k<2;k++) wrong += !same_answer(&p[k], &g, k);
+    Input in; in.buttons = 0; sim_step(&g, &in, NULL);
+  }
+  CHECK(wrong == 0);
+  CHECK(p[0].recomputes*10 < p[0].queries);
+
+  /* invalidation: a new velocity, then a serve that keeps the old one */
+  sim_new_game(&g, 1);
+  g.ball.dx = -fabsf(g.ball.dx); g.ball.prev_x = g.ball.x + 1.0f;
+  CHECK(same_answer(&p[0], &g, 0));
+  g.ball.dy = -g.ball.dy;
+  CHECK(same_answer(&p[0], &g, 0));
+  g.ball.y += 37.0f; g.ball.prev_x = g.ball.x;
+  CHECK(same_answer(&p[0], &g, 0));
+  printf("cache: %ld steps, %ld queries, %ld recomputes (velocity changes/serves only)\n",
+         steps, p[0].queries, p[0].recomputes);
+}
+
+/* -------------------------------- Matches -------------------------------- */
+#define BLEND (-1)
+#define MAX_STEPS 60000
+#define SPEED_CAP 200   /* rally this fast between two perfect AIs: call it a draw */
+
+static const char* player_name(int p){ return p==BLEND ? "blend" : AI_TIERS[p].name; }
+
+/* 0: left won, 1: right won, -1: draw. */
+static int play_match(int left, int right, uint32_t seed, long* steps){
+  Game g; sim_init(&g, seed); sim_new_game(&g, 2);
+  g.bats[0].isAI = left==BLEND; g.bats[1].isAI = right==BLEND;
+  AiAgent a[2];
+  if(left  != BLEND) ai_agent_init(&a[0], (AiTierId)left,  0, seed*3u + 1u);
+  if(right != BLEND) ai_agent_init(&a[1], (AiTierId)right, 1, seed*5u + 2u);
+  long n = 0;
+  while(g.state==ST_PLAY && n<MAX_STEPS && g.ball.speed<SPEED_CAP){
+    Input in; in.buttons = 0;
+    if(left  != BLEND) in.buttons |= ai_agent_buttons(&a[0], &g);
+    if(right != BLEND) in.buttons |= ai_agent_buttons(&a[1], &g);
+    sim_step(&g, &in, NULL);
+    n++;
+  }
+  *steps += n;
+  if(g.state!=ST_OVER) return -1;
+  return g.bats[0].score >= SIM_WIN_SCORE ? 0 : 1;
+}
+
+/* share of `n` matches `tier` wins against the blend AI, sides alternating */
+static double vs_blend(int tier, long n, long* steps){
+  long wins = 0;
+  for(long m=0;m<n;m++){
+    uint32_t seed = 0x2000u + (uint32_t)m*7919u;
+    wins += (m & 1) ? play_match(BLEND, tier, seed, steps) == 1 : play_match(tier, BLEND, seed, steps) == 0;
+  }
+  return (double)wins/(double)n;
+}
+
+int main(int argc, char** argv){
+  long per_cell = bench_arg_long(argc, argv, 1, 12);
+
+  check_intercept();
+  check_cache();
+  if(fails){ printf("checks: FAILED (%d)\n", fails); return 1; }
+  printf("checks: OK\n\n");
+
+  /* raw predictor */
+  enum { NQ = 1<<16 };
+  static float qx[NQ], qy[NQ], qdx[NQ], qdy[NQ];
+  uint32_t s = 12345u;
+  for(int i=0;i<NQ;i++) random_ball(&s, &qx[i], &qy[i], &qdx[i], &qdy[i]);
+  const float face = SIM_WIDTH - 40 - SIM_BAT_HALF_W - SIM_BALL_R;
+  float sink = 0.0f;
+  uint64_t t0 = bench_now_ns();
+  for(int r=0;r<64;r++) for(int i=0;i<NQ;i++) sink += ai_intercept_y(qx[i], qy[i], qdx[i], qdy[i], face);
+  double raw_ns = (double)(bench_now_ns() - t0) / (64.0*NQ);
+
+  /* cached, over live play */
+  Game g; sim_init(&g, 5u); sim_new_game(&g, 1);
+  AiAgent agent; ai_agent_init(&agent, AI_TIER_HARD, 0, 9u);
+  long q = 0; uint64_t tq = 0;
+  for(int i=0;i<200000;i++){
+    if(g.state!=ST_PLAY){ sim_new_game(&g, 1); }
+    float y;
+    uint64_t a = bench_now_ns();
+    for(int k=0;k<16;k++){ ai_predict(&agent.pred, &g, 0, &y); sink += y; }
+    tq += bench_now_ns() - a; q += 16;
+    Input in; in.buttons = ai_agent_buttons(&agent, &g);
+    sim_step(&g, &in, NULL);
+  }
+  printf("predictor: raw %.1f ns/query (%.1f M/s), cached %.1f ns/query (%.1f M/s)  [sink %d]\n\n",
+         raw_ns, 1e3/raw_ns, (double)tq/(double)q, 1e3*(double)q/(double)tq, (int)sink & 1);
+
+  /* win-rate matrix: row = left paddle, column = right; left wins % (draws) */
+  int players[AI_TIER_COUNT+1]; int np = 0;
+  players[np++] = BLEND;
+  for(int t=0;t<AI_TIER_COUNT;t++) players[np++] = t;
+  printf("win rate of row (left) vs column (right), %ld matches per cell, draws in ()\n%-8s", per_cell, "");
+  for(int c=0;c<np;c++) printf(" %11s", player_name(players[c]));
+  printf("\n");
+  long steps = 0;
+  t0 = bench_now_ns();
+  for(int r=0;r<np;r++){
+    printf("%-8s", player_name(players[r]));
+    for(int c=0;c<np;c++){
+      int wins = 0, draws = 0;
+      for(long m=0;m<per_cell;m++){
+        int w = play_match(players[r], players[c], 0x1000u + (uint32_t)(m*131 + r*17 + c), &steps);
+        if(w==0) wins++; else if(w<0) draws++;
+      }
+      printf(" %6.0f%% (%d)", 100.0*wins/(double)per_cell, draws);
+    }
+    printf("\n");
+  }
+
+  /* the tiers are graded against the blend AI, and one is an even match;
+   * 12 matches a cell is too few for that, so this takes its own 400 */
+  enum { NVS = 400 };
+  double rate[AI_TIER_COUNT];
+  printf("\nvs blend, %d matches each, sides alternating:", NVS);
+  for(int t=0;t<AI_TIER_COUNT;t++){
+    rate[t] = vs_blend(t, NVS, &steps);
+    printf("  %s %.1f%%", AI_TIERS[t].name, 100.0*rate[t]);
+  }
+  printf("\n");
+  int even = 0;
+  for(int t=0;t<AI_TIER_COUNT;t++){
+    if(t > 0) CHECK(rate[t-1] <= rate[t]);
+    even |= rate[t] >= 0.35 && rate[t] <= 0.65;
+  }
+  CHECK(even);
+  double secs = (double)(bench_now_ns() - t0)/1e9;
+  printf("%ld steps in %.2f s (%.1f M steps/s incl. agents)\n", steps, secs, (double)steps/secs/1e6);
+  return bench_status();
+}
@@ -0,0 +1,252 @@
+/* bench_assets.c — asset archive: checks + time-to-first-playable
+ * Usage: bench_assets [music_seconds]
+ * Checks (exit 1 on failure): pack/open round trip on a synthesized copy
+ * of the game's SFX set + a music track (page alignment, load order, name
+ * lookup, bytes), the incremental reader as bytes trickle in, malformed
+ * archives, the mmap'd file path and WAV decode straight from an entry.
+ * Then compares time-to-first-playable over a simulated link:
+ *   preload  what --preload-file does today: the whole bundle (music
+ *            included) arrives before main(), then every SFX is decoded
+ *            and audio goes live once all of them are;
+ *   pak      the archive streams in; each entry is decoded as soon as its
+ *            last byte lands, first-needed first, music in the background.
+ * Transfer time is modelled (RTT + bytes/bandwidth); decode time is the
+ * real cost of decoding each entry here. Corpus is PCM16 WAV at 22.05 kHz,
+ * so decode is a lower bound on the browser's Ogg decode.
+ */
+
+#include "bench_util.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "asset_pack.h"
+#include "audio_mixer.h"
+
+#define RATE 22050
+#define MAX_SRC 32
+
+/* -------------------------------- Corpus -------------------------------- */
+static uint8_t* make_wav(uint32_t frames, double hz, uint32_t* size){
+  uint32_t bytes = 44u + frames*2u;
+  uint8_t* w = (uint8_t*)malloc(bytes);
+  if(!w) return NULL;
+  uint32_t h[11] = { 0x46464952u, 36u + frames*2u, 0x45564157u, 0x20746D66u, 16u,
+                     1u | 1u<<16, RATE, RATE*2u, 2u | 16u<<16, 0x61746164u, frames*2u };
+  for(int i=0;i<11;i++) for(int k=0;k<4;k++) w[i*4+k] = (uint8_t)(h[i] >> (8*k));
+  for(uint32_t i=0;i<frames;i++){
+    double env = exp(-3.0*(double)i/(double)frames);
+    int16_t v = (int16_t)(12000.0*env*sin(2.0*3.14159265358979*hz*(double)i/RATE));
+    w[44+2*i] = (uint8_t)v; w[45+2*i] = (uint8_t)((uint16_t)v >> 8);
+  }
+  *size = bytes;
+  return w;
+}
+
+/* The sounds audio_queue.c asks for, in directory (name) order, plus music.
+ * Lengths: short blips for the menu, longer hits, a long goal jingle. */
+static int make_corpus(AssetSrc* src, char names[][32], double music_secs){
+  static const struct { const char* name; int variants; double secs; } set[] = {
+    { "bounce", 5, 0.20 }, { "bounce_synth", 1, 0.25 }, { "down", 1, 0.08 },
+    { "hit", 5, 0.25 }, { "hit_fast", 1, 0.30 }, { "hit_medium", 1, 0.30 },
+    { "hit_slow", 1, 0.30 }, { "hit_veryfast", 1, 0.35 }, { "score_goal", 1, 1.50 },
+    { "up", 1, 0.08 },
+  };
+  int n = 0;
+  snprintf(names[n], 32, "music/theme.wav");
+  src[n].data = make_wav((uint32_t)(music_secs*RATE), 110.0, &src[n].size); n++;
+  for(size_t k=0;k<sizeof(set)/sizeof(set[0]);k++)
+    for(int v=0;v<set[k].variants;v++){
+      if(set[k].variants > 1) snprintf(names[n], 32, "sounds/%s%d.wav", set[k].name, v);
+      else snprintf(names[n], 32, "sounds/%s.wav", set[k].name);
+      src[n].data = make_wav((uint32_t)(set[k].secs*RATE) + 37u*(uint32_t)n, 300.0 + 40.0*n, &src[n].size);
+      n++;
+    }
+  for(int i=0;i<n;i++){ src[i].name = names[i]; src[i].codec = (uint8_t)asset_codec_for(names[i]); src[i].flags = 0; }
+  return n;
+}
+
+/* -------------------------------- Checks -------------------------------- */
+static void put_u32(uint8_t* p, uint32_t v){ for(int k=0;k<4;k++) p[k] = (uint8_t)(v >> (8*k)); }
+
+static void check_pack(const AssetSrc* src, int n, const uint8_t* pak, size_t size){
+  AssetPack p;
+  CHECK(asset_pack_open(&p, pak, size) == 1);
+  CHECK(p.count == (uint32_t)n && p.total == size && p.ready == p.count);
+  for(int i=0;i<n;i++){
+    AssetEntry e; asset_pack_entry(&p, (uint32_t)i, &e);
+    CHECK(e.offset % ASSET_PAGE == 0);
+    CHECK(!strcmp(e.name, src[i].name) && e.hash == asset_hash(src[i].name));
+    CHECK(asset_pack_find(&p, src[i].name) == i);
+    uint32_t len; const uint8_t* d = asset_pack_data(&p, (uint32_t)i, &len);
+    CHECK(d && len == src[i].size && !memcmp(d, src[i].data, len));
+    CHECK(e.codec == ASSET_CODEC_WAV);
+    CHECK(!(e.flags & ASSET_FLAG_STREAM) == !!strncmp(e.name, "music/", 6));
+  }
+  AssetEntry first, last;
+  asset_pack_entry(&p, 0, &first); asset_pack_entry(&p, p.count-1, &last);
+  CHECK(!strcmp(first.name, "sounds/up.wav"));
+  CHECK(!strcmp(last.name, "music/theme.wav"));
+  CHECK(asset_pack_find(&p, "sounds/nope.wav") == -1);
+
+  /* decode straight out of the archive */
+  int hit = asset_pack_find(&p, "sounds/hit2.wav");
+  uint32_t len; const uint8_t* d = asset_pack_data(&p, (uint32_t)hit, &len);
+  float *a = NULL, *b = NULL; uint32_t fa = 0, fb = 0; int ra = 0, rb = 0;
+  CHECK(mix_parse_wav(d, len, &a, &fa, &ra));
+  CHECK(mix_parse_wav((const uint8_t*)src[hit].data, src[hit].size, &b, &fb, &rb));
+  CHECK(a && b && fa == fb && ra == RATE && !memcmp(a, b, sizeof(float)*fa));
+  free(a); free(b);
+}
+
+/* Bytes trickle in: not open until the index is whole, then entries become
+ * ready strictly in order, exactly when their last byte arrives. */
+static void check_incremental(const uint8_t* pak, size_t size){
+  AssetPack p; int opened = 0; long early = 0, late = 0;
+  size_t index_end = 0;
+  for(size_t have=0;; have = size - have > 997 ? have + 997 : size){
+    if(!opened){
+      int r = asset_pack_open(&p, pak, have);
+      CHECK(r >= 0);
+      if(r == 1){ opened = 1; index_end = have; }
+    } else {
+      uint32_t prev = p.ready, ready = asset_pack_received(&p, have);
+      CHECK(ready >= prev);
+      for(uint32_t i=0;i<p.count;i++){
+        AssetEntry e; asset_pack_entry(&p, i, &e);
+        int whole = (size_t)e.offset + e.size <= have;
+        uint32_t len;
+        if(whole != (i < ready)){ if(whole) late++; else early++; }
+        if((asset_pack_data(&p, i, &len) != NULL) != (i < ready)) early++;
+      }
+    }
+    if(have == size) break;
+  }
+  CHECK(opened && index_end < ASSET_PAGE + 997);
+  CHECK(p.ready == p.count && early == 0 && late == 0);
+}
+
+static void check_malformed(const uint8_t* pak, size_t size){
+  uint8_t* bad = (uint8_t*)malloc(size);
+  AssetPack p;
+  memcpy(bad, pak, size); bad[0] ^= 1;
+  CHECK(asset_pack_open(&p, bad, size) == -1);
+  memcpy(bad, pak, size); put_u32(bad + ASSET_HEADER_BYTES + 4, ASSET_PAGE + 8u);   /* unaligned */
+  CHECK(asset_pack_open(&p, bad, size) == -1);
+  memcpy(bad, pak, size); put_u32(bad + ASSET_HEADER_BYTES + 8, (uint32_t)size);    /* past the end */
+  CHECK(asset_pack_open(&p, bad, size) == -1);
+  uint32_t count = (uint32_t)bad[6] | (uint32_t)bad[7]<<8, last = ASSET_HEADER_BYTES + (count-1u)*ASSET_ENTRY_BYTES;
+  memcpy(bad, pak, size); put_u32(bad + last + 4, ((uint32_t)size/ASSET_PAGE + 2u)*ASSET_PAGE);   /* starts past the end */
+  put_u32(bad + last + 8, 1u);
+  CHECK(asset_pack_open(&p, bad, size) == -1);
+  memcpy(bad, pak, size); put_u32(bad + 8, 0xFFFFFFF0u);   /* index size wraps header + index */
+  CHECK(asset_pack_open(&p, bad, size) == -1);
+  CHECK(asset_pack_open(&p, bad, ASSET_HEADER_BYTES) == -1);
+  memcpy(bad, pak, size); bad[6] = bad[7] = 0xFF;          /* more entries than the index holds */
+  CHECK(asset_pack_open(&p, bad, size) == -1);
+  CHECK(asset_pack_open(&p, pak, ASSET_HEADER_BYTES - 1) == 0);
+  CHECK(asset_pack_open(&p, pak, ASSET_HEADER_BYTES + 8) == 0);
+  free(bad);
+}
+
+static void check_file(const uint8_t* pak, size_t size){
+  const char* path = "bench_assets.tmp.pak";
+  FILE* fp = fopen(path, "wb");
+  CHECK(fp && fwrite(pak, 1, size, fp) == size);
+  if(fp) fclose(fp);
+  AssetFile f;
+  CHECK(asset_file_open(&f, path));
+  CHECK(f.size == size && f.pack.ready == f.pack.count && !memcmp(f.base, pak, size));
+  asset_file_close(&f);
+  fp = fopen(path, "ab"); if(fp){ fputc(0, fp); fclose(fp); }   /* size mismatch */
+  CHECK(!asset_file_open(&f, path));
+  remove(path);
+  CHECK(!asset_file_open(&f, path));
+}
+
+/* ------------------------- Time to first playable ------------------------ */
+static uint64_t decode_ns(const uint8_t* d, uint32_t len){
+  float* pcm = NULL; uint32_t frames; int rate;
+  uint64_t t0 = bench_now_ns();
+  int ok = mix_parse_wav(d, len, &pcm, &frames, &rate);
+  uint64_t t = bench_now_ns() - t0;
+  CHECK(ok);
+  free(pcm);
+  return t;
+}
+
+typedef struct { double first, all_sfx; } Ttfp;
+
+/* Whole bundle, then every SFX decoded (js_audio_load_all's Promise.all). */
+static Ttfp ttfp_preload(const AssetSrc* src, int n, double rtt, double bps){
+  double bytes = 0, t;
+  for(int i=0;i<n;i++) bytes += src[i].size;
+  t = rtt + bytes/bps;
+  for(int i=0;i<n;i++)
+    if(strncmp(src[i].name, "music/", 6)) t += (double)decode_ns((const uint8_t*)src[i].data, src[i].size)/1e9;
+  Ttfp r = { t, t };
+  return r;
+}
+
+/* Stream the archive in 16 KB chunks through the real reader; decodes run
+ * one at a time as entries complete, overlapping the transfer. */
+static Ttfp ttfp_pak(const uint8_t* pak, size_t size, double rtt, double bps){
+  enum { CHUNK = 16384 };
+  AssetPack p; int opened = 0; uint32_t done = 0;
+  double busy = 0;                 /* decoder free at */
+  Ttfp r = { -1, -1 };
+  for(size_t have=0; have<size;){
+    have = size - have < CHUNK ? size : have + CHUNK;
+    double now = rtt + (double)have/bps;
+    if(!opened){ if(asset_pack_open(&p, pak, have) != 1) continue; opened = 1; }
+    else asset_pack_received(&p, have);
+    for(; done<p.ready; done++){
+      AssetEntry e; asset_pack_entry(&p, done, &e);
+      if(e.flags & ASSET_FLAG_STREAM) continue;
+      busy = (busy > now ? busy : now) + (double)decode_ns(pak + e.offset, e.size)/1e9;
+      if(r.first < 0) r.first = busy;
+      r.all_sfx = busy;
+    }
+  }
+  return r;
+}
+
+int main(int argc, char** argv){
+  double music_secs = (double)bench_arg_long(argc, argv, 1, 60);
+
+  static AssetSrc src[MAX_SRC]; static char names[MAX_SRC][32];
+  int n = make_corpus(src, names, music_secs);
+  asset_plan(src, n);
+  size_t size = 0;
+  uint8_t* pak = asset_pack_build(src, n, &size);
+  CHECK(pak != NULL);
+  if(!pak) return 1;
+
+  check_pack(src, n, pak, size);
+  check_incremental(pak, size);
+  check_malformed(pak, size);
+  check_file(pak, size);
+  if(fails){ printf("checks: FAILED (%d)\n", fails); return 1; }
+  printf("checks: OK (round trip, incremental, malformed, file, decode)\n\n");
+
+  double sfx = 0, raw = 0;
+  for(int i=0;i<n;i++){ raw += src[i].size; if(strncmp(src[i].name, "music/", 6)) sfx += src[i].size; }
+  printf("%d entries: %.0f KB SFX + %.0f KB music, archive %.0f KB (%.1f%% page padding)\n\n",
+         n, sfx/1024, (raw - sfx)/1024, (double)size/1024, 100.0*((double)size - raw)/raw);
+
+  static const struct { const char* name; double rtt_ms, mbit; } links[] = {
+    { "3G", 150, 1.6 }, { "DSL", 40, 10 }, { "cable", 20, 100 }, { "LAN", 2, 1000 }, { "local", 0, 0 }
+  };
+  printf("time to first playable, ms (preload: every SFX at once; pak: first SFX, all SFX)\n");
+  printf("%-7s %9s %9s %9s %9s %9s %9s\n", "link", "RTT", "Mbit/s", "preload", "pak 1st", "pak all", "speedup");
+  for(size_t k=0;k<sizeof(links)/sizeof(links[0]);k++){
+    double rtt = links[k].rtt_ms/1e3, bps = links[k].mbit > 0 ? links[k].mbit*1e6/8 : 1e18;
+    Ttfp a = ttfp_preload(src, n, rtt, bps), b = ttfp_pak(pak, size, rtt, bps);
+    printf("%-7s %9.0f %9.1f %9.2f %9.2f %9.2f %8.1fx\n", links[k].name, links[k].rtt_ms, links[k].mbit,
+           a.first*1e3, b.first*1e3, b.all_sfx*1e3, a.first/b.first);
+  }
+  free(pak);
+  for(int i=0;i<n;i++) free((void*)src[i].data);
+  return bench_status();
+}
@@ -0,0 +1,113 @@
+/* bench_audio.c — per-frame SFX queue: checks + cost
+ * Usage: bench_audio [frames]
+ * Checks merging, the voice budget, ring wrap/overflow and the sim-event
+ * mapping (exit 1 on failure). Then plays a seeded match and reports
+ * requests vs ring entries and JS drains per frame, plus ns per frame for
+ * queueing + flushing.
+ */
+
+#include "bench_util.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "audio_queue.h"
+#include "sim.h"
+
+static void check_merge_and_budget(void){
+  AudioQueue q; Sfx s; int layers;
+  audio_queue_init(&q, AUDIO_VOICES_PER_FRAME);
+
+  /* three bounces + a hit in one frame: one entry per sound */
+  Events ev; ev.n = 0;
+  for(int i=0;i<3;i++){ ev.ev[ev.n].type = EV_BOUNCE; ev.ev[ev.n].speed = 9; ev.n++; }
+  ev.ev[ev.n].type = EV_HIT; ev.ev[ev.n].speed = 14; ev.n++;
+  audio_play_events(&q, &ev);
+  CHECK(q.requests == 8 && q.merged == 4);
+  CHECK(audio_queue_flush(&q) == 4);
+  CHECK(audio_ring_count(&q.ring) == 4);
+  /* priority order: tier, hit, synth, bounce — 1+5+1+5 = the whole budget */
+  CHECK(audio_ring_pop(&q.ring, &s, &layers) && s == SFX_HIT_FAST && layers == 1);
+  CHECK(audio_ring_pop(&q.ring, &s, &layers) && s == SFX_HIT && layers == 5);
+  CHECK(audio_ring_pop(&q.ring, &s, &layers) && s == SFX_BOUNCE_SYNTH && layers == 1);
+  CHECK(audio_ring_pop(&q.ring, &s, &layers) && s == SFX_BOUNCE && layers == 5);
+  CHECK(!audio_ring_pop(&q.ring, &s, &layers));
+  CHECK(q.limited == 0);
+
+  /* a goal on top exceeds the budget: the lowest priority sound is cut */
+  audio_play(&q, SFX_SCORE_GOAL, 1);
+  audio_play(&q, SFX_HIT, 5); audio_play(&q, SFX_HIT_SLOW, 1);
+  audio_play(&q, SFX_BOUNCE, 5); audio_play(&q, SFX_BOUNCE_SYNTH, 1);
+  audio_queue_flush(&q);
+  int total = 0, last = -1;
+  while(audio_ring_pop(&q.ring, &s, &layers)){ total += layers; last = (int)s; }
+  CHECK(total == AUDIO_VOICES_PER_FRAME && last == SFX_BOUNCE && q.limited == 1);
+
+  /* empty frame writes nothing */
+  CHECK(audio_queue_flush(&q) == 0 && audio_ring_count(&q.ring) == 0);
+}
+
+static void check_ring(void){
+  AudioQueue q; Sfx s; int layers;
+  audio_queue_init(&q, 1000);
+  /* wrap the 32-bit indices and fill past capacity without a consumer */
+  q.ring.head = q.ring.tail = 0xFFFFFFF0u;
+  for(unsigned f=0; f<AUDIO_RING_CAP/2u + 4u; f++){
+    audio_play(&q, SFX_UP, 1); audio_play(&q, SFX_DOWN, 2);
+    audio_queue_flush(&q);
+  }
+  CHECK(audio_ring_count(&q.ring) == AUDIO_RING_CAP);
+  CHECK(q.ring.dropped == 8);
+  int n = 0, ok = 1;
+  while(audio_ring_pop(&q.ring, &s, &layers)){ ok &= (n%2==0) ? (s==SFX_UP && layers==1) : (s==SFX_DOWN && layers==2); n++; }
+  CHECK(ok && n == (int)AUDIO_RING_CAP);
+}
+
+static void check_tiers(void){
+  static const int speeds[] = { 6, 10, 11, 12, 13, 16, 17, 40 };
+  static const Sfx want[]   = { SFX_HIT_SLOW, SFX_HIT_SLOW, SFX_HIT_MEDIUM, SFX_HIT_MEDIUM,
+                                SFX_HIT_FAST, SFX_HIT_FAST, SFX_HIT_VERYFAST, SFX_HIT_VERYFAST };
+  for(int i=0;i<8;i++){
+    AudioQueue q; Sfx s; int layers;
+    audio_queue_init(&q, AUDIO_VOICES_PER_FRAME);
+    Events ev; ev.n = 1; ev.ev[0].type = EV_HIT; ev.ev[0].speed = speeds[i];
+    audio_play_events(&q, &ev);
+    audio_queue_flush(&q);
+    CHECK(audio_ring_pop(&q.ring, &s, &layers) && s == want[i]);
+  }
+}
+
+int main(int argc, char** argv){
+  long frames = bench_arg_long(argc, argv, 1, 1000000);
+  check_merge_and_budget();
+  check_ring();
+  check_tiers();
+  if(fails){ printf("checks: %d FAILED\n", fails); return 1; }
+  printf("checks: OK\n");
+
+  Game g; AudioQueue q; Sfx s; int layers;
+  sim_init(&g, 7); sim_new_game(&g, 1);
+  g.bats[0].isAI = 1;  /* AI vs AI: long rallies, many contacts per frame late on */
+  audio_queue_init(&q, AUDIO_VOICES_PER_FRAME);
+  long entries = 0, drains = 0, voices = 0;
+  uint64_t t_queue = 0;
+  for(long f=0; f<frames; f++){
+    Events ev; ev.n = 0;
+    sim_step(&g, NULL, &ev);
+    if(g.state!=ST_PLAY || g.ball.speed>60){ sim_new_game(&g, 1); g.bats[0].isAI = 1; }
+
+    uint64_t t0 = bench_now_ns();
+    audio_play_events(&q, &ev);
+    audio_queue_flush(&q);
+    t_queue += bench_now_ns() - t0;
+
+    if(audio_ring_count(&q.ring)) drains++;
+    while(audio_ring_pop(&q.ring, &s, &layers)){ entries++; voices += layers; }
+  }
+  double n = (double)frames;
+  printf("frames: %ld, requests %u (merged %u, layers cut %u)\n", frames, q.requests, q.merged, q.limited);
+  printf("per frame: %.3f JS drains, %.3f ring entries, %.3f voices\n", drains/n, entries/n, voices/n);
+  printf("old path:  %.3f JS calls per frame (one per request)\n", q.requests/n);
+  printf("queue+flush: %.1f ns/frame\n", (double)t_queue/n);
+  return 0;
+}
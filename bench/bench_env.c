@@ -0,0 +1,116 @@
+/* bench_env.c — vectorized training env: parity checks + env-steps/sec
+ * Usage: bench_env [env_steps]
+ * Checks (exit 1 on failure): every lane's observation/reward/done matches
+ * a scalar sim_step() game fed the same actions, through natural game
+ * ends and max_steps truncation, including the auto-reset. Then reports
+ * env-steps/sec with random actions for a range of N.
+ */
+
+#include "bench_util.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "env.h"
+#include "sim.h"
+
+/* Every third lane mostly hides in the top corner and loses quickly; the
+ * rest follow the ball and tend to run into max_steps. */
+static int32_t policy(int lane, const float* o, uint32_t* s){
+  uint32_t r = bench_rng_next(s) % 8u;
+  if(lane % 3 == 0) return r ? ENV_ACT_UP : ENV_ACT_DOWN;
+  if(r < 2) return (int32_t)r;   /* stay / up at random */
+  if(o[1] > o[5] + 0.03f) return ENV_ACT_DOWN;
+  if(o[1] < o[5] - 0.03f) return ENV_ACT_UP;
+  return ENV_ACT_STAY;
+}
+
+/* -------------------------------- Checks -------------------------------- */
+static void ref_obs(const Game* g, float* o){
+  o[0] = g->ball.x * (2.0f/SIM_WIDTH) - 1.0f;
+  o[1] = g->ball.y * (2.0f/SIM_HEIGHT) - 1.0f;
+  o[2] = g->ball.dx; o[3] = g->ball.dy;
+  o[4] = (float)g->ball.speed / ENV_SPEED_SCALE;
+  o[5] = g->bats[0].y * (2.0f/SIM_HEIGHT) - 1.0f;
+  o[6] = g->bats[1].y * (2.0f/SIM_HEIGHT) - 1.0f;
+  o[7] = (float)(g->bats[0].score - g->bats[1].score) / (float)SIM_WIN_SCORE;
+}
+
+static void ref_new_game(Game* g, uint32_t seed){
+  sim_init(g, seed); g->solver = SIM_SOLVER_MICROSTEP; sim_new_game(g, 1);
+}
+
+static void check_parity(void){
+  enum { N = 37, STEPS = 12000, MAX = 3000 };
+  static float obs[N*ENV_OBS_DIM], rew[N], done[N], trunc[N];
+  static Game ref[N]; static int ref_steps[N];
+  PongEnv* e = pong_env_create(N, MAX);
+  CHECK(e != NULL);
+  if(!e) return;
+  pong_env_bind(e, obs, rew, done);
+  pong_env_bind_truncated(e, trunc);
+  uint32_t seeds[N];
+  for(int i=0;i<N;i++){ seeds[i] = 1000u + (uint32_t)i*77u; ref_new_game(&ref[i], seeds[i]); ref_steps[i] = 0; }
+  pong_env_reset(e, seeds);
+
+  uint32_t s = 42u; int32_t act[N];
+  long mismatches = 0, ends = 0, truncs = 0;
+  for(int t=0;t<STEPS;t++){
+    for(int i=0;i<N;i++) act[i] = policy(i, obs + i*ENV_OBS_DIM, &s);
+    pong_env_step(e, act);
+    for(int i=0;i<N;i++){
+      Game* g = &ref[i];
+      int s0 = g->bats[0].score, s1 = g->bats[1].score;
+      Input in; in.buttons = act[i]==ENV_ACT_UP ? IN_P1_UP : act[i]==ENV_ACT_DOWN ? IN_P1_DOWN : 0u;
+      sim_step(g, &in, NULL);
+      float r = (float)((g->bats[0].score - s0) - (g->bats[1].score - s1));
+      int over = g->state != ST_PLAY || ++ref_steps[i] >= MAX;
+      int cut = over && g->state == ST_PLAY;
+      if(over){ if(g->state==ST_PLAY) truncs++; else ends++; ref_new_game(g, g->rng); ref_steps[i] = 0; }
+      float o[ENV_OBS_DIM]; ref_obs(g, o);
+      if(memcmp(o, obs + i*ENV_OBS_DIM, sizeof o) || r != rew[i] || (float)over != done[i] || (float)cut != trunc[i]) mismatches++;
+    }
+  }
+  CHECK(mismatches == 0);
+  CHECK(ends > 0 && truncs > 0);
+  CHECK(pong_env_episodes(e) == ends + truncs);
+  printf("parity: %d lanes x %d steps, %ld games ended, %ld truncated, %ld mismatches\n",
+         N, STEPS, ends, truncs, mismatches);
+  pong_env_destroy(e);
+}
+
+int main(int argc, char** argv){
+  long total = bench_arg_long(argc, argv, 1, 4000000);
+
+  CHECK(pong_env_create(0, 0) == NULL);
+  check_parity();
+  if(fails){ printf("checks: FAILED (%d)\n", fails); return 1; }
+  printf("checks: OK\n\n");
+
+  printf("random actions, %ld env-steps per row\n", total);
+  printf("%-7s %14s %12s %10s\n", "N", "env-steps/s", "ns/env-step", "episodes");
+  static const int sizes[] = { 1, 16, 64, 256, 1024, 4096 };
+  for(size_t k=0;k<sizeof(sizes)/sizeof(sizes[0]);k++){
+    int n = sizes[k];
+    float* obs = (float*)malloc(sizeof(float)*(size_t)n*ENV_OBS_DIM);
+    float* rew = (float*)malloc(sizeof(float)*(size_t)n);
+    float* done = (float*)malloc(sizeof(float)*(size_t)n);
+    int32_t* act = (int32_t*)malloc(sizeof(int32_t)*(size_t)n);
+    PongEnv* e = pong_env_create(n, 0);
+    if(!obs || !rew || !done || !act || !e){ fprintf(stderr, "out of memory\n"); return 1; }
+    pong_env_bind(e, obs, rew, done);
+    pong_env_reset(e, NULL);
+    long steps = total / n; if(steps < 1) steps = 1;
+    uint32_t s = 7u;
+    uint64_t t0 = bench_now_ns();
+    for(long t=0;t<steps;t++){
+      for(int i=0;i<n;i++) act[i] = (int32_t)(bench_rng_next(&s) % 3u);
+      pong_env_step(e, act);
+    }
+    double secs = (double)(bench_now_ns() - t0)/1e9;
+    double es = (double)steps*(double)n;
+    printf("%-7d %14.0f %12.1f %10ld\n", n, es/secs, secs*1e9/es, pong_env_episodes(e));
+    pong_env_destroy(e); free(obs); free(rew); free(done); free(act);
+  }
+  return 0;
+}
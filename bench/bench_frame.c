@@ -0,0 +1,303 @@
+/* bench_frame.c — headless frame loop under the profiler
+ * Usage: bench_frame [frames] [-o trace.json]
+ * Runs the browser tick() pipeline without a browser: sim steps off a
+ * 60 Hz SimClock with a bot on P1, particles stepped, the SFX queue
+ * drained into the C mixer, the scene recorded (with the frame-time graph)
+ * and replayed on the null backend, HUD dirty tracking, all inside the
+ * same PROF_ZONEs. Checks
+ * (exit 1 on failure): runtime disable, zone nesting, counters vs what
+ * the loop did, ring wrap, dropped zones and depth overflow, trace JSON
+ * (length contract, structure, event count) and graph bounds. Then prints
+ * per-zone times, counters per frame and the profiler's own cost; -o
+ * writes the last PROF_FRAMES frames as Chrome trace JSON.
+ */
+
+#include "bench_util.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "audio_mixer.h"
+#include "audio_queue.h"
+#include "gfx.h"
+#include "hud.h"
+#include "prof.h"
+#include "scene.h"
+#include "sim.h"
+#include "sim_clock.h"
+#include "vfx.h"
+
+#ifndef PONG_PROFILE
+#  error "bench_frame needs -DPONG_PROFILE (set by CMakeLists.txt)"
+#endif
+
+#define RATE 48000
+
+/* ------------------------------- Frame loop ------------------------------ */
+typedef struct {
+  Game G, prevG;
+  Hud H;
+  SimClock clk;
+  AudioQueue AQ;
+  MixBank bank; Mixer mixer; MixRing ring;
+  GfxFrame frame; GfxBackend nb;
+  Vfx fx;
+  double now;
+  int steps;            /* sim steps run by the last frame */
+  int graph;
+} Loop;
+
+static unsigned bot_buttons(const Game* g){
+  unsigned b = 0;
+  float d = g->ball.y - g->bats[0].y;
+  if(d >  4.0f) b |= IN_P1_DOWN;
+  if(d < -4.0f) b |= IN_P1_UP;
+  return b;
+}
+
+static void loop_init(Loop* L, uint32_t seed){
+  memset(L, 0, sizeof(*L));
+  sim_init(&L->G, seed); sim_new_game(&L->G, 1);
+  L->prevG = L->G;
+  hud_init(&L->H);
+  sim_clock_init(&L->clk, SIM_TICK_HZ, SIM_MAX_CATCHUP);
+  audio_queue_init(&L->AQ, AUDIO_VOICES_PER_FRAME);
+  mix_bank_init(&L->bank, RATE*2);
+  for(int s=0;s<SFX_COUNT;s++)
+    for(int v=0;v<AUDIO_SFX_VARIANTS[s];v++){
+      float* p = mix_bank_add(&L->bank, (Sfx)s, v, RATE/20);
+      for(int i=0;i<RATE/20;i++) p[i] = 0.3f*sinf(0.05f*(float)(i*(s+1)));
+    }
+  mixer_init(&L->mixer, &L->bank, RATE);
+  mix_ring_init(&L->ring);
+  gfx_null_init(&L->nb);
+  vfx_init(&L->fx, 2048);
+  L->graph = 1;
+}
+
+/* tick() from render.c, minus the browser */
+static void loop_frame(Loop* L){
+  static float pull[RATE/60];
+  PROF_FRAME_BEGIN();
+  L->now += 1000.0/60.0;
+  int steps = sim_clock_advance(&L->clk, L->now);
+  if(L->G.state != ST_PLAY){ sim_new_game(&L->G, 1); L->prevG = L->G; }
+  L->steps = 0;
+  PROF_ZONE(PZ_SIM){
+    for(int i=0; i<steps && L->G.state==ST_PLAY; i++){
+      Input in; in.buttons = bot_buttons(&L->G);
+      Events ev; ev.n = 0;
+      L->prevG = L->G;
+      PROF_COUNT(PC_MICROSTEPS, L->G.ball.speed);
+      sim_step(&L->G, &in, &ev);
+      audio_play_events(&L->AQ, &ev);
+      vfx_emit_events(&L->fx, &ev); vfx_emit_trail(&L->fx, &L->G.ball);
+      vfx_step(&L->fx);
+      PROF_COUNT(PC_SIM_STEPS, 1); PROF_COUNT(PC_EVENTS, ev.n);
+      L->steps++;
+    }
+  }
+  PROF_COUNT(PC_PARTICLES, L->fx.n);
+  PROF_ZONE(PZ_AUDIO){
+    audio_queue_flush(&L->AQ);
+    PROF_COUNT(PC_SFX, (int)audio_ring_count(&L->AQ.ring));
+    mixer_drain(&L->mixer, &L->AQ.ring);
+    mix_ring_fill(&L->ring, &L->mixer, 2048u);
+    mix_ring_pull(&L->ring, pull, RATE/60);   /* the worklet's share */
+  }
+  PROF_ZONE(PZ_RENDER){
+    Game view; sim_lerp(&L->prevG, &L->G, sim_clock_alpha(&L->clk), &view);
+    hud_sync_game(&L->H, &L->G);
+    PROF_ZONE(PZ_SCENE){
+      scene_record(&view, &L->fx, NULL, &L->frame);
+      if(L->graph){
+        int cap; ShapeInstance* dst = gfx_shapes_reserve(&L->frame, &cap);
+        gfx_shapes_commit(&L->frame, prof_graph_build(dst, cap, 8.0f, SIM_HEIGHT - 88.0f, 240.0f, 80.0f, 50.0f));
+      }
+    }
+    PROF_ZONE(PZ_SUBMIT) gfx_submit(&L->nb, &L->frame);
+    PROF_COUNT(PC_DRAW_CALLS, L->nb.stats.draw_calls);
+    PROF_COUNT(PC_GL_STATE, L->nb.stats.state_changes + L->nb.stats.uniform_uploads);
+    PROF_COUNT(PC_INSTANCES, L->nb.stats.instances);
+    if(hud_take_dirty(&L->H)) PROF_ZONE(PZ_HUD){ PROF_COUNT(PC_JS_CALLS, 1); }
+  }
+  PROF_FRAME_END();
+}
+
+static void loop_free(Loop* L){ mix_bank_free(&L->bank); vfx_free(&L->fx); }
+
+/* -------------------------------- Checks -------------------------------- */
+static void check_loop(void){
+  static Loop L;
+  enum { N = 200 };
+  int steps[N];
+  loop_init(&L, 7u);
+
+  prof_reset(); prof_enable(0);
+  for(int i=0;i<10;i++) loop_frame(&L);
+  CHECK(prof_frame_count() == 0);
+  prof_enable(1);
+
+  for(int i=0;i<N;i++){ loop_frame(&L); steps[i] = L.steps; }
+  CHECK(prof_frame_count() == N);
+  long nesting = 0, counted = 0;
+  for(int b=0;b<N;b++){
+    const ProfFrame* f = prof_frame(b);
+    CHECK(f->dropped == 0);
+    counted += f->counter[PC_SIM_STEPS] != steps[N-1-b];
+    CHECK(f->counter[PC_DRAW_CALLS] == 2);   /* playfield + graph */
+    /* each record lies inside the frame and inside the nearest earlier
+       record one level up */
+    for(int i=0;i<f->n;i++){
+      const ProfRec* r = &f->rec[i];
+      if((uint64_t)r->start + r->dur > f->dur) nesting++;
+      if(r->depth == 1) continue;
+      int p = i - 1;
+      while(p >= 0 && f->rec[p].depth >= r->depth) p--;
+      if(p < 0 || f->rec[p].depth != r->depth - 1 || r->start < f->rec[p].start ||
+         (uint64_t)r->start + r->dur > (uint64_t)f->rec[p].start + f->rec[p].dur) nesting++;
+    }
+    int top = 0;
+    for(int i=0;i<f->n;i++) top += f->rec[i].depth == 1;
+    CHECK(top == 3);   /* sim, audio, render */
+  }
+  CHECK(nesting == 0 && counted == 0);
+  ProfStats s; prof_zone_stats(PZ_FRAME, &s);
+  CHECK(s.frames == N && s.avg_ms > 0 && s.max_ms >= s.avg_ms);
+  prof_zone_stats(PZ_SUBMIT, &s);
+  CHECK(s.frames == N);
+
+  /* graph: bounded, inside its box */
+  static ShapeInstance g[PROF_GRAPH_MAX];
+  int n = prof_graph_build(g, PROF_GRAPH_MAX, 10.0f, 20.0f, 240.0f, 80.0f, 50.0f);
+  CHECK(n > PROF_GRAPH_COLUMNS && n <= PROF_GRAPH_MAX);
+  int outside = 0;
+  for(int i=0;i<n;i++)
+    if(g[i].x - g[i].w/2 < 10.0f - 1e-3f || g[i].x + g[i].w/2 > 250.0f + 1e-3f ||
+       g[i].y - g[i].h/2 < 20.0f - 1e-3f || g[i].y + g[i].h/2 > 100.0f + 1e-3f || g[i].h < 0) outside++;
+  CHECK(outside == 0);
+  CHECK(prof_graph_build(g, 5, 10.0f, 20.0f, 240.0f, 80.0f, 50.0f) == 5);
+  loop_free(&L);
+}
+
+static void check_ring(void){
+  prof_reset();
+  for(int i=0;i<PROF_FRAMES+60;i++){ prof_frame_begin(); prof_count(PC_EVENTS, i); prof_frame_end(); }
+  CHECK(prof_frame_count() == PROF_FRAMES);
+  CHECK(prof_frame(0)->counter[PC_EVENTS] == PROF_FRAMES+59);
+  CHECK(prof_frame(PROF_FRAMES-1)->counter[PC_EVENTS] == 60);
+  CHECK(prof_frame(PROF_FRAMES) == NULL && prof_frame(-1) == NULL);
+
+  /* a frame still recording doesn't disturb the completed ones */
+  prof_frame_begin(); prof_count(PC_EVENTS, 1000);
+  CHECK(prof_frame(PROF_FRAMES-1)->counter[PC_EVENTS] == 60);
+  prof_frame_end();
+
+  /* too many zones: dropped and counted; too deep: ignored, stack intact */
+  prof_frame_begin();
+  for(int i=0;i<PROF_FRAME_ZONES+5;i++){ prof_zone_begin(PZ_SIM); prof_zone_end(); }
+  prof_frame_end();
+  CHECK(prof_frame(0)->n == PROF_FRAME_ZONES && prof_frame(0)->dropped == 5);
+  prof_frame_begin();
+  for(int i=0;i<PROF_DEPTH+3;i++) prof_zone_begin(PZ_RENDER);
+  for(int i=0;i<PROF_DEPTH+3;i++) prof_zone_end();
+  prof_zone_begin(PZ_AUDIO); prof_zone_end();
+  prof_zone_end();   /* unmatched: ignored */
+  prof_frame_end();
+  const ProfFrame* f = prof_frame(0);
+  CHECK(f->n == PROF_DEPTH + 1 && f->rec[PROF_DEPTH].depth == 1 && f->rec[PROF_DEPTH].zone == PZ_AUDIO);
+  CHECK(f->rec[PROF_DEPTH-1].depth == PROF_DEPTH);
+}
+
+/* Brackets/braces balance outside strings; one "X" per frame and zone. */
+static void check_json(void){
+  size_t len = prof_trace_json(NULL, 0);
+  char* buf = (char*)malloc(len + 1);
+  CHECK(buf && prof_trace_json(buf, len + 1) == len && strlen(buf) == len);
+  if(!buf) return;
+  CHECK(!strncmp(buf, "{\"traceEvents\":[", 16));
+  int depth = 0, bad = 0, in_str = 0; long xs = 0;
+  for(size_t i=0;i<len;i++){
+    char c = buf[i];
+    if(in_str){ if(c == '\\') i++; else if(c == '"') in_str = 0; continue; }
+    if(c == '"'){ in_str = 1; if(!strncmp(buf + i, "\"ph\":\"X\"", 8)) xs++; }
+    else if(c == '{' || c == '[') depth++;
+    else if(c == '}' || c == ']'){ if(--depth < 0) bad++; }
+  }
+  CHECK(depth == 0 && !bad && !in_str);
+  long want = 0;
+  for(int b=0;b<prof_frame_count();b++) want += 1 + prof_frame(b)->n;
+  CHECK(xs == want);
+  char small[100];
+  CHECK(prof_trace_json(small, sizeof small) == len && strlen(small) == sizeof small - 1);
+  free(buf);
+}
+
+/* --------------------------------- Main ---------------------------------- */
+int main(int argc, char** argv){
+  long frames = bench_arg_long(argc, argv, 1, 3600);
+  const char* out = NULL;
+  for(int i=1;i<argc-1;i++) if(!strcmp(argv[i], "-o")) out = argv[i+1];
+
+  check_loop();
+  check_ring();
+  check_loop();   /* leaves a real run in the ring for the JSON check */
+  check_json();
+  if(fails){ printf("checks: FAILED (%d)\n", fails); return 1; }
+  printf("checks: OK (disable, nesting, counters, ring, overflow, json, graph)\n\n");
+
+  static Loop L;
+  loop_init(&L, 99u);
+  prof_reset(); L.graph = 0;
+  uint64_t t0 = bench_now_ns();
+  for(long i=0;i<frames;i++) loop_frame(&L);
+  double on_ns = (double)(bench_now_ns() - t0)/(double)frames;
+  prof_reset(); L.graph = 1;
+  t0 = bench_now_ns();
+  for(long i=0;i<frames;i++) loop_frame(&L);
+  double graph_ns = (double)(bench_now_ns() - t0)/(double)frames;
+
+  printf("last %d of %ld frames\n", prof_frame_count(), frames);
+  printf("%-8s %10s %10s %8s\n", "zone", "avg ms", "max ms", "frames");
+  for(int z=0;z<PZ_COUNT;z++){
+    ProfStats s; prof_zone_stats((ProfZone)z, &s);
+    printf("%-8s %10.4f %10.4f %8u\n", PROF_ZONE_NAME[z], s.avg_ms, s.max_ms, (unsigned)s.frames);
+  }
+  printf("\ncounters per frame:");
+  for(int c=0;c<PC_COUNT;c++){
+    double sum = 0;
+    for(int b=0;b<prof_frame_count();b++) sum += prof_frame(b)->counter[c];
+    printf(" %s %.2f", PROF_COUNTER_NAME[c], sum/prof_frame_count());
+  }
+  printf("\n");
+
+  if(out){
+    size_t len = prof_trace_json(NULL, 0);
+    char* buf = (char*)malloc(len + 1);
+    FILE* fp = buf ? fopen(out, "wb") : NULL;
+    if(!fp || (prof_trace_json(buf, len + 1), fwrite(buf, 1, len, fp)) != len){ fprintf(stderr, "%s: write failed\n", out); return 1; }
+    fclose(fp); free(buf);
+    printf("wrote %s (%zu bytes)\n", out, len);
+  }
+
+  /* the profiler's own cost */
+  enum { PAIRS = 1000000 };
+  prof_reset(); prof_frame_begin();
+  t0 = bench_now_ns();
+  for(int i=0;i<PAIRS;i++){ prof_zone_begin(PZ_SIM); prof_zone_end(); }
+  double pair_ns = (double)(bench_now_ns() - t0)/PAIRS;
+  prof_frame_end();
+  prof_enable(0);
+  t0 = bench_now_ns();
+  for(int i=0;i<PAIRS;i++){ prof_zone_begin(PZ_SIM); prof_zone_end(); }
+  double off_pair_ns = (double)(bench_now_ns() - t0)/PAIRS;
+  L.graph = 0;
+  t0 = bench_now_ns();
+  for(long i=0;i<frames;i++) loop_frame(&L);
+  double off_ns = (double)(bench_now_ns() - t0)/(double)frames;
+  printf("\nzone begin+end: %.1f ns recording, %.1f ns disabled at runtime (0 compiled out)\n", pair_ns, off_pair_ns);
+  printf("frame: %.0f ns profiler off, %.0f ns profiled, %.0f ns profiled + graph\n", off_ns, on_ns, graph_ns);
+  loop_free(&L);
+  return 0;
+}
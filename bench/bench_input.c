@@ -0,0 +1,197 @@
+/* bench_input.c — input ring + per-step consumption: checks + latency
+ * Usage: bench_input [frames]
+ * Checks the key map, repeat filtering, multi-key holds, taps shorter than
+ * a step, splitting events across the steps of one frame, ring wrap and
+ * overflow, and the latency histogram (exit 1 on failure). Then replays
+ * random key taps against a 60 Hz display driving the fixed-step clock and
+ * reports key-to-submit latency percentiles and taps lost by the old
+ * "sample key state once per frame" polling, plus ns per event.
+ */
+
+#include "bench_util.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "input.h"
+#include "sim_clock.h"
+
+enum { KC_SPACE = 32, KC_UP = 38, KC_DOWN = 40, KC_A = 65, KC_Z = 90, KC_K = 75, KC_F5 = 116 };
+
+static void check_map_and_holds(void){
+  InputKeyMap km; InputRing r; InputState s; uint32_t pressed;
+  input_keymap_default(&km); input_ring_init(&r); input_state_init(&s);
+
+  CHECK(input_key_event(&r, &km, KC_F5, 1, 0.0) == 0);   /* unmapped: browser keeps it */
+  CHECK(input_key_event(&r, &km, 1000, 1, 0.0) == 0);
+  CHECK(r.head == 0);
+
+  /* A and ArrowUp both hold P1 up; releasing one keeps it held */
+  input_key_event(&r, &km, KC_A, 1, 1.0);
+  input_key_event(&r, &km, KC_UP, 1, 2.0);
+  input_key_event(&r, &km, KC_A, 1, 3.0);                /* repeat: ignored */
+  Input in = input_step(&s, &r, 5.0, &pressed);
+  CHECK(in.buttons == IN_P1_UP);
+  CHECK(pressed == (IN_P1_UP | ACT_MENU_UP));
+  input_key_event(&r, &km, KC_A, 0, 6.0);
+  in = input_step(&s, &r, 10.0, &pressed);
+  CHECK(in.buttons == IN_P1_UP && pressed == 0);
+  input_key_event(&r, &km, KC_UP, 0, 11.0);
+  in = input_step(&s, &r, 15.0, &pressed);
+  CHECK(in.buttons == 0 && s.held == 0);
+
+  /* menu/start actions never leak into the sim's buttons */
+  input_key_event(&r, &km, KC_SPACE, 1, 16.0);
+  in = input_step(&s, &r, 20.0, &pressed);
+  CHECK(in.buttons == 0 && pressed == ACT_START);
+
+  /* rebinding goes through the table */
+  input_keymap_bind(&km, KC_K, ACT_START);
+  input_key_event(&r, &km, KC_K, 1, 21.0);
+  input_step(&s, &r, 25.0, &pressed);
+  CHECK(pressed == ACT_START);
+}
+
+static void check_steps(void){
+  InputKeyMap km; InputRing r; InputState s; uint32_t pressed;
+  input_keymap_default(&km); input_ring_init(&r); input_state_init(&s);
+
+  /* a 3 ms tap inside one step still moves the paddle in that step */
+  input_key_event(&r, &km, KC_Z, 1, 101.0);
+  input_key_event(&r, &km, KC_Z, 0, 104.0);
+  Input in = input_step(&s, &r, 100.0, NULL);
+  CHECK(in.buttons == 0 && r.tail == 0);                  /* not due yet */
+  in = input_step(&s, &r, 116.6, NULL);
+  CHECK(in.buttons == IN_P1_DOWN);
+  in = input_step(&s, &r, 133.3, NULL);
+  CHECK(in.buttons == 0);
+
+  /* one frame running three steps: each step sees only its own events */
+  SimClock c; sim_clock_init(&c, SIM_TICK_HZ, SIM_MAX_CATCHUP);
+  sim_clock_advance(&c, 1000.0);
+  input_key_event(&r, &km, KC_A, 1, 1010.0);
+  input_key_event(&r, &km, KC_A, 0, 1030.0);
+  input_key_event(&r, &km, KC_K, 1, 1045.0);
+  int n = sim_clock_advance(&c, 1000.0 + 3.0*c.step_ms + 1.0);
+  CHECK(n == 3);
+  unsigned got[3];
+  for(int i=0;i<n;i++) got[i] = input_step(&s, &r, sim_clock_step_time(&c, i, n), &pressed).buttons;
+  CHECK(got[0] == IN_P1_UP);               /* ends ~1016.7 */
+  CHECK(got[1] == 0);                      /* ends ~1033.3: released */
+  CHECK(got[2] == IN_P2_UP);               /* ends ~1050.0 */
+  CHECK(sim_clock_step_time(&c, n-1, n) <= 1000.0 + 3.0*c.step_ms + 1.0);
+}
+
+static void check_ring(void){
+  InputKeyMap km; InputRing r; InputState s;
+  input_keymap_default(&km); input_ring_init(&r); input_state_init(&s);
+  /* wrap the 32-bit indices, then overflow without a consumer */
+  r.head = r.tail = 0xFFFFFFF0u;
+  for(unsigned i=0;i<INPUT_RING_CAP+10u;i++) input_key_event(&r, &km, KC_A, (int)(i&1u)^1, (double)i);
+  CHECK(r.head - r.tail == INPUT_RING_CAP && r.dropped == 10);
+  Input in = input_step(&s, &r, 1e9, NULL);
+  CHECK(r.head == r.tail);
+  CHECK(in.buttons == IN_P1_UP);          /* tapped during the step, released at the end */
+  CHECK(s.held == 0);
+  CHECK(s.nPending == INPUT_MAX_PENDING); /* capped, not overrun */
+}
+
+static void check_latency(void){
+  InputLatency h; input_latency_reset(&h);
+  CHECK(input_latency_percentile(&h, 50) == 0.0 && input_latency_mean(&h) == 0.0);
+  for(int i=0;i<100;i++) input_latency_add(&h, (double)i*0.1);  /* 0.0 .. 9.9 ms */
+  CHECK(h.count == 100);
+  CHECK(input_latency_percentile(&h, 50) == 5.0);
+  CHECK(input_latency_percentile(&h, 99) == h.max_ms);   /* bucket edge 10.0, capped at 9.9 */
+  CHECK(input_latency_mean(&h) > 4.94 && input_latency_mean(&h) < 4.96);
+  input_latency_add(&h, 500.0);                                   /* overflow bucket */
+  CHECK(input_latency_percentile(&h, 100) == 500.0);
+
+  InputState s; input_state_init(&s);
+  s.pending[0] = 10.0; s.pending[1] = 12.0; s.nPending = 2;
+  input_frame_submitted(&s, 20.0);
+  CHECK(s.latency.count == 2 && s.nPending == 0 && s.latency.max_ms == 10.0);
+}
+
+/* -------------------------------- Replay -------------------------------- */
+
+static void replay(long frames){
+  const double frame_ms = 1000.0/60.0, render_ms = 2.0;   /* tick work before submit */
+  InputKeyMap km; InputRing r; InputState s; SimClock c;
+  input_keymap_default(&km); input_ring_init(&r); input_state_init(&s);
+  sim_clock_init(&c, SIM_TICK_HZ, SIM_MAX_CATCHUP);
+  sim_clock_advance(&c, 0.0);
+
+  /* taps of 5..40 ms every 20..120 ms, on A */
+  uint32_t seed = 0x1234567u;
+  double next_down = 10.0, up_at = -1.0;
+  long taps = 0, lost_polled = 0, seen_in_steps = 0;
+  int tap_open = 0, tap_seen = 0, polled_down = 0;
+
+  for(long f=1; f<=frames; f++){
+    double now = (double)f*frame_ms;
+    /* key events that happened since the last frame, in time order */
+    for(;;){
+      double t = tap_open ? up_at : next_down;
+      if(t > now) break;
+      if(!tap_open){
+        input_key_event(&r, &km, KC_A, 1, t);
+        up_at = t + 5.0 + (double)(bench_rng_next(&seed)%36u);
+        tap_open = 1; tap_seen = 0; taps++;
+        polled_down = 0;
+      } else {
+        input_key_event(&r, &km, KC_A, 0, t);
+        next_down = t + 20.0 + (double)(bench_rng_next(&seed)%101u);
+        tap_open = 0;
+        if(!polled_down) lost_polled++;   /* never held at a frame start */
+      }
+    }
+    if(tap_open) polled_down = 1;         /* the old code saw key state at tick time */
+
+    int n = sim_clock_advance(&c, now);
+    for(int i=0;i<n;i++){
+      Input in = input_step(&s, &r, sim_clock_step_time(&c, i, n), NULL);
+      if((in.buttons & IN_P1_UP) && !tap_seen){ tap_seen = 1; seen_in_steps++; }
+    }
+    input_frame_submitted(&s, now + render_ms);
+  }
+
+  const InputLatency* h = &s.latency;
+  printf("replay: %ld frames @60 Hz, %ld taps (5..40 ms), render %.1f ms before submit\n", frames, taps, render_ms);
+  printf("  key-to-submit ms: mean %.2f  p50 %.2f  p95 %.2f  p99 %.2f  max %.2f  (%u events)\n",
+         input_latency_mean(h), input_latency_percentile(h, 50), input_latency_percentile(h, 95),
+         input_latency_percentile(h, 99), h->max_ms, h->count);
+  printf("  taps reaching a sim step: %ld/%ld per-step ring, %ld/%ld polled once per frame\n",
+         seen_in_steps, taps, taps - lost_polled, taps);
+  CHECK(seen_in_steps >= taps - 1);      /* the last tap may still be in flight */
+  CHECK(r.dropped == 0);
+}
+
+int main(int argc, char** argv){
+  long frames = bench_arg_long(argc, argv, 1, 36000);
+
+  check_map_and_holds();
+  check_steps();
+  check_ring();
+  check_latency();
+  if(fails){ printf("checks: FAILED (%d)\n", fails); return 1; }
+  printf("checks: OK (key map, holds, taps, per-step split, ring, histogram)\n\n");
+
+  replay(frames);
+  if(fails){ printf("replay: FAILED (%d)\n", fails); return 1; }
+
+  /* push + consume cost */
+  InputKeyMap km; InputRing r; InputState s;
+  input_keymap_default(&km); input_ring_init(&r); input_state_init(&s);
+  const long N = 4000000;
+  uint64_t t0 = bench_now_ns();
+  unsigned sink = 0;
+  for(long i=0;i<N;i+=8){
+    for(int k=0;k<8;k++) input_key_event(&r, &km, (k&2) ? KC_A : KC_K, (k&1)^1, (double)(i+k));
+    sink += input_step(&s, &r, (double)(i+8), NULL).buttons;
+    s.nPending = 0;
+  }
+  uint64_t dt = bench_now_ns() - t0;
+  printf("\npush+consume: %.1f ns/event (sink %u)\n", (double)dt/(double)N, sink & 1u);
+  return 0;
+}
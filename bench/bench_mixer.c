@@ -0,0 +1,262 @@
+/* bench_mixer.c — software SFX mixer: checks, reference PCM, mix cost
+ * Usage: bench_mixer [quanta] [-o out.wav] [-g reference.wav]
+ * Checks (exit 1 on failure): arena layout, priority stealing, the SIMD mix
+ * against a double-precision reference every quantum (voices ending
+ * mid-quantum included), the PCM ring against direct rendering plus
+ * underruns, queue draining and WAV round trips. Then mixes a seeded
+ * match's SFX with a synthesized bank; -o writes that as a float WAV and
+ * -g compares against one (exit 1 on any sample off by >1e-6). Finally
+ * reports ns per 128-frame quantum by voice count, SIMD vs scalar.
+ */
+
+#include "bench_util.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "audio_mixer.h"
+#include "sim.h"
+
+#define RATE 48000
+
+/* --------------------------------- Bank --------------------------------- */
+/* A decaying tone per sound/variant. Lengths are deliberately not multiples
+ * of the SIMD width or the quantum. */
+static void synth_bank(MixBank* b){
+  mix_bank_init(b, RATE*8);
+  for(int s=0;s<SFX_COUNT;s++)
+    for(int v=0;v<AUDIO_SFX_VARIANTS[s];v++){
+      uint32_t n = (uint32_t)(RATE/20 + s*1777 + v*613);
+      float* p = mix_bank_add(b, (Sfx)s, v, n);
+      double f = 220.0*(1.0 + 0.25*s + 0.05*v);
+      for(uint32_t i=0;i<n;i++)
+        p[i] = (float)(0.4*sin(2.0*3.14159265358979*f*(double)i/RATE) * exp(-4.0*(double)i/(double)n));
+    }
+}
+
+/* ---------------------------------- Checks ---------------------------------- */
+static void check_bank(const MixBank* b){
+  uint32_t at = 0;
+  for(int s=0;s<SFX_COUNT;s++){
+    CHECK(b->variants[s] == AUDIO_SFX_VARIANTS[s]);
+    for(int v=0;v<b->variants[s];v++){ CHECK(b->clip[s][v].offset == at); at += b->clip[s][v].frames; }
+  }
+  CHECK(b->used == at);
+  MixBank t; mix_bank_init(&t, 100);
+  CHECK(mix_bank_add(&t, SFX_UP, 0, 60) == t.pcm);
+  CHECK(mix_bank_add(&t, SFX_UP, 1, 41) == NULL);
+  CHECK(mix_bank_add(&t, SFX_UP, 1, 40) == t.pcm + 60);
+  mix_bank_free(&t);
+}
+
+static void check_stealing(const MixBank* b){
+  Mixer m; mixer_init(&m, b, RATE);
+  for(int i=0;i<MIX_VOICES;i++) CHECK(mixer_play(&m, SFX_BOUNCE, 0, 1.0f) == i);
+  /* goal outranks bounce: takes the oldest bounce */
+  CHECK(mixer_play(&m, SFX_SCORE_GOAL, 0, 1.0f) == 0);
+  CHECK(m.stolen == 1 && m.voice[0].sfx == SFX_SCORE_GOAL);
+  /* another bounce: the oldest bounce left is voice 1 */
+  CHECK(mixer_play(&m, SFX_BOUNCE, 1, 1.0f) == 1);
+  for(int i=0;i<MIX_VOICES;i++) mixer_play(&m, SFX_SCORE_GOAL, 0, 1.0f);
+  CHECK(mixer_active(&m) == MIX_VOICES);
+  /* all goals now: a bounce is dropped, a goal steals the oldest goal */
+  uint32_t dropped = m.dropped;
+  CHECK(mixer_play(&m, SFX_BOUNCE, 0, 1.0f) == -1 && m.dropped == dropped + 1);
+  int oldest = 0;
+  for(int i=1;i<MIX_VOICES;i++) if((int32_t)(m.voice[i].start - m.voice[oldest].start) < 0) oldest = i;
+  CHECK(mixer_play(&m, SFX_SCORE_GOAL, 0, 1.0f) == oldest);
+  CHECK(mixer_play(&m, (Sfx)SFX_COUNT, 0, 1.0f) == -1);
+  CHECK(mixer_play(&m, SFX_UP, 3, 1.0f) == -1);   /* no such variant */
+}
+
+/* Reference for one quantum from a snapshot of the voices, in double. */
+static void reference(const Mixer* m, double* ref, int frames){
+  for(int i=0;i<frames;i++) ref[i] = 0.0;
+  for(int k=0;k<MIX_VOICES;k++){
+    const MixVoice* x = &m->voice[k];
+    if(!x->src) continue;
+    for(int i=0;i<frames && x->pos + (uint32_t)i < x->len;i++) ref[i] += (double)x->src[x->pos + (uint32_t)i]*(double)x->gain;
+  }
+  for(int i=0;i<frames;i++){
+    double v = ref[i]*(double)m->master;
+    ref[i] = v < -1.0 ? -1.0 : v > 1.0 ? 1.0 : v;
+  }
+}
+
+static void check_mix(const MixBank* b){
+  Mixer m; mixer_init(&m, b, RATE);
+  m.master = 0.8f;
+  uint32_t s = 99u; double worst = 0.0; long voices = 0;
+  float out[MIX_QUANTUM + 3]; double ref[MIX_QUANTUM + 3];
+  for(int q=0;q<3000;q++){
+    s ^= s<<13; s ^= s>>17; s ^= s<<5;
+    for(uint32_t k=0;k<s%4u;k++) mixer_play(&m, (Sfx)((s>>(4+4*k)) % SFX_COUNT), -1, 0.25f + 0.25f*(float)k);
+    int frames = (q % 7 == 0) ? MIX_QUANTUM + 3 : MIX_QUANTUM;   /* odd sizes too */
+    reference(&m, ref, frames);
+    voices += mixer_active(&m);
+    mixer_render(&m, out, frames);
+    for(int i=0;i<frames;i++){ double e = fabs((double)out[i] - ref[i]); if(e > worst) worst = e; }
+  }
+  CHECK(worst < 1e-5);
+  CHECK(m.started > 1000 && voices > 3000);
+  printf("mix: 3000 quanta, %.1f voices avg, worst |error| %.2g vs double reference\n", (double)voices/3000.0, worst);
+}
+
+static void check_ring(const MixBank* b){
+  static MixRing r; mix_ring_init(&r);
+  Mixer a, c; mixer_init(&a, b, RATE);
+  for(int i=0;i<12;i++) mixer_play(&a, (Sfx)(i % SFX_COUNT), -1, 0.5f);
+  c = a;
+  /* direct: whole quanta; via the ring: fills of ~900 frames, pulls of 100 */
+  enum { TOTAL = 40*MIX_QUANTUM };
+  static float direct[TOTAL], via[TOTAL];
+  for(int q=0;q<TOTAL/MIX_QUANTUM;q++) mixer_render(&c, direct + q*MIX_QUANTUM, MIX_QUANTUM);
+  int got = 0;
+  while(got < TOTAL){
+    mix_ring_fill(&r, &a, 900);
+    CHECK(r.head - r.tail <= 900);
+    int want = TOTAL - got < 100 ? TOTAL - got : 100;
+    got += mix_ring_pull(&r, via + got, want);
+  }
+  CHECK(memcmp(direct, via, sizeof direct) == 0);
+  CHECK(r.underruns == 0);
+  /* nothing buffered: silence and an underrun */
+  float tmp[MIX_QUANTUM]; tmp[0] = 1.0f;
+  while(mix_ring_pull(&r, tmp, MIX_QUANTUM) == MIX_QUANTUM){}
+  CHECK(mix_ring_pull(&r, tmp, MIX_QUANTUM) == 0 && tmp[0] == 0.0f && r.underruns == 2);
+  /* the fill never runs more than a ring ahead */
+  mix_ring_init(&r);
+  CHECK(mix_ring_fill(&r, &a, 1u<<20) == (int)(MIX_RING_FRAMES/MIX_QUANTUM));
+}
+
+static void check_drain(const MixBank* b){
+  AudioQueue q; audio_queue_init(&q, AUDIO_VOICES_PER_FRAME);
+  Events ev; ev.n = 0;
+  ev.ev[ev.n].type = EV_HIT; ev.ev[ev.n].speed = 14; ev.n++;
+  ev.ev[ev.n].type = EV_BOUNCE; ev.ev[ev.n].speed = 9; ev.n++;
+  audio_play_events(&q, &ev);
+  audio_queue_flush(&q);
+  Mixer m; mixer_init(&m, b, RATE);
+  mixer_drain(&m, &q.ring);
+  CHECK(m.started == 12 && mixer_active(&m) == 12);   /* 1 + 5 + 1 + 5 layers */
+  CHECK(audio_ring_count(&q.ring) == 0);
+}
+
+static void check_wav(void){
+  const char* path = "bench_mixer.tmp.wav";
+  float pcm[1001]; for(int i=0;i<1001;i++) pcm[i] = sinf((float)i*0.01f);
+  float* back = NULL; uint32_t n = 0; int rate = 0;
+  CHECK(mix_write_wav(path, pcm, 1001, RATE));
+  CHECK(mix_read_wav(path, &back, &n, &rate) && n == 1001 && rate == RATE && back && memcmp(back, pcm, sizeof pcm)==0);
+  free(back); remove(path);
+}
+
+/* ---------------------------------- Match ---------------------------------- */
+/* SFX of a seeded 1P match (built-in AI vs a tracking bot) through the same
+ * queue the browser uses, mixed at RATE: the reference scenario. */
+static float* render_match(const MixBank* b, int seconds, uint32_t* frames){
+  const int per_step = RATE/60;
+  *frames = (uint32_t)(seconds*60*per_step);
+  float* pcm = (float*)malloc(sizeof(float)*(*frames));
+  Game g; sim_init(&g, 2024u); sim_new_game(&g, 1);
+  AudioQueue q; audio_queue_init(&q, AUDIO_VOICES_PER_FRAME);
+  Mixer m; mixer_init(&m, b, RATE); m.master = 0.7f;
+  for(int t=0;t<seconds*60;t++){
+    Input in; in.buttons = g.ball.y > g.bats[0].y + 8 ? IN_P1_DOWN : g.ball.y < g.bats[0].y - 8 ? IN_P1_UP : 0u;
+    Events ev; ev.n = 0;
+    if(g.state==ST_PLAY) sim_step(&g, &in, &ev); else sim_new_game(&g, 1);
+    audio_play_events(&q, &ev);
+    audio_queue_flush(&q);
+    mixer_drain(&m, &q.ring);
+    mixer_render(&m, pcm + t*per_step, per_step);
+  }
+  return pcm;
+}
+
+static int compare_reference(const float* pcm, uint32_t frames, const char* path){
+  float* ref = NULL; uint32_t n = 0; int rate = 0;
+  if(!mix_read_wav(path, &ref, &n, &rate)){ fprintf(stderr, "cannot read %s\n", path); return 0; }
+  if(n != frames || rate != RATE){ fprintf(stderr, "%s: %u frames at %d Hz, expected %u at %d\n", path, n, rate, frames, RATE); free(ref); return 0; }
+  long bad = 0; double worst = 0.0;
+  for(uint32_t i=0;i<n;i++){ double e = fabs((double)pcm[i] - (double)ref[i]); if(e > 1e-6) bad++; if(e > worst) worst = e; }
+  printf("reference %s: %ld samples off by >1e-6 (max %.2g)\n", path, bad, worst);
+  free(ref);
+  return bad == 0;
+}
+
+/* ---------------------------------- Main ---------------------------------- */
+static void scalar_render(Mixer* m, float* out, int frames){
+  memset(out, 0, sizeof(float)*(size_t)frames);
+  for(int k=0;k<MIX_VOICES;k++){
+    MixVoice* x = &m->voice[k];
+    if(!x->src) continue;
+    uint32_t left = x->len - x->pos;
+    int n = left < (uint32_t)frames ? (int)left : frames;
+    for(int i=0;i<n;i++) out[i] += x->src[x->pos + (uint32_t)i]*x->gain;
+    x->pos += (uint32_t)n;
+    if(x->pos >= x->len) x->src = NULL;
+  }
+  for(int i=0;i<frames;i++){ float v = out[i]*m->master; out[i] = v < -1.0f ? -1.0f : v > 1.0f ? 1.0f : v; }
+}
+
+int main(int argc, char** argv){
+  long quanta = 200000; const char* out = NULL; const char* golden = NULL;
+  for(int i=1;i<argc;i++){
+    if(!strcmp(argv[i], "-o") && i+1<argc) out = argv[++i];
+    else if(!strcmp(argv[i], "-g") && i+1<argc) golden = argv[++i];
+    else quanta = bench_arg_long(argc, argv, i, quanta);
+  }
+
+  static MixBank bank;
+  synth_bank(&bank);
+  check_bank(&bank);
+  check_stealing(&bank);
+  check_mix(&bank);
+  check_ring(&bank);
+  check_drain(&bank);
+  check_wav();
+  if(fails){ printf("checks: FAILED (%d)\n", fails); return 1; }
+  printf("checks: OK (arena, stealing, mix vs reference, ring, drain, wav)\n");
+
+  uint32_t frames; float* pcm = render_match(&bank, 30, &frames);
+  int ok = 1;
+  if(out){ if(mix_write_wav(out, pcm, frames, RATE)) printf("wrote %s (%u frames)\n", out, frames); else ok = 0; }
+  if(golden && !compare_reference(pcm, frames, golden)) ok = 0;
+  free(pcm);
+
+  /* cost per quantum: every voice on a clip longer than the run */
+  static MixBank big; mix_bank_init(&big, RATE*4);
+  float* p = mix_bank_add(&big, SFX_HIT, 0, RATE*4);
+  for(int i=0;i<RATE*4;i++) p[i] = 0.01f*(float)((i*7919) % 200 - 100) / 100.0f;
+  printf("\nbank %u frames (%.1f KB), %d-lane mix, budget %.1f us per %d-frame quantum at %d Hz\n",
+         bank.used, bank.used*4.0/1024.0, mixer_width(), 1e6*MIX_QUANTUM/RATE, MIX_QUANTUM, RATE);
+  printf("%-7s %12s %12s %8s %9s\n", "voices", "simd ns/q", "scalar ns/q", "speedup", "% budget");
+  static const int counts[] = { 1, 4, 8, 16, 24 };
+  float buf[MIX_QUANTUM]; float sink = 0.0f;
+  for(size_t k=0;k<sizeof(counts)/sizeof(counts[0]);k++){
+    double ns[2];
+    for(int path=0;path<2;path++){
+      Mixer m; mixer_init(&m, &big, RATE);
+      uint64_t total = 0; long done = 0;
+      while(done < quanta){
+        for(int i=0;i<counts[k];i++){ mixer_play(&m, SFX_HIT, 0, 0.5f); m.voice[i].pos = (uint32_t)i*17u; }
+        long chunk = (RATE*3)/MIX_QUANTUM;   /* stay inside the clip */
+        if(chunk > quanta - done) chunk = quanta - done;
+        uint64_t t0 = bench_now_ns();
+        for(long q=0;q<chunk;q++){
+          if(path==0) mixer_render(&m, buf, MIX_QUANTUM); else scalar_render(&m, buf, MIX_QUANTUM);
+          sink += buf[q & (MIX_QUANTUM-1)];
+        }
+        total += bench_now_ns() - t0; done += chunk;
+        for(int i=0;i<MIX_VOICES;i++) m.voice[i].src = NULL;
+      }
+      ns[path] = (double)total/(double)quanta;
+    }
+    printf("%-7d %12.0f %12.0f %7.2fx %8.3f%%\n", counts[k], ns[0], ns[1], ns[1]/ns[0],
+           100.0*ns[0]/(1e9*MIX_QUANTUM/RATE));
+  }
+  printf("[sink %d]\n", (int)(sink != 0.0f));
+  mix_bank_free(&big); mix_bank_free(&bank);
+  return ok ? 0 : 1;
+}
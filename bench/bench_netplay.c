@@ -0,0 +1,171 @@
+/* bench_netplay.c — rollback session over the loopback link
+ * Usage: bench_netplay [frames]
+ * Checks (exit 1 on failure): two bot-driven peers end up with checkpoint
+ * hashes equal to a single local reference run of the same inputs, under
+ * latency/jitter/loss; peers with different ball solvers are flagged as
+ * desynced; a dead link stalls after max_rollback frames. Then reports
+ * rollback depth, resimulated frames and ns per advance for a sweep of
+ * link latencies.
+ */
+
+#include "bench_util.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "netplay.h"
+#include "sim.h"
+
+#define FRAME_MS (1000.0/60.0)
+#define MAX_FRAMES 40000
+
+/* ---------------------------------- Bot ---------------------------------- */
+
+/* P1-style bits for `side`, from the peer's own (possibly predicted) view.
+ * Bails towards a wall on fast rallies so points keep getting scored. */
+static unsigned bot(const Game* g, int side, uint32_t* s){
+  if(g->ball.speed > 12 + (int)(*s % 12u)) return g->bats[side].y < SIM_HEIGHT/2.0f ? IN_P1_UP : IN_P1_DOWN;
+  if(bench_rng_next(s) % 8u == 0) return 0;   /* reaction noise: input changes often */
+  float d = g->ball.y - g->bats[side].y;
+  if(d >  10.0f) return IN_P1_DOWN;
+  if(d < -10.0f) return IN_P1_UP;
+  return 0;
+}
+
+/* ---------------------------------- Run ---------------------------------- */
+typedef struct {
+  long frames, stalls, rollbacks, resim, checks, sent, lost;
+  int  max_depth;
+  int32_t desync;
+  int  ref_ok;       /* every checkpoint matched the reference */
+  double ns;         /* time inside net_advance, both peers */
+} RunResult;
+
+static NetLoopback link_;
+static NetSession peer[2];
+static uint8_t  log_[2][MAX_FRAMES + 16];  /* local bits per frame they apply to */
+static uint32_t ref_hash[MAX_FRAMES + 16];
+
+static void run(const NetLinkParams* lp, int delay, int max_rb, long ticks, int solver_b, RunResult* out){
+  Game g0; sim_init(&g0, 0xC0FFEEu); sim_new_game(&g0, 2);
+  net_loopback_init(&link_, lp);
+  for(int i=0;i<2;i++){
+    NetConfig c; c.side = i; c.input_delay = delay; c.max_rollback = max_rb;
+    int ok = net_session_init(&peer[i], &c, &link_.end[i].base, &g0);
+    CHECK(ok);
+  }
+  peer[1].g.solver = solver_b;
+  memset(log_, 0, sizeof(log_));
+  uint32_t bs[2] = { 0x1234u, 0x9876u };
+
+  uint64_t ns = 0;
+  for(long t=0; t<ticks; t++){
+    net_loopback_set_time(&link_, (double)t*FRAME_MS);
+    for(int i=0;i<2;i++){
+      NetSession* s = &peer[i];
+      unsigned b = bot(&s->g, i, &bs[i]);
+      int32_t f = s->frame + delay;
+      uint64_t t0 = bench_now_ns();
+      int adv = net_advance(s, b);
+      ns += bench_now_ns() - t0;
+      if(adv && f < MAX_FRAMES) log_[i][f] = (uint8_t)b;
+    }
+  }
+
+  /* reference: one Game fed both logs */
+  int32_t upto = peer[0].frame < peer[1].frame ? peer[0].frame : peer[1].frame;
+  Game r = g0;
+  for(int32_t f=0; f<=upto && f<MAX_FRAMES; f++){
+    ref_hash[f] = sim_state_hash(&r);
+    Input in; in.buttons = log_[0][f] | (unsigned)log_[1][f]<<2;
+    sim_step(&r, &in, NULL);
+  }
+  int ok = 1;
+  for(int i=0;i<2;i++)
+    for(int k=0;k<NET_CHECKS;k++){
+      int32_t cf = peer[i].check_frame[k];
+      if(cf > 0 && cf <= upto && peer[i].check_hash[k] != ref_hash[cf]) ok = 0;
+    }
+
+  memset(out, 0, sizeof(*out));
+  out->desync = -1;
+  for(int i=0;i<2;i++){
+    const NetStats* st = &peer[i].stats;
+    out->frames += st->frames; out->stalls += st->stalls; out->rollbacks += st->rollbacks;
+    out->resim += st->resim_frames; out->checks += st->checks;
+    if(st->max_depth > out->max_depth) out->max_depth = st->max_depth;
+    if(st->desync_frame >= 0 && (out->desync < 0 || st->desync_frame < out->desync)) out->desync = st->desync_frame;
+  }
+  out->sent = link_.sent; out->lost = link_.dropped + link_.overflow;
+  out->ref_ok = ok;
+  out->ns = (double)ns;
+}
+
+/* -------------------------------- Checks -------------------------------- */
+static void check_sessions(long ticks){
+  static const struct { double lat, jit, loss; int delay; } cases[] = {
+    { 0, 0, 0, 0 }, { 30, 10, 0.05, 0 }, { 80, 30, 0.10, 2 }, { 120, 40, 0.20, 1 },
+  };
+  for(size_t k=0;k<sizeof(cases)/sizeof(cases[0]);k++){
+    NetLinkParams lp; lp.latency_ms = cases[k].lat; lp.jitter_ms = cases[k].jit; lp.loss = cases[k].loss; lp.seed = 7u + (uint32_t)k;
+    RunResult r; run(&lp, cases[k].delay, NET_MAX_ROLLBACK, ticks, SIM_SOLVER_SWEPT, &r);
+    CHECK(r.desync < 0);
+    CHECK(r.ref_ok);
+    CHECK(r.checks > 0);
+    CHECK(link_.overflow == 0);
+    CHECK(peer[0].confirmed > 0 && peer[1].confirmed > 0);
+  }
+
+  /* same start, different ball solver on one peer: positions drift apart */
+  NetLinkParams lp = { 20, 5, 0.0, 3u };
+  RunResult r; run(&lp, 0, 8, ticks, SIM_SOLVER_MICROSTEP, &r);
+  CHECK(r.desync > 0);
+  CHECK(peer[0].stats.desync_frame >= 0 && peer[1].stats.desync_frame >= 0);
+
+  /* nothing arrives: predict max_rollback frames, then stall */
+  NetLinkParams dead = { 10, 0, 1.0, 5u };
+  run(&dead, 0, 8, 100, SIM_SOLVER_SWEPT, &r);
+  CHECK(peer[0].stats.frames == 8 && peer[0].stats.stalls == 92);
+  CHECK(peer[0].confirmed == -1 && peer[0].stats.rollbacks == 0);
+}
+
+int main(int argc, char** argv){
+  long ticks = bench_arg_long(argc, argv, 1, 20000);
+  if(ticks > MAX_FRAMES) ticks = MAX_FRAMES;
+
+  check_sessions(ticks < 3000 ? ticks : 3000);
+  if(fails){ printf("checks: FAILED (%d)\n", fails); return 1; }
+  printf("checks: OK (reference match under loss/jitter, solver desync flagged, dead link stalls)\n");
+
+  /* snapshot cost */
+  static Game ring[NET_RING]; Game g; sim_init(&g, 1u); sim_new_game(&g, 2);
+  const long N = 2000000;
+  uint64_t t0 = bench_now_ns();
+  for(long i=0;i<N;i++){ ring[i & (NET_RING-1)] = g; g.ball.x += 1e-6f; }
+  double snap_ns = (double)(bench_now_ns() - t0)/(double)N;
+  uint32_t sum = 0;   /* read the ring back so the copies can't be dropped */
+  for(int i=0;i<NET_RING;i++) sum = sum*31u + sim_state_hash(&ring[i]);
+  printf("snapshot: %zu bytes/frame, %.1f ns, ring %d frames = %zu KB per peer (ring hash %08x)\n\n",
+         sizeof(Game), snap_ns, NET_RING, sizeof(NetSession)/1024, sum);
+
+  printf("%ld frames per peer, bot vs bot, jitter 10 ms, loss 2%%, max rollback %d\n", ticks, NET_MAX_ROLLBACK);
+  printf("%-8s %-5s %9s %9s %9s %10s %8s %10s %7s\n",
+         "one-way", "delay", "rollbk/s", "avg depth", "max depth", "resim/frm", "stall%", "ns/advance", "desync");
+  static const double lat[] = { 0, 15, 30, 50, 75, 100, 150 };
+  for(size_t k=0;k<sizeof(lat)/sizeof(lat[0]);k++){
+    for(int delay=0; delay<=2; delay+=2){
+      if(lat[k] < 30 && delay) continue;
+      NetLinkParams lp; lp.latency_ms = lat[k]; lp.jitter_ms = 10.0; lp.loss = 0.02; lp.seed = 11u;
+      RunResult r; run(&lp, delay, NET_MAX_ROLLBACK, ticks, SIM_SOLVER_SWEPT, &r);
+      double secs = (double)ticks*FRAME_MS/1000.0;
+      printf("%5.0f ms %-5d %9.1f %9.2f %9d %10.3f %7.2f%% %10.0f %7s\n",
+             lat[k], delay, (double)r.rollbacks/2.0/secs,
+             r.rollbacks ? (double)r.resim/(double)r.rollbacks : 0.0, r.max_depth,
+             (double)r.resim/(double)(r.frames ? r.frames : 1),
+             100.0*(double)r.stalls/(double)(2*ticks), r.ns/(double)(2*ticks),
+             r.desync<0 && r.ref_ok ? "none" : "YES");
+      if(r.desync >= 0 || !r.ref_ok) fails++;
+    }
+  }
+  return bench_status();
+}
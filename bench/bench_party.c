@@ -0,0 +1,172 @@
+/* bench_party.c — multiball checks + steps/sec from 1 to 10k balls
+ * Usage: bench_party [steps]
+ * Checks (exit 1 on failure): a one-ball party matches sim_step() bit for
+ * bit up to the first goal (both solvers); the grid finds exactly the
+ * overlapping pairs a brute-force scan does, on random and packed layouts;
+ * a head-on pair swaps directions and separates; balls stay inside the
+ * walls; same seed, same run. Then steps/sec and the per-step grid work by
+ * ball count, grid vs the all-pairs reference (all-pairs up to 2k).
+ */
+
+#include "bench_util.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "sim.h"
+#include "sim_party.h"
+
+static int same_ball(const Ball* a, const Ball* b){
+  return a->x==b->x && a->y==b->y && a->dx==b->dx && a->dy==b->dy && a->speed==b->speed && a->prev_x==b->prev_x;
+}
+
+/* -------------------------------- Checks -------------------------------- */
+static void check_single(int solver){
+  Game g; SimParty p;
+  sim_init(&g, 77u); g.solver = solver; sim_new_game(&g, 1); g.bats[0].isAI = 1;
+  sim_party_init(&p, 4, 77u); p.solver = solver; sim_party_new_game(&p, 1, 1); p.bats[0].isAI = 1;
+  int steps = 0, diverged = 0, goal = 0;
+  while(!goal && steps < 100000){
+    Events eg, ep; eg.n = ep.n = 0;
+    sim_step(&g, NULL, &eg);
+    sim_party_step(&p, NULL, &ep);
+    for(int i=0;i<eg.n;i++) goal |= eg.ev[i].type == EV_GOAL;
+    if(goal) break;
+    steps++;
+    diverged += !same_ball(&g.ball, &p.balls[0]) || eg.n != ep.n || g.rng != p.rng || g.ai_offset != p.ai_offset ||
+                g.bats[0].y != p.bats[0].y || g.bats[1].y != p.bats[1].y || g.bats[1].timer != p.bats[1].timer;
+  }
+  CHECK(goal && steps > 100 && diverged == 0);
+  sim_party_free(&p);
+}
+
+static int cmp_pair(const void* a, const void* b){
+  const int *x = (const int*)a, *y = (const int*)b;
+  return x[0] != y[0] ? x[0] - y[0] : x[1] - y[1];
+}
+
+static int brute_pairs(const SimParty* p, int (*out)[2], int max){
+  int n = 0;
+  for(int i=0;i<p->n;i++)
+    for(int j=i+1;j<p->n;j++){
+      float dx = p->balls[j].x - p->balls[i].x, dy = p->balls[j].y - p->balls[i].y;
+      if(dx*dx + dy*dy >= 4.0f*SIM_BALL_R*SIM_BALL_R) continue;
+      if(n < max){ out[n][0] = i; out[n][1] = j; }
+      n++;
+    }
+  return n;
+}
+
+static void check_broadphase(void){
+  enum { MAXP = 200000 };
+  static int a[MAXP][2], b[MAXP][2];
+  static const int COUNTS[] = { 2, 50, 500, 3000 };
+  SimParty p;
+  sim_party_init(&p, 3000, 5u);
+  int mismatched = 0, nonzero = 0;
+  for(size_t k=0;k<sizeof COUNTS/sizeof COUNTS[0];k++){
+    sim_party_new_game(&p, COUNTS[k], 2);
+    /* play a while so the grid is maintained incrementally, not rebuilt */
+    for(int t=0;t<120;t++){
+      sim_party_step(&p, NULL, NULL);
+      if(t % 20 != 19) continue;
+      int na = sim_party_overlaps(&p, a, MAXP), nb = brute_pairs(&p, b, MAXP);
+      if(na > MAXP || nb > MAXP || na != nb){ mismatched++; continue; }
+      qsort(a, (size_t)na, sizeof a[0], cmp_pair);
+      qsort(b, (size_t)nb, sizeof b[0], cmp_pair);
+      mismatched += memcmp(a, b, (size_t)na*sizeof a[0]) != 0;
+      nonzero += na > 0;
+    }
+  }
+  CHECK(mismatched == 0 && nonzero > 0);
+  /* contacts off: balls pass through each other, pairs still reported */
+  p.collide = 0;
+  sim_party_new_game(&p, 3000, 2);
+  for(int t=0;t<30;t++) sim_party_step(&p, NULL, NULL);
+  CHECK(sim_party_overlaps(&p, a, MAXP) == brute_pairs(&p, b, MAXP));
+  sim_party_free(&p);
+}
+
+static void check_head_on(void){
+  SimParty p;
+  sim_party_init(&p, 2, 9u);
+  sim_party_new_game(&p, 2, 2);
+  Ball* l = &p.balls[0]; Ball* r = &p.balls[1];
+  *l = (Ball){ 380.0f, 240.0f,  1.0f, 0.0f, 5, 380.0f };
+  *r = (Ball){ 420.0f, 240.0f, -1.0f, 0.0f, 5, 420.0f };
+  uint32_t c0 = p.contacts;
+  for(int t=0;t<8;t++) sim_party_step(&p, NULL, NULL);
+  CHECK(p.contacts == c0 + 1);
+  CHECK(l->dx == -1.0f && r->dx == 1.0f && l->dy == 0.0f && r->dy == 0.0f);
+  CHECK(r->x - l->x >= 2.0f*SIM_BALL_R);
+  sim_party_free(&p);
+}
+
+static void check_run(void){
+  SimParty a, b;
+  sim_party_init(&a, 800, 21u); sim_party_init(&b, 800, 21u);
+  sim_party_new_game(&a, 800, 1); sim_party_new_game(&b, 800, 1);
+  a.bats[0].isAI = b.bats[0].isAI = 1;
+  int outside = 0, goals = 0;
+  for(int t=0;t<3000;t++){
+    Events ev; ev.n = 0;
+    sim_party_step(&a, NULL, &ev); sim_party_step(&b, NULL, NULL);
+    for(int i=0;i<ev.n;i++) goals += ev.ev[i].type == EV_GOAL;
+    for(int i=0;i<a.n;i++) outside += a.balls[i].y < SIM_BALL_R || a.balls[i].y > SIM_HEIGHT - SIM_BALL_R || !isfinite(a.balls[i].x);
+  }
+  CHECK(outside == 0 && goals > 0 && a.contacts > 0 && a.state == ST_PLAY);
+  CHECK(memcmp(a.balls, b.balls, (size_t)a.n*sizeof(Ball)) == 0 && a.rng == b.rng && a.contacts == b.contacts);
+  CHECK(a.bats[0].score + a.bats[1].score > 0);
+  /* linked lists agree with the cells */
+  int bad = 0, linked = 0;
+  for(int c=0;c<SIM_PARTY_GX*SIM_PARTY_GY;c++)
+    for(int j=a.head[c], prev=-1; j>=0; prev=j, j=a.next[j]){ bad += a.cell[j] != c || a.prev[j] != prev; linked++; }
+  CHECK(bad == 0 && linked == a.n);
+  a.win = 5;
+  Events ev; ev.n = 0;
+  for(int t=0;t<100 && a.state==ST_PLAY;t++){ ev.n = 0; sim_party_step(&a, NULL, &ev); }
+  CHECK(a.state == ST_OVER && ev.n > 0 && ev.ev[ev.n-1].type == EV_GAME_OVER);
+  sim_party_free(&a); sim_party_free(&b);
+}
+
+/* --------------------------------- Main ---------------------------------- */
+int main(int argc, char** argv){
+  long steps = bench_arg_long(argc, argv, 1, 600);
+
+  check_single(SIM_SOLVER_SWEPT);
+  check_single(SIM_SOLVER_MICROSTEP);
+  check_broadphase();
+  check_head_on();
+  check_run();
+  if(fails){ printf("checks: FAILED (%d)\n", fails); return 1; }
+  printf("checks: OK (single-ball parity x2, broadphase vs brute force, head-on, run)\n\n");
+
+  static const int SIZES[] = { 1, 10, 100, 500, 1000, 2000, 5000, 10000 };
+  printf("%7s %14s %12s %14s %12s %12s\n", "balls", "grid steps/s", "grid us", "pairs steps/s", "pairs us", "relink/step");
+  for(size_t k=0;k<sizeof SIZES/sizeof SIZES[0];k++){
+    int n = SIZES[k];
+    double us[2] = { 0, 0 };
+    double relinks = 0;
+    for(int mode=0; mode<2; mode++){
+      if(mode == SIM_PARTY_ALL_PAIRS && n > 2000){ us[mode] = -1; continue; }
+      SimParty p;
+      if(!sim_party_init(&p, n, 1234u)){ fprintf(stderr, "out of memory\n"); return 1; }
+      p.broadphase = mode;
+      sim_party_new_game(&p, n, 1); p.bats[0].isAI = 1;
+      long s = n > 2000 && mode ? steps/10 : steps;
+      for(int t=0;t<30;t++) sim_party_step(&p, NULL, NULL);   /* settle the spawn overlaps */
+      uint32_t r0 = p.relinks;
+      uint64_t t0 = bench_now_ns();
+      for(long t=0;t<s;t++) sim_party_step(&p, NULL, NULL);
+      us[mode] = (double)(bench_now_ns() - t0)/1e3/(double)s;
+      if(mode == SIM_PARTY_GRID) relinks = (double)(p.relinks - r0)/(double)s;
+      sim_party_free(&p);
+    }
+    printf("%7d %14.0f %12.2f ", n, 1e6/us[0], us[0]);
+    if(us[1] < 0) printf("%14s %12s", "-", "-");
+    else printf("%14.0f %12.2f", 1e6/us[1], us[1]);
+    printf(" %12.1f\n", relinks);
+  }
+  return 0;
+}
@@ -0,0 +1,209 @@
+/* bench_render.c — GfxFrame replay: counters, software raster, goldens
+ * Usage: bench_render [frames] [-o out.pam] [-g golden.pam]
+ * Plays a seeded 1P match with a bot on P1, records every frame with
+ * scene_record() and replays it on the null and software backends. Checks
+ * the per-frame counters, a few pixels and the HUD dirty tracking / glyph
+ * layout (exit 1 on failure), prints the averages and timings (DOM HUD
+ * flushes per frame, in-canvas HUD cost), and optionally writes /
+ * compares the final frame.
+ */
+
+#include "bench_util.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "gfx.h"
+#include "hud.h"
+#include "scene.h"
+#include "sim.h"
+
+static unsigned bot_buttons(const Game* g){
+  unsigned b = 0;
+  float d = g->ball.y - g->bats[0].y;
+  if(d >  4.0f) b |= IN_P1_DOWN;
+  if(d < -4.0f) b |= IN_P1_UP;
+  return b;
+}
+
+static const uint8_t* pixel(const GfxSoft* s, int x, int y){ return s->rgba + ((size_t)y*(size_t)s->w + (size_t)x)*4u; }
+
+/* First frame pays for every state change; steady frames only draw. */
+static void check_counters(void){
+  static GfxFrame f; GfxBackend nb; Game g;
+  gfx_null_init(&nb);
+  sim_init(&g, 1); sim_new_game(&g, 1);
+
+  scene_record(&g, NULL, NULL, &f);
+  CHECK(f.overflow == 0 && f.nCmds == 4);
+  gfx_submit(&nb, &f);
+  CHECK(nb.stats.draw_calls == 1 && nb.stats.instances == f.nInst);
+  CHECK(nb.stats.state_changes == 2 && nb.stats.uniform_uploads == 1);
+  CHECK(nb.stats.vertices == 6*f.nInst);
+  CHECK(nb.stats.bytes_uploaded == f.nInst*(int)sizeof(ShapeInstance));
+
+  gfx_submit(&nb, &f);
+  CHECK(nb.stats.draw_calls == 1 && nb.stats.state_changes == 0 && nb.stats.uniform_uploads == 0);
+
+  /* recording past the caps drops and counts instead of overrunning */
+  gfx_frame_begin(&f);
+  for(int i=0;i<GFX_MAX_CMDS+4;i++) gfx_set_pipeline(&f, GFX_PIPE_SHAPES);
+  CHECK(f.nCmds == GFX_MAX_CMDS && f.overflow == 4);
+}
+
+static void check_pixels(void){
+  static GfxFrame f; GfxSoft s; Game g;
+  if(!gfx_soft_init(&s, SIM_WIDTH, SIM_HEIGHT)){ fails++; return; }
+  sim_init(&g, 1); sim_new_game(&g, 1);
+  scene_record(&g, NULL, NULL, &f);
+  gfx_submit(&s.base, &f);
+
+  const uint8_t* bg = pixel(&s, 200, 100);
+  CHECK(bg[0] == (uint8_t)(COL_GREEN[0]*255.0f + 0.5f) && bg[1] == (uint8_t)(COL_GREEN[1]*255.0f + 0.5f));
+  const uint8_t* ball = pixel(&s, SIM_WIDTH/2 + 4, SIM_HEIGHT/2);  /* right of the centre line */
+  CHECK(ball[0] == 255 && ball[1] == 255 && ball[2] == 255);
+  const uint8_t* bat = pixel(&s, 40, SIM_HEIGHT/2);
+  CHECK(bat[0] == 255 && bat[1] == 255 && bat[2] == 255);
+  const uint8_t* edge = pixel(&s, SIM_WIDTH/2 + 5, SIM_HEIGHT/2 + 4);  /* ball rim: ~0.4 coverage */
+  CHECK(edge[0] > bg[0] && edge[0] < 255);
+
+  /* half-resolution target: same scene, scaled */
+  GfxSoft h;
+  if(gfx_soft_init(&h, SIM_WIDTH/2, SIM_HEIGHT/2)){
+    gfx_submit(&h.base, &f);
+    const uint8_t* hb = pixel(&h, 20, SIM_HEIGHT/4);
+    CHECK(hb[0] == 255 && hb[1] == 255);
+    gfx_soft_free(&h);
+  }
+  gfx_soft_free(&s);
+}
+
+static void check_hud(void){
+  Hud h; Game g;
+  hud_init(&h);
+  CHECK(hud_take_dirty(&h) == HUD_DIRTY_ALL && hud_take_dirty(&h) == 0);
+
+  /* unchanged values don't dirty anything */
+  hud_set_players(&h, 1); hud_set_score(&h, 0, 0); hud_set_title(&h, ""); hud_set_msg(&h, NULL);
+  hud_set_score_colors(&h, COL_WHITE, COL_WHITE);
+  CHECK(hud_take_dirty(&h) == 0);
+  hud_set_msg(&h, "Game Over"); hud_set_msg(&h, "Game Over");
+  hud_set_score(&h, 3, 0);
+  CHECK(hud_take_dirty(&h) == (HUD_DIRTY_MSG|HUD_DIRTY_SCORE));
+
+  /* goal tint follows the game and clears again */
+  sim_init(&g, 1); sim_new_game(&g, 1);
+  g.ball.x = -30.0f; g.bats[1].timer = 10;
+  hud_sync_game(&h, &g);
+  CHECK(hud_take_dirty(&h) == (HUD_DIRTY_SCORE|HUD_DIRTY_COLORS) && h.score_rgb[0] == 0xF03232u);
+  g.ball.x = 100.0f; hud_sync_game(&h, &g);
+  CHECK(hud_take_dirty(&h) == HUD_DIRTY_COLORS && h.score_rgb[0] == 0xFFFFFFu);
+
+  /* canvas layout: spaces skipped, em dash drawn as one '-' */
+  ShapeInstance s[HUD_SHAPES_MAX];
+  hud_set_title(&h, "Pong!"); hud_set_msg(&h, "A — B");
+  int n = hud_build(&h, s, HUD_SHAPES_MAX);
+  CHECK(n == 5 + 7 + 1 + 5 + 3);  /* title, "1 Player", backdrop, "00:00", "A-B" */
+  CHECK(s[0].kind == (float)SHAPE_GLYPH && s[0].outline == (float)'P');
+  CHECK(s[n-2].outline == (float)'-' && s[n-1].outline == (float)'B');
+  CHECK(hud_font_bit('P', 0, 0) && !hud_font_bit('P', 4, 0) && !hud_font_bit(' ', 2, 3));
+
+  /* software raster of the title: 'P' is solid top-left, hollow inside */
+  static GfxFrame f; GfxSoft soft;
+  if(!gfx_soft_init(&soft, SIM_WIDTH, SIM_HEIGHT)){ fails++; return; }
+  scene_record(&g, NULL, &h, &f);
+  gfx_submit(&soft.base, &f);
+  CHECK(soft.base.stats.draw_calls == 1);
+  float left = s[0].x - s[0].w*0.5f, top = s[0].y - s[0].h*0.5f, px = s[0].w/HUD_FONT_W;
+  const uint8_t* on  = pixel(&soft, (int)(left + 0.5f*px), (int)(top + 0.5f*px));
+  const uint8_t* off = pixel(&soft, (int)(left + 2.5f*px), (int)(top + 1.5f*px));
+  CHECK(on[0] > 240 && on[1] > 240 && on[2] > 240);
+  CHECK(off[0] == pixel(&soft, 5, 300)[0]);
+  gfx_soft_free(&soft);
+}
+
+/* Channel tolerance absorbs libm/rounding differences between hosts. */
+static int compare_golden(const GfxSoft* s, const char* path){
+  int w, h; uint8_t* ref;
+  if(!gfx_soft_read_pam(path, &w, &h, &ref)){ fprintf(stderr, "cannot read %s\n", path); return 0; }
+  if(w!=s->w || h!=s->h){ fprintf(stderr, "golden is %dx%d, frame is %dx%d\n", w, h, s->w, s->h); free(ref); return 0; }
+  long bad = 0; int worst = 0;
+  for(size_t i=0;i<(size_t)w*(size_t)h*4u;i++){
+    int d = abs((int)s->rgba[i] - (int)ref[i]);
+    if(d>worst) worst = d;
+    if(d>2) bad++;
+  }
+  free(ref);
+  printf("golden %s: %ld channels off by >2 (max diff %d)\n", path, bad, worst);
+  return bad==0;
+}
+
+int main(int argc, char** argv){
+  long frames = bench_arg_long(argc, argv, 1, 2000);
+  const char* out = NULL; const char* golden = NULL;
+  for(int i=1;i<argc-1;i++){
+    if(!strcmp(argv[i], "-o")) out = argv[++i];
+    else if(!strcmp(argv[i], "-g")) golden = argv[++i];
+  }
+
+  check_counters();
+  check_pixels();
+  check_hud();
+  if(fails){ printf("checks: %d FAILED\n", fails); return 1; }
+  printf("checks: OK\n");
+
+  static GfxFrame f; GfxBackend nb; GfxSoft s; Game g;
+  gfx_null_init(&nb);
+  if(!gfx_soft_init(&s, SIM_WIDTH, SIM_HEIGHT)){ fprintf(stderr, "out of memory\n"); return 1; }
+  sim_init(&g, 1); sim_new_game(&g, 1);
+
+  Hud hud; hud_init(&hud); hud_set_title(&hud, "Pong!");
+  GfxStats sum; memset(&sum, 0, sizeof sum);
+  uint64_t t_rec = 0, t_null = 0, t_soft = 0, t_hud = 0;
+  long dom_flushes = 0;
+  for(long i=0;i<frames;i++){
+    Input in; in.buttons = bot_buttons(&g);
+    sim_step(&g, &in, NULL);
+    if(g.state!=ST_PLAY) sim_new_game(&g, 1);
+
+    uint64_t t0 = bench_now_ns();
+    scene_record(&g, NULL, NULL, &f);
+    uint64_t t1 = bench_now_ns();
+    gfx_submit(&nb, &f);
+    uint64_t t2 = bench_now_ns();
+    gfx_submit(&s.base, &f);
+    uint64_t t3 = bench_now_ns();
+    t_rec += t1-t0; t_null += t2-t1; t_soft += t3-t2;
+
+    /* HUD: DOM mode flushes only when something changed; canvas mode
+     * records the glyphs into the same draw */
+    hud_sync_game(&hud, &g);
+    if(hud_take_dirty(&hud)) dom_flushes++;
+    t0 = bench_now_ns();
+    scene_record(&g, NULL, &hud, &f);
+    t_hud += bench_now_ns() - t0;
+
+    sum.draw_calls += nb.stats.draw_calls; sum.state_changes += nb.stats.state_changes;
+    sum.uniform_uploads += nb.stats.uniform_uploads; sum.instances += nb.stats.instances;
+    sum.bytes_uploaded += nb.stats.bytes_uploaded;
+  }
+
+  double n = (double)frames;
+  printf("frames: %ld\n", frames);
+  printf("per frame: %.2f draw calls, %.3f state changes, %.3f uniform uploads, %.1f instances, %.0f bytes\n",
+         sum.draw_calls/n, sum.state_changes/n, sum.uniform_uploads/n, sum.instances/n, sum.bytes_uploaded/n);
+  printf("record: %8.0f ns/frame\n", (double)t_rec/n);
+  printf("null:   %8.0f ns/frame\n", (double)t_null/n);
+  printf("soft:   %8.0f ns/frame (%dx%d)\n", (double)t_soft/n, s.w, s.h);
+  printf("hud:    %.3f DOM flushes/frame (was 1 style write + score/msg calls), canvas record %.0f ns/frame (%d instances incl. HUD)\n",
+         dom_flushes/n, (double)t_hud/n, f.nInst);
+
+  int ok = 1;
+  if(out){
+    if(gfx_soft_write_pam(&s, out)) printf("wrote %s\n", out);
+    else { fprintf(stderr, "cannot write %s\n", out); ok = 0; }
+  }
+  if(golden && !compare_golden(&s, golden)) ok = 0;
+  gfx_soft_free(&s);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+/* bench_shapes.c — headless check + throughput of shapes_build()
+ * Usage: bench_shapes [frames]
+ * Verifies the instance buffer for a few hand-built Game states (exit 1 on
+ * any mismatch), then times building it for a live match.
+ */
+
+#include "bench_util.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "shapes.h"
+#include "sim.h"
+
+static int col_eq(const float a[4], const float b[4]){ return memcmp(a, b, 4*sizeof(float))==0; }
+
+static void check_fresh_game(void){
+  Game g; ShapeInstance s[SHAPES_MAX];
+  sim_init(&g, 1); sim_new_game(&g, 1);
+  int n = shapes_build(&g, s, SHAPES_MAX);
+  CHECK(n == SIM_HEIGHT/20 + 3);
+  for(int i=0;i<SIM_HEIGHT/20;i++){
+    CHECK(s[i].kind == (float)SHAPE_RECT);
+    CHECK(s[i].x == SIM_WIDTH/2.0f && s[i].y == (float)(i*20)+5.0f);
+    CHECK(s[i].w == 4.0f && s[i].h == 10.0f && col_eq(s[i].color, COL_WHITE));
+  }
+  const ShapeInstance* p0 = &s[n-3]; const ShapeInstance* p1 = &s[n-2]; const ShapeInstance* ball = &s[n-1];
+  CHECK(p0->kind == (float)SHAPE_RECT && p0->x == 40.0f && p0->y == SIM_HEIGHT/2.0f && p0->w == 18.0f && p0->h == 128.0f);
+  CHECK(p1->kind == (float)SHAPE_RECT && p1->x == SIM_WIDTH-40.0f && col_eq(p1->color, COL_WHITE));
+  CHECK(ball->kind == (float)SHAPE_CIRCLE && ball->x == SIM_WIDTH/2.0f && ball->w == 14.0f && ball->outline == 0.0f);
+}
+
+static void check_goal_flash(void){
+  Game g; ShapeInstance s[SHAPES_MAX];
+  sim_init(&g, 1); sim_new_game(&g, 1);
+  g.ball.x = -20.0f; g.bats[0].timer = 15; g.bats[1].timer = 15;
+  int n = shapes_build(&g, s, SHAPES_MAX);
+  CHECK(col_eq(s[n-3].color, COL_RED));
+  CHECK(col_eq(s[n-2].color, COL_BLUE));
+  g.ball.x = 100.0f;  /* back in play: no flash */
+  n = shapes_build(&g, s, SHAPES_MAX);
+  CHECK(col_eq(s[n-3].color, COL_WHITE) && col_eq(s[n-2].color, COL_WHITE));
+}
+
+/* Truncation at capacity keeps draw order. (Hit ripples are particles
+ * now: bench_vfx checks them.) */
+static void check_truncation(void){
+  Game g; ShapeInstance s[SHAPES_MAX];
+  sim_init(&g, 1); sim_new_game(&g, 1);
+  CHECK(shapes_build(&g, s, 10) == 10 && s[9].kind == (float)SHAPE_RECT && s[9].y == 185.0f);
+  CHECK(shapes_build(&g, s, SHAPES_MAX-1) == SHAPES_MAX-1 && s[SHAPES_MAX-2].x == SIM_WIDTH-40.0f);
+}
+
+static void check_party(void){
+  SimParty p; ShapeInstance s[64];
+  sim_party_init(&p, 8, 1); sim_party_new_game(&p, 3, 1);
+  const int base = SIM_HEIGHT/20 + 2;
+  CHECK(shapes_build_party(&p, s, 64) == base + 3);
+  for(int i=0;i<3;i++)
+    CHECK(s[base+i].kind == (float)SHAPE_CIRCLE && s[base+i].x == p.balls[i].x && s[base+i].y == p.balls[i].y);
+  CHECK(s[base-1].kind == (float)SHAPE_RECT && s[base-1].x == SIM_WIDTH-40.0f);
+  CHECK(shapes_build_party(&p, s, base + 1) == base + 1);
+  sim_party_free(&p);
+}
+
+int main(int argc, char** argv){
+  long frames = bench_arg_long(argc, argv, 1, 1000000);
+
+  check_fresh_game();
+  check_goal_flash();
+  check_truncation();
+  check_party();
+  if(fails){ printf("instance buffer checks: %d FAILED\n", fails); return 1; }
+  printf("instance buffer checks: OK\n");
+
+  Game g; Events ev; ShapeInstance s[SHAPES_MAX];
+  sim_init(&g, 7u); sim_new_game(&g, 1); g.bats[0].isAI = 1;
+  long instances = 0;
+  uint64_t t_build = 0;
+  for(long f=0; f<frames; f++){
+    ev.n = 0; sim_step(&g, NULL, &ev);
+    if(g.state!=ST_PLAY){ sim_new_game(&g, 1); g.bats[0].isAI = 1; }
+    uint64_t t0 = bench_now_ns();
+    instances += shapes_build(&g, s, SHAPES_MAX);
+    t_build += bench_now_ns() - t0;
+  }
+  printf("shapes_build: %.1f ns/frame, %.1f instances/frame, %.1f MB/s of instance data\n",
+         (double)t_build/(double)frames, (double)instances/(double)frames,
+         (double)instances*sizeof(ShapeInstance)/((double)t_build/1e9)/1e6);
+  return 0;
+}
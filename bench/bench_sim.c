@@ -0,0 +1,96 @@
+/* bench_sim.c — native throughput of sim_step() across ball speeds
+ * Usage: bench_sim [steps_per_speed]
+ * First drives SimClock with simulated displays (30..240 Hz, jittered
+ * frame times, one long stall) and fails (exit 1) unless every display
+ * gets the same number of sim steps per second. Then the throughput table:
+ * P1 is a simple tracking bot, P2 the built-in AI. The ball speed is pinned
+ * each step so every row measures one microstep count.
+ */
+
+#include "bench_util.h"
+
+#include <stdio.h>
+
+#include "sim.h"
+#include "sim_clock.h"
+
+static Input bot_input(const Game* g){
+  Input in; in.buttons = 0;
+  float d = g->ball.y - g->bats[0].y;
+  if(d >  4.0f) in.buttons |= IN_P1_DOWN;
+  if(d < -4.0f) in.buttons |= IN_P1_UP;
+  return in;
+}
+
+/* 10 simulated seconds of frames at `hz` (+-10% jitter); a stall of
+ * `stall_ms` halfway through. Returns the sim steps handed out. */
+static long run_display(double hz, double stall_ms, SimClock* c){
+  sim_clock_init(c, SIM_TICK_HZ, SIM_MAX_CATCHUP);
+  uint32_t rng = 12345u;
+  double frame = 1000.0/hz, t = 0.0;
+  int stalled = 0;
+  sim_clock_advance(c, t);
+  while(t < 10000.0){
+    rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+    double dt = frame * (0.9 + 0.2*(double)(rng%1000u)/1000.0);
+    if(!stalled && t>=5000.0){ dt += stall_ms; stalled = 1; }
+    t += dt;
+    if(t > 10000.0) t = 10000.0;
+    sim_clock_advance(c, t);
+    float a = sim_clock_alpha(c);
+    if(a<0.0f || a>=1.0f) return -1;
+  }
+  return c->ticks;
+}
+
+static int check_display_rates(void){
+  static const double rates[] = { 30.0, 59.94, 60.0, 75.0, 120.0, 144.0, 240.0 };
+  const long want = 10L*SIM_TICK_HZ;
+  int ok = 1;
+  SimClock c;
+  printf("%-10s %8s\n", "display", "steps/10s");
+  for(size_t k=0;k<sizeof(rates)/sizeof(rates[0]);k++){
+    long n = run_display(rates[k], 0.0, &c);
+    printf("%-7.2fHz %8ld\n", rates[k], n);
+    if(n<want-1 || n>want+1) ok = 0;
+  }
+  /* 1 s stall at 144 Hz: catch-up capped, the rest is dropped, not replayed */
+  long n = run_display(144.0, 1000.0, &c);
+  printf("stall 1s %8ld  (dropped %.0f ms)\n", n, c.dropped_ms);
+  long expect = want - (long)(c.dropped_ms/c.step_ms + 0.5);
+  if(c.dropped_ms<=0.0 || n<expect-1 || n>expect+1) ok = 0;
+  printf("display-rate independence: %s\n\n", ok ? "OK" : "FAILED");
+  return ok;
+}
+
+int main(int argc, char** argv){
+  long steps = bench_arg_long(argc, argv, 1, 2000000);
+  if(!check_display_rates()) return 1;
+  static const int speeds[] = { 5, 8, 12, 16, 20, 30, 40 };
+  uint64_t sink = 0;
+
+  printf("%-6s %12s %14s %10s %8s\n", "speed", "steps", "steps/sec", "ns/step", "events");
+  for(size_t k=0;k<sizeof(speeds)/sizeof(speeds[0]);k++){
+    Game g; Events ev;
+    sim_init(&g, 1234u);
+    sim_new_game(&g, 1);
+    long events = 0;
+
+    uint64_t t0 = bench_now_ns();
+    for(long i=0;i<steps;i++){
+      Input in = bot_input(&g);
+      g.ball.speed = speeds[k];
+      ev.n = 0;
+      sim_step(&g, &in, &ev);
+      events += ev.n;
+      if(g.state!=ST_PLAY) sim_new_game(&g, 1);
+    }
+    uint64_t dt = bench_now_ns() - t0;
+
+    sink += (uint64_t)(g.ball.x*1000.0f) + (uint64_t)g.bats[0].score;
+    double ns = (double)dt / (double)steps;
+    printf("%-6d %12ld %14.0f %10.1f %8ld\n", speeds[k], steps, 1e9/ns, ns, events);
+  }
+  printf("(sink %llu)\n", (unsigned long long)sink);
+  return 0;
+}
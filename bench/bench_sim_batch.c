@@ -0,0 +1,123 @@
+/* bench_sim_batch.c — SoA batch engine: parity check + scaling with N
+ * Usage: bench_sim_batch [frames]
+ * First steps a mixed set of games through both sim_step() (microstep
+ * solver) and sim_batch_step() and fails (exit 1) on any bit difference.
+ * Then reports games*steps/sec for growing N next to the scalar loop over
+ * Game[N] with the same solver.
+ * In the timing runs each lane's ball speed is pinned (5..28, like a spread
+ * of live rallies) so one endless AI-vs-bot rally can't dominate the total.
+ */
+
+#include "bench_util.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "sim.h"
+#include "sim_batch.h"
+
+static unsigned bot_buttons(float ball_y, float bat_y){
+  unsigned b = 0;
+  float d = ball_y - bat_y;
+  if(d >  4.0f) b |= IN_P1_DOWN;
+  if(d < -4.0f) b |= IN_P1_UP;
+  return b;
+}
+
+static int lane_speed(int i){ return 5 + (i*7)%24; }
+
+static void make_game(Game* g, int i){
+  sim_init(g, 0x1000u + (uint32_t)i);
+  g->solver = SIM_SOLVER_MICROSTEP;  /* what the batch kernel implements */
+  sim_new_game(g, (i%3==2) ? 2 : 1);
+  /* spread the lanes over different speeds/angles so masking is exercised */
+  g->ball.speed = lane_speed(i);
+  g->ball.dy = (float)((i*13)%17 - 8) / 10.0f;
+  g->ball.x += (float)((i*31)%200 - 100);
+}
+
+static int bits_eq(float a, float b){ return memcmp(&a, &b, sizeof a)==0; }
+
+static int game_eq(const Game* a, const Game* b){
+  if(!bits_eq(a->ball.x,b->ball.x) || !bits_eq(a->ball.y,b->ball.y) ||
+     !bits_eq(a->ball.dx,b->ball.dx) || !bits_eq(a->ball.dy,b->ball.dy) ||
+     !bits_eq(a->ball.prev_x,b->ball.prev_x) || a->ball.speed!=b->ball.speed) return 0;
+  for(int k=0;k<2;k++){
+    if(!bits_eq(a->bats[k].x,b->bats[k].x) || !bits_eq(a->bats[k].y,b->bats[k].y) ||
+       a->bats[k].score!=b->bats[k].score || a->bats[k].timer!=b->bats[k].timer ||
+       a->bats[k].isAI!=b->bats[k].isAI) return 0;
+  }
+  return a->ai_offset==b->ai_offset && a->rng==b->rng && a->state==b->state && a->numPlayers==b->numPlayers;
+}
+
+static int parity(int n, int frames){
+  static Game ref[257]; static Input in[257]; static Events evA[257], evB[257];
+  SimBatch b;
+  if(!sim_batch_init(&b, n)) return 0;
+  for(int i=0;i<n;i++){ make_game(&ref[i], i); sim_batch_load(&b, i, &ref[i]); }
+
+  for(int f=0; f<frames; f++){
+    for(int i=0;i<n;i++){
+      in[i].buttons = bot_buttons(ref[i].ball.y, ref[i].bats[0].y);
+      evA[i].n = 0; evB[i].n = 0;
+      sim_step(&ref[i], &in[i], &evA[i]);
+    }
+    sim_batch_step(&b, in, evB);
+    for(int i=0;i<n;i++){
+      Game got; sim_batch_store(&b, i, &got);
+      if(!game_eq(&ref[i], &got) || evA[i].n!=evB[i].n ||
+         memcmp(evA[i].ev, evB[i].ev, sizeof(Event)*(size_t)evA[i].n)!=0){
+        fprintf(stderr, "parity mismatch: lane %d frame %d\n", i, f);
+        sim_batch_free(&b);
+        return 0;
+      }
+    }
+  }
+  sim_batch_free(&b);
+  return 1;
+}
+
+int main(int argc, char** argv){
+  long frames = bench_arg_long(argc, argv, 1, 2000);
+  printf("vector width: %d lanes\n", sim_batch_width());
+
+  if(!parity(257, 4000)){ printf("parity: FAILED\n"); return 1; }
+  printf("parity: OK (257 games x 4000 frames, bit-identical to sim_step)\n\n");
+
+  static const int Ns[] = { 1, 8, 64, 256, 1024, 4096, 16384 };
+  printf("%-7s %16s %16s %8s\n", "N", "batch g*st/s", "scalar g*st/s", "speedup");
+  for(size_t k=0;k<sizeof(Ns)/sizeof(Ns[0]);k++){
+    int n = Ns[k];
+    long f_n = frames * 1024 / (n<1024 ? 1024 : n);  /* keep total work roughly flat */
+    if(f_n < 50) f_n = 50;
+    SimBatch b; Game* games = (Game*)malloc(sizeof(Game)*(size_t)n);
+    Input* in = (Input*)malloc(sizeof(Input)*(size_t)n);
+    if(!games || !in || !sim_batch_init(&b, n)){ fprintf(stderr, "out of memory\n"); return 1; }
+    for(int i=0;i<n;i++){ make_game(&games[i], i); sim_batch_load(&b, i, &games[i]); }
+
+    uint64_t t0 = bench_now_ns();
+    for(long f=0; f<f_n; f++){
+      for(int i=0;i<n;i++){ in[i].buttons = bot_buttons(b.ball_y[i], b.bat_y[0][i]); b.ball_speed[i] = lane_speed(i); }
+      sim_batch_step(&b, in, NULL);
+      for(int i=0;i<n;i++){ if(b.state[i]!=ST_PLAY){ Game g; make_game(&g, i); sim_batch_load(&b, i, &g); } }
+    }
+    uint64_t t_batch = bench_now_ns() - t0;
+
+    t0 = bench_now_ns();
+    for(long f=0; f<f_n; f++){
+      for(int i=0;i<n;i++){
+        Input one; one.buttons = bot_buttons(games[i].ball.y, games[i].bats[0].y);
+        games[i].ball.speed = lane_speed(i);
+        sim_step(&games[i], &one, NULL);
+        if(games[i].state!=ST_PLAY) make_game(&games[i], i);
+      }
+    }
+    uint64_t t_scalar = bench_now_ns() - t0;
+
+    double work = (double)n * (double)f_n;
+    printf("%-7d %16.0f %16.0f %7.2fx\n", n, work*1e9/(double)t_batch, work*1e9/(double)t_scalar,
+           (double)t_scalar/(double)t_batch);
+    sim_batch_free(&b); free(games); free(in);
+  }
+  return 0;
+}
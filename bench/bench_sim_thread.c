@@ -0,0 +1,341 @@
+/* bench_sim_thread.c — sim thread handoff: torn-read stress + latency
+ * Usage: bench_sim_thread [ms per phase]
+ * Checks (exit 1 on failure): a writer thread publishing as fast as it can
+ * through the triple buffer never lets the reader see a torn snapshot
+ * (every word of a large payload derives from its sequence number, and
+ * the reader yields mid-verification to let the writer run), sequence
+ * numbers never go backwards, and the same harness does catch tears on a
+ * single unsynchronized buffer; the event ring delivers every event in
+ * order under a producer that outruns it; a SimThread stepping a real
+ * match at 60 then 240 Hz keeps its rate, and every snapshot a 144 Hz
+ * render loop takes hashes to the state the sim published.
+ * Then handoff latency (publish -> take, reader spinning), the cost of a
+ * take, and snapshot age as seen by the render loop.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "bench_util.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "handoff.h"
+#include "pong_atomic.h"
+#include "sim.h"
+#include "sim_thread.h"
+
+static void sleep_ns(uint64_t ns){
+  struct timespec ts = { (time_t)(ns/1000000000ull), (long)(ns%1000000000ull) };
+  nanosleep(&ts, NULL);
+}
+
+/* ------------------------------- Histogram ------------------------------- */
+#define HIST_BUCKETS 65536   /* 1 unit each; the last is overflow */
+
+typedef struct { uint32_t b[HIST_BUCKETS]; uint32_t n; uint64_t max; } Hist;
+
+static void hist_add(Hist* h, uint64_t v){
+  h->b[v < HIST_BUCKETS-1 ? v : HIST_BUCKETS-1]++;
+  h->n++; if(v > h->max) h->max = v;
+}
+
+static uint64_t hist_pct(const Hist* h, double p){
+  uint64_t want = (uint64_t)((double)h->n*p/100.0), seen = 0;
+  for(int i=0;i<HIST_BUCKETS;i++){ seen += h->b[i]; if(seen > want) return (uint64_t)i; }
+  return h->max;
+}
+
+/* -------------------------------- Payload -------------------------------- */
+#define PAY_WORDS 4096   /* 16 KB: big enough that a copy spans a preemption */
+
+typedef struct {
+  uint64_t seq;
+  uint64_t publish_ns;
+  uint32_t w[PAY_WORDS];
+} Payload;
+
+static uint32_t pay_word(uint64_t seq, int i){
+  uint32_t x = (uint32_t)seq*0x9E3779B1u ^ (uint32_t)i*0x85EBCA77u;
+  x ^= x >> 15; x *= 0x2C1B3C6Du; x ^= x >> 12;
+  return x;
+}
+
+static void pay_fill(Payload* p, uint64_t seq){
+  p->seq = seq;
+  for(int i=0;i<PAY_WORDS;i++) p->w[i] = pay_word(seq, i);
+}
+
+/* Words checked in chunks with a yield in between, so that even on one
+ * core the writer runs while a snapshot is being read. Returns 1 if torn. */
+static int pay_torn(const volatile Payload* p, uint64_t seq){
+  for(int c=0;c<PAY_WORDS;c+=PAY_WORDS/8){
+    for(int i=c;i<c+PAY_WORDS/8;i++) if(p->w[i] != pay_word(seq, i)) return 1;
+    sched_yield();
+  }
+  return p->seq != seq;
+}
+
+/* -------------------------------- Writers -------------------------------- */
+typedef struct {
+  TripleBuf* tb;        /* NULL: write `naive` in place */
+  Payload*   naive;
+  uint64_t   pace_ns;   /* 0: flat out */
+  int        stop;
+  uint64_t   seq;
+} Writer;
+
+static void* writer_main(void* arg){
+  Writer* w = (Writer*)arg;
+  uint64_t next = bench_now_ns();
+  while(!PONG_LOAD_ACQ(&w->stop)){
+    uint64_t seq = w->seq + 1;
+    if(w->tb){
+      Payload* p = (Payload*)triple_back(w->tb);
+      pay_fill(p, seq);
+      p->publish_ns = bench_now_ns();
+      triple_publish(w->tb);
+    } else {
+      pay_fill(w->naive, seq);
+    }
+    PONG_STORE_REL(&w->seq, seq);
+    if(w->pace_ns){
+      next += w->pace_ns;
+      uint64_t now = bench_now_ns();
+      if(next > now) sleep_ns(next - now); else next = now;
+    }
+  }
+  return NULL;
+}
+
+static Payload slots[3], naiveBuf;
+
+/* ------------------------------ Torn reads ------------------------------- */
+typedef struct { uint64_t reads, fresh, torn, backwards, published; } TornResult;
+
+static TornResult torn_run(int triple, uint64_t dur_ns){
+  TornResult r; memset(&r, 0, sizeof r);
+  TripleBuf tb; triple_init(&tb, &slots[0], &slots[1], &slots[2]);
+  Writer w; memset(&w, 0, sizeof w);
+  w.tb = triple ? &tb : NULL; w.naive = &naiveBuf;
+  pay_fill(&naiveBuf, 0);
+  pthread_t th; pthread_create(&th, NULL, writer_main, &w);
+
+  uint64_t end = bench_now_ns() + dur_ns, last = 0;
+  while(bench_now_ns() < end){
+    const Payload* p; int fresh = 1;
+    if(triple){
+      p = (const Payload*)triple_take(&tb, &fresh);
+      if(!p){ sched_yield(); continue; }
+    } else p = &naiveBuf;
+    uint64_t seq = ((const volatile Payload*)p)->seq;
+    r.reads++; r.fresh += (uint64_t)fresh;
+    if(seq < last) r.backwards++;
+    last = seq;
+    if(pay_torn(p, seq)) r.torn++;
+  }
+  PONG_STORE_REL(&w.stop, 1);
+  pthread_join(th, NULL);
+  r.published = w.seq;
+  return r;
+}
+
+/* -------------------------------- Latency -------------------------------- */
+static Hist latHist, takeHist;
+
+/* Writer paced at `pace_ns`; the reader spins on take() (yielding between
+ * polls) and times each fresh snapshot from publish to take. */
+static void latency_run(uint64_t pace_ns, uint64_t dur_ns, uint64_t* torn){
+  memset(&latHist, 0, sizeof latHist); memset(&takeHist, 0, sizeof takeHist);
+  TripleBuf tb; triple_init(&tb, &slots[0], &slots[1], &slots[2]);
+  Writer w; memset(&w, 0, sizeof w);
+  w.tb = &tb; w.pace_ns = pace_ns;
+  pthread_t th; pthread_create(&th, NULL, writer_main, &w);
+
+  uint64_t end = bench_now_ns() + dur_ns;
+  while(bench_now_ns() < end){
+    int fresh;
+    uint64_t t0 = bench_now_ns();
+    const Payload* p = (const Payload*)triple_take(&tb, &fresh);
+    uint64_t t1 = bench_now_ns();
+    hist_add(&takeHist, t1 - t0);
+    if(p && fresh){
+      hist_add(&latHist, (t1 - p->publish_ns)/1000u);
+      if(p->w[0] != pay_word(p->seq, 0) || p->w[PAY_WORDS-1] != pay_word(p->seq, PAY_WORDS-1)) (*torn)++;
+    }
+    sched_yield();
+  }
+  PONG_STORE_REL(&w.stop, 1);
+  pthread_join(th, NULL);
+}
+
+/* ------------------------------- Event ring ------------------------------ */
+#define RING_EVENTS 1000000
+
+static EventRing ring;
+static uint32_t ringRetries;
+
+static void* ring_producer(void* arg){
+  (void)arg;
+  for(int i=0;i<RING_EVENTS;i++){
+    Event e = { EV_BOUNCE, i & 1, i, (float)i, 0.0f };
+    while(!event_ring_push(&ring, &e)){ ringRetries++; sched_yield(); }
+  }
+  return NULL;
+}
+
+static void check_ring(void){
+  event_ring_init(&ring);
+  pthread_t th; pthread_create(&th, NULL, ring_producer, NULL);
+  int next = 0, bad = 0;
+  while(next < RING_EVENTS){
+    Event e;
+    if(!event_ring_pop(&ring, &e)){ sched_yield(); continue; }
+    if(e.speed != next || e.side != (next & 1) || e.x != (float)next) bad++;
+    next++;
+  }
+  pthread_join(th, NULL);
+  Event e = { EV_HIT, 0, 0, 0.0f, 0.0f };
+  CHECK(bad == 0);
+  CHECK(event_ring_count(&ring) == 0 && !event_ring_pop(&ring, &e));
+  CHECK(ring.dropped == ringRetries);   /* every full push was counted */
+  for(uint32_t i=0;i<EVENT_RING_CAP+3u;i++) event_ring_push(&ring, &e);
+  CHECK(event_ring_count(&ring) == EVENT_RING_CAP && ring.dropped == ringRetries + 3u);
+}
+
+/* ------------------------------ Sim thread ------------------------------- */
+typedef struct {
+  Game     g;
+  uint32_t tick;
+  uint32_t hash;
+  double   t_ms;
+} Snapshot;
+
+typedef struct {
+  Game      g;
+  uint32_t  tick;
+  Snapshot  slot[3];
+  TripleBuf tb;
+} Match;
+
+static void match_step(void* user, double t_ms){
+  Match* m = (Match*)user;
+  if(m->g.state != ST_PLAY){ sim_new_game(&m->g, 1); m->g.bats[0].isAI = 1; }
+  sim_step(&m->g, NULL, NULL);
+  Snapshot* s = (Snapshot*)triple_back(&m->tb);
+  s->g = m->g; s->tick = ++m->tick; s->t_ms = t_ms;
+  s->hash = sim_state_hash(&m->g);
+  triple_publish(&m->tb);
+}
+
+static Match match;
+static Hist ageHist;
+
+typedef struct { uint32_t steps, frames, fresh, torn, backwards; } RenderResult;
+
+/* A render loop at `fps` for `dur_ms`, taking the latest snapshot each
+ * frame and timing its age against the sim clock. */
+static RenderResult render_run(int fps, double dur_ms){
+  RenderResult r; memset(&r, 0, sizeof r);
+  uint32_t last = 0, first = 0;
+  double end = sim_thread_now_ms() + dur_ms;
+  uint64_t next = bench_now_ns(), frame = 1000000000ull/(uint64_t)fps;
+  while(sim_thread_now_ms() < end){
+    next += frame;
+    uint64_t now = bench_now_ns();
+    if(next > now) sleep_ns(next - now);
+    int fresh;
+    const Snapshot* s = (const Snapshot*)triple_take(&match.tb, &fresh);
+    r.frames++;
+    if(!s) continue;
+    if(!first) first = s->tick;
+    if(fresh){
+      r.fresh++;
+      hist_add(&ageHist, (uint64_t)((sim_thread_now_ms() - s->t_ms)*1000.0));
+    }
+    if(sim_state_hash(&s->g) != s->hash) r.torn++;
+    if(s->tick < last) r.backwards++;
+    last = s->tick;
+  }
+  r.steps = last - first;
+  return r;
+}
+
+static void check_sim_thread(double dur_ms, RenderResult* at60, RenderResult* at240, SimThreadStats* st){
+  sim_init(&match.g, 7u); match.tick = 0;
+  triple_init(&match.tb, &match.slot[0], &match.slot[1], &match.slot[2]);
+  memset(&ageHist, 0, sizeof ageHist);
+  SimThread* t = sim_thread_start(60, match_step, &match);
+  CHECK(t != NULL);
+  if(!t) return;
+  *at60 = render_run(144, dur_ms);
+  sim_thread_set_hz(t, 240);
+  render_run(144, 50.0);   /* settle on the new rate */
+  *at240 = render_run(144, dur_ms);
+  sim_thread_stats(t, st);
+  sim_thread_stop(t);
+
+  /* +-10% of the nominal rate (plus a step either side); dropped steps
+   * count, a stall on a loaded machine is not a rate error */
+  double want60 = dur_ms*0.06, want240 = dur_ms*0.24;
+  CHECK(at60->steps + st->dropped >= want60*0.9 - 1 && at60->steps <= want60*1.1 + 1);
+  CHECK(at240->steps + st->dropped >= want240*0.9 - 1 && at240->steps <= want240*1.1 + 1);
+  CHECK(at60->torn == 0 && at240->torn == 0);
+  CHECK(at60->backwards == 0 && at240->backwards == 0);
+  CHECK(at60->fresh > 0 && at240->fresh > 0);
+}
+
+int main(int argc, char** argv){
+  long ms = bench_arg_long(argc, argv, 1, 1000);
+  uint64_t dur = (uint64_t)ms*1000000ull;
+
+  /* Triple buffer under a flat-out writer, then the control: the same
+   * reader on one shared buffer must see tears, or the check is blind. */
+  TornResult tr = torn_run(1, dur);
+  TornResult nv = torn_run(0, dur/4);
+  CHECK(tr.reads > 0 && tr.fresh > 0 && tr.published > tr.fresh);
+  CHECK(tr.torn == 0);
+  CHECK(tr.backwards == 0);
+  CHECK(nv.torn > 0);
+
+  /* 1 kHz writer, spinning reader */
+  uint64_t latTorn = 0;
+  latency_run(1000000ull, dur, &latTorn);
+  CHECK(latTorn == 0);
+  CHECK(latHist.n > 0);
+
+  check_ring();
+
+  RenderResult r60, r240; SimThreadStats st; memset(&st, 0, sizeof st);
+  memset(&r60, 0, sizeof r60); memset(&r240, 0, sizeof r240);
+  check_sim_thread((double)ms, &r60, &r240, &st);
+
+  if(fails){ fprintf(stderr, "%d check(s) failed\n", fails); return 1; }
+  printf("checks: OK (%llu reads of %llu snapshots, 0 torn; %llu torn on the unsynchronized control; %d ring events in order)\n\n",
+         (unsigned long long)tr.reads, (unsigned long long)tr.published,
+         (unsigned long long)nv.torn, RING_EVENTS);
+
+  printf("triple buffer, %d-byte payload, %ld ms per phase\n", (int)sizeof(Payload), ms);
+  printf("  flat-out writer: %llu published, reader took %llu fresh (%.1f%% skipped as stale)\n",
+         (unsigned long long)tr.published, (unsigned long long)tr.fresh,
+         tr.published ? 100.0*(double)(tr.published - tr.fresh)/(double)tr.published : 0.0);
+  printf("  handoff us (1 kHz writer, publish -> take): p50 %llu  p99 %llu  max %llu  (%u snapshots)\n",
+         (unsigned long long)hist_pct(&latHist, 50), (unsigned long long)hist_pct(&latHist, 99),
+         (unsigned long long)latHist.max, latHist.n);
+  printf("  take() ns: p50 %llu  p99 %llu  max %llu\n",
+         (unsigned long long)hist_pct(&takeHist, 50), (unsigned long long)hist_pct(&takeHist, 99),
+         (unsigned long long)takeHist.max);
+  printf("  event ring: %d events, producer found it full %u times\n\n", RING_EVENTS, ringRetries);
+
+  printf("sim thread + 144 Hz render loop\n");
+  printf("  %4s  %6s  %6s  %6s  %6s\n", "hz", "steps", "frames", "fresh", "torn");
+  printf("  %4d  %6u  %6u  %6u  %6u\n", 60, r60.steps, r60.frames, r60.fresh, r60.torn);
+  printf("  %4d  %6u  %6u  %6u  %6u\n", 240, r240.steps, r240.frames, r240.fresh, r240.torn);
+  printf("  snapshot age at take us: p50 %llu  p99 %llu  max %llu\n",
+         (unsigned long long)hist_pct(&ageHist, 50), (unsigned long long)hist_pct(&ageHist, 99),
+         (unsigned long long)ageHist.max);
+  printf("  wake lateness us: mean %u  max %u  (%u steps, %u dropped)\n",
+         st.late_mean_us, st.late_max_us, st.steps, st.dropped);
+  return 0;
+}
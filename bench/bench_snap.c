@@ -0,0 +1,305 @@
+/* bench_snap.c — snapshot codec checks + bytes/tick and encode/decode cost
+ * Usage: bench_snap [ticks]
+ * Checks (exit 1 on failure): capture/apply stays within half a quantum;
+ * streams over a simulated link (delay, loss, late acks) decode to exactly
+ * the snapshots sent; random snapshot/baseline pairs round-trip and fit
+ * SNAP_MAX_BYTES; truncated packets and deltas against a baseline the
+ * receiver lacks are rejected; random and bit-flipped packets never decode
+ * to something that doesn't round-trip. Then bytes per tick and ns per
+ * encode/decode for typical and worst-case rallies at several link delays.
+ */
+
+#include "bench_util.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "sim.h"
+#include "snapshot.h"
+
+#define MAX_DELAY 64   /* link delay, ticks each way */
+
+static uint32_t rng = 0xC0FFEEu;
+static uint32_t rnd(void){ return bench_rng_next(&rng); }
+static float rndf(float lo, float hi){ return lo + (hi - lo)*(float)(rnd() >> 8)/16777216.0f; }
+
+static int snap_eq(const Snap* a, const Snap* b){
+  return a->tick == b->tick && a->state == b->state && a->score[0] == b->score[0] && a->score[1] == b->score[1] &&
+         a->bat_y[0] == b->bat_y[0] && a->bat_y[1] == b->bat_y[1] && a->ball_x == b->ball_x && a->ball_y == b->ball_y &&
+         a->ball_dx == b->ball_dx && a->ball_dy == b->ball_dy && a->speed == b->speed;
+}
+
+/* --------------------------------- Match --------------------------------- */
+/* AI vs AI, restarted when it ends. `min_speed` > 0 pins the ball at
+ * least that fast: the worst case, a bounce every few ticks. */
+typedef struct { Game g; int min_speed; } Match;
+
+static void match_init(Match* m, uint32_t seed, int min_speed){
+  sim_init(&m->g, seed); sim_new_game(&m->g, 1); m->g.bats[0].isAI = 1;
+  m->min_speed = min_speed;
+}
+
+static void match_step(Match* m){
+  if(m->g.state != ST_PLAY){ sim_new_game(&m->g, 1); m->g.bats[0].isAI = 1; }
+  if(m->g.ball.speed < m->min_speed) m->g.ball.speed = m->min_speed;
+  sim_step(&m->g, NULL, NULL);
+}
+
+/* ---------------------------------- Link --------------------------------- */
+/* Sender -> receiver packets arrive `delay` ticks later unless lost; the
+ * receiver acks each one it decodes, and the ack takes `delay` more. */
+typedef struct {
+  int delay; double loss;
+  uint8_t pkt[MAX_DELAY+1][SNAP_MAX_BYTES]; size_t len[MAX_DELAY+1];
+  uint32_t ack[MAX_DELAY+1]; int has_ack[MAX_DELAY+1];
+} Link;
+
+typedef struct {
+  long ticks, bytes, keys, errors, mismatches, received;
+  size_t max_bytes;
+} LinkStats;
+
+static void run_link(int delay, double loss, int min_speed, long ticks, uint32_t seed, LinkStats* st){
+  static Link l;
+  static Snap sent_log[1<<16];
+  memset(&l, 0, sizeof l);
+  memset(st, 0, sizeof(*st));
+  l.delay = delay; l.loss = loss;
+  Match m; match_init(&m, seed, min_speed);
+  SnapSender tx; snap_sender_init(&tx);
+  SnapRing rx; snap_ring_init(&rx);
+  const int Q = MAX_DELAY+1;
+  const int hop = delay > 0 ? delay : 1;   /* at least the next tick */
+  for(long t=0;t<ticks;t++){
+    int slot = (int)(t % Q);
+    /* deliveries due this tick (sent `delay` ago), then acks */
+    if(l.len[slot]){
+      Snap got;
+      SnapStatus r = snap_decode(&got, l.pkt[slot], l.len[slot], &rx);
+      if(r == SNAP_OK){
+        snap_ring_put(&rx, &got);
+        st->received++;
+        st->mismatches += !snap_eq(&got, &sent_log[got.tick & 0xFFFFu]);
+        l.ack[(t + hop) % Q] = got.tick; l.has_ack[(t + hop) % Q] = 1;
+      } else st->errors++;
+      l.len[slot] = 0;
+    }
+    if(l.has_ack[slot]){ snap_sender_ack(&tx, l.ack[slot]); l.has_ack[slot] = 0; }
+
+    match_step(&m);
+    Snap s; snap_capture(&s, &m.g, (uint32_t)t);
+    sent_log[t & 0xFFFF] = s;
+    uint8_t buf[SNAP_MAX_BYTES];
+    size_t n = snap_sender_encode(&tx, &s, buf, sizeof buf);
+    st->ticks++; st->bytes += (long)n;
+    if(n > st->max_bytes) st->max_bytes = n;
+    if(loss > 0 && (double)(rnd() >> 8)/16777216.0 < loss) continue;
+    int at = (int)((t + hop) % Q);
+    memcpy(l.pkt[at], buf, n); l.len[at] = n;
+  }
+  st->keys = tx.keys;
+}
+
+/* -------------------------------- Checks -------------------------------- */
+static void check_quant(void){
+  Game g; sim_init(&g, 3u); sim_new_game(&g, 2);
+  float worst_pos = 0, worst_dir = 0;
+  for(int i=0;i<100000;i++){
+    g.bats[0].y = rndf(64, 416); g.bats[1].y = rndf(64, 416);
+    g.ball.x = rndf(-500, 1300); g.ball.y = rndf(7, 473);
+    float a = rndf(0, 6.2831853f);
+    g.ball.dx = cosf(a); g.ball.dy = sinf(a);
+    Snap s; snap_capture(&s, &g, (uint32_t)i);
+    Game h = g; snap_apply(&s, &h);
+    float ep = fmaxf(fmaxf(fabsf(h.ball.x - g.ball.x), fabsf(h.ball.y - g.ball.y)),
+                     fmaxf(fabsf(h.bats[0].y - g.bats[0].y), fabsf(h.bats[1].y - g.bats[1].y)));
+    float ed = fmaxf(fabsf(h.ball.dx - g.ball.dx), fabsf(h.ball.dy - g.ball.dy));
+    if(ep > worst_pos) worst_pos = ep;
+    if(ed > worst_dir) worst_dir = ed;
+  }
+  CHECK(worst_pos <= 0.5f/SNAP_POS_SCALE + 1e-4f);
+  CHECK(worst_dir <= 0.5f/SNAP_DIR_SCALE + 1e-6f);
+  /* out of range clamps instead of wrapping */
+  g.ball.x = 1e9f; g.ball.y = -1e9f;
+  Snap s; snap_capture(&s, &g, 0);
+  CHECK(s.ball_x == 32767 && s.ball_y == -32768);
+}
+
+static void check_streams(void){
+  static const int DELAYS[] = { 0, 1, 3, 6, 15, 40 };
+  static const double LOSS[] = { 0.0, 0.1, 0.5 };
+  int bad = 0, keys_only_late = 1;
+  for(size_t d=0; d<sizeof DELAYS/sizeof DELAYS[0]; d++)
+    for(size_t k=0; k<sizeof LOSS/sizeof LOSS[0]; k++)
+      for(int speed=0; speed<=30; speed+=30){
+        LinkStats st;
+        run_link(DELAYS[d], LOSS[k], speed, 4000, 100u + (uint32_t)d, &st);
+        bad += st.mismatches != 0 || st.errors != 0 || st.received == 0;
+        if(DELAYS[d] >= SNAP_WINDOW/2) keys_only_late &= st.keys == st.ticks;
+        else bad += st.keys == st.ticks;   /* deltas must actually happen */
+      }
+  CHECK(bad == 0);
+  CHECK(keys_only_late);
+}
+
+static void random_snap(Snap* s, uint32_t tick){
+  s->tick = tick;
+  s->state = (uint8_t)(1 + rnd() % 3);
+  s->score[0] = (uint8_t)rnd(); s->score[1] = (uint8_t)rnd();
+  s->bat_y[0] = (int16_t)rnd(); s->bat_y[1] = (int16_t)rnd();
+  s->ball_x = (int16_t)rnd(); s->ball_y = (int16_t)rnd();
+  s->ball_dx = (int16_t)rnd(); s->ball_dy = (int16_t)rnd();
+  s->speed = (uint16_t)rnd();
+}
+
+/* nudge fields by amounts that land in every residual tier */
+static void near_snap(Snap* s, const Snap* b, uint32_t age){
+  static const int STEP[] = { 0, 1, -1, 15, -15, 16, 200, -255, 256, 4000, -30000 };
+  const int NS = (int)(sizeof STEP/sizeof STEP[0]);
+  *s = *b; s->tick = b->tick + age;
+  int16_t* f[6] = { &s->bat_y[0], &s->bat_y[1], &s->ball_x, &s->ball_y, &s->ball_dx, &s->ball_dy };
+  for(int i=0;i<6;i++){ int v = *f[i] + STEP[rnd() % NS]; *f[i] = (int16_t)(v < -32768 ? -32768 : v > 32767 ? 32767 : v); }
+  int sp = s->speed + STEP[rnd() % NS];
+  s->speed = (uint16_t)(sp < 0 ? 0 : sp > 65535 ? 65535 : sp);
+  if(rnd() % 4 == 0){ s->score[rnd() & 1]++; s->state = (uint8_t)(1 + rnd() % 3); }
+}
+
+static void check_random(void){
+  SnapRing ring; snap_ring_init(&ring);
+  int bad = 0; size_t maxn = 0;
+  for(int i=0;i<200000;i++){
+    Snap b, s, out;
+    random_snap(&b, rnd());
+    uint32_t age = 1 + rnd() % (SNAP_WINDOW + 4);
+    if(i & 1) near_snap(&s, &b, age); else random_snap(&s, b.tick + age);
+    snap_ring_init(&ring); snap_ring_put(&ring, &b);
+    uint8_t buf[64];
+    size_t n = snap_encode(&s, &b, buf, sizeof buf);
+    if(n > maxn) maxn = n;
+    bad += n == 0 || snap_decode(&out, buf, n, &ring) != SNAP_OK || !snap_eq(&out, &s);
+    /* truncated, or with a byte too many */
+    if(i % 16 == 0){
+      for(size_t k=0;k<n;k++) bad += snap_decode(&out, buf, k, &ring) == SNAP_OK;
+      buf[n] = 0; bad += snap_decode(&out, buf, n+1, &ring) == SNAP_OK;
+      bad += snap_encode(&s, &b, buf, n-1) != 0;
+    }
+  }
+  CHECK(bad == 0);
+  CHECK(maxn <= SNAP_MAX_BYTES);
+
+  /* a delta whose baseline the receiver never got */
+  Snap b, s, out; random_snap(&b, 1000); near_snap(&s, &b, 3);
+  uint8_t buf[SNAP_MAX_BYTES];
+  size_t n = snap_encode(&s, &b, buf, sizeof buf);
+  snap_ring_init(&ring);
+  CHECK(snap_decode(&out, buf, n, &ring) == SNAP_ERR_BASE);
+  CHECK(snap_decode(&out, buf, n, NULL) == SNAP_ERR_BASE);
+  Snap other = b; other.tick += SNAP_WINDOW;   /* same slot, newer tick */
+  snap_ring_put(&ring, &other);
+  CHECK(snap_decode(&out, buf, n, &ring) == SNAP_ERR_BASE);
+  other.tick = b.tick + 256;   /* same slot and low 8 bits: a delta 256 late */
+  snap_ring_put(&ring, &other);
+  CHECK(snap_decode(&out, buf, n, &ring) == SNAP_ERR_BASE);
+  /* too old a baseline falls back to a key */
+  s.tick = b.tick + SNAP_WINDOW;
+  CHECK(snap_encode(&s, &b, buf, sizeof buf) == snap_encode(&s, NULL, buf, sizeof buf));
+}
+
+static void check_fuzz(void){
+  SnapRing ring; snap_ring_init(&ring);
+  Match m; match_init(&m, 9u, 0);
+  Snap hist[SNAP_WINDOW];
+  for(uint32_t t=0;t<SNAP_WINDOW;t++){ match_step(&m); snap_capture(&hist[t], &m.g, t); snap_ring_put(&ring, &hist[t]); }
+  int bad = 0, accepted = 0;
+  for(int i=0;i<300000;i++){
+    uint8_t buf[SNAP_MAX_BYTES + 8];
+    size_t len;
+    if(i & 1){
+      /* a valid packet with a few bits flipped and maybe cut short */
+      Snap s; uint32_t age = 1 + rnd() % 8;
+      near_snap(&s, &hist[SNAP_WINDOW-1-age], age);
+      len = snap_encode(&s, (i & 2) ? &hist[SNAP_WINDOW-1-age] : NULL, buf, sizeof buf);
+      for(int f=0, nf=1+(int)(rnd()%3); f<nf; f++) buf[rnd() % len] ^= (uint8_t)(1u << (rnd() & 7));
+      if(rnd() % 4 == 0) len = rnd() % (len + 1);
+    } else {
+      len = rnd() % sizeof buf;
+      for(size_t k=0;k<len;k++) buf[k] = (uint8_t)rnd();
+    }
+    Snap out, again;
+    if(snap_decode(&out, buf, len, &ring) != SNAP_OK) continue;
+    accepted++;
+    uint8_t re[SNAP_MAX_BYTES];
+    size_t n = snap_encode(&out, NULL, re, sizeof re);
+    bad += n == 0 || snap_decode(&again, re, n, NULL) != SNAP_OK || !snap_eq(&again, &out);
+  }
+  CHECK(bad == 0 && accepted > 0);
+}
+
+/* --------------------------------- Bench --------------------------------- */
+typedef struct { const char* name; int delay; double loss; int min_speed; } Scenario;
+
+static void bench(const Scenario* sc, long ticks){
+  LinkStats st;
+  run_link(sc->delay, sc->loss, sc->min_speed, ticks, 7u, &st);
+
+  /* encode/decode cost on the same stream shape: deltas against the
+   * snapshot `age` ticks back (the ack round trip), no loss */
+  enum { N = 4096 };
+  static Snap snaps[N];
+  static uint8_t pkt[N][SNAP_MAX_BYTES];
+  static size_t len[N];
+  Match m; match_init(&m, 7u, sc->min_speed);
+  for(int i=0;i<N;i++){ match_step(&m); snap_capture(&snaps[i], &m.g, (uint32_t)i); }
+  uint32_t age = (uint32_t)(2*sc->delay + 1);
+  int reps = (int)(ticks / N) + 1;
+  uint64_t t0 = bench_now_ns();
+  for(int r=0;r<reps;r++)
+    for(int i=0;i<N;i++)
+      len[i] = snap_encode(&snaps[i], (uint32_t)i >= age ? &snaps[i-(int)age] : NULL, pkt[i], SNAP_MAX_BYTES);
+  double enc = (double)(bench_now_ns() - t0)/((double)reps*N);
+  SnapRing ring;
+  int errors = 0;
+  t0 = bench_now_ns();
+  for(int r=0;r<reps;r++){
+    snap_ring_init(&ring);
+    for(int i=0;i<N;i++){
+      Snap out;
+      errors += snap_decode(&out, pkt[i], len[i], &ring) != SNAP_OK;
+      snap_ring_put(&ring, &out);
+    }
+  }
+  double dec = (double)(bench_now_ns() - t0)/((double)reps*N);
+  if(errors) fails++;
+
+  printf("%-32s %6d %5.0f%% %9.2f %6zu %6.1f%% %9.1f %9.1f\n", sc->name, sc->delay, sc->loss*100.0,
+         (double)st.bytes/(double)st.ticks, st.max_bytes, 100.0*(double)st.keys/(double)st.ticks, enc, dec);
+}
+
+/* --------------------------------- Main ---------------------------------- */
+int main(int argc, char** argv){
+  long ticks = bench_arg_long(argc, argv, 1, 36000);
+
+  check_quant();
+  check_streams();
+  check_random();
+  check_fuzz();
+  if(fails){ printf("checks: FAILED (%d)\n", fails); return 1; }
+  printf("checks: OK (quantization, link streams, random pairs, truncation/baseline, fuzz)\n\n");
+
+  static const Scenario SC[] = {
+    { "typical rally, LAN",            1, 0.0,  0 },
+    { "typical rally, 100 ms RTT",     3, 0.0,  0 },
+    { "typical rally, 100 ms, 10% loss", 3, 0.1, 0 },
+    { "typical rally, 250 ms RTT",     8, 0.0,  0 },
+    { "worst rally (speed 30), LAN",   1, 0.0, 30 },
+    { "worst rally, 250 ms RTT",       8, 0.0, 30 },
+    { "worst rally, 250 ms, 25% loss", 8, 0.25, 30 },
+    { "no acks in window (keys)",     20, 0.0,  0 },
+  };
+  printf("%zu-byte Game, %zu-byte Snap; delay is ticks each way at 60 Hz\n", sizeof(Game), sizeof(Snap));
+  printf("%-32s %6s %6s %9s %6s %7s %9s %9s\n", "scenario", "delay", "loss", "bytes/tk", "max", "keys", "enc ns", "dec ns");
+  for(size_t i=0;i<sizeof SC/sizeof SC[0];i++) bench(&SC[i], ticks);
+  if(fails){ printf("decode errors in the timed stream\n"); return 1; }
+  return 0;
+}
@@ -0,0 +1,108 @@
+/* bench_sweep.c — swept ball solver vs the microstep reference
+ * Usage: bench_sweep [frames]
+ * Parity: plays seeded matches with the microstep solver and, every frame,
+ * also steps a copy of the pre-step state with the swept solver. Event
+ * types, sides and speeds, scores, timers and the PRNG must match exactly;
+ * positions may differ by one microstep (exit 1 otherwise). The loop's
+ * running sum x += dx rounds differently from the swept x + k*dx, and with
+ * |dx| ~ 1 off integer faces that can move a contact by one microstep.
+ * Comparing from the same state per frame keeps such a difference from
+ * snowballing into a different rally.
+ * Then ns/step for both solvers with the ball speed pinned per row.
+ */
+
+#include "bench_util.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "sim.h"
+
+#define SWEEP_POS_EPS 1.01f         /* one microstep (|(dx,dy)| = 1) */
+#define SWEEP_DIR_EPS (1.0f/64.0f)  /* ~1px of diff_y english, twice */
+
+static Input bot_input(const Game* g){
+  Input in; in.buttons = 0;
+  float d = g->ball.y - g->bats[0].y;
+  if(d >  4.0f) in.buttons |= IN_P1_DOWN;
+  if(d < -4.0f) in.buttons |= IN_P1_UP;
+  return in;
+}
+
+static int near(float a, float b){ return fabsf(a - b) <= SWEEP_POS_EPS; }
+static int near_dir(float a, float b){ return fabsf(a - b) <= SWEEP_DIR_EPS; }
+
+static int same_step(const Game* a, const Events* ea, const Game* b, const Events* eb){
+  if(ea->n!=eb->n) return 0;
+  for(int i=0;i<ea->n;i++){
+    const Event* x = &ea->ev[i]; const Event* y = &eb->ev[i];
+    if(x->type!=y->type || x->side!=y->side || x->speed!=y->speed || !near(x->x,y->x) || !near(x->y,y->y)) return 0;
+  }
+  if(!near(a->ball.x,b->ball.x) || !near(a->ball.y,b->ball.y) || !near_dir(a->ball.dx,b->ball.dx) ||
+     !near_dir(a->ball.dy,b->ball.dy) || !near(a->ball.prev_x,b->ball.prev_x)) return 0;
+  if(a->ball.speed!=b->ball.speed || a->rng!=b->rng || a->ai_offset!=b->ai_offset) return 0;
+  for(int k=0;k<2;k++) if(a->bats[k].score!=b->bats[k].score || a->bats[k].timer!=b->bats[k].timer) return 0;
+  return a->state==b->state;
+}
+
+/* Returns the number of mismatching frames; `speed_floor` forces fast balls. */
+static long parity(uint32_t seed, int speed_floor, long frames, long* contacts, long* exact){
+  Game g; sim_init(&g, seed); g.solver = SIM_SOLVER_MICROSTEP; sim_new_game(&g, 1);
+  long bad = 0;
+  for(long f=0; f<frames; f++){
+    if(g.ball.speed < speed_floor) g.ball.speed = speed_floor;
+    Input in = bot_input(&g);
+    Game s = g; s.solver = SIM_SOLVER_SWEPT;
+    Events ea, eb; ea.n = 0; eb.n = 0;
+    sim_step(&g, &in, &ea);
+    sim_step(&s, &in, &eb);
+    *contacts += ea.n;
+    if(memcmp(&g.ball, &s.ball, sizeof(Ball))==0) (*exact)++;
+    if(!same_step(&g, &ea, &s, &eb)){
+      if(!bad) fprintf(stderr, "mismatch: seed %u frame %ld speed %d\n", seed, f, g.ball.speed);
+      bad++;
+    }
+    if(g.state!=ST_PLAY) sim_new_game(&g, 1);
+  }
+  return bad;
+}
+
+static double ns_per_step(int solver, int speed, long steps){
+  Game g; sim_init(&g, 1234u); g.solver = solver; sim_new_game(&g, 1);
+  Events ev;
+  uint64_t t0 = bench_now_ns();
+  for(long i=0;i<steps;i++){
+    Input in = bot_input(&g);
+    g.ball.speed = speed;
+    ev.n = 0;
+    sim_step(&g, &in, &ev);
+    if(g.state!=ST_PLAY) sim_new_game(&g, 1);
+  }
+  return (double)(bench_now_ns() - t0) / (double)steps;
+}
+
+int main(int argc, char** argv){
+  long frames = bench_arg_long(argc, argv, 1, 200000);
+
+  static const int floors[] = { 0, 12, 24, 48, 96 };
+  long bad = 0, contacts = 0, checked = 0, exact = 0;
+  for(uint32_t seed=1; seed<=8; seed++){
+    for(size_t k=0;k<sizeof(floors)/sizeof(floors[0]);k++){
+      bad += parity(seed, floors[k], 20000, &contacts, &exact);
+      checked += 20000;
+    }
+  }
+  printf("parity: %ld frames, %ld contacts, %ld mismatches -> %s (%.1f%% of frames bit-identical)\n\n",
+         checked, contacts, bad, bad ? "FAILED" : "OK", 100.0*(double)exact/(double)checked);
+  if(bad) return 1;
+
+  static const int speeds[] = { 5, 10, 20, 40, 80, 160, 320 };
+  printf("%-6s %14s %14s %8s\n", "speed", "microstep ns", "swept ns", "speedup");
+  for(size_t k=0;k<sizeof(speeds)/sizeof(speeds[0]);k++){
+    double m = ns_per_step(SIM_SOLVER_MICROSTEP, speeds[k], frames);
+    double s = ns_per_step(SIM_SOLVER_SWEPT, speeds[k], frames);
+    printf("%-6d %14.1f %14.1f %7.2fx\n", speeds[k], m, s, m/s);
+  }
+  return 0;
+}
@@ -0,0 +1,38 @@
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+/* Tiny helpers shared by the native bench_* programs.
+ * Include first in the .c file: it sets _POSIX_C_SOURCE for clock_gettime. */
+
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static inline uint64_t bench_now_ns(void){
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec*1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* Iteration count from argv[1] (or the default), so CI can run short. */
+static inline long bench_arg_long(int argc, char** argv, int idx, long def){
+  if(argc>idx){ long v = strtol(argv[idx], NULL, 10); if(v>0) return v; }
+  return def;
+}
+
+/* xorshift32 for test data; seed nonzero. */
+static inline uint32_t bench_rng_next(uint32_t* s){ *s ^= *s<<13; *s ^= *s>>17; *s ^= *s<<5; return *s; }
+
+/* Failed CHECKs so far; a bench that ends with any exits 1. */
+static int fails = 0;
+#define CHECK(cond) do{ if(!(cond)){ fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); fails++; } }while(0)
+
+/* Exit status for main(). */
+static inline int bench_status(void){ return fails ? 1 : 0; }
+
+#endif /* BENCH_UTIL_H */
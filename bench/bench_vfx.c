@@ -0,0 +1,294 @@
+/* bench_vfx.c — particle pool checks + step/build cost at 10k..100k
+ * Usage: bench_vfx [steps]
+ * Checks (exit 1 on failure): pool rounding and drop counting, the hit
+ * ripple against the old 64-slot impact formula, swap-remove keeping
+ * exactly the live set, the SIMD step against a scalar reference, emitter
+ * directions/counts/flash, build truncation, and a bot match that never
+ * overflows the browser's pool. Then, at 10k..100k live particles with
+ * steady turnover: the old array-of-structs copy-and-compact update, a
+ * scalar SoA loop, vfx_step(), and vfx_build() into one instance run.
+ */
+
+#include "bench_util.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "shapes.h"
+#include "sim.h"
+#include "vfx.h"
+
+static uint32_t rng = 12345u;
+static float frand(void){
+  rng ^= rng<<13; rng ^= rng>>17; rng ^= rng<<5;
+  return (float)(rng >> 8) * (1.0f/16777216.0f);
+}
+
+static void spawn_random(Vfx* v, float life){
+  vfx_spawn(v, 800.0f*frand(), 480.0f*frand(), 4.0f*frand() - 2.0f, 4.0f*frand() - 2.0f,
+            life, 1.0f + 6.0f*frand(), frand() - 0.5f, 0.85f + 0.15f*frand(), SHAPE_CIRCLE, VFX_YELLOW);
+}
+
+static Events one_event(EventType type, int side, int speed, float x, float y){
+  Events ev; ev.n = 1;
+  ev.ev[0].type = type; ev.ev[0].side = side; ev.ev[0].speed = speed; ev.ev[0].x = x; ev.ev[0].y = y;
+  return ev;
+}
+
+/* -------------------------------- Checks -------------------------------- */
+static void check_pool(void){
+  Vfx v;
+  CHECK(vfx_init(&v, 10) && v.cap == 12 && v.n == 0);
+  for(int i=0;i<15;i++) spawn_random(&v, 5.0f);
+  CHECK(v.n == 12 && v.spawned == 12 && v.dropped == 3);
+  vfx_clear(&v);
+  CHECK(v.n == 0 && v.flash == 0.0f && v.cap == 12);
+  vfx_free(&v);
+}
+
+/* Same rings as the impacts the sim used to keep: diameter 2*(2 + 1.5t),
+ * alpha 1 - 0.1t at t = 1..9 steps after the bounce, then gone. */
+static void check_ripple(void){
+  Vfx v; ShapeInstance s[64];
+  vfx_init(&v, 64);
+  Events ev = one_event(EV_BOUNCE, 1, 5, 300.0f, SIM_HEIGHT - SIM_BALL_R);
+  vfx_emit_events(&v, &ev);
+  for(int t=1;t<=10;t++){
+    vfx_step(&v);
+    int n = vfx_build(&v, s, 64), rings = 0;
+    for(int i=0;i<n;i++){
+      if(s[i].kind != (float)SHAPE_RING) continue;
+      rings++;
+      CHECK(s[i].x == 300.0f && s[i].outline == SHAPES_RING_WIDTH);
+      CHECK(s[i].w == 2.0f*(2.0f + (float)t*1.5f) && s[i].h == s[i].w);
+      CHECK(fabsf(s[i].color[3] - (1.0f - (float)t*0.1f)) < 1e-6f);
+    }
+    CHECK(rings == (t < 10));
+  }
+  vfx_free(&v);
+}
+
+/* Particle i lives i%17 + 1 steps and sits still at x = i: after each
+ * step the survivors are exactly those with a longer life. */
+static void check_swap_remove(void){
+  enum { N = 500 };
+  Vfx v;
+  vfx_init(&v, N);
+  for(int i=0;i<N;i++) vfx_spawn(&v, (float)i, 0.0f, 0.0f, 0.0f, (float)(i%17 + 1), 2.0f, 0.0f, 1.0f, SHAPE_CIRCLE, VFX_WHITE);
+  for(int t=1;t<=18;t++){
+    vfx_step(&v);
+    static unsigned char seen[N];
+    memset(seen, 0, sizeof seen);
+    int want = 0, bad = 0;
+    for(int i=0;i<N;i++) want += i%17 + 1 > t;
+    for(int i=0;i<v.n;i++){
+      int id = (int)v.x[i];
+      if(id < 0 || id >= N || seen[id] || id%17 + 1 <= t || v.age[i] != (float)t) bad++;
+      else seen[id] = 1;
+    }
+    CHECK(v.n == want && bad == 0);
+  }
+  CHECK(v.n == 0);
+  vfx_free(&v);
+}
+
+typedef struct { float x, y, vx, vy, age, size; } Ref;
+
+static void ref_step(Ref* r, const Vfx* v, int i){
+  r->x += r->vx; r->y += r->vy;
+  r->vx *= v->drag[i]; r->vy *= v->drag[i];
+  r->age += 1.0f;
+  r->size = fmaxf(r->size + v->grow[i], 0.0f);
+}
+
+/* 1003 particles: full vectors plus a scalar tail; nothing dies. */
+static void check_simd(void){
+  enum { N = 1003 };
+  static Ref ref[N];
+  Vfx v;
+  vfx_init(&v, N);
+  for(int i=0;i<N;i++){
+    spawn_random(&v, 1e9f);
+    ref[i].x = v.x[i]; ref[i].y = v.y[i]; ref[i].vx = v.vx[i]; ref[i].vy = v.vy[i];
+    ref[i].age = 0.0f; ref[i].size = v.size[i];
+  }
+  for(int t=0;t<50;t++) for(int i=0;i<N;i++) ref_step(&ref[i], &v, i);
+  for(int t=0;t<50;t++) vfx_step(&v);
+  int bad = 0;
+  for(int i=0;i<N;i++)
+    bad += v.x[i] != ref[i].x || v.y[i] != ref[i].y || v.vx[i] != ref[i].vx || v.vy[i] != ref[i].vy ||
+           v.age[i] != ref[i].age || v.size[i] != ref[i].size;
+  CHECK(v.n == N && bad == 0);
+  vfx_free(&v);
+}
+
+static void check_emitters(void){
+  Vfx v; ShapeInstance s[128];
+  vfx_init(&v, 128);
+  for(int side=0;side<2;side++){
+    vfx_clear(&v);
+    Events ev = one_event(EV_HIT, side, 9, side ? 751.0f : 49.0f, 200.0f);
+    vfx_emit_events(&v, &ev);
+    CHECK(v.n == 1 + 13);
+    CHECK(v.shape[0] == SHAPE_RING && v.x[0] == (side ? 761.0f : 39.0f));   /* at the paddle face */
+    int wrong = 0;
+    for(int i=1;i<v.n;i++) wrong += side ? v.vx[i] >= 0.0f : v.vx[i] <= 0.0f;
+    CHECK(wrong == 0);
+  }
+  Events fast = one_event(EV_HIT, 0, 40, 49.0f, 200.0f);
+  vfx_clear(&v); vfx_emit_events(&v, &fast);
+  CHECK(v.n == 1 + 24);   /* spray is capped */
+
+  vfx_clear(&v);
+  Events top = one_event(EV_BOUNCE, 0, 5, 400.0f, SIM_BALL_R);
+  vfx_emit_events(&v, &top);
+  int up = 0;
+  for(int i=1;i<v.n;i++) up += v.vy[i] < 0.0f;
+  CHECK(v.n == 5 && up == 0);   /* off the top wall: downwards */
+
+  vfx_clear(&v);
+  Events goal = one_event(EV_GOAL, 0, 7, SIM_WIDTH + 20.0f, 100.0f);
+  vfx_emit_events(&v, &goal);
+  CHECK(v.flash == 1.0f && v.flash_color == VFX_RED && v.n == 32);
+  int outside = 0;
+  for(int i=0;i<v.n;i++) outside += v.x[i] != (float)SIM_WIDTH;
+  CHECK(outside == 0);
+  int n = vfx_build(&v, s, 128);
+  CHECK(n == 33 && s[32].kind == (float)SHAPE_RECT && s[32].w == (float)SIM_WIDTH && s[32].color[3] > 0.0f);
+  CHECK(vfx_build(&v, s, 10) == 10 && s[9].kind == (float)SHAPE_CIRCLE);   /* truncation drops the flash */
+  int steps = 0;
+  while(v.flash > 0.0f && steps < 100){ vfx_step(&v); steps++; }
+  CHECK(steps < 40);
+  n = vfx_build(&v, s, 128);
+  CHECK(n == v.n);
+
+  Ball b = { 100.0f, 100.0f, 1.0f, 0.0f, 5, 100.0f };
+  vfx_clear(&v);
+  vfx_emit_trail(&v, &b); CHECK(v.n == 0);
+  b.speed = 12; vfx_emit_trail(&v, &b); CHECK(v.n == 1 && v.color[0] == VFX_GHOST);
+  b.x = -5.0f;  vfx_emit_trail(&v, &b); CHECK(v.n == 1);
+  vfx_free(&v);
+}
+
+/* Bots on both paddles, a long rally-heavy run: the browser's 2048 pool
+ * never fills and every instance is finite and inside the frame's cap. */
+static void check_match(void){
+  Vfx v; Game g; static ShapeInstance s[2049];
+  vfx_init(&v, 2048);
+  sim_init(&g, 3u); sim_new_game(&g, 2);
+  g.bats[0].isAI = g.bats[1].isAI = 1;
+  int peak = 0, bad = 0;
+  long hits = 0;
+  for(int t=0;t<60*60*5;t++){
+    Events ev; ev.n = 0;
+    sim_step(&g, NULL, &ev);
+    for(int i=0;i<ev.n;i++) hits += ev.ev[i].type == EV_HIT;
+    vfx_emit_events(&v, &ev); vfx_emit_trail(&v, &g.ball);
+    vfx_step(&v);
+    if(v.n > peak) peak = v.n;
+    if(g.state != ST_PLAY){ sim_new_game(&g, 2); g.bats[0].isAI = g.bats[1].isAI = 1; }
+    if(t % 97 == 0){
+      int n = vfx_build(&v, s, 2049);
+      for(int i=0;i<n;i++) bad += !isfinite(s[i].x) || !isfinite(s[i].w) || s[i].w < 0.0f || !(s[i].color[3] >= 0.0f && s[i].color[3] <= 1.0f);
+    }
+  }
+  CHECK(hits > 0 && v.dropped == 0 && bad == 0 && peak > 0 && peak < 2048);
+  vfx_free(&v);
+}
+
+/* ------------------------------- Baselines ------------------------------- */
+/* The old Impact list generalized: one struct per particle, copied out,
+ * updated and copied back if still alive, every step. */
+typedef struct { float x, y, vx, vy, age, life, size, grow, drag; uint8_t shape, color; } AosParticle;
+
+static int aos_step(AosParticle* p, int n){
+  int w = 0;
+  for(int i=0;i<n;i++){
+    AosParticle q = p[i];
+    q.x += q.vx; q.y += q.vy; q.vx *= q.drag; q.vy *= q.drag;
+    q.age += 1.0f; q.size = fmaxf(q.size + q.grow, 0.0f);
+    if(q.age < q.life) p[w++] = q;
+  }
+  return w;
+}
+
+/* vfx_step() without the vector kernel */
+static void soa_scalar_step(Vfx* v){
+  int n = v->n;
+  for(int i=0;i<n;i++){
+    v->x[i] += v->vx[i]; v->y[i] += v->vy[i];
+    v->vx[i] *= v->drag[i]; v->vy[i] *= v->drag[i];
+    v->age[i] += 1.0f;
+    v->size[i] = fmaxf(v->size[i] + v->grow[i], 0.0f);
+  }
+  for(int i=0;i<n;){
+    if(v->age[i] < v->life[i]){ i++; continue; }
+    n--;
+    v->x[i] = v->x[n]; v->y[i] = v->y[n]; v->vx[i] = v->vx[n]; v->vy[i] = v->vy[n];
+    v->age[i] = v->age[n]; v->life[i] = v->life[n];
+    v->size[i] = v->size[n]; v->grow[i] = v->grow[n]; v->drag[i] = v->drag[n];
+    v->shape[i] = v->shape[n]; v->color[i] = v->color[n];
+  }
+  v->n = n;
+}
+
+static float life_rand(void){ return 30.0f + 60.0f*frand(); }
+
+/* --------------------------------- Main ---------------------------------- */
+int main(int argc, char** argv){
+  long steps = bench_arg_long(argc, argv, 1, 300);
+
+  check_pool();
+  check_ripple();
+  check_swap_remove();
+  check_simd();
+  check_emitters();
+  check_match();
+  if(fails){ printf("checks: FAILED (%d)\n", fails); return 1; }
+  printf("checks: OK (pool, ripple, swap-remove, simd, emitters, match); kernel width %d\n\n", vfx_width());
+
+  static const int SIZES[] = { 10000, 25000, 50000, 100000 };
+  printf("%8s %12s %12s %12s %12s %12s\n", "live", "AoS ns/p", "SoA ns/p", "SIMD ns/p", "build ns/p", "upload KB");
+  for(size_t k=0;k<sizeof SIZES/sizeof SIZES[0];k++){
+    int N = SIZES[k];
+    Vfx v; vfx_init(&v, N);
+    AosParticle* aos = (AosParticle*)malloc((size_t)N*sizeof(AosParticle));
+    ShapeInstance* out = (ShapeInstance*)malloc((size_t)(N + 1)*sizeof(ShapeInstance));
+    if(!v.block || !aos || !out){ fprintf(stderr, "out of memory\n"); return 1; }
+    int na = 0;
+    uint64_t t_aos = 0, t_soa = 0, t_simd = 0, t_build = 0;
+    long live = 0;
+
+    /* steady state: refill to N before every step (not timed) */
+    for(long s=0;s<steps;s++){
+      while(na < N){
+        AosParticle* p = &aos[na++];
+        p->x = 800.0f*frand(); p->y = 480.0f*frand(); p->vx = 4.0f*frand() - 2.0f; p->vy = 4.0f*frand() - 2.0f;
+        p->age = 0.0f; p->life = life_rand(); p->size = 4.0f; p->grow = -0.05f; p->drag = 0.95f;
+        p->shape = SHAPE_CIRCLE; p->color = VFX_YELLOW;
+      }
+      uint64_t t0 = bench_now_ns();
+      na = aos_step(aos, na);
+      t_aos += bench_now_ns() - t0;
+    }
+    for(int pass=0;pass<2;pass++){
+      vfx_clear(&v);
+      for(long s=0;s<steps;s++){
+        while(v.n < N) spawn_random(&v, life_rand());
+        uint64_t t0 = bench_now_ns();
+        if(pass) vfx_step(&v); else soa_scalar_step(&v);
+        uint64_t t1 = bench_now_ns();
+        int n = vfx_build(&v, out, N + 1);
+        uint64_t t2 = bench_now_ns();
+        if(pass){ t_simd += t1 - t0; t_build += t2 - t1; live += n; }
+        else t_soa += t1 - t0;
+      }
+    }
+    double per = (double)steps*(double)N;
+    printf("%8d %12.2f %12.2f %12.2f %12.2f %12.0f\n", N, (double)t_aos/per, (double)t_soa/per,
+           (double)t_simd/per, (double)t_build/per, (double)live/(double)steps*sizeof(ShapeInstance)/1024.0);
+    free(out); free(aos); vfx_free(&v);
+  }
+  return 0;
+}
@@ -0,0 +1,427 @@
+/* pong_loadgen.c — thousands of loopback clients against the match server
+ * Usage: pong_loadgen [-c clients] [-s seconds] [-j workers] [-m 1|2] [-p port]
+ * Every client is its own UDP socket (one "connection") on 127.0.0.1. It
+ * JOINs (mode 2: paired with another client, the default; mode 1: vs the
+ * server AI), steers its paddle at the ball from each STATE, and JOINs
+ * again when the match ends. Without -p the server runs in this process on
+ * a free port with -j workers; with -p it targets a running pong_server,
+ * which needs `-a` of at least -c since every client shares one address.
+ *
+ * Checks first (exit 1 on failure): every message type round-trips the
+ * codec and malformed datagrams are rejected; a small private server only
+ * answers JOIN and STATS_REQ with a cookie until it is echoed, ignores a
+ * repeated JOIN, caps seats per address and rate-limits STATS. After the
+ * run it fails if the clients got under 95% of the STATEs a 60 Hz tick
+ * owes them, the server did not answer STATS, had any overrun or a p99
+ * wake lateness over a tick. Reports per-client STATE arrival jitter (gap
+ * vs the 16.7 ms tick), the server's wake lateness, and worker CPU per
+ * match step as a share of one core per match.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "bench_util.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "server.h"
+#include "sim_clock.h"
+
+#define TICK_US       (1000000 / SIM_TICK_HZ)
+#define JITTER_BUCKETS 100000        /* 1 us buckets up to 100 ms */
+#define RETRY_NS      1000000000ull  /* re-JOIN after a second of silence */
+#define KEEPALIVE     30             /* INPUT at least every 30 STATEs */
+
+/* -------------------------------- Checks -------------------------------- */
+static int roundtrip(const SrvMsg* m){
+  uint8_t buf[SRV_MSG_MAX];
+  SrvMsg back;
+  size_t n = srv_msg_encode(m, buf, sizeof buf);
+  if(n == 0 || !srv_msg_decode(&back, buf, n)) return 0;
+  uint8_t again[SRV_MSG_MAX];
+  if(srv_msg_encode(&back, again, sizeof again) != n || memcmp(buf, again, n) != 0) return 0;
+  /* every shorter prefix is rejected */
+  for(size_t k=0;k<n;k++) if(srv_msg_decode(&back, buf, k)) return 0;
+  return 1;
+}
+
+static void check_codec(void){
+  SrvMsg m;
+  memset(&m, 0, sizeof m); m.type = SRV_JOIN; m.mode = 2; m.cookie = 0xC00C1Eu;
+  CHECK(roundtrip(&m));
+  memset(&m, 0, sizeof m); m.type = SRV_INPUT; m.match = 4000000000u; m.side = 1; m.buttons = IN_P1_DOWN;
+  CHECK(roundtrip(&m));
+  memset(&m, 0, sizeof m); m.type = SRV_LEAVE; m.match = 17; m.side = 1;
+  CHECK(roundtrip(&m));
+  memset(&m, 0, sizeof m); m.type = SRV_STATS_REQ; m.cookie = 1;
+  CHECK(roundtrip(&m));
+  memset(&m, 0, sizeof m); m.type = SRV_COOKIE; m.cookie = 0xFFFFFFFFu;
+  CHECK(roundtrip(&m));
+  memset(&m, 0, sizeof m); m.type = SRV_STATE;
+  m.st = (SrvState){ 9, 12345, 987654321u, 1, ST_PLAY, { 3, 10 }, { -1.5f, 479.25f }, 400.125f, 7.0f, -0.70710678f, 0.70710678f, 14 };
+  CHECK(roundtrip(&m));
+  uint8_t buf[SRV_MSG_MAX];
+  SrvMsg back;
+  size_t n = srv_msg_encode(&m, buf, sizeof buf);
+  CHECK(srv_msg_decode(&back, buf, n) && memcmp(&back.st, &m.st, sizeof m.st) == 0);
+  CHECK(srv_msg_encode(&m, buf, n-1) == 0);
+  buf[2] = SRV_VERSION + 1;
+  CHECK(!srv_msg_decode(&back, buf, n));
+  memset(&m, 0, sizeof m); m.type = SRV_STATS;
+  m.stats = (ServerStats){ 1, 2, 3, 0x123456789Aull, 4, 5, 6, 7, 8, 9, 10 };
+  CHECK(roundtrip(&m));
+  memset(&m, 0, sizeof m); m.type = 0;
+  CHECK(srv_msg_encode(&m, buf, sizeof buf) == 0);
+
+  /* random datagrams: anything accepted re-encodes to the same bytes */
+  uint32_t r = 0x5EED5u;
+  int bad = 0;
+  for(int t=0;t<200000;t++){
+    r ^= r<<13; r ^= r>>17; r ^= r<<5;
+    size_t len = r % (SRV_MSG_MAX + 1);
+    for(size_t i=0;i<len;i++){ r ^= r<<13; r ^= r>>17; r ^= r<<5; buf[i] = (uint8_t)r; }
+    if(len >= 4 && (t & 1)){ buf[0] = 'P'; buf[1] = 'S'; buf[2] = SRV_VERSION; buf[3] = (uint8_t)(1 + r % SRV_COOKIE); }
+    if(!srv_msg_decode(&back, buf, len)) continue;
+    uint8_t again[SRV_MSG_MAX];
+    bad += srv_msg_encode(&back, again, sizeof again) != len || memcmp(buf, again, len) != 0;
+  }
+  CHECK(bad == 0);
+}
+
+/* -------------------------------- Clients -------------------------------- */
+typedef struct {
+  int fd;
+  int in_match;
+  uint32_t cookie;       /* the server's, once it sent one */
+  uint32_t match, tick, since_input;
+  uint8_t side;
+  unsigned buttons;
+  uint64_t last_ns;      /* last STATE (or JOIN sent, while waiting) */
+} Client;
+
+static uint32_t jitter[JITTER_BUCKETS];
+static uint64_t states, joins, inputs, games;
+
+static void client_send(Client* c, const SrvMsg* m){
+  uint8_t buf[SRV_MSG_MAX];
+  size_t n = srv_msg_encode(m, buf, sizeof buf);
+  (void)!send(c->fd, buf, n, MSG_DONTWAIT);
+}
+
+static void client_join(Client* c, int mode, uint64_t now){
+  SrvMsg m; memset(&m, 0, sizeof m);
+  m.type = SRV_JOIN; m.mode = (uint8_t)mode; m.cookie = c->cookie;
+  client_send(c, &m);
+  c->in_match = 0; c->last_ns = now;
+  joins++;
+}
+
+static void client_state(Client* c, const SrvState* st, int mode, uint64_t now){
+  states++;
+  if(c->in_match && st->match == c->match && st->tick == c->tick + 1){
+    int64_t d = (int64_t)(now - c->last_ns)/1000 - TICK_US;
+    uint64_t us = (uint64_t)(d < 0 ? -d : d);
+    jitter[us < JITTER_BUCKETS ? us : JITTER_BUCKETS-1]++;
+  }
+  c->in_match = 1; c->match = st->match; c->side = st->side; c->tick = st->tick; c->last_ns = now;
+  if(st->state != ST_PLAY){ games++; client_join(c, mode, now); return; }
+  /* bot: keep the paddle centre on the ball */
+  float bat = st->bat_y[st->side];
+  unsigned b = st->ball_y < bat - 16.0f ? IN_P1_UP : st->ball_y > bat + 16.0f ? IN_P1_DOWN : 0;
+  if(b != c->buttons || ++c->since_input >= KEEPALIVE){
+    SrvMsg m; memset(&m, 0, sizeof m);
+    m.type = SRV_INPUT; m.match = c->match; m.side = c->side; m.buttons = b;
+    client_send(c, &m);
+    c->buttons = b; c->since_input = 0;
+    inputs++;
+  }
+}
+
+/* a JOIN without a valid cookie comes back with one: repeat it */
+static void client_cookie(Client* c, uint32_t cookie, int mode){
+  c->cookie = cookie;
+  if(!c->in_match){
+    SrvMsg m; memset(&m, 0, sizeof m);
+    m.type = SRV_JOIN; m.mode = (uint8_t)mode; m.cookie = cookie;
+    client_send(c, &m);
+  }
+}
+
+static int open_client(uint16_t port){
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if(fd < 0) return -1;
+  int sz = 64 << 10;
+  setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &sz, sizeof sz);
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  struct sockaddr_in a;
+  memset(&a, 0, sizeof a);
+  a.sin_family = AF_INET; a.sin_port = htons(port); a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if(connect(fd, (struct sockaddr*)&a, sizeof a) < 0){ close(fd); return -1; }
+  return fd;
+}
+
+/* the next decodable datagram within `ms`; 0 on timeout */
+static int recv_msg(int fd, SrvMsg* m, int ms){
+  uint64_t end = bench_now_ns() + (uint64_t)ms*1000000ull;
+  for(;;){
+    uint64_t now = bench_now_ns();
+    if(now >= end) return 0;
+    struct pollfd p = { fd, POLLIN, 0 };
+    if(poll(&p, 1, (int)((end - now)/1000000ull) + 1) <= 0) continue;
+    uint8_t buf[SRV_MSG_MAX];
+    ssize_t n = recv(fd, buf, sizeof buf, MSG_DONTWAIT);
+    if(n > 0 && srv_msg_decode(m, buf, (size_t)n)) return 1;
+  }
+}
+
+static void send_msg(int fd, const SrvMsg* m){
+  uint8_t buf[SRV_MSG_MAX];
+  (void)!send(fd, buf, srv_msg_encode(m, buf, sizeof buf), 0);
+}
+
+/* a message of `type` within `ms`, skipping others */
+static int await(int fd, int type, SrvMsg* m, int ms){
+  uint64_t end = bench_now_ns() + (uint64_t)ms*1000000ull;
+  while(bench_now_ns() < end){
+    int left = (int)((end - bench_now_ns())/1000000ull) + 1;
+    if(recv_msg(fd, m, left) && m->type == type) return 1;
+  }
+  return 0;
+}
+
+static int fetch_stats(uint16_t port, ServerStats* out){
+  int fd = open_client(port);
+  if(fd < 0) return 0;
+  int ok = 0;
+  uint32_t cookie = 0;
+  for(int attempt=0; attempt<6 && !ok; attempt++){
+    SrvMsg m; memset(&m, 0, sizeof m); m.type = SRV_STATS_REQ; m.cookie = cookie;
+    send_msg(fd, &m);
+    if(!recv_msg(fd, &m, 300)) continue;
+    if(m.type == SRV_COOKIE) cookie = m.cookie;
+    else if(m.type == SRV_STATS){ *out = m.stats; ok = 1; }
+  }
+  close(fd);
+  return ok;
+}
+
+static void* run_server(void* arg){ server_run((Server*)arg); return NULL; }
+
+/* a private server with 2 seats per address; every client is 127.0.0.1 */
+static void check_server(void){
+  ServerConfig cfg = { 0, 8, 1, 7u, 2 };
+  Server* srv = server_start(&cfg);
+  pthread_t thr;
+  if(!srv || pthread_create(&thr, NULL, run_server, srv) != 0){ CHECK(!"private server"); return; }
+  uint16_t port = server_port(srv);
+  int a = open_client(port), b = open_client(port), c = open_client(port);
+  CHECK(a >= 0 && b >= 0 && c >= 0);
+  SrvMsg m, got;
+
+  /* no cookie, or a wrong one: a cookie back and nothing else */
+  memset(&m, 0, sizeof m); m.type = SRV_JOIN; m.mode = 1;
+  send_msg(a, &m);
+  CHECK(await(a, SRV_COOKIE, &got, 500) && got.cookie != 0);
+  uint32_t cookie = got.cookie;
+  m.cookie = cookie ^ 1u;
+  send_msg(a, &m);
+  CHECK(await(a, SRV_COOKIE, &got, 500) && got.cookie == cookie);
+  CHECK(!await(a, SRV_STATE, &got, 100));
+  /* the cookie is per address */
+  send_msg(b, &m);
+  CHECK(await(b, SRV_COOKIE, &got, 500) && got.cookie != cookie);
+  uint32_t cookie_b = got.cookie;
+
+  /* echoed: a match, and the same JOIN again does not open a second */
+  m.cookie = cookie;
+  send_msg(a, &m); send_msg(a, &m);
+  CHECK(await(a, SRV_STATE, &got, 500));
+  uint32_t match = got.st.match;
+  int others = 0;
+  for(int i=0;i<10;i++) if(await(a, SRV_STATE, &got, 100)) others += got.st.match != match;
+  CHECK(others == 0);
+
+  /* leaving frees the seat right away: rejoining starts a new match */
+  int fresh = 0;
+  for(int i=0;i<10;i++){
+    memset(&m, 0, sizeof m); m.type = SRV_LEAVE; m.match = match; m.side = 0;
+    send_msg(a, &m);
+    await(a, -1, &got, 40);   /* drain while the worker ends it */
+    memset(&m, 0, sizeof m); m.type = SRV_JOIN; m.mode = 1; m.cookie = cookie;
+    send_msg(a, &m);
+    if(await(a, SRV_STATE, &got, 500) && got.st.tick <= 3){ fresh++; match = got.st.match; }
+  }
+  CHECK(fresh == 10);
+
+  /* b takes the address's second seat, c would be a third */
+  m.cookie = cookie_b;
+  send_msg(b, &m);
+  CHECK(await(b, SRV_STATE, &got, 500));
+  m.cookie = 0;
+  send_msg(c, &m);
+  CHECK(await(c, SRV_COOKIE, &got, 500));
+  m.cookie = got.cookie;
+  send_msg(c, &m);
+  CHECK(!await(c, SRV_STATE, &got, 200));
+
+  /* STATS: cookie first, then one reply per SRV_STATS_MIN_MS */
+  memset(&m, 0, sizeof m); m.type = SRV_STATS_REQ;
+  send_msg(c, &m);
+  CHECK(await(c, SRV_COOKIE, &got, 500));
+  m.cookie = got.cookie;
+  send_msg(c, &m);
+  CHECK(await(c, SRV_STATS, &got, 500) && got.stats.started == 12 && got.stats.active == 2);
+  send_msg(c, &m);
+  CHECK(!await(c, SRV_STATS, &got, SRV_STATS_MIN_MS/2));
+
+  close(a); close(b); close(c);
+  server_shutdown(srv);
+  pthread_join(thr, NULL);
+  server_free(srv);
+}
+
+static uint32_t pct(const uint32_t* h, int buckets, double q){
+  uint64_t total = 0, acc = 0;
+  for(int i=0;i<buckets;i++) total += h[i];
+  uint64_t want = (uint64_t)((double)total * q);
+  for(int i=0;i<buckets;i++){ acc += h[i]; if(acc > want) return (uint32_t)i; }
+  return 0;
+}
+
+static uint32_t hist_max(const uint32_t* h, int buckets){
+  for(int i=buckets-1;i>=0;i--) if(h[i]) return (uint32_t)i;
+  return 0;
+}
+
+/* --------------------------------- Main ---------------------------------- */
+int main(int argc, char** argv){
+  long nproc = sysconf(_SC_NPROCESSORS_ONLN);
+  int nclients = 2000, workers = nproc > 0 ? (int)nproc : 1, mode = 2;
+  double secs = 5.0;
+  uint16_t port = 0;
+  for(int i=1;i<argc;i++){
+    const char* a = argv[i];
+    const char* v = i+1 < argc ? argv[i+1] : NULL;
+    if(!strcmp(a, "-c") && v){ nclients = atoi(v); i++; }
+    else if(!strcmp(a, "-s") && v){ secs = atof(v); i++; }
+    else if(!strcmp(a, "-j") && v){ workers = atoi(v); i++; }
+    else if(!strcmp(a, "-m") && v){ mode = atoi(v); i++; }
+    else if(!strcmp(a, "-p") && v){ port = (uint16_t)atoi(v); i++; }
+    else { fprintf(stderr, "usage: %s [-c clients] [-s seconds] [-j workers] [-m 1|2] [-p port]\n", argv[0]); return 2; }
+  }
+  if(nclients < 2 || secs <= 0 || (mode != 1 && mode != 2)){ fprintf(stderr, "bad arguments\n"); return 2; }
+  if(workers < 1) workers = 1;
+  if(workers > SRV_MAX_WORKERS) workers = SRV_MAX_WORKERS;
+
+  check_codec();
+  check_server();
+  if(fails){ printf("checks: FAILED (%d)\n", fails); return 1; }
+  printf("checks: OK (codec round-trip x7, malformed datagrams, cookies, repeated JOIN, seat cap, STATS rate)\n\n");
+
+  /* one descriptor per client, plus headroom */
+  struct rlimit rl;
+  if(getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < (rlim_t)nclients + 64){
+    rl.rlim_cur = rl.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &rl);
+    getrlimit(RLIMIT_NOFILE, &rl);
+    if(rl.rlim_cur < (rlim_t)nclients + 64){ fprintf(stderr, "need %d descriptors, have %ld\n", nclients + 64, (long)rl.rlim_cur); return 1; }
+  }
+
+  Server* srv = NULL;
+  pthread_t srv_thr;
+  if(!port){
+    ServerConfig cfg = { 0, nclients, workers, 1u, nclients };
+    srv = server_start(&cfg);
+    if(!srv) return 1;
+    port = server_port(srv);
+    if(pthread_create(&srv_thr, NULL, run_server, srv) != 0){ fprintf(stderr, "can't start server thread\n"); return 1; }
+  }
+
+  Client* cl = (Client*)calloc((size_t)nclients, sizeof(Client));
+  int ep = epoll_create1(0);
+  if(!cl || ep < 0){ fprintf(stderr, "out of memory\n"); return 1; }
+  uint64_t now = bench_now_ns();
+  for(int i=0;i<nclients;i++){
+    Client* c = &cl[i];
+    c->fd = open_client(port);
+    if(c->fd < 0){ perror("socket"); return 1; }
+    struct epoll_event ev = { EPOLLIN, { .ptr = c } };
+    epoll_ctl(ep, EPOLL_CTL_ADD, c->fd, &ev);
+    client_join(c, mode, now);
+  }
+
+  static struct epoll_event evs[512];
+  const uint64_t t0 = bench_now_ns(), t_end = t0 + (uint64_t)(secs*1e9);
+  uint64_t last_retry = t0, retries = 0;
+  while((now = bench_now_ns()) < t_end){
+    int n = epoll_wait(ep, evs, 512, 5);
+    for(int i=0;i<n;i++){
+      Client* c = (Client*)evs[i].data.ptr;
+      uint8_t buf[SRV_MSG_MAX];
+      ssize_t r;
+      while((r = recv(c->fd, buf, sizeof buf, 0)) > 0){
+        SrvMsg m;
+        if(!srv_msg_decode(&m, buf, (size_t)r)) continue;
+        if(m.type == SRV_STATE) client_state(c, &m.st, mode, bench_now_ns());
+        else if(m.type == SRV_COOKIE) client_cookie(c, m.cookie, mode);
+      }
+    }
+    now = bench_now_ns();
+    if(now - last_retry > RETRY_NS/10){
+      last_retry = now;
+      for(int i=0;i<nclients;i++)
+        if(now - cl[i].last_ns > RETRY_NS){ client_join(&cl[i], mode, now); retries++; }
+    }
+  }
+  double elapsed = (double)(bench_now_ns() - t0)/1e9;
+
+  ServerStats st = {0};
+  int got_stats = fetch_stats(port, &st);
+  for(int i=0;i<nclients;i++){
+    if(cl[i].in_match){
+      SrvMsg m; memset(&m, 0, sizeof m);
+      m.type = SRV_LEAVE; m.match = cl[i].match; m.side = cl[i].side;
+      client_send(&cl[i], &m);
+    }
+    close(cl[i].fd);
+  }
+  close(ep);
+  free(cl);
+  if(srv){
+    server_shutdown(srv);
+    pthread_join(srv_thr, NULL);
+    server_free(srv);
+  }
+
+  double expected = (double)nclients * elapsed * SIM_TICK_HZ;
+  int matches = mode == 2 ? nclients/2 : nclients;
+  printf("clients %d (mode %d, %d concurrent matches), %.1f s, server %s, %d workers\n",
+         nclients, mode, matches, elapsed, srv ? "in-process" : "external", got_stats ? (int)st.workers : workers);
+  printf("states received %llu of ~%.0f (%.1f%%), inputs sent %llu, joins %llu (%llu retries), games finished %llu\n",
+         (unsigned long long)states, expected, 100.0*(double)states/expected,
+         (unsigned long long)inputs, (unsigned long long)joins, (unsigned long long)retries, (unsigned long long)games/ (mode == 2 ? 2 : 1));
+  printf("state arrival jitter us |gap - %d|: p50 %u  p99 %u  max %u\n",
+         TICK_US, pct(jitter, JITTER_BUCKETS, 0.50), pct(jitter, JITTER_BUCKETS, 0.99), hist_max(jitter, JITTER_BUCKETS));
+  if(got_stats){
+    double core = (double)st.cpu_ns_per_step * SIM_TICK_HZ / 1e9;
+    printf("server: %u matches started, %llu steps, wake lateness us p50 %u  p99 %u  max %u (%u overruns), %u send drops\n",
+           st.started, (unsigned long long)st.steps, st.late_p50_us, st.late_p99_us, st.late_max_us, st.overruns, st.send_drops);
+    printf("cpu per match: %u ns/step = %.4f%% of a core at %d Hz (~%.0f matches per core)\n",
+           st.cpu_ns_per_step, 100.0*core, SIM_TICK_HZ, core > 0 ? 1.0/core : 0.0);
+  }
+  CHECK(got_stats && st.started > 0);
+  CHECK((double)states >= 0.95*expected);
+  /* the jitter this tool measures: any wake a whole tick late fails */
+  CHECK(got_stats && st.overruns == 0 && st.late_p99_us <= TICK_US);
+  if(fails){ printf("run: FAILED (%d)\n", fails); return 1; }
+  return 0;
+}
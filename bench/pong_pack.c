@@ -0,0 +1,102 @@
+/* pong_pack.c — build-time asset packer
+ * Usage: pong_pack out.pak dir...     pack every file in each dir
+ *        pong_pack -l file.pak        list an archive's index
+ * Entries are named "<dir basename>/<file>" ("sounds/hit0.ogg", the paths
+ * the game asks for), ordered by asset_plan() (first-needed first, music
+ * last and flagged for streaming) and written page aligned (asset_pack.h).
+ */
+
+#define _POSIX_C_SOURCE 200809L  /* strdup */
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "asset_pack.h"
+
+#define MAX_FILES 1024
+
+static const char* const CODEC_NAME[] = { "raw", "wav", "ogg" };
+
+static void* slurp(const char* path, uint32_t* size){
+  FILE* fp = fopen(path, "rb");
+  if(!fp) return NULL;
+  long len = fseek(fp, 0, SEEK_END) == 0 ? ftell(fp) : -1;
+  void* buf = len >= 0 && fseek(fp, 0, SEEK_SET) == 0 ? malloc(len ? (size_t)len : 1u) : NULL;
+  if(buf && fread(buf, 1, (size_t)len, fp) != (size_t)len){ free(buf); buf = NULL; }
+  fclose(fp);
+  *size = (uint32_t)len;
+  return buf;
+}
+
+static int by_name(const void* a, const void* b){
+  return strcmp(((const AssetSrc*)a)->name, ((const AssetSrc*)b)->name);
+}
+
+static int list(const char* path){
+  AssetFile f;
+  if(!asset_file_open(&f, path)){ fprintf(stderr, "%s: not a valid archive\n", path); return 1; }
+  printf("%-4s %-28s %10s %10s %-4s %s\n", "#", "name", "offset", "bytes", "fmt", "flags");
+  for(uint32_t i=0;i<f.pack.count;i++){
+    AssetEntry e; asset_pack_entry(&f.pack, i, &e);
+    printf("%-4u %-28s %10u %10u %-4s %s\n", (unsigned)i, e.name, (unsigned)e.offset, (unsigned)e.size,
+           e.codec < 3 ? CODEC_NAME[e.codec] : "?", (e.flags & ASSET_FLAG_STREAM) ? "stream" : "");
+  }
+  printf("%u entries, %u bytes\n", (unsigned)f.pack.count, (unsigned)f.pack.total);
+  asset_file_close(&f);
+  return 0;
+}
+
+int main(int argc, char** argv){
+  if(argc == 3 && !strcmp(argv[1], "-l")) return list(argv[2]);
+  if(argc < 3){ fprintf(stderr, "usage: pong_pack out.pak dir...\n       pong_pack -l file.pak\n"); return 2; }
+
+  static AssetSrc src[MAX_FILES];
+  int n = 0;
+  for(int a=2;a<argc;a++){
+    const char* dir = argv[a];
+    size_t dl = strlen(dir);
+    while(dl > 1 && dir[dl-1] == '/') dl--;
+    const char* base = dir + dl;
+    while(base > dir && base[-1] != '/') base--;
+    DIR* d = opendir(dir);
+    if(!d){ fprintf(stderr, "%s: cannot open\n", dir); return 1; }
+    struct dirent* de;
+    while((de = readdir(d)) != NULL){
+      if(de->d_name[0] == '.') continue;
+      char path[1024], name[256];
+      if((size_t)snprintf(path, sizeof path, "%.*s/%s", (int)dl, dir, de->d_name) >= sizeof path){
+        fprintf(stderr, "%s/%s: path too long\n", dir, de->d_name); return 1;
+      }
+      struct stat st;
+      if(stat(path, &st) != 0 || !S_ISREG(st.st_mode)) continue;
+      if(n == MAX_FILES){ fprintf(stderr, "too many files (max %d)\n", MAX_FILES); return 1; }
+      /* truncated names could collide: refuse rather than pack two as one */
+      if((size_t)snprintf(name, sizeof name, "%.*s/%s", (int)(dir + dl - base), base, de->d_name) >= sizeof name){
+        fprintf(stderr, "%s: entry name too long (max %d)\n", path, (int)sizeof name - 1); return 1;
+      }
+      AssetSrc* s = &src[n];
+      s->data = slurp(path, &s->size);
+      if(!s->data){ fprintf(stderr, "%s: read failed\n", path); return 1; }
+      s->name = strdup(name); s->codec = (uint8_t)asset_codec_for(name); s->flags = 0;
+      n++;
+    }
+    closedir(d);
+  }
+  qsort(src, (size_t)n, sizeof src[0], by_name);   /* readdir order is arbitrary */
+  asset_plan(src, n);
+
+  size_t size;
+  uint8_t* pak = asset_pack_build(src, n, &size);
+  if(!pak){ fprintf(stderr, "pack failed\n"); return 1; }
+  FILE* fp = fopen(argv[1], "wb");
+  int ok = fp && fwrite(pak, 1, size, fp) == size;
+  if(fp && fclose(fp) != 0) ok = 0;
+  if(!ok){ fprintf(stderr, "%s: write failed\n", argv[1]); return 1; }
+  printf("%s: %d entries, %zu bytes\n", argv[1], n, size);
+  free(pak);
+  for(int i=0;i<n;i++){ free((void*)src[i].data); free((void*)src[i].name); }
+  return 0;
+}
@@ -0,0 +1,58 @@
+/* pong_server.c — authoritative UDP match server
+ * Usage: pong_server [-p port] [-m max_matches] [-j workers] [-s seed] [-a seats_per_ip]
+ * Hosts matches for any number of clients speaking the server.h protocol
+ * (JOIN vs the server AI or vs the next waiting player, then INPUT per
+ * tick; STATE comes back every tick). One source IP holds at most -a
+ * seats (default SRV_MAX_PER_ADDR). Ctrl+C stops it and prints totals.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "server.h"
+
+static Server* g_server;
+
+static void on_signal(int sig){ (void)sig; if(g_server) server_shutdown(g_server); }
+
+int main(int argc, char** argv){
+  long nproc = sysconf(_SC_NPROCESSORS_ONLN);
+  ServerConfig cfg = { 7777, 4096, nproc > 0 ? (int)nproc : 1, 1u, 0 };
+  if(cfg.workers > SRV_MAX_WORKERS) cfg.workers = SRV_MAX_WORKERS;
+  for(int i=1;i<argc;i++){
+    const char* a = argv[i];
+    const char* v = i+1 < argc ? argv[i+1] : NULL;
+    if(!strcmp(a, "-p") && v){ cfg.port = (uint16_t)atoi(v); i++; }
+    else if(!strcmp(a, "-m") && v){ cfg.max_matches = atoi(v); i++; }
+    else if(!strcmp(a, "-j") && v){ cfg.workers = atoi(v); i++; }
+    else if(!strcmp(a, "-s") && v){ cfg.seed = (uint32_t)strtoul(v, NULL, 10); i++; }
+    else if(!strcmp(a, "-a") && v){ cfg.max_per_addr = atoi(v); i++; }
+    else { fprintf(stderr, "usage: %s [-p port] [-m max_matches] [-j workers] [-s seed] [-a seats_per_ip]\n", argv[0]); return 2; }
+  }
+
+  g_server = server_start(&cfg);
+  if(!g_server) return 1;
+  struct sigaction sa;
+  memset(&sa, 0, sizeof sa);
+  sa.sa_handler = on_signal;
+  sigaction(SIGINT, &sa, NULL);
+  sigaction(SIGTERM, &sa, NULL);
+  printf("pong_server: udp port %u, %d match slots, %d workers\n",
+         (unsigned)server_port(g_server), cfg.max_matches, cfg.workers);
+  fflush(stdout);
+
+  server_run(g_server);
+
+  ServerStats st;
+  server_stats(g_server, &st);
+  printf("matches %u started, %llu steps, %u ticks\n", st.started, (unsigned long long)st.steps, st.ticks);
+  printf("wake lateness us: p50 %u  p99 %u  max %u  (%u overruns)\n", st.late_p50_us, st.late_p99_us, st.late_max_us, st.overruns);
+  printf("cpu per match step: %u ns, send drops %u\n", st.cpu_ns_per_step, st.send_drops);
+  server_free(g_server);
+  return 0;
+}
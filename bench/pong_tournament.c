@@ -0,0 +1,339 @@
+/* pong_tournament.c — multithreaded AI-vs-AI parameter sweep
+ * Usage: pong_tournament [-j threads] [-n matches] [-s seed]
+ *                        [-speed 4,6,8] [-offset 0,10,20] [-blend 200,400,600]
+ *                        [-scale]
+ * Every point of the grid (max_speed x offset_range x blend_dist, see
+ * AiBlendParams in ai.h) plays `matches` games to SIM_WIN_SCORE against the
+ * stock blend AI, alternating sides. Games are spread over a work-stealing
+ * pool of pthreads. Reports per-config win rate, points and rally-length
+ * distribution (paddle hits per point), then matches/sec. -scale reruns the
+ * grid at 1, 2, 4, ... threads and reports the speedup.
+ *
+ * Checks first (exit 1 on failure): the default params drive a paddle
+ * exactly like the built-in AI, and results don't depend on the thread count.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "bench_util.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "ai.h"
+#include "sim.h"
+
+#define MAX_STEPS (60*60*10)   /* a match still going after 10 minutes is a draw */
+#define RALLY_BUCKETS 64       /* rally lengths 0..62 exactly, 63 = longer */
+#define MAX_CONFIGS 1024
+#define MAX_THREADS 256
+
+/* --------------------------------- Grid --------------------------------- */
+typedef struct {
+  AiBlendParams cfg[MAX_CONFIGS];
+  int n;
+} Grid;
+
+static int parse_list(const char* s, float* out, int cap){
+  int n = 0;
+  while(*s && n<cap){
+    char* end; float v = strtof(s, &end);
+    if(end==s) return -1;
+    out[n++] = v; s = end;
+    if(*s==',') s++;
+  }
+  return n;
+}
+
+static void grid_build(Grid* g, const float* sp, int nsp, const float* off, int noff, const float* bl, int nbl){
+  g->n = 0;
+  for(int a=0;a<nsp;a++) for(int b=0;b<noff;b++) for(int c=0;c<nbl;c++){
+    if(g->n >= MAX_CONFIGS) return;
+    AiBlendParams* p = &g->cfg[g->n++];
+    p->max_speed = sp[a]; p->offset_range = off[b]; p->blend_dist = bl[c];
+  }
+}
+
+/* -------------------------------- Results -------------------------------- */
+typedef struct {
+  long matches, wins, draws, points_for, points_against, steps;
+  long rallies, rally_sum, rally_max;
+  long rally_hist[RALLY_BUCKETS];
+} Acc;
+
+static void acc_merge(Acc* dst, const Acc* src){
+  dst->matches += src->matches; dst->wins += src->wins; dst->draws += src->draws;
+  dst->points_for += src->points_for; dst->points_against += src->points_against;
+  dst->steps += src->steps; dst->rallies += src->rallies; dst->rally_sum += src->rally_sum;
+  if(src->rally_max > dst->rally_max) dst->rally_max = src->rally_max;
+  for(int i=0;i<RALLY_BUCKETS;i++) dst->rally_hist[i] += src->rally_hist[i];
+}
+
+static int rally_percentile(const Acc* a, double p){
+  long want = (long)(p/100.0*(double)a->rallies + 0.5), seen = 0;
+  for(int i=0;i<RALLY_BUCKETS;i++){ seen += a->rally_hist[i]; if(seen >= want && seen > 0) return i; }
+  return RALLY_BUCKETS-1;
+}
+
+/* --------------------------------- Match --------------------------------- */
+/* Match k of every config uses the same seed and side (common random
+ * numbers), so configs are compared on the same serves. */
+static uint32_t match_seed(uint32_t base, long k){
+  uint32_t z = base + (uint32_t)k*0x9E3779B9u;
+  z = (z ^ (z>>16)) * 0x85EBCA6Bu; z = (z ^ (z>>13)) * 0xC2B2AE35u; z ^= z>>16;
+  return z ? z : 1u;
+}
+
+static void play(const AiBlendParams* p, uint32_t seed, int side, Acc* a){
+  Game g; sim_init(&g, seed); sim_new_game(&g, 2);
+  g.bats[0].isAI = g.bats[1].isAI = 0;
+  long n = 0, hits = 0;
+  while(g.state==ST_PLAY && n<MAX_STEPS){
+    ai_blend_move(p, &g, side);
+    ai_blend_move(&AI_BLEND_DEFAULT, &g, 1-side);
+    Events ev; ev.n = 0;
+    sim_step(&g, NULL, &ev);
+    for(int i=0;i<ev.n;i++){
+      if(ev.ev[i].type==EV_HIT) hits++;
+      else if(ev.ev[i].type==EV_GOAL){
+        a->rallies++; a->rally_sum += hits;
+        a->rally_hist[hits < RALLY_BUCKETS ? hits : RALLY_BUCKETS-1]++;
+        if(hits > a->rally_max) a->rally_max = hits;
+        hits = 0;
+      }
+    }
+    n++;
+  }
+  a->matches++; a->steps += n;
+  a->points_for += g.bats[side].score; a->points_against += g.bats[1-side].score;
+  if(g.state!=ST_OVER) a->draws++;
+  else if(g.bats[side].score >= SIM_WIN_SCORE) a->wins++;
+}
+
+/* ------------------------------- Scheduler ------------------------------- */
+/* Each worker owns a range of task indices packed as head | tail<<32 in one
+ * word. The owner pops from the head; an idle worker steals the upper half
+ * of a victim's range with a CAS and makes it its own. Tasks are created up
+ * front, so `remaining` reaching 0 ends the run. */
+typedef struct {
+  uint64_t range;
+  char pad[64 - sizeof(uint64_t)];
+} Deque;
+
+typedef struct Pool Pool;
+typedef struct {
+  Pool*    pool;
+  int      id;
+  Acc*     acc;        /* per config, this worker only */
+  long     steals;
+  uint32_t rng;        /* victim choice */
+  pthread_t th;
+} Worker;
+
+struct Pool {
+  const Grid* grid;
+  long     per_config;
+  uint32_t seed;
+  int      nw;
+  Deque    dq[MAX_THREADS];
+  Worker   w[MAX_THREADS];
+  long     remaining;
+};
+
+static uint64_t pack(uint32_t head, uint32_t tail){ return (uint64_t)head | (uint64_t)tail<<32; }
+
+static int pop_own(Deque* d, long* task){
+  uint64_t r = __atomic_load_n(&d->range, __ATOMIC_ACQUIRE);
+  for(;;){
+    uint32_t h = (uint32_t)r, t = (uint32_t)(r>>32);
+    if(h >= t) return 0;
+    if(__atomic_compare_exchange_n(&d->range, &r, pack(h+1, t), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)){
+      *task = (long)h; return 1;
+    }
+  }
+}
+
+static int steal(Pool* p, Worker* w){
+  int start = (int)(w->rng % (uint32_t)p->nw);
+  for(int k=0;k<p->nw;k++){
+    int vi = (start + k) % p->nw;
+    if(vi == w->id) continue;
+    Deque* v = &p->dq[vi];
+    uint64_t r = __atomic_load_n(&v->range, __ATOMIC_ACQUIRE);
+    uint32_t h = (uint32_t)r, t = (uint32_t)(r>>32);
+    if(h >= t) continue;
+    uint32_t take = (t - h + 1)/2;
+    if(!__atomic_compare_exchange_n(&v->range, &r, pack(h, t-take), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) continue;
+    /* our deque is empty, and nobody steals from an empty one */
+    __atomic_store_n(&p->dq[w->id].range, pack(t-take, t), __ATOMIC_RELEASE);
+    w->steals++;
+    return 1;
+  }
+  return 0;
+}
+
+static void* worker_main(void* arg){
+  Worker* w = (Worker*)arg;
+  Pool* p = w->pool;
+  long task;
+  while(__atomic_load_n(&p->remaining, __ATOMIC_ACQUIRE) > 0){
+    if(pop_own(&p->dq[w->id], &task)){
+      long c = task / p->per_config, k = task % p->per_config;
+      play(&p->grid->cfg[c], match_seed(p->seed, k), (int)(k & 1), &w->acc[c]);
+      __atomic_fetch_sub(&p->remaining, 1, __ATOMIC_ACQ_REL);
+      continue;
+    }
+    w->rng ^= w->rng<<13; w->rng ^= w->rng>>17; w->rng ^= w->rng<<5;
+    if(!steal(p, w)) sched_yield();
+  }
+  return NULL;
+}
+
+/* Plays the whole grid on `nw` threads; out[c] gets config c's totals.
+ * Returns wall time in seconds. */
+static double run_pool(const Grid* grid, long per_config, uint32_t seed, int nw, Acc* out, long* steals){
+  static Pool p;
+  long total = (long)grid->n * per_config;
+  memset(&p, 0, sizeof(p));
+  p.grid = grid; p.per_config = per_config; p.seed = seed; p.nw = nw; p.remaining = total;
+  for(int i=0;i<nw;i++){
+    /* contiguous slices: neighbouring configs cost alike, stealing evens it out */
+    p.dq[i].range = pack((uint32_t)(total*i/nw), (uint32_t)(total*(i+1)/nw));
+    p.w[i].pool = &p; p.w[i].id = i; p.w[i].rng = 0x2545F491u*(uint32_t)(i+1);
+    p.w[i].acc = (Acc*)calloc((size_t)grid->n, sizeof(Acc));
+  }
+  uint64_t t0 = bench_now_ns();
+  for(int i=1;i<nw;i++) pthread_create(&p.w[i].th, NULL, worker_main, &p.w[i]);
+  worker_main(&p.w[0]);
+  for(int i=1;i<nw;i++) pthread_join(p.w[i].th, NULL);
+  double secs = (double)(bench_now_ns() - t0)/1e9;
+
+  memset(out, 0, sizeof(Acc)*(size_t)grid->n);
+  *steals = 0;
+  for(int i=0;i<nw;i++){
+    for(int c=0;c<grid->n;c++) acc_merge(&out[c], &p.w[i].acc[c]);
+    *steals += p.w[i].steals;
+    free(p.w[i].acc);
+  }
+  return secs;
+}
+
+/* -------------------------------- Checks -------------------------------- */
+/* AI_BLEND_DEFAULT moving both paddles from outside == isAI in the sim. */
+static void check_default_matches_builtin(void){
+  for(uint32_t s=1;s<=8;s++){
+    Game a, b; sim_init(&a, s*7919u); sim_new_game(&a, 2);
+    a.bats[0].isAI = a.bats[1].isAI = 1;
+    b = a; b.bats[0].isAI = b.bats[1].isAI = 0;
+    long n = 0; int same = 1;
+    while(a.state==ST_PLAY && n<MAX_STEPS && same){
+      sim_step(&a, NULL, NULL);
+      ai_blend_move(&AI_BLEND_DEFAULT, &b, 0); ai_blend_move(&AI_BLEND_DEFAULT, &b, 1);
+      sim_step(&b, NULL, NULL);
+      same = a.bats[0].y==b.bats[0].y && a.bats[1].y==b.bats[1].y && a.ball.x==b.ball.x && a.ball.y==b.ball.y &&
+             a.bats[0].score==b.bats[0].score && a.bats[1].score==b.bats[1].score && a.rng==b.rng;
+      n++;
+    }
+    CHECK(same);
+    CHECK(a.state==b.state);
+  }
+}
+
+static int acc_equal(const Acc* a, const Acc* b, int n){
+  return memcmp(a, b, sizeof(Acc)*(size_t)n)==0;
+}
+
+/* ---------------------------------- Main ---------------------------------- */
+static void usage(void){
+  fprintf(stderr, "usage: pong_tournament [-j threads] [-n matches] [-s seed] "
+                  "[-speed list] [-offset list] [-blend list] [-scale]\n");
+}
+
+int main(int argc, char** argv){
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  int threads = cpus > 0 ? (int)cpus : 1;
+  long per_config = 200; uint32_t seed = 0x7041u; int scale = 0;
+  float sp[32] = { 4, 6, 8 }, off[32] = { 0, 10, 20 }, bl[32] = { 200, 400, 600 };
+  int nsp = 3, noff = 3, nbl = 3;
+  for(int i=1;i<argc;i++){
+    const char* a = argv[i]; const char* v = i+1<argc ? argv[i+1] : NULL;
+    if(!strcmp(a, "-scale")){ scale = 1; continue; }
+    if(!v){ usage(); return 2; }
+    i++;
+    if(!strcmp(a, "-j"))           threads = atoi(v);
+    else if(!strcmp(a, "-n"))      per_config = atol(v);
+    else if(!strcmp(a, "-s"))      seed = (uint32_t)strtoul(v, NULL, 0);
+    else if(!strcmp(a, "-speed"))  nsp = parse_list(v, sp, 32);
+    else if(!strcmp(a, "-offset")) noff = parse_list(v, off, 32);
+    else if(!strcmp(a, "-blend"))  nbl = parse_list(v, bl, 32);
+    else { usage(); return 2; }
+  }
+  if(threads < 1) threads = 1;
+  if(threads > MAX_THREADS) threads = MAX_THREADS;
+  if(per_config < 1 || nsp < 1 || noff < 1 || nbl < 1){ usage(); return 2; }
+
+  static Grid grid;
+  grid_build(&grid, sp, nsp, off, noff, bl, nbl);
+  static Acc res[MAX_CONFIGS], res1[MAX_CONFIGS];
+  long steals;
+
+  /* checks: parity with the built-in AI; 1 thread vs `threads` on a small grid */
+  check_default_matches_builtin();
+  {
+    static Grid small; small.n = 3;
+    for(int i=0;i<3;i++){ small.cfg[i] = AI_BLEND_DEFAULT; small.cfg[i].max_speed = 4.0f + 2.0f*(float)i; }
+    int nw = threads > 1 ? threads : 2;   /* stealing runs even on one core */
+    run_pool(&small, 16, seed, 1, res1, &steals);
+    run_pool(&small, 16, seed, nw, res, &steals);
+    CHECK(acc_equal(res1, res, small.n));
+    long m = 0; for(int c=0;c<small.n;c++) m += res[c].matches;
+    CHECK(m == 3*16);
+  }
+  if(fails){ printf("checks: FAILED (%d)\n", fails); return 1; }
+  printf("checks: OK (default params == built-in AI, results independent of thread count)\n\n");
+
+  long total = (long)grid.n*per_config;
+  printf("%d configs x %ld matches vs the stock blend AI (speed %.0f, offset %.0f, blend %.0f), %d threads\n",
+         grid.n, per_config, AI_BLEND_DEFAULT.max_speed, AI_BLEND_DEFAULT.offset_range, AI_BLEND_DEFAULT.blend_dist, threads);
+  double secs = run_pool(&grid, per_config, seed, threads, res, &steals);
+
+  printf("%-4s %6s %6s %6s %6s %6s %9s %10s %5s %5s %5s %5s %9s\n",
+         "cfg", "speed", "offset", "blend", "win%", "draw%", "pts/m", "rally avg", "p50", "p90", "p99", "max", "steps/m");
+  int best = 0;
+  for(int c=0;c<grid.n;c++){
+    const Acc* a = &res[c]; const AiBlendParams* p = &grid.cfg[c];
+    double m = (double)a->matches;
+    printf("%-4d %6.1f %6.1f %6.0f %5.1f%% %5.1f%% %4.1f-%-4.1f %10.2f %5d %5d %5d %5ld %9.0f\n",
+           c, p->max_speed, p->offset_range, p->blend_dist,
+           100.0*(double)a->wins/m, 100.0*(double)a->draws/m,
+           (double)a->points_for/m, (double)a->points_against/m,
+           a->rallies ? (double)a->rally_sum/(double)a->rallies : 0.0,
+           rally_percentile(a, 50), rally_percentile(a, 90), rally_percentile(a, 99), a->rally_max,
+           (double)a->steps/m);
+    if(a->wins > res[best].wins) best = c;
+  }
+  long steps = 0; for(int c=0;c<grid.n;c++) steps += res[c].steps;
+  printf("best: cfg %d (speed %.1f, offset %.1f, blend %.0f) wins %.1f%%\n",
+         best, grid.cfg[best].max_speed, grid.cfg[best].offset_range, grid.cfg[best].blend_dist,
+         100.0*(double)res[best].wins/(double)res[best].matches);
+  printf("%ld matches in %.2f s: %.0f matches/s, %.1f M steps/s, %ld steals\n",
+         total, secs, (double)total/secs, (double)steps/secs/1e6, steals);
+
+  if(scale){
+    printf("\n%-8s %12s %8s %10s %8s\n", "threads", "matches/s", "speedup", "efficiency", "steals");
+    double base = 0.0;
+    for(int t=1;;t*=2){
+      if(t > threads) t = threads;
+      double s = run_pool(&grid, per_config, seed, t, res1, &steals);
+      double mps = (double)total/s;
+      if(t==1) base = mps;
+      printf("%-8d %12.0f %7.2fx %9.0f%% %8ld\n", t, mps, mps/base, 100.0*mps/base/(double)t, steals);
+      CHECK(acc_equal(res1, res, grid.n));
+      if(t==threads) break;
+    }
+    if(cpus > 0 && threads > cpus) printf("(only %ld CPUs online: threads beyond that share cores)\n", cpus);
+  }
+  return bench_status();
+}
@@ -0,0 +1,198 @@
+/* replay_play.c — headless replay player / checker
+ * Usage: replay_play [file.pongrep ...]
+ *        replay_play -w out.pongrep [seed]
+ * With files: replays each as fast as possible, checking every stored state
+ * hash, and reports steps/sec and speed vs real time (exit 1 if any file
+ * fails). Without: records a corpus of seeded bot matches, checks the
+ * encode/decode round trip and that tampered files are caught, then
+ * reports the same numbers for the corpus. -w writes one generated match.
+ */
+
+#include "bench_util.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "replay.h"
+#include "sim.h"
+
+#define MAX_STEPS (60*60*10)  /* generated matches stop after 10 minutes */
+
+/* --------------------------- Generated Matches --------------------------- */
+
+/* Follows the ball with a dead zone and the odd lapse, so inputs change
+ * often enough to exercise the run encoding. Once a rally gets fast it
+ * bails towards the nearer wall: a straight serve between two still
+ * paddles would otherwise never end. */
+static unsigned bot(const Game* g, int side, uint32_t* s, int* lapse){
+  unsigned up = side ? IN_P2_UP : IN_P1_UP, down = side ? IN_P2_DOWN : IN_P1_DOWN;
+  if(g->ball.speed > 12 + (int)(*s % 16u)) return g->bats[side].y < SIM_HEIGHT/2.0f ? up : down;
+  if(*lapse > 0){ (*lapse)--; return 0; }
+  if(bench_rng_next(s) % 400u == 0) *lapse = 20 + (int)(bench_rng_next(s) % 40u);
+  float d = g->ball.y - g->bats[side].y;
+  if(d >  12.0f) return down;
+  if(d < -12.0f) return up;
+  return 0;
+}
+
+/* Plays one match through the recorder; returns the serialised replay. */
+static size_t record_match(uint32_t seed, int players, uint8_t** out, Input* log, uint32_t* nlog){
+  static ReplayRecorder rec;
+  Game g; sim_init(&g, seed);
+  uint32_t bs = seed*2654435761u | 1u; int lapse[2] = { 0, 0 };
+  replay_rec_begin(&rec, &g, players, REPLAY_HASH_EVERY, 60);
+  uint32_t n = 0;
+  while(g.state==ST_PLAY && n<MAX_STEPS){
+    Input in; in.buttons = bot(&g, 0, &bs, &lapse[0]);
+    if(players==2) in.buttons |= bot(&g, 1, &bs, &lapse[1]);
+    sim_step(&g, &in, NULL);
+    replay_rec_step(&rec, &in, &g);
+    if(log) log[n] = in;
+    n++;
+  }
+  if(nlog) *nlog = n;
+  return replay_rec_finish(&rec, &g, out);
+}
+
+/* --------------------------------- Play --------------------------------- */
+typedef struct { double steps, ns; } Tally;
+
+static ReplayStatus play(const uint8_t* data, size_t len, int reps, Tally* t, uint32_t* bad){
+  Replay r; Game g;
+  ReplayStatus st = replay_parse(&r, data, len);
+  if(st != REPLAY_OK) return st;
+  uint64_t t0 = bench_now_ns();
+  for(int k=0;k<reps && st==REPLAY_OK;k++) st = replay_run(&r, &g, bad);
+  if(t){ t->ns += (double)(bench_now_ns() - t0); t->steps += (double)r.hdr.steps*(double)reps; }
+  return st;
+}
+
+static void report(const char* what, const Tally* t){
+  double sps = t->steps*1e9/t->ns;
+  printf("%s: %.0f steps in %.1f ms: %.2f M steps/s, %.0fx real time at 60 Hz\n",
+         what, t->steps, t->ns/1e6, sps/1e6, sps/60.0);
+}
+
+static int play_files(int n, char** paths){
+  int bad_files = 0; Tally all = { 0, 0 };
+  for(int i=0;i<n;i++){
+    FILE* fp = fopen(paths[i], "rb");
+    if(!fp){ fprintf(stderr, "%s: cannot open\n", paths[i]); bad_files++; continue; }
+    fseek(fp, 0, SEEK_END); long len = ftell(fp); fseek(fp, 0, SEEK_SET);
+    uint8_t* buf = (uint8_t*)malloc(len>0 ? (size_t)len : 1u);
+    size_t got = buf ? fread(buf, 1, (size_t)len, fp) : 0;
+    fclose(fp);
+    uint32_t bad = 0; Tally t = { 0, 0 };
+    ReplayStatus st = got==(size_t)len ? play(buf, got, 1, &t, &bad) : REPLAY_ERR_FORMAT;
+    if(st==REPLAY_OK){
+      printf("%s: ok, %.0f steps, %.2f ms\n", paths[i], t.steps, t.ns/1e6);
+      all.steps += t.steps; all.ns += t.ns;
+    } else { printf("%s: %s at step %u\n", paths[i], replay_status_name(st), bad); bad_files++; }
+    free(buf);
+  }
+  if(all.ns>0) report("total", &all);
+  return bad_files ? 1 : 0;
+}
+
+/* ------------------------------ Self Check ------------------------------ */
+static void check_roundtrip(uint32_t seed, int players, size_t* bytes, uint32_t* steps){
+  static Input log[MAX_STEPS];
+  uint8_t* buf; uint32_t n;
+  size_t len = record_match(seed, players, &buf, log, &n);
+  CHECK(len > 0);
+  if(!len) return;
+  Replay r; CHECK(replay_parse(&r, buf, len) == REPLAY_OK);
+  CHECK(r.hdr.steps == n && r.n_hash == n);
+
+  ReplayCursor c; Input in; uint32_t k = 0;
+  replay_cursor_init(&c, &r);
+  while(replay_cursor_next(&c, &in)){ if(k<n && in.buttons!=log[k].buttons) break; k++; }
+  CHECK(k == n);
+
+  Game g; uint32_t bad = 0;
+  CHECK(replay_run(&r, &g, &bad) == REPLAY_OK);
+  CHECK(g.state == (State)r.hdr.final_state);
+
+  /* different seed: the PRNG state is hashed, so step 1 already differs */
+  uint8_t* t = (uint8_t*)malloc(len);
+  memcpy(t, buf, len); t[8] ^= 1u;
+  CHECK(replay_parse(&r, t, len) == REPLAY_OK && replay_run(&r, &g, &bad) == REPLAY_ERR_DESYNC && bad == 1);
+  /* one step of input changed: caught at that step */
+  memcpy(t, buf, len);
+  uint32_t pos = REPLAY_HEADER_BYTES + (uint32_t)(len - REPLAY_HEADER_BYTES - 4u*n)/2u;
+  t[pos] ^= IN_P1_UP | IN_P1_DOWN;
+  CHECK(replay_parse(&r, t, len) == REPLAY_OK && replay_run(&r, &g, &bad) != REPLAY_OK);
+  /* truncated */
+  CHECK(replay_parse(&r, buf, len-1) == REPLAY_ERR_FORMAT);
+  CHECK(replay_parse(&r, buf, REPLAY_HEADER_BYTES-1) == REPLAY_ERR_FORMAT);
+  free(t);
+
+  *bytes += len; *steps += n;
+  free(buf);
+}
+
+static void check_runs(void){
+  /* runs of 16+ steps take the varint path */
+  static const uint32_t runs[] = { 1, 15, 16, 17, 300, 70000, 2 };
+  ReplayRecorder rec; memset(&rec, 0, sizeof(rec));
+  Game g; sim_init(&g, 7u);
+  replay_rec_begin(&rec, &g, 2, 0, 60);
+  uint32_t total = 0;
+  for(size_t i=0;i<sizeof(runs)/sizeof(runs[0]);i++){
+    Input in; in.buttons = (unsigned)(i % 2 ? IN_P2_UP : IN_P1_DOWN);
+    for(uint32_t k=0;k<runs[i];k++) replay_rec_step(&rec, &in, &g);
+    total += runs[i];
+  }
+  uint8_t* buf; size_t len = replay_rec_finish(&rec, &g, &buf);
+  Replay r; CHECK(replay_parse(&r, buf, len) == REPLAY_OK && r.n_hash == 0 && r.hdr.steps == total);
+  CHECK(r.hdr.input_bytes == 1+1+2+2+3+4+1);
+  ReplayCursor c; Input in; uint32_t k = 0; size_t run = 0, in_run = 0; int ok = 1;
+  replay_cursor_init(&c, &r);
+  while(replay_cursor_next(&c, &in)){
+    unsigned want = (unsigned)(run % 2 ? IN_P2_UP : IN_P1_DOWN);
+    if(in.buttons != want) ok = 0;
+    k++;
+    if(++in_run == runs[run]){ run++; in_run = 0; }
+  }
+  CHECK(ok && k == total);
+  free(buf); replay_rec_free(&rec);
+}
+
+static int self_check(void){
+  enum { MATCHES = 24 };
+  size_t bytes = 0; uint32_t steps = 0;
+  check_runs();
+  for(int i=0;i<MATCHES;i++) check_roundtrip(0x51u + (uint32_t)i*977u, 1 + i%2, &bytes, &steps);
+  if(fails){ printf("checks: FAILED (%d)\n", fails); return 1; }
+  printf("checks: OK (round trip, varint runs, seed/input tamper, truncation)\n");
+  printf("corpus: %d matches, %u steps, %.3f bytes/step (%.3f without hashes)\n\n",
+         MATCHES, steps, (double)bytes/(double)steps,
+         (double)(bytes - 4u*(size_t)steps - (size_t)MATCHES*REPLAY_HEADER_BYTES)/(double)steps);
+
+  /* the corpus as a sim benchmark */
+  Tally t = { 0, 0 };
+  for(int i=0;i<MATCHES;i++){
+    uint8_t* buf; size_t len = record_match(0x51u + (uint32_t)i*977u, 1 + i%2, &buf, NULL, NULL);
+    if(play(buf, len, 20, &t, NULL) != REPLAY_OK) fails++;
+    free(buf);
+  }
+  report("replay", &t);
+  return bench_status();
+}
+
+int main(int argc, char** argv){
+  if(argc>1 && !strcmp(argv[1], "-w")){
+    if(argc<3){ fprintf(stderr, "usage: replay_play -w out.pongrep [seed]\n"); return 2; }
+    uint32_t seed = argc>3 ? (uint32_t)strtoul(argv[3], NULL, 0) : 1u;
+    uint8_t* buf; size_t len = record_match(seed ? seed : 1u, 1, &buf, NULL, NULL);
+    FILE* fp = fopen(argv[2], "wb");
+    int ok = fp && len && fwrite(buf, 1, len, fp)==len;
+    if(fp && fclose(fp)!=0) ok = 0;
+    free(buf);
+    if(!ok){ fprintf(stderr, "%s: write failed\n", argv[2]); return 1; }
+    printf("%s: %zu bytes\n", argv[2], len);
+    return 0;
+  }
+  if(argc>1) return play_files(argc-1, argv+1);
+  return self_check();
+}
@@ -0,0 +1,94 @@
+#ifndef AI_H
+#define AI_H
+
+#include <stdint.h>
+
+#include "sim.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Predictive paddle AI. The built-in AI (Bat.isAI, sim_ai_delta) steers
+ * towards a blend of screen centre and the ball's current y; this one works
+ * out where the ball will cross the paddle's face and goes there.
+ *
+ * Agents drive a paddle through Input bits like a player does, so the sim,
+ * the batch engine and replays are unchanged: a match against an agent is
+ * a 2P match whose second player's inputs happen to be computed. */
+
+/* ------------------------------- Predictor ------------------------------- */
+/* y of the ball centre when it reaches x = face_x, moving along (dx, dy)
+ * with the top/bottom wall reflections unfolded (mirror images of the
+ * court stacked vertically, folded back with one fmod). The caller makes
+ * sure the ball is heading towards face_x. */
+float ai_intercept_y(float x, float y, float dx, float dy, float face_x);
+
+/* Ball-centre x at contact with side's paddle face. */
+float ai_face_x(const Game* g, int side);
+
+/* Intercept for one paddle, cached until the ball's velocity changes (paddle
+ * hit, wall bounce) or it is served again. */
+typedef struct {
+  float dx, dy;     /* velocity the cache was computed for */
+  float y;          /* intercept, if `valid` */
+  int   valid;      /* ball heading for this paddle */
+  long  queries, recomputes;
+} AiPredictor;
+
+void ai_predictor_reset(AiPredictor* p);
+/* Returns 1 and sets *y if the ball is heading for `side`'s paddle. */
+int  ai_predict(AiPredictor* p, const Game* g, int side, float* y);
+
+/* --------------------------------- Tiers --------------------------------- */
+typedef enum { AI_TIER_EASY, AI_TIER_MEDIUM, AI_TIER_HARD, AI_TIER_EXPERT, AI_TIER_COUNT } AiTierId;
+
+typedef struct {
+  const char* name;
+  int   reaction_steps;  /* after a velocity change, keep the old plan this long */
+  float err_px;          /* aim error (gaussian sigma) at any distance ... */
+  float err_per_px;      /* ... plus this much per px of ball travel left */
+  float speed;           /* fraction of SIM_PLAYER_SPEED, 0..1 (moves on that share of steps) */
+} AiTier;
+
+extern const AiTier AI_TIERS[AI_TIER_COUNT];
+
+/* --------------------------------- Agent --------------------------------- */
+typedef struct {
+  AiTier      tier;
+  int         side;
+  AiPredictor pred;
+  uint32_t    rng;       /* error model only; separate from Game.rng */
+  float       target;    /* y the paddle is heading for */
+  int         wait;      /* steps until the pending plan is adopted */
+  int         pending;
+  float       move_acc;  /* speed cap accumulator */
+} AiAgent;
+
+void ai_agent_init(AiAgent* a, AiTierId tier, int side, uint32_t seed);
+/* IN_* bits for the agent's side this step (P1 or P2 bits). */
+unsigned ai_agent_buttons(AiAgent* a, const Game* g);
+
+/* ------------------------------ Tuned blend ------------------------------ */
+/* The built-in blend AI with its constants exposed, for parameter sweeps
+ * (pong_tournament). AI_BLEND_DEFAULT reproduces sim_ai_delta() exactly. */
+typedef struct {
+  float max_speed;     /* px/step cap (SIM_MAX_AI_SPEED) */
+  float offset_range;  /* aim offset drawn on each hit spans +-this (10) */
+  float blend_dist;    /* ball distance at which the AI sits at centre (SIM_WIDTH/2) */
+} AiBlendParams;
+
+extern const AiBlendParams AI_BLEND_DEFAULT;
+
+/* Paddle delta for `side`. Scales the game's own -10..10 ai_offset, so the
+ * offset sequence is the sim's and the default params are bit-identical. */
+float ai_blend_delta(const AiBlendParams* p, const Game* g, int side);
+/* Moves side's paddle; call before sim_step() with that bat's isAI off and
+ * its buttons up (the sim moves paddles before the ball, so it's the same). */
+void  ai_blend_move(const AiBlendParams* p, Game* g, int side);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AI_H */
@@ -0,0 +1,103 @@
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Packed asset archive (.pak). One file instead of a --preload-file bundle:
+ * a small header + index up front, then every entry on its own page, laid
+ * out in load order. The browser streams it with fetch() and decodes each
+ * entry the moment its last byte arrives, so the first SFX is playable
+ * after a few KB instead of after the whole bundle; natively the file is
+ * mmap'd and an entry's pages are only touched when it is decoded.
+ *
+ * Layout (little-endian):
+ *   0   "PAK1"
+ *   4   u16 version, u16 count
+ *   8   u32 index_bytes     entries + name table, right after the header
+ *   12  u32 data_offset     first entry, page aligned
+ *   16  u32 total           archive size in bytes
+ *   20  12 bytes reserved
+ *   32  count x { u32 hash, u32 offset, u32 size, u8 codec, u8 flags,
+ *                 u16 name }  (name: offset into the name table)
+ *   ..  name table, NUL-terminated paths ("sounds/hit0.ogg")
+ * Entry offsets are page aligned and increase in index order. */
+
+#define ASSET_MAGIC        0x314B4150u   /* "PAK1" */
+#define ASSET_VERSION      1
+#define ASSET_PAGE         4096u
+#define ASSET_HEADER_BYTES 32u
+#define ASSET_ENTRY_BYTES  16u
+
+typedef enum { ASSET_CODEC_RAW = 0, ASSET_CODEC_WAV, ASSET_CODEC_OGG } AssetCodec;
+
+/* Not needed to start playing (music): packed last and loaded in the
+ * background. The page still decodes it whole (decodeAudioData) once its
+ * last byte has arrived; nothing plays it while it downloads. */
+#define ASSET_FLAG_STREAM 1u
+
+typedef struct {
+  uint32_t    hash, offset, size;
+  uint8_t     codec, flags;
+  const char* name;
+} AssetEntry;
+
+/* ---------------------------------- Reader ------------------------------- */
+/* A view over archive bytes that may still be arriving: `ready` counts the
+ * leading entries that are complete. Nothing is copied. */
+typedef struct {
+  const uint8_t* data;
+  uint32_t total;         /* from the header */
+  uint32_t count;
+  uint32_t ready;
+} AssetPack;
+
+/* FNV-1a of the entry path. */
+uint32_t asset_hash(const char* name);
+/* Parse the header + index from the first `have` bytes. Returns 1 when
+ * open, 0 if more bytes are needed first, -1 if the archive is malformed. */
+int asset_pack_open(AssetPack* p, const uint8_t* data, size_t have);
+/* `have` bytes are now valid; returns the number of complete entries. */
+uint32_t asset_pack_received(AssetPack* p, size_t have);
+void asset_pack_entry(const AssetPack* p, uint32_t i, AssetEntry* e);
+/* Index of `name`, or -1. */
+int  asset_pack_find(const AssetPack* p, const char* name);
+/* Entry bytes, or NULL while they haven't all arrived. */
+const uint8_t* asset_pack_data(const AssetPack* p, uint32_t i, uint32_t* size);
+
+/* ---------------------------------- Writer ------------------------------- */
+typedef struct {
+  const char* name;
+  const void* data;
+  uint32_t    size;
+  uint8_t     codec, flags;
+} AssetSrc;
+
+AssetCodec asset_codec_for(const char* name);
+/* Put sources in the order the game first needs them (menu blips, hits,
+ * bounces, goal, anything else, then music) and flag music for streaming. */
+void asset_plan(AssetSrc* src, int n);
+/* Archive of src[0..n) in the given order, malloc'd; NULL on failure. */
+uint8_t* asset_pack_build(const AssetSrc* src, int n, size_t* size);
+
+/* ------------------------------- Native file ----------------------------- */
+/* mmap where available, else read into memory. */
+typedef struct {
+  AssetPack pack;
+  void*     base;
+  size_t    size;
+  int       mapped;
+} AssetFile;
+
+int  asset_file_open(AssetFile* f, const char* path);
+void asset_file_close(AssetFile* f);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ASSET_PACK_H */
@@ -0,0 +1,109 @@
+#ifndef AUDIO_MIXER_H
+#define AUDIO_MIXER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "audio_queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Software SFX mixer. Every sound is decoded once at load into one
+ * contiguous mono float arena (MixBank); a fixed pool of voices plays
+ * slices of it, and mixer_render() sums the live voices into a float
+ * buffer with 4-wide SIMD (SSE / wasm simd128, scalar fallback). In the
+ * browser the mixer fills a PCM ring (MixRing) that an AudioWorklet reads
+ * straight out of shared wasm memory; natively the same code is benchmarked
+ * and compared against reference PCM (bench_mixer). */
+
+/* ---------------------------------- Bank --------------------------------- */
+#define MIX_MAX_VARIANTS 8
+
+typedef struct { uint32_t offset, frames; } MixClip;
+
+typedef struct {
+  float*   pcm;           /* every clip back to back, mono, mixer rate */
+  uint32_t cap, used;     /* frames */
+  MixClip  clip[SFX_COUNT][MIX_MAX_VARIANTS];
+  uint8_t  variants[SFX_COUNT];
+} MixBank;
+
+/* One allocation of `frames` samples. Returns 0 on failure. */
+int    mix_bank_init(MixBank* b, uint32_t frames);
+void   mix_bank_free(MixBank* b);
+/* Reserve the next `frames` of the arena as variant `v` of `s` and return
+ * where the decoded samples go (NULL if it doesn't fit). */
+float* mix_bank_add(MixBank* b, Sfx s, int v, uint32_t frames);
+
+/* --------------------------------- Voices -------------------------------- */
+#define MIX_VOICES  24
+#define MIX_QUANTUM 128   /* AudioWorklet render quantum, frames */
+
+typedef struct {
+  const float* src;       /* NULL = free */
+  uint32_t pos, len;
+  float    gain;
+  uint8_t  sfx;           /* priority: lower Sfx value wins (audio_queue.h) */
+  uint32_t start;         /* play order, for oldest-first stealing */
+} MixVoice;
+
+typedef struct {
+  const MixBank* bank;
+  int      rate;          /* Hz, the bank's sample rate */
+  float    master;
+  MixVoice voice[MIX_VOICES];
+  uint32_t clock, rng;
+  /* totals since init */
+  uint32_t started, stolen, dropped;
+} Mixer;
+
+void mixer_init(Mixer* m, const MixBank* b, int rate);
+/* Start variant `v` of `s` (v < 0: a random one). With every voice busy it
+ * steals the oldest voice of the lowest priority, unless all of them
+ * outrank `s`, in which case the sound is dropped. Returns the voice or -1. */
+int  mixer_play(Mixer* m, Sfx s, int v, float gain);
+/* Consume an AudioQueue ring (the per-frame SFX batch): `layers` voices of
+ * random variants per entry, as the WebAudio path plays them. */
+void mixer_drain(Mixer* m, AudioRing* r);
+/* Overwrite out[0..frames) with the mix, clamped to -1..1. */
+void mixer_render(Mixer* m, float* out, int frames);
+int  mixer_active(const Mixer* m);
+/* SIMD lanes mixer_render() was compiled for (1 = scalar). */
+int  mixer_width(void);
+
+/* ----------------------------------- Ring -------------------------------- */
+#define MIX_RING_FRAMES 4096u  /* power of two, multiple of MIX_QUANTUM */
+
+/* Single producer (the game thread, mix_ring_fill) / single consumer (the
+ * AudioWorklet, or mix_ring_pull natively). JS reads the layout directly:
+ * keep the four uint32 words first and the samples right after them. */
+typedef struct {
+  uint32_t head;          /* frames written; producer only */
+  uint32_t tail;          /* frames read; consumer only */
+  uint32_t mask;          /* MIX_RING_FRAMES - 1 */
+  uint32_t underruns;     /* quanta the consumer found short; consumer only */
+  float    pcm[MIX_RING_FRAMES];
+} MixRing;
+
+void mix_ring_init(MixRing* r);
+/* Render whole quanta until `target` frames are buffered. Returns quanta. */
+int  mix_ring_fill(MixRing* r, Mixer* m, uint32_t target);
+/* Copy up to `frames` out; the rest of out is zeroed and counts as an
+ * underrun. Returns frames copied. */
+int  mix_ring_pull(MixRing* r, float* out, int frames);
+
+/* ---------------------------------- WAV ---------------------------------- */
+/* Mono 32-bit float WAV, for reference PCM / goldens. */
+int mix_write_wav(const char* path, const float* pcm, uint32_t frames, int rate);
+/* Reads mono float32 or PCM16 WAV into a malloc'd buffer. */
+int mix_read_wav(const char* path, float** pcm, uint32_t* frames, int* rate);
+/* Same, from a WAV file already in memory (e.g. an asset archive entry). */
+int mix_parse_wav(const uint8_t* data, size_t len, float** pcm, uint32_t* frames, int* rate);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUDIO_MIXER_H */
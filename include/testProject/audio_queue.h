@@ -0,0 +1,87 @@
+#ifndef AUDIO_QUEUE_H
+#define AUDIO_QUEUE_H
+
+#include <stdint.h>
+
+#include "sim.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Per-frame batched SFX. Gameplay code asks for sounds by enum while the
+ * frame runs; audio_queue_flush() merges repeats of the same sound, trims
+ * the frame to a voice budget and writes what's left into a ring in linear
+ * memory. The browser drains that ring with one JS call per frame (none on
+ * quiet frames) instead of one UTF8ToString'd call per sound. */
+
+/* --------------------------------- Sounds -------------------------------- */
+/* Declaration order is priority order when the voice budget runs out. */
+typedef enum {
+  SFX_SCORE_GOAL = 0,
+  SFX_HIT_SLOW,
+  SFX_HIT_MEDIUM,
+  SFX_HIT_FAST,
+  SFX_HIT_VERYFAST,
+  SFX_HIT,          /* hit0..hit4 */
+  SFX_BOUNCE_SYNTH,
+  SFX_BOUNCE,       /* bounce0..bounce4 */
+  SFX_UP,
+  SFX_DOWN,
+  SFX_COUNT
+} Sfx;
+
+/* File stem under /sounds and number of numbered variants (1: stem0.ogg or
+ * stem.ogg). Indexed by Sfx. */
+extern const char* const AUDIO_SFX_NAME[SFX_COUNT];
+extern const uint8_t     AUDIO_SFX_VARIANTS[SFX_COUNT];
+
+/* ---------------------------------- Ring --------------------------------- */
+#define AUDIO_RING_CAP 64u  /* power of two */
+
+/* Single producer (C, end of frame) / single consumer (JS drain, or
+ * audio_ring_pop natively). Layout is read directly from JS: keep the
+ * uint32 header first and the uint16 slots right after it. */
+typedef struct {
+  uint32_t head;      /* next slot to write; producer only */
+  uint32_t tail;      /* next slot to read; consumer only */
+  uint32_t mask;      /* AUDIO_RING_CAP - 1 */
+  uint32_t dropped;   /* entries lost to a full ring */
+  uint16_t slot[AUDIO_RING_CAP];  /* sound | layers<<8 */
+} AudioRing;
+
+static inline uint32_t audio_ring_count(const AudioRing* r){ return r->head - r->tail; }
+
+/* 0 when empty. */
+int audio_ring_pop(AudioRing* r, Sfx* sound, int* layers);
+
+/* --------------------------------- Queue --------------------------------- */
+#define AUDIO_MAX_LAYERS       8
+#define AUDIO_VOICES_PER_FRAME 12  /* a hit and a bounce (6 each) in one frame */
+
+typedef struct {
+  AudioRing ring;
+  uint8_t frame[SFX_COUNT];  /* layers requested this frame; 0 = none */
+  int voice_budget;
+  /* totals since init */
+  uint32_t requests;   /* audio_play() calls */
+  uint32_t merged;     /* requests folded into another of the same sound */
+  uint32_t limited;    /* layers cut by the voice budget */
+} AudioQueue;
+
+void audio_queue_init(AudioQueue* q, int voice_budget);
+/* Request `layers` simultaneous variants of `s` this frame. Repeats of the
+ * same sound keep the larger layer count. */
+void audio_play(AudioQueue* q, Sfx s, int layers);
+/* SFX for one step's sim events (hit tiers by post-hit speed, bounces,
+ * goals), matching the original per-event mapping. */
+void audio_play_events(AudioQueue* q, const Events* ev);
+/* End of frame: highest-priority sounds first until the voice budget is
+ * spent, one ring entry per sound. Returns entries written. */
+int  audio_queue_flush(AudioQueue* q);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUDIO_QUEUE_H */
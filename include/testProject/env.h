@@ -0,0 +1,85 @@
+#ifndef ENV_H
+#define ENV_H
+
+#include <stdint.h>
+
+#include "sim_batch.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Vectorized training environment: N 1P games (agent = left paddle, the
+ * built-in AI on the right) stepped together on the SoA batch engine.
+ * Observations, rewards and done flags go straight into caller-owned
+ * contiguous float arrays bound once with pong_env_bind(), so a NumPy
+ * binding hands over its arrays' memory and never copies (python/pong_env.py).
+ *
+ * A game that ends (SIM_WIN_SCORE reached, or max_steps) reports done = 1
+ * and is reset in place: its observation row already shows the next game,
+ * seeded from the finished game's PRNG. done covers both; a lane cut off by
+ * max_steps (terminal state not reached, bootstrap from it) is also flagged
+ * in the optional truncated array, see pong_env_bind_truncated().
+ *
+ * Physics: SimBatch only has the microstep ball solver, while the game
+ * (sim_step()) defaults to SIM_SOLVER_SWEPT. The two find the same
+ * contacts with the same response, but positions differ by float
+ * rounding, so trajectories drift apart over long rallies: a policy
+ * trained here plays slightly different (not different-rule) physics
+ * from the browser build. bench_env's reference runs sim_step() with
+ * SIM_SOLVER_MICROSTEP for exactly that reason. */
+
+#define ENV_OBS_DIM 8
+/* Observation row, all roughly in -1..1:
+ *   0 ball x      (0..SIM_WIDTH  -> -1..1)
+ *   1 ball y      (0..SIM_HEIGHT -> -1..1)
+ *   2 ball dx     (unit velocity)
+ *   3 ball dy
+ *   4 ball speed  (microsteps/step / ENV_SPEED_SCALE)
+ *   5 agent paddle y
+ *   6 opponent paddle y
+ *   7 score difference / SIM_WIN_SCORE */
+#define ENV_SPEED_SCALE 16.0f
+
+/* Actions (int32 per game). */
+enum { ENV_ACT_STAY = 0, ENV_ACT_UP = 1, ENV_ACT_DOWN = 2 };
+
+typedef struct {
+  int      n;
+  int      max_steps;      /* truncate longer games; 0 = never */
+  SimBatch b;
+  Input*   in;             /* n, from the actions */
+  int*     score[2];       /* n, scores after the previous step */
+  int*     steps;          /* n, steps into the current game */
+  float*   obs;            /* n*ENV_OBS_DIM, caller-owned */
+  float*   reward;         /* n: +1 agent scored, -1 conceded, else 0 */
+  float*   done;           /* n: 1 if the game ended this step */
+  float*   truncated;      /* n or NULL: 1 if it ended by max_steps */
+  long     episodes;       /* finished games, all lanes */
+} PongEnv;
+
+/* NULL on allocation failure or n < 1. Buffers must be bound before reset. */
+PongEnv* pong_env_create(int n, int max_steps);
+void     pong_env_destroy(PongEnv* e);
+
+/* obs: n*ENV_OBS_DIM floats, reward/done: n floats each. */
+void pong_env_bind(PongEnv* e, float* obs, float* reward, float* done);
+/* Optional, n floats: which done lanes were truncated rather than finished
+ * (NULL to stop reporting it). */
+void pong_env_bind_truncated(PongEnv* e, float* truncated);
+
+/* New game on every lane; seeds[i] (NULL: i+1). Writes obs, zeroes reward/done. */
+void pong_env_reset(PongEnv* e, const uint32_t* seeds);
+
+/* One step for every lane; actions: n ENV_ACT_* values. */
+void pong_env_step(PongEnv* e, const int32_t* actions);
+
+/* Accessors for bindings that don't mirror the struct. */
+int  pong_env_obs_dim(void);
+long pong_env_episodes(const PongEnv* e);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ENV_H */
@@ -0,0 +1,113 @@
+#ifndef GFX_H
+#define GFX_H
+
+#include <stdint.h>
+
+#include "shapes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Recorded frame: render() no longer talks to GL. It fills a GfxFrame with
+ * a compact list of state/draw commands plus the instance data they
+ * reference; a backend replays it. Backends: GLES (browser), null
+ * (counters only) and a CPU software rasterizer (RGBA8, golden images). */
+
+/* ------------------------------- Commands ------------------------------- */
+typedef enum {
+  GFX_CMD_CLEAR = 1,       /* u.color */
+  GFX_CMD_SET_PIPELINE,    /* u.pipeline */
+  GFX_CMD_SET_RESOLUTION,  /* u.res */
+  GFX_CMD_DRAW_SHAPES      /* u.draw: range in GfxFrame.inst */
+} GfxCmdType;
+
+typedef enum { GFX_PIPE_SHAPES = 1 } GfxPipeline;
+
+typedef struct {
+  uint32_t type;
+  union {
+    float color[4];
+    uint32_t pipeline;
+    struct { float w, h; } res;
+    struct { uint32_t first, count; } draw;
+  } u;
+} GfxCmd;  /* 20 bytes */
+
+#define GFX_MAX_CMDS      32
+#define GFX_MAX_INSTANCES 4096   /* playfield + particles + HUD + graph */
+
+typedef struct {
+  GfxCmd cmds[GFX_MAX_CMDS];         int nCmds;
+  ShapeInstance inst[GFX_MAX_INSTANCES]; int nInst;
+  int overflow;                      /* commands/instances dropped */
+} GfxFrame;
+
+void gfx_frame_begin(GfxFrame* f);
+void gfx_clear(GfxFrame* f, const float color[4]);
+void gfx_set_pipeline(GfxFrame* f, GfxPipeline p);
+void gfx_set_resolution(GfxFrame* f, float w, float h);
+/* Copies `n` instances into the frame and records one instanced draw. */
+void gfx_draw_shapes(GfxFrame* f, const ShapeInstance* s, int n);
+/* Zero-copy variant: write up to *cap instances at the returned pointer,
+ * then gfx_shapes_commit() the number actually written. */
+ShapeInstance* gfx_shapes_reserve(GfxFrame* f, int* cap);
+void gfx_shapes_commit(GfxFrame* f, int n);
+
+/* ------------------------------- Counters ------------------------------- */
+typedef struct {
+  int draw_calls;
+  int state_changes;    /* pipeline/VAO binds and clear-colour changes */
+  int uniform_uploads;
+  int vertices;         /* vertices submitted (6 per instance) */
+  int instances;
+  int bytes_uploaded;   /* instance data */
+} GfxStats;
+
+/* Redundant-state filter shared by the backends so their counts agree:
+ * a SET_* equal to the current value is not a state change. */
+typedef struct { uint32_t pipeline; float res_w, res_h; float clear[4]; } GfxStateCache;
+
+/* ------------------------------- Backends ------------------------------- */
+typedef struct GfxBackend GfxBackend;
+struct GfxBackend {
+  const char* name;
+  void (*submit)(GfxBackend* self, const GfxFrame* f);
+  GfxStats stats;       /* counts for the last submitted frame */
+  GfxStateCache cache;  /* persists across frames, like real GL state */
+};
+
+static inline void gfx_submit(GfxBackend* b, const GfxFrame* f){ b->submit(b, f); }
+
+/* Null backend: replays for the counters only. */
+void gfx_null_init(GfxBackend* b);
+
+/* GLES3/WebGL2 backend (gfx_gles.c, browser build only). Needs a current
+ * context; returns 0 if the shape program fails to build. */
+int  gfx_gles_init(GfxBackend* b);
+
+/* Software rasterizer: same signed-distance coverage as the GLES shader,
+ * straight-alpha "over" blending into an RGBA8 image. */
+typedef struct {
+  GfxBackend base;
+  int w, h;
+  uint8_t* rgba;   /* w*h*4, row 0 at the top */
+} GfxSoft;
+
+int  gfx_soft_init(GfxSoft* s, int w, int h);  /* 0 on allocation failure */
+void gfx_soft_free(GfxSoft* s);
+/* PAM (P7, RGB_ALPHA) so golden images keep their alpha. 0 on I/O error. */
+int  gfx_soft_write_pam(const GfxSoft* s, const char* path);
+int  gfx_soft_read_pam(const char* path, int* w, int* h, uint8_t** rgba);
+
+/* ----------------------------- Shared helpers ---------------------------- */
+/* Apply a CLEAR/SET_* command to the cache; returns 1 when the value
+ * differs from the current one (i.e. the backend must touch the device). */
+int gfx_state_apply(GfxStateCache* cache, const GfxCmd* c);
+void gfx_state_reset(GfxStateCache* cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GFX_H */
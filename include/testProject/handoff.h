@@ -0,0 +1,72 @@
+#ifndef HANDOFF_H
+#define HANDOFF_H
+
+#include <stdint.h>
+
+#include "sim.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Sim thread -> render thread handoff, lock-free and wait-free on both
+ * sides. Platform-free: the threads themselves live in sim_thread.h.
+ *
+ * TripleBuf passes whole snapshots: the writer fills its back slot and
+ * publishes it, the reader takes the latest published one. Of the three
+ * caller-provided slots one is the writer's, one the reader's and one sits
+ * in the middle holding the newest published snapshot; publish and take
+ * each swap their slot with the middle one in a single atomic exchange, so
+ * neither ever waits, the writer never touches a slot the reader holds (no
+ * torn reads) and intermediate snapshots the reader was too slow for are
+ * simply overwritten.
+ *
+ * EventRing carries what must not be overwritten (sim events, menu
+ * actions): an SPSC ring like InputRing, in the other direction. */
+
+/* ------------------------------ Triple buffer ---------------------------- */
+#define TRIPLE_FRESH 4   /* in `mid`: published, not yet taken */
+
+typedef struct {
+  void*    slot[3];
+  int      mid;         /* shared: slot index | TRIPLE_FRESH */
+  int      back;        /* writer only */
+  int      front;       /* reader only */
+  int      has_front;   /* reader only: front holds a published snapshot */
+  uint32_t published;   /* writer only */
+  uint32_t taken;       /* reader only: fresh takes */
+} TripleBuf;
+
+void        triple_init(TripleBuf* t, void* a, void* b, void* c);
+/* Writer: the slot to fill; the reader cannot see it until published. */
+void*       triple_back(TripleBuf* t);
+/* Writer: make the back slot the latest snapshot and get a free one back. */
+void        triple_publish(TripleBuf* t);
+/* Reader: the latest published snapshot, valid until the next take; the
+ * same one again if nothing new was published, NULL before the first.
+ * `fresh` (may be NULL) is 1 when it is new since the previous take. */
+const void* triple_take(TripleBuf* t, int* fresh);
+
+/* ------------------------------- Event ring ------------------------------ */
+#define EVENT_RING_CAP 1024u  /* power of two */
+
+typedef struct {
+  uint32_t head, tail;
+  uint32_t dropped;   /* producer side: events lost to a full ring */
+  Event    ev[EVENT_RING_CAP];
+} EventRing;
+
+void event_ring_init(EventRing* r);
+/* Producer. Returns 0 (and counts a drop) when the ring is full. */
+int  event_ring_push(EventRing* r, const Event* e);
+/* Consumer. Returns 0 when empty. */
+int  event_ring_pop(EventRing* r, Event* e);
+/* Either side: events waiting; an upper bound for the producer, a lower
+ * bound for the consumer. */
+uint32_t event_ring_count(const EventRing* r);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HANDOFF_H */
@@ -0,0 +1,75 @@
+#ifndef HUD_H
+#define HUD_H
+
+#include <stdint.h>
+
+#include "shapes.h"
+#include "sim.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* HUD state block. Setters only mark a field dirty when its value actually
+ * changes; the frontend takes the dirty mask once per frame and either
+ * pushes just those fields to the DOM overlay (one JS call, none when
+ * clean) or draws the whole HUD into the canvas with hud_build(). */
+
+#define HUD_TEXT_MAX 64
+
+enum {
+  HUD_DIRTY_TITLE  = 1u<<0,
+  HUD_DIRTY_MODE   = 1u<<1,
+  HUD_DIRTY_SCORE  = 1u<<2,
+  HUD_DIRTY_COLORS = 1u<<3,
+  HUD_DIRTY_MSG    = 1u<<4,
+  HUD_DIRTY_ALL    = 0x1Fu
+};
+
+/* Read field-by-field from JS: keep the int32 block first, text last. */
+typedef struct {
+  uint32_t dirty;
+  int32_t  score[2];
+  int32_t  players;         /* 1 or 2 */
+  uint32_t score_rgb[2];    /* 0xRRGGBB tint of each score */
+  char     title[HUD_TEXT_MAX];
+  char     msg[HUD_TEXT_MAX];  /* UTF-8 */
+} Hud;
+
+void hud_init(Hud* h);  /* everything blank and dirty */
+void hud_set_title(Hud* h, const char* s);
+void hud_set_msg(Hud* h, const char* s);
+void hud_set_players(Hud* h, int n);
+void hud_set_score(Hud* h, int left, int right);
+void hud_set_score_colors(Hud* h, const float left[4], const float right[4]);
+/* Scores + goal tint (scorer's colour while the ball is out) from `g`. */
+void hud_sync_game(Hud* h, const Game* g);
+/* Dirty mask since the last call; clears it. */
+uint32_t hud_take_dirty(Hud* h);
+
+/* ------------------------------ Canvas HUD ------------------------------- */
+/* Baked 5x7 bitmap font, ASCII 32..126. Non-ASCII UTF-8 sequences draw as
+ * '-' (the prompts use an em dash). The atlas is 16x6 cells of 6x8 px,
+ * one byte per texel (0 or 255), row 0 at the top. */
+#define HUD_FONT_W   5
+#define HUD_FONT_H   7
+#define HUD_CELL_W   6
+#define HUD_CELL_H   8
+#define HUD_ATLAS_W  (16*HUD_CELL_W)
+#define HUD_ATLAS_H  (6*HUD_CELL_H)
+
+int  hud_font_bit(int c, int x, int y);  /* 1 if pixel (x,y) of glyph c is set */
+void hud_font_atlas(uint8_t out[HUD_ATLAS_W*HUD_ATLAS_H]);
+
+/* Upper bound of instances hud_build() writes. */
+#define HUD_SHAPES_MAX (2*HUD_TEXT_MAX + 16)  /* title + msg + mode/score row */
+
+/* Title, mode, score box and message as SHAPE_GLYPH instances (plus the
+ * score backdrop), laid out like the DOM overlay. Returns count. */
+int hud_build(const Hud* h, ShapeInstance* out, int cap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HUD_H */
@@ -0,0 +1,101 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stdint.h>
+
+#include "sim.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Keyboard -> sim input. The key callback maps the DOM keyCode through a
+ * table to an action mask and pushes a timestamped event into an SPSC
+ * ring; each sim step consumes the events up to its own time, so presses
+ * shorter than a frame still reach the step they fell in. Consumed events
+ * are timed again when the frame that shows their effect is submitted,
+ * giving a key-to-submit latency histogram. */
+
+/* -------------------------------- Actions -------------------------------- */
+/* Bits 0..3 are the sim's IN_* buttons; the rest are frontend-only. */
+enum {
+  ACT_MENU_UP   = 1u<<4,  /* select 1P */
+  ACT_MENU_DOWN = 1u<<5,  /* select 2P */
+  ACT_START     = 1u<<6   /* start / back to menu */
+};
+#define INPUT_SIM_MASK (IN_P1_UP|IN_P1_DOWN|IN_P2_UP|IN_P2_DOWN)
+
+#define INPUT_KEYS 256  /* DOM keyCode range */
+
+typedef struct { uint32_t action[INPUT_KEYS]; } InputKeyMap;
+
+/* Original bindings: A/Z or arrows for P1, K/M for P2, arrows pick the
+ * mode in the menu, Space starts. */
+void input_keymap_default(InputKeyMap* m);
+void input_keymap_bind(InputKeyMap* m, unsigned keyCode, uint32_t actions);
+
+/* --------------------------------- Ring ---------------------------------- */
+typedef struct {
+  double   t_ms;      /* event time, same clock as the sim clock */
+  uint32_t actions;   /* from the key map at push time */
+  uint16_t key;       /* keyCode */
+  uint8_t  down;
+  uint8_t  pad_;
+} InputEvent;
+
+#define INPUT_RING_CAP 256u  /* power of two */
+
+/* Lock-free single producer (key callback) / single consumer (sim). */
+typedef struct {
+  uint32_t head, tail;
+  uint32_t dropped;   /* producer side: events lost to a full ring */
+  InputEvent ev[INPUT_RING_CAP];
+} InputRing;
+
+void input_ring_init(InputRing* r);
+/* Map + push one key transition. Returns 0 for unmapped keys (let the
+ * browser keep them) and 1 otherwise, even if the ring was full. */
+int  input_key_event(InputRing* r, const InputKeyMap* m, unsigned keyCode, int down, double t_ms);
+
+/* ------------------------------- Latency -------------------------------- */
+#define INPUT_LAT_BUCKET_MS 0.25
+#define INPUT_LAT_BUCKETS   256   /* 0..64 ms; the last bucket is overflow */
+
+typedef struct {
+  uint32_t bucket[INPUT_LAT_BUCKETS];
+  uint32_t count;
+  double   sum_ms, max_ms;
+} InputLatency;
+
+void   input_latency_reset(InputLatency* h);
+void   input_latency_add(InputLatency* h, double ms);
+/* Upper edge of the bucket holding percentile p (0..100), capped at the
+ * max seen; 0 when empty. */
+double input_latency_percentile(const InputLatency* h, double p);
+double input_latency_mean(const InputLatency* h);
+
+/* -------------------------------- State ---------------------------------- */
+#define INPUT_MAX_PENDING 64
+
+typedef struct {
+  uint8_t  down[INPUT_KEYS];  /* keys currently held */
+  uint8_t  holders[32];       /* held keys per action bit */
+  uint32_t held;              /* action bits with holders */
+  double   pending[INPUT_MAX_PENDING];  /* consumed, awaiting frame submit */
+  int      nPending;
+  InputLatency latency;
+} InputState;
+
+void input_state_init(InputState* s);
+/* Consume events stamped <= until_ms. Returns the step's Input: actions
+ * held at the end plus any pressed during the step (a tap inside one step
+ * still counts). `pressed` (may be NULL) gets the press edges. */
+Input input_step(InputState* s, InputRing* r, double until_ms, uint32_t* pressed);
+/* The frame showing everything consumed so far was submitted at now_ms. */
+void input_frame_submitted(InputState* s, double now_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INPUT_H */
@@ -0,0 +1,128 @@
+#ifndef NETPLAY_H
+#define NETPLAY_H
+
+#include <stdint.h>
+
+#include "sim.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Rollback netplay for 2P (GGPO style). Each peer steps the shared match
+ * every frame with its own input and a prediction of the remote one
+ * (repeat the last confirmed input). When the real remote input arrives
+ * and differs, the peer restores the snapshot taken before that frame and
+ * re-simulates up to the present. Snapshots are plain Game copies in a
+ * preallocated ring; nothing is allocated while playing. Peers exchange
+ * state hashes of confirmed frames to detect desyncs.
+ *
+ * Both peers must start from the same Game (same seed, sim_new_game(g,2))
+ * and feed the same input delay. */
+
+#define NET_RING          64   /* frames of snapshots/inputs kept (power of two) */
+#define NET_MAX_ROLLBACK  16   /* predicted frames allowed before stalling */
+#define NET_MAX_SEND      32   /* inputs per packet (redundant, unacked) */
+#define NET_CHECK_EVERY   30   /* frames between desync checksums */
+#define NET_CHECKS        8    /* checksum history per side */
+#define NET_MAX_PACKET    (18 + NET_MAX_SEND/4)
+
+/* ------------------------------- Transport ------------------------------- */
+/* Unreliable, unordered datagrams; the session copes with loss/reordering
+ * by resending every unacknowledged input. */
+typedef struct NetTransport NetTransport;
+struct NetTransport {
+  const char* name;
+  void (*send)(NetTransport* self, const uint8_t* data, int len);
+  /* Next datagram into buf; returns its length, 0 when none is ready. */
+  int  (*recv)(NetTransport* self, uint8_t* buf, int cap);
+};
+
+/* In-process link between two endpoints with simulated one-way latency,
+ * uniform jitter (reorders packets) and random loss. Time only moves when
+ * net_loopback_set_time() is called, so runs are reproducible. */
+typedef struct {
+  double   latency_ms;   /* one way */
+  double   jitter_ms;    /* + U[0, jitter) per packet */
+  double   loss;         /* drop probability, 0..1 */
+  uint32_t seed;
+} NetLinkParams;
+
+#define NET_LOOP_QUEUE 512  /* in-flight packets per direction */
+
+typedef struct NetLoopback NetLoopback;
+typedef struct { NetTransport base; NetLoopback* link; int side; } NetLoopEnd;
+
+typedef struct {
+  double  deliver_ms;
+  int     len;
+  uint8_t data[NET_MAX_PACKET];
+} NetLoopPacket;
+
+struct NetLoopback {
+  NetLoopEnd    end[2];          /* end[i] sends to end[1-i] */
+  NetLinkParams p;
+  double        now_ms;
+  uint32_t      rng;
+  NetLoopPacket q[2][NET_LOOP_QUEUE];  /* q[i]: in flight towards end i */
+  int           n[2];
+  long          sent, dropped, overflow;
+};
+
+void net_loopback_init(NetLoopback* l, const NetLinkParams* p);
+void net_loopback_set_time(NetLoopback* l, double now_ms);
+
+/* -------------------------------- Session -------------------------------- */
+typedef struct {
+  long frames;          /* frames advanced */
+  long stalls;          /* advance calls that waited for the remote */
+  long rollbacks;
+  long resim_frames;    /* frames re-simulated by rollbacks */
+  int  max_depth;       /* deepest rollback, frames */
+  long packets_sent, packets_recv;
+  long checks;          /* checksums compared with the remote */
+  int32_t desync_frame; /* first mismatching checksum frame, -1 if none */
+} NetStats;
+
+typedef struct {
+  int side;             /* 0: left paddle (P1 bits), 1: right (P2 bits) */
+  int input_delay;      /* frames local input is held back, 0..8 */
+  int max_rollback;     /* 1..NET_MAX_ROLLBACK */
+} NetConfig;
+
+typedef struct {
+  NetConfig     cfg;
+  NetTransport* tr;
+  Game    g;             /* state at the start of `frame` */
+  int32_t frame;         /* next frame to simulate */
+  int32_t confirmed;     /* remote input known for every frame <= this */
+  int32_t remote_ack;    /* remote has our input for every frame <= this */
+  int32_t local_last;    /* last frame with a recorded local input */
+  int32_t rollback_from; /* earliest mispredicted frame (INT32_MAX: none) */
+
+  uint8_t local[NET_RING];         /* IN_P1_* style bits, per frame */
+  uint8_t remote[NET_RING];        /* confirmed or as predicted when used */
+  int32_t remote_frame[NET_RING];  /* frame remote[] holds a value for */
+  uint8_t remote_conf[NET_RING];
+  Game    snap[NET_RING];          /* state at the start of each frame */
+
+  int32_t check_last;              /* last checkpoint computed locally */
+  int32_t check_frame[NET_CHECKS]; uint32_t check_hash[NET_CHECKS];
+  int32_t peer_frame;  uint32_t peer_hash;   /* newest remote checksum not yet hashed here */
+  int32_t peer_checked;                      /* newest remote checksum compared */
+
+  NetStats stats;
+} NetSession;
+
+/* `g` is the agreed starting state (frame 0). Returns 0 on a bad config. */
+int  net_session_init(NetSession* s, const NetConfig* cfg, NetTransport* tr, const Game* g);
+/* One display frame: receive, roll back if needed, then simulate the next
+ * frame with `buttons` (IN_P1_UP/IN_P1_DOWN for whichever side is local).
+ * Returns 1 if a frame was simulated, 0 if stalled waiting for the remote. */
+int  net_advance(NetSession* s, unsigned buttons);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NETPLAY_H */
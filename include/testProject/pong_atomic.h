@@ -0,0 +1,25 @@
+#ifndef PONG_ATOMIC_H
+#define PONG_ATOMIC_H
+
+#include <stdint.h>
+
+/* Minimal acquire/release helpers for the lock-free SPSC structures and the
+ * triple buffer's exchange. The tree is C99, so these map to the GCC/Clang
+ * __atomic builtins (also what Emscripten's pthreads build uses). Without
+ * them, fall back to plain accesses, which is only enough for
+ * single-threaded use. */
+
+#if defined(__GNUC__) || defined(__clang__)
+#  define PONG_LOAD_ACQ(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#  define PONG_STORE_REL(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#  define PONG_LOAD_RLX(p)     __atomic_load_n((p), __ATOMIC_RELAXED)
+#  define PONG_XCHG(p, v)      __atomic_exchange_n((p), (v), __ATOMIC_ACQ_REL)
+#else
+#  define PONG_LOAD_ACQ(p)     (*(p))
+#  define PONG_STORE_REL(p, v) (*(p) = (v))
+#  define PONG_LOAD_RLX(p)     (*(p))
+#  define PONG_XCHG(p, v)      pong_xchg_int_((p), (v))   /* int only */
+static inline int pong_xchg_int_(int* p, int v){ int o = *p; *p = v; return o; }
+#endif
+
+#endif /* PONG_ATOMIC_H */
@@ -0,0 +1,132 @@
+#ifndef PROF_H
+#define PROF_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "shapes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Frame profiler. Timed zones and per-frame counters go into a ring of the
+ * last PROF_FRAMES frames; from there they come out as Chrome trace-event
+ * JSON (chrome://tracing, Perfetto) or as an on-canvas frame-time graph.
+ *
+ * Instrument through the macros: without -DPONG_PROFILE they expand to
+ * nothing (arguments are not evaluated), so a normal build carries no
+ * profiler code at the call sites.
+ *
+ *   PROF_FRAME_BEGIN();
+ *   PROF_ZONE(PZ_SIM){ ...steps... }     // no return/break/goto out of it
+ *   PROF_COUNT(PC_SIM_STEPS, steps);
+ *   PROF_FRAME_END();
+ *
+ * One profiler per process, driven from one thread. */
+
+/* --------------------------------- Names -------------------------------- */
+typedef enum {
+  PZ_FRAME = 0,   /* tick(): recorded by PROF_FRAME_BEGIN/END */
+  PZ_INPUT,
+  PZ_SIM,
+  PZ_AUDIO,       /* queue flush + JS drain / C mixer */
+  PZ_RENDER,
+  PZ_SCENE,       /* record the frame's commands */
+  PZ_SUBMIT,      /* replay them through the backend (GL calls) */
+  PZ_HUD,         /* DOM writes */
+  PZ_COUNT
+} ProfZone;
+
+typedef enum {
+  PC_SIM_STEPS = 0,
+  PC_MICROSTEPS,  /* ball.speed per step: the original solver's unit moves */
+  PC_EVENTS,
+  PC_PARTICLES,   /* live VFX particles after the frame's steps */
+  PC_SFX,         /* AudioRing entries flushed */
+  PC_JS_CALLS,    /* EM_JS crossings (GL calls are counted below) */
+  PC_DRAW_CALLS,
+  PC_GL_STATE,    /* state changes + uniform uploads */
+  PC_INSTANCES,
+  PC_COUNT
+} ProfCounter;
+
+extern const char* const PROF_ZONE_NAME[PZ_COUNT];
+extern const char* const PROF_COUNTER_NAME[PC_COUNT];
+
+/* --------------------------------- Ring --------------------------------- */
+#define PROF_FRAMES      240   /* ~4 s at 60 Hz */
+#define PROF_FRAME_ZONES 48    /* zones kept per frame; more are dropped */
+#define PROF_DEPTH       8
+
+typedef struct {
+  uint8_t  zone, depth;        /* depth 1 = directly inside the frame */
+  uint32_t start, dur;         /* ns from the frame's start */
+} ProfRec;
+
+typedef struct {
+  uint64_t t0;                 /* ns, prof_now_ns() */
+  uint32_t dur;                /* ns, begin to end */
+  uint16_t n, dropped;
+  int32_t  counter[PC_COUNT];
+  ProfRec  rec[PROF_FRAME_ZONES];
+} ProfFrame;
+
+typedef struct { double avg_ms, max_ms; uint32_t frames; } ProfStats;
+
+uint64_t prof_now_ns(void);
+/* Clear the ring; recording starts enabled. */
+void prof_reset(void);
+/* Runtime switch on top of the compile-time one (the graph toggle). */
+void prof_enable(int on);
+int  prof_enabled(void);
+
+void prof_frame_begin(void);
+void prof_frame_end(void);
+void prof_zone_begin(ProfZone z);
+void prof_zone_end(void);
+void prof_count(ProfCounter c, int n);
+
+/* Completed frames held (<= PROF_FRAMES) and the one `back` frames ago
+ * (0 = the last completed), or NULL. */
+int              prof_frame_count(void);
+const ProfFrame* prof_frame(int back);
+/* Per-frame time in zone `z` (summed if it ran several times) over the
+ * ring; PZ_FRAME gives the frame itself. */
+void prof_zone_stats(ProfZone z, ProfStats* s);
+
+/* Chrome trace JSON for the ring: one complete ("X") event per zone and a
+ * counter ("C") event per frame. Writes at most `cap` bytes (NUL included)
+ * and returns the full length, like snprintf. */
+size_t prof_trace_json(char* out, size_t cap);
+
+/* Frame-time graph in the box (x, y, w, h), y down: one column per recent
+ * frame, the frame-to-frame interval behind the stacked top-level zones,
+ * scaled so `full_ms` fills the box, plus a 60 Hz budget line. Returns
+ * instances written (at most PROF_GRAPH_MAX). */
+#define PROF_GRAPH_COLUMNS 120
+#define PROF_GRAPH_MAX     (PROF_GRAPH_COLUMNS*(PZ_COUNT) + 2)
+int prof_graph_build(ShapeInstance* out, int cap, float x, float y, float w, float h, float full_ms);
+
+/* ------------------------------- Macros --------------------------------- */
+#ifdef PONG_PROFILE
+#  define PROF_CAT_(a, b) a##b
+#  define PROF_CAT(a, b)  PROF_CAT_(a, b)
+#  define PROF_FRAME_BEGIN() prof_frame_begin()
+#  define PROF_FRAME_END()   prof_frame_end()
+#  define PROF_ZONE(z) \
+     for(int PROF_CAT(prof_z_, __LINE__) = (prof_zone_begin(z), 1); PROF_CAT(prof_z_, __LINE__); \
+         PROF_CAT(prof_z_, __LINE__) = (prof_zone_end(), 0))
+#  define PROF_COUNT(c, n)   prof_count((c), (n))
+#else
+#  define PROF_FRAME_BEGIN() ((void)0)
+#  define PROF_FRAME_END()   ((void)0)
+#  define PROF_ZONE(z)
+#  define PROF_COUNT(c, n)   ((void)0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PROF_H */
@@ -1,13 +1,17 @@
 #ifndef RENDER_H
 #define RENDER_H
 
+#include <stdint.h>
+
 #include <emscripten/emscripten.h>
 
+#include "asset_pack.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-// Called once at startup to set up GL state & circle vertex buffer
+// Called once at startup to set up GL state & the instanced shape buffers
 EMSCRIPTEN_KEEPALIVE
 int initWebGL(void);
 
@@ -15,6 +19,69 @@ int initWebGL(void);
 EMSCRIPTEN_KEEPALIVE
 void startMainLoop(void);
 
+// Sim tick rate (default SIM_TICK_HZ); the display rate no longer matters
+EMSCRIPTEN_KEEPALIVE
+void setSimHz(int hz);
+
+// Multiball from the next match: n balls (0..1000), 0 = normal game
+EMSCRIPTEN_KEEPALIVE
+void setPartyBalls(int n);
+
+// Key-to-frame-submit latency histogram (ms): percentile p in 0..100
+EMSCRIPTEN_KEEPALIVE
+double inputLatencyPercentile(double p);
+
+EMSCRIPTEN_KEEPALIVE
+int inputLatencyCount(void);
+
+EMSCRIPTEN_KEEPALIVE
+void inputLatencyReset(void);
+
+// Last finished match as a replay file (replay.h); 0/0 before the first
+EMSCRIPTEN_KEEPALIVE
+uint8_t* replayData(void);
+
+EMSCRIPTEN_KEEPALIVE
+int replaySize(void);
+
+// C mixer setup (called from the page's JS once SFX are decoded)
+EMSCRIPTEN_KEEPALIVE
+int audioMixerBegin(int rate, int frames);
+
+EMSCRIPTEN_KEEPALIVE
+float* audioMixerClip(int sfx, int variant, int frames);
+
+EMSCRIPTEN_KEEPALIVE
+void* audioMixerRing(void);   // MixRing (audio_mixer.h) the worklet reads
+
+EMSCRIPTEN_KEEPALIVE
+void audioMixerStart(void);
+
+// Asset archive download (asset_pack.h), driven by the page's JS
+EMSCRIPTEN_KEEPALIVE
+uint8_t* assetsAlloc(int total);
+
+EMSCRIPTEN_KEEPALIVE
+int assetsReceived(int have);  // complete entries; 0 = index not whole yet, -1 = malformed
+
+EMSCRIPTEN_KEEPALIVE
+const AssetEntry* assetsEntry(int i);
+
+// Profiler (prof.h): Chrome trace JSON of recent frames; frame-time overlay
+EMSCRIPTEN_KEEPALIVE
+const char* profTraceJson(void);
+
+EMSCRIPTEN_KEEPALIVE
+void profSetGraph(int on);
+
+// 1P opponent: 0 = built-in blend AI, 1..4 = easy/medium/hard/expert (ai.h)
+EMSCRIPTEN_KEEPALIVE
+void setAiTier(int tier);
+
+// 0: HUD in the DOM overlay (default), 1: drawn into the canvas
+EMSCRIPTEN_KEEPALIVE
+void setHudMode(int canvas);
+
 #ifdef __cplusplus
 }
 #endif
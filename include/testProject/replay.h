@@ -0,0 +1,108 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sim.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Deterministic match replays. A match is fully determined by the PRNG
+ * state at sim_new_game(), the player count, the solver and the Input fed
+ * to each sim_step(), so that is all a replay stores, plus state hashes to
+ * catch divergence at the step it happens.
+ *
+ * Layout (little-endian):
+ *   header    REPLAY_HEADER_BYTES, see ReplayHeader
+ *   inputs    input_bytes of run tokens: low nibble = buttons, high nibble
+ *             = run length - 1; 15 means 16 + a LEB128 varint follows
+ *   hashes    steps / hash_every u32s, sim_state_hash() after step
+ *             k*hash_every (k = 1, 2, ...)
+ */
+
+#define REPLAY_MAGIC        0x504C5250u  /* "PRLP" read as LE u32 */
+#define REPLAY_VERSION      1
+#define REPLAY_HEADER_BYTES 32
+#define REPLAY_HASH_EVERY   1   /* browser recordings: check every step */
+
+typedef struct {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t tick_hz;      /* informational: rate the match was played at */
+  uint32_t seed;         /* Game.rng at sim_new_game() */
+  uint8_t  numPlayers;
+  uint8_t  solver;       /* SIM_SOLVER_* */
+  uint16_t hash_every;   /* 0: no per-step hashes */
+  uint32_t steps;
+  uint32_t input_bytes;
+  uint32_t final_hash;   /* after the last step */
+  uint8_t  final_state;  /* State after the last step */
+} ReplayHeader;
+
+typedef enum {
+  REPLAY_OK = 0,
+  REPLAY_ERR_FORMAT = -1,  /* bad magic/version/sizes */
+  REPLAY_ERR_INPUT  = -2,  /* input runs don't add up to `steps` */
+  REPLAY_ERR_DESYNC = -3   /* a state hash differs */
+} ReplayStatus;
+
+const char* replay_status_name(ReplayStatus s);
+
+/* ------------------------------- Recorder ------------------------------- */
+typedef struct {
+  ReplayHeader hdr;
+  uint8_t*  in;   uint32_t in_len,   in_cap;
+  uint32_t* hash; uint32_t hash_len, hash_cap;
+  unsigned  run_buttons; uint32_t run_len;
+  int       failed;   /* allocation failure: the recording is unusable */
+} ReplayRecorder;
+
+/* Zero-initialised recorders are valid; buffers are reused across matches. */
+void replay_rec_free(ReplayRecorder* r);
+/* Starts a match on `g` (sim_new_game) and records it from there. */
+void replay_rec_begin(ReplayRecorder* r, Game* g, int numPlayers, int hash_every, int tick_hz);
+/* Call after each sim_step() with the Input it was given. */
+void replay_rec_step(ReplayRecorder* r, const Input* in, const Game* after);
+/* Serialises the recording into a malloc()ed buffer (caller frees).
+ * Returns its size, 0 on allocation failure. */
+size_t replay_rec_finish(ReplayRecorder* r, const Game* g, uint8_t** out);
+
+/* -------------------------------- Player -------------------------------- */
+typedef struct {
+  ReplayHeader   hdr;
+  const uint8_t* in;       /* input run tokens (points into the buffer) */
+  const uint8_t* hashes;   /* n_hash LE u32s */
+  uint32_t       n_hash;
+} Replay;
+
+/* Validates the header and sizes; `data` must outlive `r`. */
+ReplayStatus replay_parse(Replay* r, const uint8_t* data, size_t len);
+
+typedef struct {
+  const Replay* r;
+  uint32_t pos;       /* byte offset into r->in */
+  uint32_t left;      /* steps left in the current run */
+  unsigned buttons;
+} ReplayCursor;
+
+void replay_cursor_init(ReplayCursor* c, const Replay* r);
+/* Next step's Input; 0 when the stream is exhausted or malformed. */
+int  replay_cursor_next(ReplayCursor* c, Input* in);
+
+/* Sets `g` up as the recorded match started (sim_init + solver +
+ * sim_new_game). */
+void replay_start(const Replay* r, Game* g);
+
+/* Plays the whole match into `g`, checking every stored hash. On
+ * REPLAY_ERR_DESYNC/INPUT, *bad_step (may be NULL) is the 1-based step that
+ * failed. */
+ReplayStatus replay_run(const Replay* r, Game* g, uint32_t* bad_step);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* REPLAY_H */
@@ -0,0 +1,26 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include "gfx.h"
+#include "hud.h"
+#include "sim.h"
+#include "vfx.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Record the playfield for `g` into `f` (clear, shape pipeline, one
+ * instanced draw). Particles from `fx` (NULL for none) go into the same
+ * draw over the playfield; with a `hud`, its glyphs go on top of those;
+ * NULL when the DOM overlay shows the HUD. Shared by the browser render()
+ * and the native tools. */
+void scene_record(const Game* g, const Vfx* fx, const Hud* hud, GfxFrame* f);
+/* The same for a multiball party (sim_party.h). */
+void scene_record_party(const SimParty* p, const Vfx* fx, const Hud* hud, GfxFrame* f);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SCENE_H */
@@ -0,0 +1,133 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sim.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Authoritative match server (Linux: epoll, recvmmsg/sendmmsg).
+ *
+ * One UDP socket. The I/O thread (server_run) owns it for reading: an
+ * epoll loop that takes datagrams in batches, pairs JOINs into matches,
+ * stores each player's latest buttons, answers STATS and reclaims ended or
+ * silent matches. Matches live in a slab preallocated at start (no
+ * allocation after server_start); only the I/O thread hands slots out and
+ * takes them back.
+ *
+ * Worker threads run the fixed 60 Hz tick. Slot i belongs to worker
+ * i % workers, and each worker splits its tick into SRV_SUBTICKS phases,
+ * stepping one phase's matches per wake, so steps and sends are spread
+ * over the whole period instead of bursting at the top of it. A step is
+ * sim_step() with the match's buttons, then one STATE datagram per player
+ * (batched per wake with sendmmsg). Workers record how late each wake was
+ * and their own CPU time.
+ *
+ * Slot handoff without locks: the I/O thread fills a free slot and
+ * publishes it (live = SRV_RUNNING, release); its worker steps it until
+ * the match ends or the I/O thread asks it to stop, then sets SRV_ENDED
+ * (release) and never touches it again; the I/O thread frees it.
+ *
+ * Nothing goes to an address before it shows it can receive there: a JOIN
+ * or STATS_REQ without a valid cookie only gets SRV_COOKIE back, no larger
+ * than the request, and the client repeats the request with it. A cookie
+ * is a keyed hash (SipHash, secret drawn at start) of the source address,
+ * port and SRV_COOKIE_MS time bucket, so the server keeps no state for
+ * it. A JOIN from an address that already holds a running seat is a
+ * retransmit and is dropped, one source IP holds at most max_per_addr
+ * seats, and STATS replies go out at most once per SRV_STATS_MIN_MS. */
+
+/* --------------------------------- Wire ---------------------------------- */
+/* Every datagram: "PS", version, type, then the type's fields, little
+ * endian. Positions are the sim's floats, bit for bit. */
+#define SRV_VERSION  2
+#define SRV_MSG_MAX  64
+
+typedef enum {
+  SRV_JOIN = 1,   /* client: mode 1 = vs server AI, 2 = wait for an opponent; cookie */
+  SRV_INPUT,      /* client: match, side, buttons (IN_P1_* bits, any side) */
+  SRV_STATE,      /* server: one per tick per player */
+  SRV_LEAVE,      /* client: match, side */
+  SRV_STATS_REQ,  /* client: cookie */
+  SRV_STATS,      /* server: ServerStats */
+  SRV_COOKIE      /* server: the cookie to repeat a JOIN / STATS_REQ with */
+} SrvType;
+
+typedef struct {
+  uint32_t match, tick, sent_us;   /* slot, match tick, server clock */
+  uint8_t  side, state;            /* 0/1, State */
+  uint8_t  score[2];
+  float    bat_y[2];
+  float    ball_x, ball_y, ball_dx, ball_dy;
+  uint16_t speed;
+} SrvState;
+
+typedef struct {
+  uint32_t active, started, ticks;   /* matches now / since start; full ticks */
+  uint64_t steps;                    /* match steps since start */
+  uint32_t workers;
+  uint32_t late_p50_us, late_p99_us, late_max_us;   /* wake lateness */
+  uint32_t cpu_ns_per_step;          /* worker CPU per match step */
+  uint32_t send_drops;               /* STATE datagrams the socket refused */
+  uint32_t overruns;                 /* wakes over a tick late: the schedule restarts */
+                                     /* from the wake, the phase still advances by one */
+} ServerStats;
+
+typedef struct {
+  uint8_t type;                      /* SrvType */
+  uint8_t mode, side;                /* JOIN / INPUT, LEAVE */
+  uint32_t cookie;                   /* JOIN, STATS_REQ, COOKIE; 0: none yet */
+  uint32_t match;                    /* INPUT, LEAVE */
+  uint32_t buttons;                  /* INPUT */
+  SrvState st;                       /* STATE */
+  ServerStats stats;                 /* STATS */
+} SrvMsg;
+
+/* Returns bytes written (0 if `cap` is too small). */
+size_t srv_msg_encode(const SrvMsg* m, uint8_t* buf, size_t cap);
+/* 1 on a well-formed datagram, 0 otherwise. */
+int    srv_msg_decode(SrvMsg* m, const uint8_t* buf, size_t len);
+
+/* -------------------------------- Server --------------------------------- */
+#define SRV_SUBTICKS     4
+#define SRV_MAX_WORKERS  64
+#define SRV_TIMEOUT_MS   5000   /* a player silent this long ends the match */
+#define SRV_LATE_BUCKETS 16384  /* wake lateness histogram, 1 us buckets */
+#define SRV_COOKIE_MS    10000  /* cookie time bucket; the previous one still counts */
+#define SRV_STATS_MIN_MS 100    /* between STATS replies */
+#define SRV_MAX_PER_ADDR 16     /* default seats per source IP */
+
+typedef struct {
+  uint16_t port;       /* 0: pick a free one (see Server.port) */
+  int max_matches;     /* slab size */
+  int workers;         /* tick threads */
+  uint32_t seed;       /* match PRNG seeds derive from this */
+  int max_per_addr;    /* seats one source IP may hold; 0: SRV_MAX_PER_ADDR */
+} ServerConfig;
+
+typedef struct Server Server;
+
+/* Bind, allocate the slab, start the workers. NULL on failure (message on
+ * stderr). */
+Server*  server_start(const ServerConfig* cfg);
+/* The bound port. */
+uint16_t server_port(const Server* s);
+/* I/O loop; returns after server_shutdown(). */
+void     server_run(Server* s);
+/* Ask server_run() and the workers to return (any thread). */
+void     server_shutdown(Server* s);
+/* Join the workers and free everything (after server_run returned). */
+void     server_free(Server* s);
+/* Totals so far; from the I/O thread (it answers SRV_STATS_REQ with
+ * this) or after server_run() returned. */
+void     server_stats(Server* s, ServerStats* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SERVER_H */
@@ -0,0 +1,53 @@
+#ifndef SHAPES_H
+#define SHAPES_H
+
+#include "sim.h"
+#include "sim_party.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Per-frame shape instances: the whole playfield is one instanced draw of a
+ * unit quad, with a signed-distance fragment shader choosing the shape.
+ * Building the buffer is platform-free so it can be checked headless. */
+
+typedef enum {
+  SHAPE_RECT   = 0,  /* filled axis-aligned rect, w x h */
+  SHAPE_CIRCLE = 1,  /* filled disc, diameter w */
+  SHAPE_RING   = 2,  /* anti-aliased ring, diameter w, stroke `outline` px */
+  SHAPE_GLYPH  = 3   /* bitmap-font cell w x h, character code in `outline` */
+} ShapeKind;
+
+/* Layout matches the GL instance attributes (10 floats, 40 bytes). */
+typedef struct {
+  float x, y;        /* centre, pixels */
+  float w, h;        /* size, pixels */
+  float color[4];    /* straight (non-premultiplied) RGBA */
+  float outline;     /* ring stroke width, pixels (0 for fills); glyph code */
+  float kind;        /* ShapeKind as float, read directly by the shader */
+} ShapeInstance;
+
+/* 24 centre-line dashes + 2 paddles + ball */
+#define SHAPES_MAX (SIM_HEIGHT/20 + 3)
+
+#define SHAPES_RING_WIDTH 1.5f
+
+extern const float COL_WHITE[4];
+extern const float COL_GREEN[4];
+extern const float COL_YELLOW[4];
+extern const float COL_RED[4];
+extern const float COL_BLUE[4];
+
+/* Fill `out` (capacity `cap`) with the frame for `g`, back to front.
+ * Returns the number of instances written. */
+int shapes_build(const Game* g, ShapeInstance* out, int cap);
+/* Same for a party: centre line, paddles, then every ball (capacity
+ * permitting). */
+int shapes_build_party(const SimParty* p, ShapeInstance* out, int cap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SHAPES_H */
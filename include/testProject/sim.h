@@ -0,0 +1,94 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Headless Pong simulation core.
+ * Platform-free: no GL, no DOM, no audio. The browser build and the native
+ * tools drive the same sim_step(); side effects come back as Events. */
+
+/* ---------------------------- Config / Rules ---------------------------- */
+#define SIM_WIDTH        800
+#define SIM_HEIGHT       480
+#define SIM_PLAYER_SPEED 6.0f
+#define SIM_MAX_AI_SPEED 6.0f
+#define SIM_BAT_HALF_W   9.0f   /* paddle half width */
+#define SIM_BAT_HALF_H   64.0f  /* paddle half height */
+#define SIM_BALL_R       7.0f   /* ball radius */
+#define SIM_WIN_SCORE    10
+
+/* ---------------------------- Game Structures --------------------------- */
+typedef enum { ST_MENU=1, ST_PLAY=2, ST_OVER=3 } State;
+
+typedef struct { float x,y; int score; int timer; int isAI; } Bat;
+typedef struct { float x,y, dx,dy; int speed; float prev_x; } Ball;
+typedef struct {
+  Bat  bats[2];
+  Ball ball;
+  int  numPlayers; /* 1 or 2 */
+  int  ai_offset;  /* -10..10 */
+  uint32_t rng;    /* per-game PRNG state (never 0) */
+  int  solver;     /* SIM_SOLVER_*: how the ball is integrated */
+  State state;
+} Game;
+
+/* Ball integration. The original game moved the ball `speed` unit
+ * microsteps per frame and tested both paddles and walls after each one.
+ * SIM_SOLVER_SWEPT gets the same contacts (same microstep, same response)
+ * by solving for the next one analytically, so cost follows the number of
+ * contacts instead of the speed; positions match to float rounding.
+ * SIM_SOLVER_MICROSTEP is that original loop, kept as the reference and
+ * for bit parity with the batch engine. */
+enum { SIM_SOLVER_SWEPT = 0, SIM_SOLVER_MICROSTEP = 1 };
+
+/* ------------------------------- Input ---------------------------------- */
+enum {
+  IN_P1_UP   = 1u<<0,
+  IN_P1_DOWN = 1u<<1,
+  IN_P2_UP   = 1u<<2,
+  IN_P2_DOWN = 1u<<3
+};
+typedef struct { unsigned buttons; } Input;
+
+/* ------------------------------- Events --------------------------------- */
+/* What happened during one step; the caller maps these to SFX / HUD. */
+typedef enum {
+  EV_HIT = 1,    /* ball hit paddle `side`; speed is the post-hit speed */
+  EV_BOUNCE,     /* ball bounced off the top/bottom wall */
+  EV_GOAL,       /* `side` scored */
+  EV_GAME_OVER   /* `side` won the match */
+} EventType;
+
+typedef struct { EventType type; int side; int speed; float x,y; } Event;
+
+#define SIM_MAX_EVENTS 32
+typedef struct { int n; Event ev[SIM_MAX_EVENTS]; } Events;
+
+/* --------------------------------- API ---------------------------------- */
+/* Menu state, 1P selected, PRNG seeded (0 picks a fixed default), swept
+ * ball solver. */
+void sim_init(Game* g, uint32_t seed);
+
+/* Fresh match: bats centred, scores cleared, ball served to the right. */
+void sim_new_game(Game* g, int numPlayers);
+
+/* Advance one frame of play. No-op outside ST_PLAY. `ev` may be NULL. */
+void sim_step(Game* g, const Input* in, Events* ev);
+
+/* Next value of the game's PRNG (xorshift32). */
+uint32_t sim_rand(Game* g);
+
+/* FNV-1a over the gameplay state (float bit patterns, scores, timers,
+ * PRNG, state) for replay/desync checks. The solver is left out (a
+ * setting, not state). */
+uint32_t sim_state_hash(const Game* g);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_H */
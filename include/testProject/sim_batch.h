@@ -0,0 +1,61 @@
+#ifndef SIM_BATCH_H
+#define SIM_BATCH_H
+
+#include <stdint.h>
+
+#include "sim.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* N independent games in structure-of-arrays form, stepped in lockstep.
+ * The ball microstep loop runs as a vector kernel (AVX / SSE2 / wasm
+ * simd128, scalar fallback); lanes whose remaining `speed` is used up are
+ * masked off. Paddle/wall responses fall back to the scalar sim for the
+ * lanes that need them, so results are bit-identical to sim_step() with
+ * SIM_SOLVER_MICROSTEP (lanes ignore Game.solver; sim_batch_store() sets
+ * it to MICROSTEP). */
+
+typedef struct {
+  int n;          /* live games */
+  int cap;        /* lanes allocated (n rounded up to SIM_BATCH_ALIGN) */
+  void* block;    /* single allocation backing every array below */
+
+  /* ball */
+  float *ball_x, *ball_y, *ball_dx, *ball_dy, *ball_prev_x;
+  int   *ball_speed;
+  /* bats */
+  float *bat_x[2], *bat_y[2];
+  int   *bat_score[2], *bat_timer[2], *bat_isAI[2];
+  /* match */
+  int      *ai_offset;
+  uint32_t *rng;
+  int      *state;
+  int      *numPlayers;
+
+  /* scratch for the kernel: per-lane microstep budget as float */
+  float *steps;
+} SimBatch;
+
+#define SIM_BATCH_ALIGN 8  /* lanes per widest vector (AVX) */
+
+/* Returns 0 on allocation failure. All lanes start in ST_MENU. */
+int  sim_batch_init(SimBatch* b, int n);
+void sim_batch_free(SimBatch* b);
+
+void sim_batch_load (SimBatch* b, int lane, const Game* g);
+void sim_batch_store(const SimBatch* b, int lane, Game* g);
+
+/* One frame for every lane. `in` and `ev` are arrays of b->n (either may be
+ * NULL); events are appended to ev[lane] just like sim_step(). */
+void sim_batch_step(SimBatch* b, const Input* in, Events* ev);
+
+/* Vector width the kernel was compiled for (1 = scalar). */
+int  sim_batch_width(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_BATCH_H */
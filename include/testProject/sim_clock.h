@@ -0,0 +1,50 @@
+#ifndef SIM_CLOCK_H
+#define SIM_CLOCK_H
+
+#include "sim.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Fixed-timestep driver. The host feeds wall-clock time once per displayed
+ * frame and runs as many sim_step()s as have accrued, so gameplay speed no
+ * longer depends on the refresh rate; the leftover fraction of a step is
+ * used to interpolate what gets drawn. Gameplay constants are per step and
+ * tuned for SIM_TICK_HZ: other rates are for testing, and play faster or
+ * slower accordingly. */
+
+#define SIM_TICK_HZ     60  /* rate the original per-frame game ran at */
+#define SIM_MAX_CATCHUP 5   /* steps per frame; older time is dropped */
+
+typedef struct {
+  double step_ms;     /* 1000 / hz */
+  double acc_ms;      /* time not yet simulated */
+  double last_ms;     /* time of the previous advance (< 0: none yet) */
+  int    max_steps;
+  long   ticks;       /* steps handed out so far */
+  double dropped_ms;  /* time discarded by the catch-up cap (stalls, hidden tab) */
+} SimClock;
+
+void sim_clock_init(SimClock* c, int hz, int max_steps);
+void sim_clock_set_hz(SimClock* c, int hz);
+/* Forget accumulated time (e.g. when a match starts after the menu). */
+void sim_clock_reset(SimClock* c);
+/* Steps to run for a frame displayed at `now_ms` (0..max_steps). */
+int  sim_clock_advance(SimClock* c, double now_ms);
+/* Fraction of the next step already elapsed, in [0,1). */
+float sim_clock_alpha(const SimClock* c);
+/* Wall-clock time step i of the n handed out by the last advance stands
+ * for (its end), e.g. to feed it the input that arrived by then. */
+double sim_clock_step_time(const SimClock* c, int i, int n);
+
+/* Render-only blend of ball and paddle positions from `a` (state before the
+ * last step) toward `b`. Everything else comes from `b`; a serve/reset or a
+ * state change snaps to `b` instead of sweeping across the field. */
+void sim_lerp(const Game* a, const Game* b, float t, Game* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_CLOCK_H */
@@ -0,0 +1,78 @@
+#ifndef SIM_PARTY_H
+#define SIM_PARTY_H
+
+#include <stdint.h>
+
+#include "sim.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Multiball ("party") mode: one pair of paddles, up to `cap` balls.
+ * Each ball moves, hits paddles and bounces off walls under exactly the
+ * single-ball rules (the same solver code runs per ball against the shared
+ * bats), so a one-ball party plays like sim_step() until the first goal.
+ * Differences: a ball that leaves the field scores and is served again at
+ * once (no goal delay), the AI paddles chase the nearest incoming ball, and
+ * balls can bounce off each other.
+ *
+ * Ball–ball contacts go through a uniform grid over the field
+ * (SIM_PARTY_CELL px cells, at least one ball diameter, so touching balls
+ * are always in neighbouring cells). The grid is a doubly linked list per
+ * cell, kept across steps: only balls that changed cell are relinked. A
+ * contact is an equal-mass elastic bounce along the centre line (each ball
+ * keeps its own speed; the directions exchange their normal parts) after
+ * pushing the pair apart. Game stays single-ball: replays, netplay, the
+ * batch engine and the env are unaffected. */
+
+#define SIM_PARTY_CELL 16
+#define SIM_PARTY_GX   (SIM_WIDTH/SIM_PARTY_CELL)    /* 50 */
+#define SIM_PARTY_GY   (SIM_HEIGHT/SIM_PARTY_CELL)   /* 30 */
+
+enum { SIM_PARTY_GRID = 0, SIM_PARTY_ALL_PAIRS = 1 };
+
+typedef struct {
+  Bat   bats[2];
+  int   n, cap;          /* balls live / allocated */
+  Ball* balls;
+  /* grid: cell of each ball and its neighbours in that cell's list */
+  int  *cell, *next, *prev;
+  int   head[SIM_PARTY_GX*SIM_PARTY_GY];
+  void* block;           /* one allocation behind balls + links */
+
+  int   numPlayers;
+  int   ai_offset;
+  uint32_t rng;
+  int   solver;          /* SIM_SOLVER_*, per ball as in Game */
+  int   collide;         /* ball–ball contacts on (default) / off */
+  int   broadphase;      /* SIM_PARTY_GRID, or the all-pairs reference */
+  int   win;             /* points to win; 0 = endless */
+  State state;
+  /* totals since init */
+  uint32_t contacts, relinks;
+} SimParty;
+
+/* Room for `cap` balls; menu state, seeded like sim_init(). 0 on failure. */
+int  sim_party_init(SimParty* p, int cap, uint32_t seed);
+void sim_party_free(SimParty* p);
+
+/* Fresh match with `balls` balls (clamped to cap): ball 0 is served like
+ * sim_new_game()'s, the rest start scattered over the middle of the field
+ * in random directions. Bat setup, numPlayers and AI as sim_new_game(). */
+void sim_party_new_game(SimParty* p, int balls, int numPlayers);
+
+/* One step: paddles, every ball, goals, then ball–ball contacts. No-op
+ * outside ST_PLAY. Events as sim_step() (beyond SIM_MAX_EVENTS a step's
+ * events are dropped: a party can produce hundreds). */
+void sim_party_step(SimParty* p, const Input* in, Events* ev);
+
+/* Overlapping pairs (i < j) found through the grid as it stands, in no
+ * particular order. Returns the count; at most `max` are written. */
+int  sim_party_overlaps(const SimParty* p, int (*pairs)[2], int max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_PARTY_H */
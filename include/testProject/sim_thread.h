@@ -0,0 +1,49 @@
+#ifndef SIM_THREAD_H
+#define SIM_THREAD_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Fixed-rate runner on its own pthread: calls `step` every 1/hz seconds of
+ * CLOCK_MONOTONIC, independent of the display. Natively this is plain
+ * pthreads; in the browser it needs a -pthread build (PONG_SIM_THREAD) and
+ * a cross-origin isolated page, and sim_thread_start() returning NULL is
+ * the cue to stay single-threaded.
+ *
+ * Steps are scheduled on absolute deadlines, so lateness does not
+ * accumulate. After a stall of more than SIM_MAX_CATCHUP steps the
+ * schedule restarts from now and the skipped steps are counted as dropped,
+ * like SimClock does on the main thread. */
+
+/* `t_ms` is the time the step stands for (its deadline, on
+ * sim_thread_now_ms()'s clock). */
+typedef void (*SimThreadStep)(void* user, double t_ms);
+
+typedef struct {
+  uint32_t steps;
+  uint32_t dropped;       /* steps skipped after long stalls */
+  uint32_t late_max_us;   /* worst wake-up after a deadline */
+  uint32_t late_mean_us;
+} SimThreadStats;
+
+typedef struct SimThread SimThread;
+
+/* The clock steps are scheduled on; use it for key timestamps too. */
+double     sim_thread_now_ms(void);
+/* NULL if the thread could not be created. */
+SimThread* sim_thread_start(int hz, SimThreadStep step, void* user);
+/* Takes effect from the next step. */
+void       sim_thread_set_hz(SimThread* t, int hz);
+/* Any thread; counters are read without stopping the runner. */
+void       sim_thread_stats(const SimThread* t, SimThreadStats* out);
+/* Waits for the step in progress, joins and frees. */
+void       sim_thread_stop(SimThread* t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_THREAD_H */
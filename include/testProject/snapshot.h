@@ -0,0 +1,107 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sim.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Delta-compressed match state for spectators and overlays: what is on
+ * screen, not what the sim needs to continue (no PRNG, timers or AI state;
+ * players and replays keep using exact inputs).
+ *
+ * A Snap is the quantized view: positions in 1/8 px, ball direction in
+ * 1/1024, all as 16-bit integers, so encode/decode is lossless on a Snap
+ * and the only loss is snap_capture()'s rounding.
+ *
+ * Packets are bit-packed (LSB first). A keyframe carries every field raw.
+ * A delta names a baseline the receiver already has (low 16 bits of its
+ * tick, plus the age 1..SNAP_WINDOW-1) and codes each field as a residual
+ * against it: the ball against where the baseline's velocity would have
+ * carried it, everything else against its baseline value. Residuals use
+ * a prefix code:
+ *   0                      unchanged
+ *   10  + 5-bit signed     |r| < 16
+ *   110 + 9-bit signed     |r| < 256
+ *   111 + 16-bit value     the field itself
+ * State and scores ride behind one "changed" bit.
+ *
+ * The sender may only delta against a tick the receiver acknowledged
+ * (SnapSender tracks that); the receiver keeps what it decoded in a
+ * SnapRing so any recent one can serve as a baseline. A delta delayed by
+ * 65536 ticks or more (18 minutes at 60 Hz) would match a newer baseline
+ * with the same low bits; receivers drop packets that stale. */
+
+#define SNAP_WINDOW    32   /* baselines older than this many ticks: keyframe */
+#define SNAP_MAX_BYTES 24   /* room for the largest packet (22 bytes) */
+#define SNAP_POS_SCALE 8.0f
+#define SNAP_DIR_SCALE 1024.0f
+
+typedef struct {
+  uint32_t tick;
+  uint8_t  state;            /* State */
+  uint8_t  score[2];
+  int16_t  bat_y[2];         /* 1/8 px */
+  int16_t  ball_x, ball_y;   /* 1/8 px */
+  int16_t  ball_dx, ball_dy; /* 1/1024 */
+  uint16_t speed;
+} Snap;
+
+typedef enum {
+  SNAP_OK = 0,
+  SNAP_ERR_FORMAT = -1,   /* truncated, trailing garbage or bad field */
+  SNAP_ERR_BASE   = -2    /* delta against a tick we don't have: ask for a key */
+} SnapStatus;
+
+const char* snap_status_name(SnapStatus s);
+
+/* Quantize `g` (rounded to nearest, clamped to the field widths). */
+void snap_capture(Snap* s, const Game* g, uint32_t tick);
+/* Write the snapshot back into `g` for drawing: bats, ball, scores and
+ * state; everything else in `g` is left alone. */
+void snap_apply(const Snap* s, Game* g);
+
+/* ---------------------------------- Ring --------------------------------- */
+/* The last SNAP_WINDOW snapshots by tick (slot tick % SNAP_WINDOW). */
+typedef struct {
+  Snap    s[SNAP_WINDOW];
+  uint8_t valid[SNAP_WINDOW];
+} SnapRing;
+
+void        snap_ring_init(SnapRing* r);
+void        snap_ring_put(SnapRing* r, const Snap* s);
+const Snap* snap_ring_get(const SnapRing* r, uint32_t tick);   /* NULL if gone */
+
+/* --------------------------------- Codec --------------------------------- */
+/* Encodes `cur` against `base` (NULL, or a base not 1..SNAP_WINDOW-1 ticks
+ * older: keyframe). Returns bytes written, 0 if `cap` is too small. */
+size_t     snap_encode(const Snap* cur, const Snap* base, uint8_t* out, size_t cap);
+/* Decodes a packet, finding a delta's baseline in `have` (may be NULL:
+ * keyframes only). On SNAP_OK the caller puts `out` into its ring and acks
+ * out->tick. */
+SnapStatus snap_decode(Snap* out, const uint8_t* buf, size_t len, const SnapRing* have);
+
+/* -------------------------------- Sender --------------------------------- */
+/* One spectator stream: deltas against the newest acked snapshot still in
+ * the window, keyframes until there is one. */
+typedef struct {
+  SnapRing sent;
+  uint32_t acked;
+  int      has_ack;
+  uint32_t keys, deltas;   /* packets so far */
+} SnapSender;
+
+void   snap_sender_init(SnapSender* s);
+/* The receiver has `tick` (acks may arrive late or out of order). */
+void   snap_sender_ack(SnapSender* s, uint32_t tick);
+size_t snap_sender_encode(SnapSender* s, const Snap* cur, uint8_t* out, size_t cap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SNAPSHOT_H */
@@ -0,0 +1,84 @@
+#ifndef VFX_H
+#define VFX_H
+
+#include <stdint.h>
+
+#include "shapes.h"
+#include "sim.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Particle effects: hit sparks, wall ripples, ball trail, goal flash.
+ * Render-only (never part of the sim state or its hash), but stepped at
+ * the sim rate from the Events each step produces, so a replay shows the
+ * same effects.
+ *
+ * Particles live in a fixed pool of parallel arrays (one allocation at
+ * init, no per-effect malloc). Each step the update kernel runs 4-wide
+ * (SSE / wasm simd128, scalar fallback) over the live prefix, then dead
+ * particles are swap-removed so the live ones stay packed at [0, n).
+ * vfx_build() turns the pool into one run of ShapeInstances: the effects
+ * go out in the frame's single instance upload as one draw. A full pool
+ * drops new particles and counts them; it never evicts live ones. */
+
+/* -------------------------------- Particles ------------------------------ */
+typedef enum {
+  VFX_WHITE = 0, VFX_YELLOW, VFX_RED, VFX_BLUE,
+  VFX_GHOST,               /* faint white: the trail */
+  VFX_PAL_COUNT
+} VfxColor;
+
+typedef struct {
+  int cap, n;              /* pool size (multiple of 4), live count */
+  /* SoA, `cap` entries each; live particles are [0, n) */
+  float *x, *y, *vx, *vy;  /* pixels, pixels per step */
+  float *age, *life;       /* steps; dies when age >= life */
+  float *size, *grow;      /* diameter and its change per step */
+  float *drag;             /* velocity scale per step */
+  uint8_t *shape;          /* ShapeKind: SHAPE_CIRCLE or SHAPE_RING */
+  uint8_t *color;          /* VfxColor; alpha fades over the lifetime */
+  void* block;             /* the one allocation behind the arrays */
+  float flash;             /* full-screen goal flash, 1 -> 0 */
+  uint8_t flash_color;
+  uint32_t rng;
+  /* totals since init */
+  uint32_t spawned, dropped;
+} Vfx;
+
+/* Room for `cap` particles (rounded up to the SIMD width). 0 on failure. */
+int  vfx_init(Vfx* v, int cap);
+void vfx_free(Vfx* v);
+/* Drop every particle and the flash; keeps the pool. */
+void vfx_clear(Vfx* v);
+/* SIMD lanes the update kernel was compiled for (1 = scalar). */
+int  vfx_width(void);
+
+/* Add one particle; 0 if the pool is full (counted in `dropped`). */
+int  vfx_spawn(Vfx* v, float x, float y, float vx, float vy, float life,
+               float size, float grow, float drag, ShapeKind shape, VfxColor color);
+
+/* ------------------------------- Emitters -------------------------------- */
+/* Effects for one step's events: EV_HIT a ripple at the paddle face and a
+ * spray of sparks that grows with the ball speed, EV_BOUNCE a ripple and a
+ * few sparks off the wall, EV_GOAL the screen flash in the scorer's colour
+ * and a burst where the ball left. */
+void vfx_emit_events(Vfx* v, const Events* ev);
+/* Fading ball trail, one particle per step once the ball is fast. */
+void vfx_emit_trail(Vfx* v, const Ball* b);
+
+/* ------------------------------ Step / Draw ------------------------------ */
+/* Advance one sim step: move, drag, age, grow; then remove the dead. */
+void vfx_step(Vfx* v);
+
+/* Instances for the live particles, then the flash (if any) as a
+ * full-screen rect. Returns instances written (at most VFX_DRAW_MAX(v)). */
+#define VFX_DRAW_MAX(v) ((v)->n + 1)
+int  vfx_build(const Vfx* v, ShapeInstance* out, int cap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VFX_H */
@@ -0,0 +1,131 @@
+"""pong_env.py — NumPy binding for the vectorized Pong env (env.h)
+
+Loads libpong_env from a native build (cmake --preset native-debug) with
+ctypes. The observation/reward/done arrays are allocated here once and
+bound to the C side, which writes into them in place: step() returns the
+same arrays every time, overwritten by the next call (copy what you keep).
+
+    env = PongVecEnv(1024)
+    obs = env.reset(seeds=np.arange(1024))
+    obs, reward, done = env.step(actions)   # actions: 0 stay, 1 up, 2 down
+
+Games that end report done = 1 and are already reset: their obs row shows
+the next game. done mixes both endings; env.truncated (same layout, filled
+by the same step) is 1 where the game was only cut off by max_steps, so a
+learner can bootstrap there instead of treating it as terminal.
+
+Physics: the env runs on the batch engine's microstep ball solver, while
+the browser game defaults to the swept solver. Same contacts and response,
+but float rounding differs, so long rallies drift apart between the two.
+Set PONG_ENV_LIB to point at the shared library elsewhere.
+"""
+
+import ctypes
+import os
+import time
+
+import numpy as np
+
+_HERE = os.path.dirname(os.path.abspath(__file__))
+_DEFAULT_LIBS = [
+    os.path.join(_HERE, "..", "build-native", "libpong_env.so"),
+    os.path.join(_HERE, "..", "build-native", "libpong_env.dylib"),
+]
+
+_f32p = ctypes.POINTER(ctypes.c_float)
+
+
+def _load(path=None):
+    path = path or os.environ.get("PONG_ENV_LIB")
+    candidates = [path] if path else _DEFAULT_LIBS
+    for p in candidates:
+        if p and os.path.exists(p):
+            lib = ctypes.CDLL(p)
+            break
+    else:
+        raise OSError("libpong_env not found (build natively or set PONG_ENV_LIB)")
+    lib.pong_env_create.restype = ctypes.c_void_p
+    lib.pong_env_create.argtypes = [ctypes.c_int, ctypes.c_int]
+    lib.pong_env_destroy.restype = None
+    lib.pong_env_destroy.argtypes = [ctypes.c_void_p]
+    lib.pong_env_bind.restype = None
+    lib.pong_env_bind.argtypes = [ctypes.c_void_p, _f32p, _f32p, _f32p]
+    lib.pong_env_bind_truncated.restype = None
+    lib.pong_env_bind_truncated.argtypes = [ctypes.c_void_p, _f32p]
+    lib.pong_env_reset.restype = None
+    lib.pong_env_reset.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_uint32)]
+    lib.pong_env_step.restype = None
+    lib.pong_env_step.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_int32)]
+    lib.pong_env_obs_dim.restype = ctypes.c_int
+    lib.pong_env_episodes.restype = ctypes.c_long
+    lib.pong_env_episodes.argtypes = [ctypes.c_void_p]
+    return lib
+
+
+class PongVecEnv:
+    """N games, agent on the left paddle vs the built-in AI."""
+
+    STAY, UP, DOWN = 0, 1, 2
+
+    def __init__(self, n, max_steps=0, lib=None):
+        self._lib = _load(lib)
+        self.n = int(n)
+        self.obs_dim = self._lib.pong_env_obs_dim()
+        self.obs = np.zeros((self.n, self.obs_dim), dtype=np.float32)
+        self.reward = np.zeros(self.n, dtype=np.float32)
+        self.done = np.zeros(self.n, dtype=np.float32)
+        self.truncated = np.zeros(self.n, dtype=np.float32)
+        self._h = self._lib.pong_env_create(self.n, int(max_steps))
+        if not self._h:
+            raise MemoryError("pong_env_create failed")
+        self._lib.pong_env_bind(self._h, self.obs.ctypes.data_as(_f32p),
+                                self.reward.ctypes.data_as(_f32p),
+                                self.done.ctypes.data_as(_f32p))
+        self._lib.pong_env_bind_truncated(self._h, self.truncated.ctypes.data_as(_f32p))
+
+    def reset(self, seeds=None):
+        if seeds is None:
+            self._lib.pong_env_reset(self._h, None)
+        else:
+            s = np.ascontiguousarray(seeds, dtype=np.uint32)
+            if s.shape != (self.n,):
+                raise ValueError("seeds must have shape (n,)")
+            self._lib.pong_env_reset(self._h, s.ctypes.data_as(ctypes.POINTER(ctypes.c_uint32)))
+        return self.obs
+
+    def step(self, actions):
+        a = actions
+        if not (isinstance(a, np.ndarray) and a.dtype == np.int32 and a.flags.c_contiguous):
+            a = np.ascontiguousarray(a, dtype=np.int32)   # the only copy, and only if needed
+        if a.shape != (self.n,):
+            raise ValueError("actions must have shape (n,)")
+        self._lib.pong_env_step(self._h, a.ctypes.data_as(ctypes.POINTER(ctypes.c_int32)))
+        return self.obs, self.reward, self.done
+
+    @property
+    def episodes(self):
+        return self._lib.pong_env_episodes(self._h)
+
+    def close(self):
+        if self._h:
+            self._lib.pong_env_destroy(self._h)
+            self._h = None
+
+    def __del__(self):
+        self.close()
+
+
+if __name__ == "__main__":
+    # env-steps/sec through the binding, random actions
+    for n in (1, 64, 1024, 4096):
+        env = PongVecEnv(n)
+        env.reset()
+        rng = np.random.default_rng(0)
+        acts = rng.integers(0, 3, size=(64, n), dtype=np.int32)
+        steps = max(1, 2_000_000 // n)
+        t0 = time.perf_counter()
+        for t in range(steps):
+            env.step(acts[t & 63])
+        dt = time.perf_counter() - t0
+        print(f"N={n:<6d} {steps * n / dt:14.0f} env-steps/s  {env.episodes} episodes")
+        env.close()
@@ -0,0 +1,106 @@
+/* ai.c — intercept predictor and difficulty-tiered paddle agents */
+
+#include "ai.h"
+#include "sim_internal.h"
+
+#include <math.h>
+#include <string.h>
+
+/* ------------------------------- Predictor ------------------------------- */
+float ai_intercept_y(float x, float y, float dx, float dy, float face_x){
+  const float L = SIM_HEIGHT - 2.0f*SIM_BALL_R;   /* span the centre can use */
+  float t = (face_x - x) / dx;                    /* microsteps to the face */
+  float u = fmodf(y - SIM_BALL_R + dy*t, 2.0f*L);
+  if(u < 0.0f) u += 2.0f*L;
+  return SIM_BALL_R + (u <= L ? u : 2.0f*L - u);
+}
+
+float ai_face_x(const Game* g, int side){
+  return side==0 ? g->bats[0].x + SIM_BAT_HALF_W + SIM_BALL_R
+                 : g->bats[1].x - SIM_BAT_HALF_W - SIM_BALL_R;
+}
+
+void ai_predictor_reset(AiPredictor* p){
+  memset(p, 0, sizeof(*p));
+  p->dx = NAN;   /* never equal: first query computes */
+}
+
+int ai_predict(AiPredictor* p, const Game* g, int side, float* y){
+  const Ball* b = &g->ball;
+  p->queries++;
+  /* a serve puts the ball back at the centre with prev_x == x */
+  if(b->dx != p->dx || b->dy != p->dy || b->x == b->prev_x){
+    p->dx = b->dx; p->dy = b->dy;
+    float face = ai_face_x(g, side);
+    p->valid = side==0 ? (b->dx < 0.0f && b->x > face) : (b->dx > 0.0f && b->x < face);
+    if(p->valid) p->y = ai_intercept_y(b->x, b->y, b->dx, b->dy, face);
+    p->recomputes++;
+  }
+  if(p->valid) *y = p->y;
+  return p->valid;
+}
+
+/* --------------------------------- Tiers --------------------------------- */
+const AiTier AI_TIERS[AI_TIER_COUNT] = {
+  /* name      reaction  err_px  err/px  speed     vs blend (bench_ai) */
+  { "easy",    13,       18.0f,  0.06f,  0.75f },  /* ~10% */
+  { "medium",  10,       14.0f,  0.05f,  0.90f },  /* ~50% */
+  { "hard",     7,       10.0f,  0.04f,  1.00f },  /* ~90% */
+  { "expert",   0,        0.0f,  0.00f,  1.00f },
+};
+
+/* --------------------------------- Agent --------------------------------- */
+static float gauss(uint32_t* rng){
+  /* Irwin-Hall: sum of 4 uniforms, rescaled to unit variance */
+  float s = 0.0f;
+  for(int i=0;i<4;i++) s += (float)(sim_xorshift(rng) >> 8) / 16777216.0f;
+  return (s - 2.0f) * 1.7320508f;
+}
+
+void ai_agent_init(AiAgent* a, AiTierId tier, int side, uint32_t seed){
+  memset(a, 0, sizeof(*a));
+  a->tier = AI_TIERS[tier];
+  a->side = side;
+  a->rng = seed ? seed : 0x6C078965u;
+  a->target = SIM_HEIGHT/2.0f;
+  ai_predictor_reset(&a->pred);
+}
+
+unsigned ai_agent_buttons(AiAgent* a, const Game* g){
+  long before = a->pred.recomputes;
+  float y = SIM_HEIGHT/2.0f;
+  int heading = ai_predict(&a->pred, g, a->side, &y);
+
+  /* new trajectory: re-plan after the reaction delay */
+  if(a->pred.recomputes != before){ a->pending = 1; a->wait = a->tier.reaction_steps; }
+  if(a->pending && a->wait-- <= 0){
+    a->pending = 0;
+    if(heading){
+      float travel = fabsf(ai_face_x(g, a->side) - g->ball.x);
+      a->target = y + gauss(&a->rng) * (a->tier.err_px + a->tier.err_per_px*travel);
+    } else {
+      a->target = SIM_HEIGHT/2.0f;   /* ball going away: recentre */
+    }
+  }
+
+  float d = sim_clamp_bat(a->target) - g->bats[a->side].y;
+  if(fabsf(d) <= SIM_PLAYER_SPEED*0.5f) return 0;
+  a->move_acc += a->tier.speed;
+  if(a->move_acc < 1.0f) return 0;
+  a->move_acc -= 1.0f;
+  unsigned up = a->side ? IN_P2_UP : IN_P1_UP, down = a->side ? IN_P2_DOWN : IN_P1_DOWN;
+  return d > 0.0f ? down : up;
+}
+
+/* ------------------------------ Tuned blend ------------------------------ */
+const AiBlendParams AI_BLEND_DEFAULT = { SIM_MAX_AI_SPEED, 10.0f, SIM_WIDTH/2.0f };
+
+float ai_blend_delta(const AiBlendParams* p, const Game* g, int side){
+  float offset = (float)g->ai_offset * (p->offset_range / 10.0f);
+  return sim_ai_delta_tuned(g->ball.x, g->ball.y, g->bats[side].x, g->bats[side].y,
+                            offset, p->blend_dist, p->max_speed);
+}
+
+void ai_blend_move(const AiBlendParams* p, Game* g, int side){
+  g->bats[side].y = sim_clamp_bat(g->bats[side].y + ai_blend_delta(p, g, side));
+}
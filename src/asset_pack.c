@@ -0,0 +1,190 @@
+/* asset_pack.c — .pak index reader (incremental), writer + load order,
+ * native mmap */
+
+#if !defined(__EMSCRIPTEN__) && (defined(__unix__) || defined(__APPLE__))
+#  ifndef _POSIX_C_SOURCE
+#    define _POSIX_C_SOURCE 200112L
+#  endif
+#  define ASSET_MMAP 1
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+#include "asset_pack.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bytes_internal.h"
+
+static uint32_t page_up(uint32_t n){ return (n + ASSET_PAGE - 1u) & ~(ASSET_PAGE - 1u); }
+
+uint32_t asset_hash(const char* name){
+  uint32_t h = 2166136261u;
+  for(; *name; name++){ h ^= (uint8_t)*name; h *= 16777619u; }
+  return h;
+}
+
+/* ---------------------------------- Reader ------------------------------- */
+static const uint8_t* entry_at(const AssetPack* p, uint32_t i){
+  return p->data + ASSET_HEADER_BYTES + i*ASSET_ENTRY_BYTES;
+}
+
+int asset_pack_open(AssetPack* p, const uint8_t* data, size_t have){
+  memset(p, 0, sizeof(*p));
+  if(have < ASSET_HEADER_BYTES) return 0;
+  if(get_u32(data) != ASSET_MAGIC || get_u16(data+4) != ASSET_VERSION) return -1;
+  uint32_t count = get_u16(data+6), index = get_u32(data+8), first = get_u32(data+12), total = get_u32(data+16);
+  uint32_t names = count*ASSET_ENTRY_BYTES;
+  /* 64-bit: a header's index near 2^32 must not wrap past these */
+  uint64_t index_end = (uint64_t)ASSET_HEADER_BYTES + index;
+  if(index < names || first < index_end || first % ASSET_PAGE || total < first) return -1;
+  if(have < index_end) return 0;
+
+  /* entries: page aligned, in order, inside the archive; names terminated */
+  const uint8_t* tab = data + ASSET_HEADER_BYTES + names;
+  uint32_t tab_len = index - names, prev = first;
+  for(uint32_t i=0;i<count;i++){
+    const uint8_t* e = data + ASSET_HEADER_BYTES + i*ASSET_ENTRY_BYTES;
+    uint32_t off = get_u32(e+4), size = get_u32(e+8), name = get_u16(e+14);
+    if(off % ASSET_PAGE || off < prev || off > total || size > total - off || name >= tab_len) return -1;
+    if(!memchr(tab + name, 0, tab_len - name)) return -1;
+    prev = off + size;
+  }
+  p->data = data; p->total = total; p->count = count;
+  asset_pack_received(p, have);
+  return 1;
+}
+
+uint32_t asset_pack_received(AssetPack* p, size_t have){
+  while(p->ready < p->count){
+    const uint8_t* e = entry_at(p, p->ready);
+    if((size_t)get_u32(e+4) + get_u32(e+8) > have) break;
+    p->ready++;
+  }
+  return p->ready;
+}
+
+void asset_pack_entry(const AssetPack* p, uint32_t i, AssetEntry* out){
+  const uint8_t* e = entry_at(p, i);
+  out->hash = get_u32(e); out->offset = get_u32(e+4); out->size = get_u32(e+8);
+  out->codec = e[12]; out->flags = e[13];
+  out->name = (const char*)p->data + ASSET_HEADER_BYTES + p->count*ASSET_ENTRY_BYTES + get_u16(e+14);
+}
+
+int asset_pack_find(const AssetPack* p, const char* name){
+  uint32_t h = asset_hash(name);
+  for(uint32_t i=0;i<p->count;i++){
+    if(get_u32(entry_at(p, i)) != h) continue;
+    AssetEntry e; asset_pack_entry(p, i, &e);
+    if(!strcmp(e.name, name)) return (int)i;
+  }
+  return -1;
+}
+
+const uint8_t* asset_pack_data(const AssetPack* p, uint32_t i, uint32_t* size){
+  if(i >= p->ready) return NULL;
+  const uint8_t* e = entry_at(p, i);
+  *size = get_u32(e+8);
+  return p->data + get_u32(e+4);
+}
+
+/* ---------------------------------- Writer ------------------------------- */
+AssetCodec asset_codec_for(const char* name){
+  const char* dot = strrchr(name, '.');
+  if(dot && !strcmp(dot, ".ogg")) return ASSET_CODEC_OGG;
+  if(dot && !strcmp(dot, ".wav")) return ASSET_CODEC_WAV;
+  return ASSET_CODEC_RAW;
+}
+
+/* First screen is the menu (up/down), then the first rally, then a goal. */
+static int load_rank(const char* name){
+  static const char* const order[] = {
+    "sounds/up", "sounds/down", "sounds/hit", "sounds/bounce", "sounds/score"
+  };
+  const int n = (int)(sizeof(order)/sizeof(order[0]));
+  for(int i=0;i<n;i++) if(!strncmp(name, order[i], strlen(order[i]))) return i;
+  if(!strncmp(name, "sounds/", 7)) return n;
+  if(!strncmp(name, "music/", 6))  return n + 2;
+  return n + 1;
+}
+
+void asset_plan(AssetSrc* src, int n){
+  for(int i=1;i<n;i++){   /* stable: variants stay in name order */
+    AssetSrc x = src[i]; int r = load_rank(x.name), j = i;
+    for(; j>0 && load_rank(src[j-1].name) > r; j--) src[j] = src[j-1];
+    src[j] = x;
+  }
+  for(int i=0;i<n;i++) if(!strncmp(src[i].name, "music/", 6)) src[i].flags |= ASSET_FLAG_STREAM;
+}
+
+uint8_t* asset_pack_build(const AssetSrc* src, int n, size_t* size){
+  if(n < 0 || n > 0xFFFF) return NULL;
+  uint32_t names = 0;
+  for(int i=0;i<n;i++) names += (uint32_t)strlen(src[i].name) + 1u;
+  if(names > 0xFFFFu) return NULL;
+  uint32_t index = (uint32_t)n*ASSET_ENTRY_BYTES + names;
+  uint32_t first = page_up(ASSET_HEADER_BYTES + index), total = first;
+  for(int i=0;i<n;i++) total = page_up(total) + src[i].size;
+
+  uint8_t* out = (uint8_t*)calloc(total, 1);
+  if(!out) return NULL;
+  put_u32(out, ASSET_MAGIC); put_u16(out+4, ASSET_VERSION); put_u16(out+6, (uint32_t)n);
+  put_u32(out+8, index); put_u32(out+12, first); put_u32(out+16, total);
+  uint32_t at = first, name = 0;
+  for(int i=0;i<n;i++){
+    uint8_t* e = out + ASSET_HEADER_BYTES + (uint32_t)i*ASSET_ENTRY_BYTES;
+    at = page_up(at);
+    put_u32(e, asset_hash(src[i].name)); put_u32(e+4, at); put_u32(e+8, src[i].size);
+    e[12] = src[i].codec; e[13] = src[i].flags; put_u16(e+14, name);
+    size_t len = strlen(src[i].name) + 1u;
+    memcpy(out + ASSET_HEADER_BYTES + (uint32_t)n*ASSET_ENTRY_BYTES + name, src[i].name, len);
+    name += (uint32_t)len;
+    if(src[i].size) memcpy(out + at, src[i].data, src[i].size);
+    at += src[i].size;
+  }
+  *size = total;
+  return out;
+}
+
+/* ------------------------------- Native file ----------------------------- */
+int asset_file_open(AssetFile* f, const char* path){
+  memset(f, 0, sizeof(*f));
+#ifdef ASSET_MMAP
+  int fd = open(path, O_RDONLY);
+  if(fd < 0) return 0;
+  struct stat st;
+  if(fstat(fd, &st) == 0 && st.st_size > 0){
+    void* m = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(m != MAP_FAILED){ f->base = m; f->size = (size_t)st.st_size; f->mapped = 1; }
+  }
+  close(fd);
+#endif
+  if(!f->base){
+    FILE* fp = fopen(path, "rb");
+    if(!fp) return 0;
+    long len = fseek(fp, 0, SEEK_END) == 0 ? ftell(fp) : -1;
+    if(len > 0 && fseek(fp, 0, SEEK_SET) == 0 && (f->base = malloc((size_t)len)) != NULL){
+      f->size = fread(f->base, 1, (size_t)len, fp);
+    }
+    fclose(fp);
+    if(!f->base) return 0;
+  }
+  if(asset_pack_open(&f->pack, (const uint8_t*)f->base, f->size) != 1 || f->pack.total != f->size){
+    asset_file_close(f);
+    return 0;
+  }
+  return 1;
+}
+
+void asset_file_close(AssetFile* f){
+#ifdef ASSET_MMAP
+  if(f->mapped) munmap(f->base, f->size);
+  else
+#endif
+  free(f->base);
+  memset(f, 0, sizeof(*f));
+}
@@ -0,0 +1,232 @@
+/* audio_mixer.c — PCM arena, voice pool with priority stealing, SIMD mix,
+ * PCM ring for the AudioWorklet, float WAV I/O */
+
+#include "audio_mixer.h"
+#include "pong_atomic.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bytes_internal.h"
+
+#if defined(__SSE__) || defined(_M_X64)
+#  include <xmmintrin.h>
+#  define MIX_W 4
+#elif defined(__wasm_simd128__)
+#  include <wasm_simd128.h>
+#  define MIX_W 4
+#else
+#  define MIX_W 1
+#endif
+
+int mixer_width(void){ return MIX_W; }
+
+/* ---------------------------------- Bank --------------------------------- */
+int mix_bank_init(MixBank* b, uint32_t frames){
+  memset(b, 0, sizeof(*b));
+  b->pcm = (float*)calloc(frames ? frames : 1u, sizeof(float));
+  if(!b->pcm) return 0;
+  b->cap = frames;
+  return 1;
+}
+
+void mix_bank_free(MixBank* b){
+  free(b->pcm);
+  memset(b, 0, sizeof(*b));
+}
+
+float* mix_bank_add(MixBank* b, Sfx s, int v, uint32_t frames){
+  if((unsigned)s >= SFX_COUNT || v < 0 || v >= MIX_MAX_VARIANTS || frames > b->cap - b->used) return NULL;
+  MixClip* c = &b->clip[s][v];
+  c->offset = b->used; c->frames = frames;
+  b->used += frames;
+  if(v >= b->variants[s]) b->variants[s] = (uint8_t)(v + 1);
+  return b->pcm + c->offset;
+}
+
+/* --------------------------------- Voices -------------------------------- */
+void mixer_init(Mixer* m, const MixBank* b, int rate){
+  memset(m, 0, sizeof(*m));
+  m->bank = b; m->rate = rate; m->master = 1.0f;
+  m->rng = 0x1D872B41u;
+}
+
+static uint32_t mixer_rand(Mixer* m){
+  m->rng ^= m->rng<<13; m->rng ^= m->rng>>17; m->rng ^= m->rng<<5;
+  return m->rng;
+}
+
+int mixer_play(Mixer* m, Sfx s, int v, float gain){
+  if((unsigned)s >= SFX_COUNT || !m->bank->variants[s]) return -1;
+  if(v < 0) v = (int)(mixer_rand(m) % m->bank->variants[s]);
+  if(v >= m->bank->variants[s] || !m->bank->clip[s][v].frames) return -1;
+  const MixClip* c = &m->bank->clip[s][v];
+
+  /* a free voice, else the oldest of the lowest priority */
+  int pick = -1;
+  for(int i=0;i<MIX_VOICES;i++){
+    const MixVoice* x = &m->voice[i];
+    if(!x->src){ pick = i; break; }
+    if(pick < 0 || x->sfx > m->voice[pick].sfx ||
+       (x->sfx == m->voice[pick].sfx && (int32_t)(x->start - m->voice[pick].start) < 0)) pick = i;
+  }
+  MixVoice* x = &m->voice[pick];
+  if(x->src){
+    if(x->sfx < (uint8_t)s){ m->dropped++; return -1; }
+    m->stolen++;
+  }
+  x->src = m->bank->pcm + c->offset; x->pos = 0; x->len = c->frames;
+  x->gain = gain; x->sfx = (uint8_t)s; x->start = m->clock++;
+  m->started++;
+  return pick;
+}
+
+void mixer_drain(Mixer* m, AudioRing* r){
+  Sfx s; int layers;
+  while(audio_ring_pop(r, &s, &layers))
+    for(int l=0;l<layers;l++) mixer_play(m, s, -1, 1.0f);
+}
+
+int mixer_active(const Mixer* m){
+  int n = 0;
+  for(int i=0;i<MIX_VOICES;i++) n += m->voice[i].src != NULL;
+  return n;
+}
+
+/* ----------------------------------- Mix --------------------------------- */
+/* out[i] += src[i]*gain. Sources start anywhere in the arena: unaligned loads. */
+static void mix_add(float* out, const float* src, float gain, int n){
+  int i = 0;
+#if MIX_W == 4 && !defined(__wasm_simd128__)
+  __m128 g = _mm_set1_ps(gain);
+  for(; i+4<=n; i+=4) _mm_storeu_ps(out+i, _mm_add_ps(_mm_loadu_ps(out+i), _mm_mul_ps(_mm_loadu_ps(src+i), g)));
+#elif MIX_W == 4
+  v128_t g = wasm_f32x4_splat(gain);
+  for(; i+4<=n; i+=4) wasm_v128_store(out+i, wasm_f32x4_add(wasm_v128_load(out+i), wasm_f32x4_mul(wasm_v128_load(src+i), g)));
+#endif
+  for(; i<n; i++) out[i] += src[i]*gain;
+}
+
+static void mix_finish(float* out, float master, int n){
+  int i = 0;
+#if MIX_W == 4 && !defined(__wasm_simd128__)
+  __m128 g = _mm_set1_ps(master), lo = _mm_set1_ps(-1.0f), hi = _mm_set1_ps(1.0f);
+  for(; i+4<=n; i+=4) _mm_storeu_ps(out+i, _mm_min_ps(hi, _mm_max_ps(lo, _mm_mul_ps(_mm_loadu_ps(out+i), g))));
+#elif MIX_W == 4
+  v128_t g = wasm_f32x4_splat(master), lo = wasm_f32x4_splat(-1.0f), hi = wasm_f32x4_splat(1.0f);
+  for(; i+4<=n; i+=4) wasm_v128_store(out+i, wasm_f32x4_pmin(hi, wasm_f32x4_pmax(lo, wasm_f32x4_mul(wasm_v128_load(out+i), g))));
+#endif
+  for(; i<n; i++){
+    float v = out[i]*master;
+    out[i] = v < -1.0f ? -1.0f : v > 1.0f ? 1.0f : v;
+  }
+}
+
+void mixer_render(Mixer* m, float* out, int frames){
+  memset(out, 0, sizeof(float)*(size_t)frames);
+  for(int i=0;i<MIX_VOICES;i++){
+    MixVoice* x = &m->voice[i];
+    if(!x->src) continue;
+    uint32_t left = x->len - x->pos;
+    int n = left < (uint32_t)frames ? (int)left : frames;
+    mix_add(out, x->src + x->pos, x->gain, n);
+    x->pos += (uint32_t)n;
+    if(x->pos >= x->len) x->src = NULL;
+  }
+  mix_finish(out, m->master, frames);
+}
+
+/* ----------------------------------- Ring -------------------------------- */
+void mix_ring_init(MixRing* r){
+  memset(r, 0, sizeof(*r));
+  r->mask = MIX_RING_FRAMES - 1u;
+}
+
+int mix_ring_fill(MixRing* r, Mixer* m, uint32_t target){
+  if(target > MIX_RING_FRAMES) target = MIX_RING_FRAMES;
+  uint32_t head = r->head;
+  int quanta = 0;
+  /* quanta never straddle the wrap: MIX_RING_FRAMES is a multiple of them */
+  while(head - PONG_LOAD_ACQ(&r->tail) + MIX_QUANTUM <= target){
+    mixer_render(m, r->pcm + (head & r->mask), MIX_QUANTUM);
+    head += MIX_QUANTUM;
+    PONG_STORE_REL(&r->head, head);
+    quanta++;
+  }
+  return quanta;
+}
+
+int mix_ring_pull(MixRing* r, float* out, int frames){
+  uint32_t tail = r->tail, avail = PONG_LOAD_ACQ(&r->head) - tail;
+  int n = avail < (uint32_t)frames ? (int)avail : frames;
+  for(int i=0;i<n;i++) out[i] = r->pcm[(tail + (uint32_t)i) & r->mask];
+  if(n < frames){ memset(out + n, 0, sizeof(float)*(size_t)(frames - n)); r->underruns++; }
+  PONG_STORE_REL(&r->tail, tail + (uint32_t)n);
+  return n;
+}
+
+/* ----------------------------------- WAV --------------------------------- */
+
+int mix_write_wav(const char* path, const float* pcm, uint32_t frames, int rate){
+  FILE* fp = fopen(path, "wb");
+  if(!fp) return 0;
+  uint8_t h[44];
+  memcpy(h, "RIFF", 4); put_u32(h+4, 36u + frames*4u); memcpy(h+8, "WAVEfmt ", 8);
+  put_u32(h+16, 16); put_u16(h+20, 3); put_u16(h+22, 1);           /* IEEE float, mono */
+  put_u32(h+24, (uint32_t)rate); put_u32(h+28, (uint32_t)rate*4u); put_u16(h+32, 4); put_u16(h+34, 32);
+  memcpy(h+36, "data", 4); put_u32(h+40, frames*4u);
+  int ok = fwrite(h, 1, sizeof h, fp)==sizeof h;
+  for(uint32_t i=0;i<frames && ok;i++){
+    uint32_t bits; memcpy(&bits, &pcm[i], 4);
+    uint8_t b[4]; put_u32(b, bits);
+    ok = fwrite(b, 1, 4, fp)==4;
+  }
+  return fclose(fp)==0 && ok;
+}
+
+int mix_parse_wav(const uint8_t* data, size_t len, float** pcm, uint32_t* frames, int* rate){
+  if(len < 12 || memcmp(data, "RIFF", 4) || memcmp(data+8, "WAVE", 4)) return 0;
+  int fmt = 0, chans = 0, bits = 0; uint32_t hz = 0;
+  size_t at = 12;
+  while(at + 8 <= len){
+    const uint8_t* ch = data + at;
+    uint32_t n = get_u32(ch+4);
+    at += 8;
+    if(n > len - at) return 0;
+    if(!memcmp(ch, "fmt ", 4) && n >= 16){
+      fmt = (int)get_u16(data+at); chans = (int)get_u16(data+at+2); hz = get_u32(data+at+4); bits = (int)get_u16(data+at+14);
+    } else if(!memcmp(ch, "data", 4)){
+      if(chans!=1 || !((fmt==3 && bits==32) || (fmt==1 && bits==16))) return 0;
+      uint32_t count = n / (uint32_t)(bits/8);
+      float* out = (float*)malloc(sizeof(float)*(count ? count : 1u));
+      if(!out) return 0;
+      const uint8_t* p = data + at;
+      if(fmt==3) for(uint32_t i=0;i<count;i++){ uint32_t v = get_u32(p + 4u*i); memcpy(&out[i], &v, 4); }
+      else       for(uint32_t i=0;i<count;i++) out[i] = (float)(int16_t)get_u16(p + 2u*i) / 32768.0f;
+      *pcm = out; *frames = count; *rate = (int)hz;
+      return 1;
+    }
+    at += n + (n & 1u);
+  }
+  return 0;
+}
+
+int mix_read_wav(const char* path, float** pcm, uint32_t* frames, int* rate){
+  FILE* fp = fopen(path, "rb");
+  if(!fp) return 0;
+  uint8_t* buf = NULL; size_t len = 0, cap = 0, got;
+  do {
+    if(len == cap){
+      uint8_t* nb = (uint8_t*)realloc(buf, cap ? cap*2 : 65536);
+      if(!nb){ free(buf); fclose(fp); return 0; }
+      buf = nb; cap = cap ? cap*2 : 65536;
+    }
+    got = fread(buf + len, 1, cap - len, fp);
+    len += got;
+  } while(got > 0);
+  fclose(fp);
+  int ok = mix_parse_wav(buf, len, pcm, frames, rate);
+  free(buf);
+  return ok;
+}
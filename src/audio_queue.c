@@ -0,0 +1,79 @@
+/* audio_queue.c — per-frame SFX merge/limit + ring for the JS drain */
+
+#include "audio_queue.h"
+
+#include <string.h>
+
+const char* const AUDIO_SFX_NAME[SFX_COUNT] = {
+  "score_goal", "hit_slow", "hit_medium", "hit_fast", "hit_veryfast",
+  "hit", "bounce_synth", "bounce", "up", "down"
+};
+const uint8_t AUDIO_SFX_VARIANTS[SFX_COUNT] = { 1, 1, 1, 1, 1, 5, 1, 5, 1, 1 };
+
+int audio_ring_pop(AudioRing* r, Sfx* sound, int* layers){
+  if(r->head==r->tail) return 0;
+  uint16_t e = r->slot[r->tail & r->mask];
+  r->tail++;
+  *sound = (Sfx)(e & 0xFFu); *layers = e >> 8;
+  return 1;
+}
+
+static void ring_push(AudioRing* r, Sfx s, int layers){
+  if(r->head - r->tail >= AUDIO_RING_CAP){ r->dropped++; return; }
+  r->slot[r->head & r->mask] = (uint16_t)((unsigned)s | ((unsigned)layers << 8));
+  r->head++;
+}
+
+void audio_queue_init(AudioQueue* q, int voice_budget){
+  memset(q, 0, sizeof(*q));
+  q->ring.mask = AUDIO_RING_CAP - 1u;
+  q->voice_budget = voice_budget>0 ? voice_budget : AUDIO_VOICES_PER_FRAME;
+}
+
+void audio_play(AudioQueue* q, Sfx s, int layers){
+  if((unsigned)s >= SFX_COUNT || layers<=0) return;
+  if(layers>AUDIO_MAX_LAYERS) layers = AUDIO_MAX_LAYERS;
+  q->requests++;
+  if(q->frame[s]){
+    q->merged++;
+    if(layers > q->frame[s]) q->frame[s] = (uint8_t)layers;
+  } else {
+    q->frame[s] = (uint8_t)layers;
+  }
+}
+
+void audio_play_events(AudioQueue* q, const Events* ev){
+  for(int i=0;i<ev->n;i++){
+    const Event* e = &ev->ev[i];
+    switch(e->type){
+      case EV_HIT:
+        audio_play(q, SFX_HIT, 5);
+        if(e->speed<=10) audio_play(q, SFX_HIT_SLOW, 1); else if(e->speed<=12) audio_play(q, SFX_HIT_MEDIUM, 1);
+        else if(e->speed<=16) audio_play(q, SFX_HIT_FAST, 1); else audio_play(q, SFX_HIT_VERYFAST, 1);
+        break;
+      case EV_BOUNCE:
+        audio_play(q, SFX_BOUNCE, 5); audio_play(q, SFX_BOUNCE_SYNTH, 1);
+        break;
+      case EV_GOAL:
+        audio_play(q, SFX_SCORE_GOAL, 1);
+        break;
+      case EV_GAME_OVER:
+        break;
+    }
+  }
+}
+
+int audio_queue_flush(AudioQueue* q){
+  int budget = q->voice_budget, written = 0;
+  for(int s=0;s<SFX_COUNT;s++){
+    int layers = q->frame[s];
+    if(!layers) continue;
+    q->frame[s] = 0;
+    if(layers>budget){ q->limited += (uint32_t)(layers - budget); layers = budget; }
+    if(layers<=0) continue;
+    budget -= layers;
+    ring_push(&q->ring, (Sfx)s, layers);
+    written++;
+  }
+  return written;
+}
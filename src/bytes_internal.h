@@ -0,0 +1,15 @@
+#ifndef BYTES_INTERNAL_H
+#define BYTES_INTERNAL_H
+
+/* Little-endian field access for the byte formats (replays, netplay and
+ * server datagrams, asset packs, WAV files), so they read the same on any
+ * host and in the wasm build. */
+
+#include <stdint.h>
+
+static inline void put_u16(uint8_t* p, uint32_t v){ p[0]=(uint8_t)v; p[1]=(uint8_t)(v>>8); }
+static inline void put_u32(uint8_t* p, uint32_t v){ put_u16(p, v & 0xFFFFu); put_u16(p+2, v>>16); }
+static inline uint32_t get_u16(const uint8_t* p){ return (uint32_t)p[0] | (uint32_t)p[1]<<8; }
+static inline uint32_t get_u32(const uint8_t* p){ return get_u16(p) | get_u16(p+2)<<16; }
+
+#endif /* BYTES_INTERNAL_H */
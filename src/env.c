@@ -0,0 +1,96 @@
+/* env.c — vectorized training environment over the SoA batch engine */
+
+#include "env.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* ------------------------------ Lifetime ------------------------------ */
+PongEnv* pong_env_create(int n, int max_steps){
+  if(n < 1) return NULL;
+  PongEnv* e = (PongEnv*)calloc(1, sizeof(PongEnv));
+  if(!e) return NULL;
+  e->n = n; e->max_steps = max_steps > 0 ? max_steps : 0;
+  e->in       = (Input*)calloc((size_t)n, sizeof(Input));
+  e->score[0] = (int*)calloc((size_t)n, sizeof(int));
+  e->score[1] = (int*)calloc((size_t)n, sizeof(int));
+  e->steps    = (int*)calloc((size_t)n, sizeof(int));
+  if(!e->in || !e->score[0] || !e->score[1] || !e->steps || !sim_batch_init(&e->b, n)){
+    pong_env_destroy(e);
+    return NULL;
+  }
+  return e;
+}
+
+void pong_env_destroy(PongEnv* e){
+  if(!e) return;
+  sim_batch_free(&e->b);
+  free(e->in); free(e->score[0]); free(e->score[1]); free(e->steps);
+  free(e);
+}
+
+void pong_env_bind(PongEnv* e, float* obs, float* reward, float* done){
+  e->obs = obs; e->reward = reward; e->done = done;
+}
+
+void pong_env_bind_truncated(PongEnv* e, float* truncated){ e->truncated = truncated; }
+
+int  pong_env_obs_dim(void){ return ENV_OBS_DIM; }
+long pong_env_episodes(const PongEnv* e){ return e->episodes; }
+
+/* ------------------------------- Lanes -------------------------------- */
+static void lane_new_game(PongEnv* e, int i, uint32_t seed){
+  Game g; sim_init(&g, seed); sim_new_game(&g, 1);
+  sim_batch_load(&e->b, i, &g);
+  e->score[0][i] = e->score[1][i] = 0;
+  e->steps[i] = 0;
+}
+
+static void lane_obs(const PongEnv* e, int i){
+  const SimBatch* b = &e->b;
+  float* o = e->obs + (size_t)i*ENV_OBS_DIM;
+  o[0] = b->ball_x[i] * (2.0f/SIM_WIDTH) - 1.0f;
+  o[1] = b->ball_y[i] * (2.0f/SIM_HEIGHT) - 1.0f;
+  o[2] = b->ball_dx[i];
+  o[3] = b->ball_dy[i];
+  o[4] = (float)b->ball_speed[i] / ENV_SPEED_SCALE;
+  o[5] = b->bat_y[0][i] * (2.0f/SIM_HEIGHT) - 1.0f;
+  o[6] = b->bat_y[1][i] * (2.0f/SIM_HEIGHT) - 1.0f;
+  o[7] = (float)(b->bat_score[0][i] - b->bat_score[1][i]) / (float)SIM_WIN_SCORE;
+}
+
+/* ------------------------------- Step --------------------------------- */
+void pong_env_reset(PongEnv* e, const uint32_t* seeds){
+  for(int i=0;i<e->n;i++){
+    lane_new_game(e, i, seeds ? seeds[i] : (uint32_t)i + 1u);
+    lane_obs(e, i);
+    e->reward[i] = 0.0f; e->done[i] = 0.0f;
+    if(e->truncated) e->truncated[i] = 0.0f;
+  }
+}
+
+void pong_env_step(PongEnv* e, const int32_t* actions){
+  const int n = e->n;
+  for(int i=0;i<n;i++)
+    e->in[i].buttons = actions[i]==ENV_ACT_UP ? IN_P1_UP : actions[i]==ENV_ACT_DOWN ? IN_P1_DOWN : 0u;
+
+  sim_batch_step(&e->b, e->in, NULL);
+
+  SimBatch* b = &e->b;
+  for(int i=0;i<n;i++){
+    int s0 = b->bat_score[0][i], s1 = b->bat_score[1][i];
+    e->reward[i] = (float)((s0 - e->score[0][i]) - (s1 - e->score[1][i]));
+    e->score[0][i] = s0; e->score[1][i] = s1;
+    int ended = b->state[i] != ST_PLAY;
+    int cut = !ended && e->max_steps && ++e->steps[i] >= e->max_steps;
+    int over = ended || cut;
+    e->done[i] = over ? 1.0f : 0.0f;
+    if(e->truncated) e->truncated[i] = cut ? 1.0f : 0.0f;
+    if(over){
+      /* next seed from the finished game's PRNG: deterministic per lane */
+      lane_new_game(e, i, b->rng[i]);
+      e->episodes++;
+    }
+    lane_obs(e, i);
+  }
+}
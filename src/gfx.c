@@ -0,0 +1,108 @@
+/* gfx.c — frame command recording, redundant-state filter, null backend */
+
+#include "gfx.h"
+
+#include <string.h>
+
+/* ------------------------------- Recording ------------------------------ */
+static GfxCmd* cmd_push(GfxFrame* f, GfxCmdType type){
+  if(f->nCmds>=GFX_MAX_CMDS){ f->overflow++; return NULL; }
+  GfxCmd* c = &f->cmds[f->nCmds++];
+  memset(c, 0, sizeof(*c));
+  c->type = (uint32_t)type;
+  return c;
+}
+
+void gfx_frame_begin(GfxFrame* f){ f->nCmds = 0; f->nInst = 0; f->overflow = 0; }
+
+void gfx_clear(GfxFrame* f, const float color[4]){
+  GfxCmd* c = cmd_push(f, GFX_CMD_CLEAR);
+  if(c) memcpy(c->u.color, color, sizeof(c->u.color));
+}
+
+void gfx_set_pipeline(GfxFrame* f, GfxPipeline p){
+  GfxCmd* c = cmd_push(f, GFX_CMD_SET_PIPELINE);
+  if(c) c->u.pipeline = (uint32_t)p;
+}
+
+void gfx_set_resolution(GfxFrame* f, float w, float h){
+  GfxCmd* c = cmd_push(f, GFX_CMD_SET_RESOLUTION);
+  if(c){ c->u.res.w = w; c->u.res.h = h; }
+}
+
+ShapeInstance* gfx_shapes_reserve(GfxFrame* f, int* cap){
+  *cap = GFX_MAX_INSTANCES - f->nInst;
+  return &f->inst[f->nInst];
+}
+
+void gfx_shapes_commit(GfxFrame* f, int n){
+  if(n<=0) return;
+  GfxCmd* c = cmd_push(f, GFX_CMD_DRAW_SHAPES);
+  if(!c) return;
+  c->u.draw.first = (uint32_t)f->nInst;
+  c->u.draw.count = (uint32_t)n;
+  f->nInst += n;
+}
+
+void gfx_draw_shapes(GfxFrame* f, const ShapeInstance* s, int n){
+  int cap; ShapeInstance* dst = gfx_shapes_reserve(f, &cap);
+  if(n > cap){ f->overflow += n - cap; n = cap; }
+  if(n<=0) return;
+  memcpy(dst, s, sizeof(ShapeInstance)*(size_t)n);
+  gfx_shapes_commit(f, n);
+}
+
+/* ------------------------------ State Cache ----------------------------- */
+void gfx_state_reset(GfxStateCache* cache){
+  cache->pipeline = 0; cache->res_w = -1.0f; cache->res_h = -1.0f;
+  for(int i=0;i<4;i++) cache->clear[i] = -1.0f;
+}
+
+int gfx_state_apply(GfxStateCache* cache, const GfxCmd* c){
+  switch(c->type){
+    case GFX_CMD_CLEAR:
+      if(!memcmp(cache->clear, c->u.color, sizeof(cache->clear))) return 0;
+      memcpy(cache->clear, c->u.color, sizeof(cache->clear));
+      return 1;
+    case GFX_CMD_SET_PIPELINE:
+      if(cache->pipeline==c->u.pipeline) return 0;
+      cache->pipeline = c->u.pipeline;
+      return 1;
+    case GFX_CMD_SET_RESOLUTION:
+      if(cache->res_w==c->u.res.w && cache->res_h==c->u.res.h) return 0;
+      cache->res_w = c->u.res.w; cache->res_h = c->u.res.h;
+      return 1;
+    default:
+      return 0;
+  }
+}
+
+/* ------------------------------ Null Backend ---------------------------- */
+static void null_submit(GfxBackend* b, const GfxFrame* f){
+  memset(&b->stats, 0, sizeof(b->stats));
+  for(int i=0;i<f->nCmds;i++){
+    const GfxCmd* c = &f->cmds[i];
+    switch(c->type){
+      case GFX_CMD_CLEAR:
+      case GFX_CMD_SET_PIPELINE:
+        b->stats.state_changes += gfx_state_apply(&b->cache, c);
+        break;
+      case GFX_CMD_SET_RESOLUTION:
+        b->stats.uniform_uploads += gfx_state_apply(&b->cache, c);
+        break;
+      case GFX_CMD_DRAW_SHAPES:
+        b->stats.draw_calls++;
+        b->stats.instances += (int)c->u.draw.count;
+        b->stats.vertices  += 6*(int)c->u.draw.count;
+        b->stats.bytes_uploaded += (int)(c->u.draw.count*sizeof(ShapeInstance));
+        break;
+    }
+  }
+}
+
+void gfx_null_init(GfxBackend* b){
+  memset(b, 0, sizeof(*b));
+  b->name = "null";
+  b->submit = null_submit;
+  gfx_state_reset(&b->cache);
+}
@@ -0,0 +1,204 @@
+/* gfx_gles.c — GLES3 / WebGL2 backend for recorded GfxFrames
+ * Owns the shape program and the instanced VAO (unit quad + per-instance
+ * ShapeInstance stream). Replays commands in order; redundant clear colour,
+ * program/VAO binds and uniform uploads are filtered by the state cache.
+ * Browser build only.
+ */
+
+#include <GLES3/gl3.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "gfx.h"
+#include "hud.h"
+
+static GLuint prog = 0;
+static GLint  uResolution, uAtlas;
+static GLuint texAtlas = 0;  /* HUD font, R8, bound to unit 0 for good */
+
+static GLuint vaoShapes = 0, vboQuad = 0, vboInst = 0;
+static uint32_t instBase = 0;  /* instance the attrib pointers start at */
+
+/* One unit quad per ShapeInstance, grown by 1px so the AA edge fits. */
+static const char* VERT_SRC =
+"#version 300 es\n"
+"layout(location=0) in vec2 aCorner;\n"
+"layout(location=1) in vec4 iRect;   /* center.xy, size.wh (px) */\n"
+"layout(location=2) in vec4 iColor;\n"
+"layout(location=3) in vec2 iParams; /* outline px, kind */\n"
+"uniform vec2 uResolution;\n"
+"out vec2 vLocal; out vec2 vHalf; out vec4 vColor; out vec2 vParams;\n"
+"void main(){\n"
+"  vec2 ext = iRect.zw + 2.0;\n"
+"  vLocal = aCorner * ext; vHalf = iRect.zw * 0.5;\n"
+"  vColor = iColor; vParams = iParams;\n"
+"  vec2 pos = iRect.xy + vLocal; /* pixels */\n"
+"  vec2 ndc = (pos / uResolution * 2.0 - 1.0) * vec2(1.0, -1.0);\n"
+"  gl_Position = vec4(ndc,0.0,1.0);\n"
+"}\n";
+
+/* Signed distance per kind: 0 rect, 1 disc, 2 ring. Coverage = 0.5 - d.
+ * Kind 3 is a font cell: nearest texel of the atlas (16 cells per row,
+ * 6x8 px each, glyph code in vParams.x). gfx_soft.c mirrors this; keep
+ * them in step. */
+static const char* FRAG_SRC =
+"#version 300 es\n"
+"precision mediump float;\n"
+"uniform sampler2D uAtlas;\n"
+"in vec2 vLocal; in vec2 vHalf; in vec4 vColor; in vec2 vParams;\n"
+"out vec4 outColor;\n"
+"void main(){\n"
+"  float a;\n"
+"  if(vParams.y > 2.5){\n"
+"    vec2 uv = (vLocal + vHalf) / (2.0*vHalf);\n"
+"    if(any(lessThan(uv, vec2(0.0))) || any(greaterThanEqual(uv, vec2(1.0)))) discard;\n"
+"    int c = int(vParams.x) - 32;\n"
+"    ivec2 px = ivec2(c % 16, c / 16) * ivec2(6, 8) + ivec2(uv * vec2(5.0, 7.0));\n"
+"    a = texelFetch(uAtlas, px, 0).r;\n"
+"  } else {\n"
+"    float d;\n"
+"    if(vParams.y < 0.5){ vec2 q = abs(vLocal) - vHalf; d = length(max(q,0.0)) + min(max(q.x,q.y),0.0); }\n"
+"    else if(vParams.y < 1.5){ d = length(vLocal) - vHalf.x; }\n"
+"    else { d = abs(length(vLocal) - vHalf.x) - 0.5*vParams.x; }\n"
+"    a = clamp(0.5 - d, 0.0, 1.0);\n"
+"  }\n"
+"  if(a <= 0.0) discard;\n"
+"  outColor = vec4(vColor.rgb, vColor.a * a);\n"
+"}\n";
+
+static GLuint compile(GLenum type, const char* src){
+  GLuint sh = glCreateShader(type);
+  glShaderSource(sh, 1, &src, NULL);
+  glCompileShader(sh);
+#ifdef DEBUG
+  GLint ok=0; glGetShaderiv(sh, GL_COMPILE_STATUS, &ok);
+  if(!ok){ char log[1024]; GLsizei n=0; glGetShaderInfoLog(sh,1024,&n,log); printf("shader:\n%.*s\n",n,log); }
+#endif
+  return sh;
+}
+
+static int makeProgram(void){
+  GLuint vs = compile(GL_VERTEX_SHADER, VERT_SRC);
+  GLuint fs = compile(GL_FRAGMENT_SHADER, FRAG_SRC);
+  prog = glCreateProgram();
+  glAttachShader(prog, vs); glAttachShader(prog, fs);
+  glLinkProgram(prog);
+  glDeleteShader(vs); glDeleteShader(fs);
+#ifdef DEBUG
+  GLint ok=0; glGetProgramiv(prog, GL_LINK_STATUS, &ok);
+  if(!ok){ char log[1024]; GLsizei n=0; glGetProgramInfoLog(prog,1024,&n,log); printf("program:\n%.*s\n",n,log); return 0; }
+#endif
+  uResolution = glGetUniformLocation(prog, "uResolution");
+  uAtlas      = glGetUniformLocation(prog, "uAtlas");
+  return 1;
+}
+
+static void makeAtlas(void){
+  if(texAtlas) return;
+  static uint8_t texels[HUD_ATLAS_W*HUD_ATLAS_H];
+  hud_font_atlas(texels);
+  glGenTextures(1, &texAtlas);
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, texAtlas);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, HUD_ATLAS_W, HUD_ATLAS_H, 0, GL_RED, GL_UNSIGNED_BYTE, texels);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+/* WebGL2 has no base-instance draw: point the instance attribs at `first`
+ * instead. Expects vaoShapes and vboInst bound. */
+static void bindInstances(uint32_t first){
+  if(first==instBase) return;
+  const GLsizei stride = sizeof(ShapeInstance);
+  const size_t at = (size_t)first*sizeof(ShapeInstance);
+  glVertexAttribPointer(1,4,GL_FLOAT,GL_FALSE,stride,(void*)(at));
+  glVertexAttribPointer(2,4,GL_FLOAT,GL_FALSE,stride,(void*)(at + 4*sizeof(float)));
+  glVertexAttribPointer(3,2,GL_FLOAT,GL_FALSE,stride,(void*)(at + 8*sizeof(float)));
+  instBase = first;
+}
+
+static void makeShapeVAO(void){
+  if(vaoShapes) return;
+  const float quad[] = {
+    -0.5f,-0.5f,  -0.5f, 0.5f,   0.5f, 0.5f,
+    -0.5f,-0.5f,   0.5f, 0.5f,   0.5f,-0.5f
+  };
+  glGenVertexArrays(1,&vaoShapes);
+  glGenBuffers(1,&vboQuad);
+  glGenBuffers(1,&vboInst);
+  glBindVertexArray(vaoShapes);
+
+  glBindBuffer(GL_ARRAY_BUFFER, vboQuad);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(0,2,GL_FLOAT,GL_FALSE,2*sizeof(float),(void*)0);
+
+  /* sized for a whole frame; the buffer stays bound to the VAO */
+  glBindBuffer(GL_ARRAY_BUFFER, vboInst);
+  glBufferData(GL_ARRAY_BUFFER, GFX_MAX_INSTANCES*sizeof(ShapeInstance), NULL, GL_DYNAMIC_DRAW);
+  glEnableVertexAttribArray(1);
+  glEnableVertexAttribArray(2);
+  glEnableVertexAttribArray(3);
+  instBase = 1; bindInstances(0);
+  glVertexAttribDivisor(1,1); glVertexAttribDivisor(2,1); glVertexAttribDivisor(3,1);
+}
+
+static void gles_submit(GfxBackend* b, const GfxFrame* f){
+  memset(&b->stats, 0, sizeof(b->stats));
+
+  /* all instance data for the frame goes up in one call */
+  if(f->nInst>0){
+    glBindBuffer(GL_ARRAY_BUFFER, vboInst);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)((size_t)f->nInst*sizeof(ShapeInstance)), f->inst);
+    b->stats.bytes_uploaded = (int)((size_t)f->nInst*sizeof(ShapeInstance));
+  }
+
+  for(int i=0;i<f->nCmds;i++){
+    const GfxCmd* c = &f->cmds[i];
+    switch(c->type){
+      case GFX_CMD_CLEAR:
+        if(gfx_state_apply(&b->cache, c)){
+          glClearColor(c->u.color[0], c->u.color[1], c->u.color[2], c->u.color[3]);
+          b->stats.state_changes++;
+        }
+        glClear(GL_COLOR_BUFFER_BIT);
+        break;
+      case GFX_CMD_SET_PIPELINE:
+        if(gfx_state_apply(&b->cache, c)){
+          glUseProgram(prog);
+          glBindVertexArray(vaoShapes);
+          b->stats.state_changes++;
+        }
+        break;
+      case GFX_CMD_SET_RESOLUTION:
+        if(gfx_state_apply(&b->cache, c)){
+          glUniform2f(uResolution, c->u.res.w, c->u.res.h);
+          b->stats.uniform_uploads++;
+        }
+        break;
+      case GFX_CMD_DRAW_SHAPES:
+        if(c->u.draw.first!=instBase){ glBindBuffer(GL_ARRAY_BUFFER, vboInst); bindInstances(c->u.draw.first); b->stats.state_changes++; }
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 6, (GLsizei)c->u.draw.count);
+        b->stats.draw_calls++;
+        b->stats.instances += (int)c->u.draw.count;
+        b->stats.vertices  += 6*(int)c->u.draw.count;
+        break;
+    }
+  }
+}
+
+int gfx_gles_init(GfxBackend* b){
+  memset(b, 0, sizeof(*b));
+  b->name = "gles";
+  b->submit = gles_submit;
+  gfx_state_reset(&b->cache);
+  if(!makeProgram()) return 0;
+  makeShapeVAO();
+  makeAtlas();
+  glUseProgram(prog);
+  glUniform1i(uAtlas, 0);
+  return 1;
+}
@@ -0,0 +1,144 @@
+/* gfx_soft.c — CPU software rasterizer backend
+ * Mirrors the GLES shape shader: per-pixel signed distance at the pixel
+ * centre, coverage = clamp(0.5 - d), then GL_SRC_ALPHA/ONE_MINUS_SRC_ALPHA
+ * blending on all four channels. Meant for golden images and for profiling
+ * the render path on machines without a GPU, not for speed.
+ */
+
+#include "gfx.h"
+#include "hud.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint8_t to_u8(float v){
+  if(v<=0.0f) return 0;
+  if(v>=1.0f) return 255;
+  return (uint8_t)(v*255.0f + 0.5f);
+}
+
+/* Glyph cells: nearest texel of the 5x7 font, like texelFetch() in the
+ * shader. Returns coverage 0 or 1. */
+static float glyph_cov(const ShapeInstance* s, float lx, float ly){
+  float u = (lx + s->w*0.5f)/s->w, v = (ly + s->h*0.5f)/s->h;
+  if(u<0.0f || v<0.0f || u>=1.0f || v>=1.0f) return 0.0f;
+  return (float)hud_font_bit((int)s->outline, (int)(u*(float)HUD_FONT_W), (int)(v*(float)HUD_FONT_H));
+}
+
+/* Same distance functions as FRAG_SRC in gfx_gles.c. */
+static float shape_dist(const ShapeInstance* s, float lx, float ly){
+  float hx = s->w*0.5f, hy = s->h*0.5f;
+  if(s->kind < 0.5f){
+    float qx = fabsf(lx) - hx, qy = fabsf(ly) - hy;
+    float ox = fmaxf(qx, 0.0f), oy = fmaxf(qy, 0.0f);
+    return sqrtf(ox*ox + oy*oy) + fminf(fmaxf(qx, qy), 0.0f);
+  }
+  float len = sqrtf(lx*lx + ly*ly);
+  if(s->kind < 1.5f) return len - hx;
+  return fabsf(len - hx) - 0.5f*s->outline;
+}
+
+static void raster_shape(GfxSoft* g, const ShapeInstance* s, float sx, float sy){
+  /* quad footprint in logical px (size + 1px AA margin per side) -> image px */
+  float ex = s->w*0.5f + 1.0f, ey = s->h*0.5f + 1.0f;
+  int x0 = (int)floorf((s->x - ex)/sx), x1 = (int)ceilf((s->x + ex)/sx);
+  int y0 = (int)floorf((s->y - ey)/sy), y1 = (int)ceilf((s->y + ey)/sy);
+  if(x0<0) x0 = 0;
+  if(y0<0) y0 = 0;
+  if(x1>g->w) x1 = g->w;
+  if(y1>g->h) y1 = g->h;
+
+  for(int py=y0; py<y1; py++){
+    uint8_t* row = g->rgba + (size_t)py*(size_t)g->w*4u;
+    float ly = ((float)py + 0.5f)*sy - s->y;
+    for(int px=x0; px<x1; px++){
+      float lx = ((float)px + 0.5f)*sx - s->x;
+      float cov = s->kind > 2.5f ? glyph_cov(s, lx, ly) : 0.5f - shape_dist(s, lx, ly);
+      if(cov<=0.0f) continue;
+      if(cov>1.0f) cov = 1.0f;
+      float a = s->color[3]*cov;
+      uint8_t* d = row + px*4;
+      for(int k=0;k<3;k++) d[k] = to_u8(s->color[k]*a + (d[k]/255.0f)*(1.0f-a));
+      d[3] = to_u8(a*a + (d[3]/255.0f)*(1.0f-a));
+    }
+  }
+}
+
+static void soft_submit(GfxBackend* b, const GfxFrame* f){
+  GfxSoft* g = (GfxSoft*)b;
+  memset(&b->stats, 0, sizeof(b->stats));
+  float sx = 1.0f, sy = 1.0f;  /* logical px per image px */
+  if(b->cache.res_w>0.0f){ sx = b->cache.res_w/(float)g->w; sy = b->cache.res_h/(float)g->h; }
+
+  for(int i=0;i<f->nCmds;i++){
+    const GfxCmd* c = &f->cmds[i];
+    switch(c->type){
+      case GFX_CMD_CLEAR: {
+        b->stats.state_changes += gfx_state_apply(&b->cache, c);
+        uint8_t px[4] = { to_u8(c->u.color[0]), to_u8(c->u.color[1]), to_u8(c->u.color[2]), to_u8(c->u.color[3]) };
+        for(int p=0;p<g->w*g->h;p++) memcpy(g->rgba + (size_t)p*4u, px, 4);
+      } break;
+      case GFX_CMD_SET_PIPELINE:
+        b->stats.state_changes += gfx_state_apply(&b->cache, c);
+        break;
+      case GFX_CMD_SET_RESOLUTION:
+        b->stats.uniform_uploads += gfx_state_apply(&b->cache, c);
+        sx = c->u.res.w/(float)g->w; sy = c->u.res.h/(float)g->h;
+        break;
+      case GFX_CMD_DRAW_SHAPES:
+        for(uint32_t k=0;k<c->u.draw.count;k++) raster_shape(g, &f->inst[c->u.draw.first+k], sx, sy);
+        b->stats.draw_calls++;
+        b->stats.instances += (int)c->u.draw.count;
+        b->stats.vertices  += 6*(int)c->u.draw.count;
+        b->stats.bytes_uploaded += (int)(c->u.draw.count*sizeof(ShapeInstance));
+        break;
+    }
+  }
+}
+
+int gfx_soft_init(GfxSoft* s, int w, int h){
+  memset(s, 0, sizeof(*s));
+  s->rgba = (uint8_t*)calloc((size_t)w*(size_t)h, 4u);
+  if(!s->rgba) return 0;
+  s->w = w; s->h = h;
+  s->base.name = "soft";
+  s->base.submit = soft_submit;
+  gfx_state_reset(&s->base.cache);
+  return 1;
+}
+
+void gfx_soft_free(GfxSoft* s){
+  free(s->rgba);
+  s->rgba = NULL;
+}
+
+/* --------------------------------- PAM ---------------------------------- */
+int gfx_soft_write_pam(const GfxSoft* s, const char* path){
+  FILE* fp = fopen(path, "wb");
+  if(!fp) return 0;
+  fprintf(fp, "P7\nWIDTH %d\nHEIGHT %d\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n", s->w, s->h);
+  size_t n = (size_t)s->w*(size_t)s->h*4u;
+  int ok = fwrite(s->rgba, 1, n, fp)==n;
+  return fclose(fp)==0 && ok;
+}
+
+int gfx_soft_read_pam(const char* path, int* w, int* h, uint8_t** rgba){
+  FILE* fp = fopen(path, "rb");
+  if(!fp) return 0;
+  char line[128]; int W=0, H=0, D=0, M=0;
+  if(!fgets(line, sizeof line, fp) || strncmp(line, "P7", 2)!=0){ fclose(fp); return 0; }
+  while(fgets(line, sizeof line, fp)){
+    if(!strncmp(line, "ENDHDR", 6)) break;
+    sscanf(line, "WIDTH %d", &W); sscanf(line, "HEIGHT %d", &H);
+    sscanf(line, "DEPTH %d", &D); sscanf(line, "MAXVAL %d", &M);
+  }
+  if(W<=0 || H<=0 || D!=4 || M!=255){ fclose(fp); return 0; }
+  size_t n = (size_t)W*(size_t)H*4u;
+  uint8_t* buf = (uint8_t*)malloc(n);
+  if(!buf || fread(buf, 1, n, fp)!=n){ free(buf); fclose(fp); return 0; }
+  fclose(fp);
+  *w = W; *h = H; *rgba = buf;
+  return 1;
+}
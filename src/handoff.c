@@ -0,0 +1,60 @@
+/* handoff.c — triple buffer + SPSC event ring between sim and render */
+
+#include "handoff.h"
+
+#include <string.h>
+
+#include "pong_atomic.h"
+
+/* ------------------------------ Triple buffer ---------------------------- */
+void triple_init(TripleBuf* t, void* a, void* b, void* c){
+  t->slot[0] = a; t->slot[1] = b; t->slot[2] = c;
+  t->back = 0; t->mid = 1; t->front = 2;
+  t->has_front = 0;
+  t->published = t->taken = 0;
+}
+
+void* triple_back(TripleBuf* t){ return t->slot[t->back]; }
+
+void triple_publish(TripleBuf* t){
+  /* release: the slot's contents before the index; acquire: whatever the
+   * reader was done with before it swapped this slot out */
+  t->back = PONG_XCHG(&t->mid, t->back | TRIPLE_FRESH) & 3;
+  t->published++;
+}
+
+const void* triple_take(TripleBuf* t, int* fresh){
+  int got = 0;
+  if(PONG_LOAD_RLX(&t->mid) & TRIPLE_FRESH){
+    /* only the reader clears FRESH, so the exchange returns it set */
+    t->front = PONG_XCHG(&t->mid, t->front) & 3;
+    t->has_front = 1; t->taken++;
+    got = 1;
+  }
+  if(fresh) *fresh = got;
+  return t->has_front ? t->slot[t->front] : NULL;
+}
+
+/* ------------------------------- Event ring ------------------------------ */
+void event_ring_init(EventRing* r){ memset(r, 0, sizeof(*r)); }
+
+int event_ring_push(EventRing* r, const Event* e){
+  uint32_t head = r->head;                 /* only we write it */
+  uint32_t tail = PONG_LOAD_ACQ(&r->tail);
+  if(head - tail >= EVENT_RING_CAP){ r->dropped++; return 0; }
+  r->ev[head & (EVENT_RING_CAP-1u)] = *e;
+  PONG_STORE_REL(&r->head, head + 1u);
+  return 1;
+}
+
+uint32_t event_ring_count(const EventRing* r){
+  return PONG_LOAD_ACQ(&r->head) - PONG_LOAD_ACQ(&r->tail);
+}
+
+int event_ring_pop(EventRing* r, Event* e){
+  uint32_t tail = r->tail;                 /* only we write it */
+  if(tail == PONG_LOAD_ACQ(&r->head)) return 0;
+  *e = r->ev[tail & (EVENT_RING_CAP-1u)];
+  PONG_STORE_REL(&r->tail, tail + 1u);
+  return 1;
+}
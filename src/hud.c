@@ -0,0 +1,152 @@
+/* hud.c — HUD state with dirty tracking + in-canvas glyph layout */
+
+#include "hud.h"
+
+#include <string.h>
+
+/* ------------------------------- State ---------------------------------- */
+void hud_init(Hud* h){
+  memset(h, 0, sizeof(*h));
+  h->players = 1;
+  h->score_rgb[0] = h->score_rgb[1] = 0xFFFFFFu;
+  h->dirty = HUD_DIRTY_ALL;
+}
+
+static void set_text(Hud* h, char* dst, const char* s, uint32_t bit){
+  if(!s) s = "";
+  if(!strncmp(dst, s, HUD_TEXT_MAX-1)) return;
+  strncpy(dst, s, HUD_TEXT_MAX-1);
+  dst[HUD_TEXT_MAX-1] = '\0';
+  h->dirty |= bit;
+}
+
+void hud_set_title(Hud* h, const char* s){ set_text(h, h->title, s, HUD_DIRTY_TITLE); }
+void hud_set_msg(Hud* h, const char* s){ set_text(h, h->msg, s, HUD_DIRTY_MSG); }
+
+void hud_set_players(Hud* h, int n){
+  if(h->players==n) return;
+  h->players = n; h->dirty |= HUD_DIRTY_MODE;
+}
+
+void hud_set_score(Hud* h, int left, int right){
+  if(h->score[0]==left && h->score[1]==right) return;
+  h->score[0] = left; h->score[1] = right; h->dirty |= HUD_DIRTY_SCORE;
+}
+
+static uint32_t rgb(const float c[4]){
+  uint32_t r = (uint32_t)(c[0]*255.0f + 0.5f), g = (uint32_t)(c[1]*255.0f + 0.5f), b = (uint32_t)(c[2]*255.0f + 0.5f);
+  return (r<<16) | (g<<8) | b;
+}
+
+void hud_set_score_colors(Hud* h, const float left[4], const float right[4]){
+  uint32_t l = rgb(left), r = rgb(right);
+  if(h->score_rgb[0]==l && h->score_rgb[1]==r) return;
+  h->score_rgb[0] = l; h->score_rgb[1] = r; h->dirty |= HUD_DIRTY_COLORS;
+}
+
+void hud_sync_game(Hud* h, const Game* g){
+  int out = g->ball.x<0 || g->ball.x>SIM_WIDTH;
+  hud_set_score(h, g->bats[0].score, g->bats[1].score);
+  hud_set_score_colors(h, (g->bats[1].timer>0 && out) ? COL_RED  : COL_WHITE,
+                          (g->bats[0].timer>0 && out) ? COL_BLUE : COL_WHITE);
+}
+
+uint32_t hud_take_dirty(Hud* h){
+  uint32_t d = h->dirty;
+  h->dirty = 0;
+  return d;
+}
+
+/* ------------------------------ Canvas HUD ------------------------------- */
+/* Integer scales keep the bitmap font crisp; sizes follow the DOM CSS
+ * (44px title, 40px scores, 18px mode/message). */
+#define TITLE_SCALE 6
+#define SCORE_SCALE 5
+#define TEXT_SCALE  2
+#define TITLE_Y     30.0f
+#define ROW_Y       80.0f
+#define MSG_Y       116.0f
+
+static const float TEXT_COL[4] = { 1.0f, 1.0f, 1.0f, 0.95f };
+static const float BOX_COL[4]  = { 0.0f, 0.0f, 0.0f, 0.5f };
+
+/* Next glyph code of a UTF-8 string; any multi-byte sequence is one '-'. */
+static int next_glyph(const char** p){
+  unsigned char c = (unsigned char)**p;
+  if(!c) return 0;
+  (*p)++;
+  if(c<0x80) return c;
+  while(((unsigned char)**p & 0xC0u)==0x80u) (*p)++;
+  return '-';
+}
+
+static int text_len(const char* s){
+  int n = 0;
+  while(next_glyph(&s)) n++;
+  return n;
+}
+
+static float text_width(const char* s, int scale){
+  int n = text_len(s);
+  return n ? (float)(n*HUD_CELL_W*scale - scale) : 0.0f;
+}
+
+static int put_text(ShapeInstance* out, int n, int cap, const char* s,
+                    float left, float cy, int scale, const float col[4]){
+  float w = (float)(HUD_FONT_W*scale), hgt = (float)(HUD_FONT_H*scale);
+  float x = left + w*0.5f;
+  int c;
+  while((c = next_glyph(&s))!=0){
+    if(c!=' ' && n<cap){
+      ShapeInstance* g = &out[n++];
+      g->x = x; g->y = cy; g->w = w; g->h = hgt;
+      memcpy(g->color, col, sizeof g->color);
+      g->outline = (float)c; g->kind = (float)SHAPE_GLYPH;
+    }
+    x += (float)(HUD_CELL_W*scale);
+  }
+  return n;
+}
+
+static void unpack(uint32_t c, float out[4]){
+  out[0] = (float)((c>>16)&255u)/255.0f; out[1] = (float)((c>>8)&255u)/255.0f;
+  out[2] = (float)(c&255u)/255.0f;       out[3] = 1.0f;
+}
+
+static void two_digits(char out[3], int v){
+  if(v<0) v = 0;
+  if(v>99) v = 99;
+  out[0] = (char)('0' + v/10); out[1] = (char)('0' + v%10); out[2] = '\0';
+}
+
+int hud_build(const Hud* h, ShapeInstance* out, int cap){
+  int n = 0;
+  const float cx = SIM_WIDTH/2.0f;
+
+  n = put_text(out, n, cap, h->title, cx - text_width(h->title, TITLE_SCALE)*0.5f, TITLE_Y, TITLE_SCALE, TEXT_COL);
+
+  /* "1 Player  [07:03]" centred as one row */
+  const char* mode = h->players==1 ? "1 Player" : "2 Players";
+  char l[3], r[3]; two_digits(l, h->score[0]); two_digits(r, h->score[1]);
+  const float pad = 12.0f, gap = 16.0f;
+  const float digits = text_width("00", SCORE_SCALE), colon = text_width(":", SCORE_SCALE);
+  const float sep = (float)(2*SCORE_SCALE);
+  const float box_w = 2.0f*pad + 2.0f*digits + colon + 2.0f*sep;
+  const float mode_w = text_width(mode, TEXT_SCALE);
+  float x = cx - (mode_w + gap + box_w)*0.5f;
+  n = put_text(out, n, cap, mode, x, ROW_Y, TEXT_SCALE, TEXT_COL);
+  x += mode_w + gap;
+  if(n<cap){
+    ShapeInstance* b = &out[n++];
+    b->x = x + box_w*0.5f; b->y = ROW_Y; b->w = box_w; b->h = (float)(HUD_FONT_H*SCORE_SCALE) + 8.0f;
+    memcpy(b->color, BOX_COL, sizeof b->color); b->outline = 0.0f; b->kind = (float)SHAPE_RECT;
+  }
+  float cl[4], cr[4]; unpack(h->score_rgb[0], cl); unpack(h->score_rgb[1], cr);
+  x += pad;
+  n = put_text(out, n, cap, l, x, ROW_Y, SCORE_SCALE, cl);   x += digits + sep;
+  n = put_text(out, n, cap, ":", x, ROW_Y, SCORE_SCALE, TEXT_COL); x += colon + sep;
+  n = put_text(out, n, cap, r, x, ROW_Y, SCORE_SCALE, cr);
+
+  n = put_text(out, n, cap, h->msg, cx - text_width(h->msg, TEXT_SCALE)*0.5f, MSG_Y, TEXT_SCALE, TEXT_COL);
+  return n;
+}
@@ -0,0 +1,109 @@
+/* input.c — key map, timestamped SPSC input ring, per-step consumption,
+ * key-to-submit latency histogram */
+
+#include "input.h"
+
+#include "pong_atomic.h"
+
+#include <string.h>
+
+/* ------------------------------- Key map -------------------------------- */
+enum { KC_SPACE = 32, KC_UP = 38, KC_DOWN = 40, KC_A = 65, KC_K = 75, KC_M = 77, KC_Z = 90 };
+
+void input_keymap_default(InputKeyMap* m){
+  memset(m, 0, sizeof(*m));
+  input_keymap_bind(m, KC_UP,    IN_P1_UP   | ACT_MENU_UP);
+  input_keymap_bind(m, KC_DOWN,  IN_P1_DOWN | ACT_MENU_DOWN);
+  input_keymap_bind(m, KC_A,     IN_P1_UP);
+  input_keymap_bind(m, KC_Z,     IN_P1_DOWN);
+  input_keymap_bind(m, KC_K,     IN_P2_UP);
+  input_keymap_bind(m, KC_M,     IN_P2_DOWN);
+  input_keymap_bind(m, KC_SPACE, ACT_START);
+}
+
+void input_keymap_bind(InputKeyMap* m, unsigned keyCode, uint32_t actions){
+  if(keyCode<INPUT_KEYS) m->action[keyCode] = actions;
+}
+
+/* --------------------------------- Ring ---------------------------------- */
+void input_ring_init(InputRing* r){ memset(r, 0, sizeof(*r)); }
+
+int input_key_event(InputRing* r, const InputKeyMap* m, unsigned keyCode, int down, double t_ms){
+  if(keyCode>=INPUT_KEYS || !m->action[keyCode]) return 0;
+  uint32_t head = r->head;                 /* only we write it */
+  uint32_t tail = PONG_LOAD_ACQ(&r->tail);
+  if(head - tail >= INPUT_RING_CAP){ r->dropped++; return 1; }
+  InputEvent* e = &r->ev[head & (INPUT_RING_CAP-1u)];
+  e->t_ms = t_ms; e->actions = m->action[keyCode];
+  e->key = (uint16_t)keyCode; e->down = (uint8_t)(down!=0); e->pad_ = 0;
+  PONG_STORE_REL(&r->head, head + 1u);
+  return 1;
+}
+
+/* ------------------------------- Latency -------------------------------- */
+void input_latency_reset(InputLatency* h){ memset(h, 0, sizeof(*h)); }
+
+void input_latency_add(InputLatency* h, double ms){
+  if(ms<0.0) ms = 0.0;
+  int b = (int)(ms / INPUT_LAT_BUCKET_MS);
+  if(b>=INPUT_LAT_BUCKETS) b = INPUT_LAT_BUCKETS-1;
+  h->bucket[b]++;
+  h->count++; h->sum_ms += ms;
+  if(ms>h->max_ms) h->max_ms = ms;
+}
+
+double input_latency_percentile(const InputLatency* h, double p){
+  if(!h->count) return 0.0;
+  double want = p/100.0 * (double)h->count;
+  uint32_t seen = 0;
+  for(int b=0;b<INPUT_LAT_BUCKETS-1;b++){
+    seen += h->bucket[b];
+    if((double)seen >= want && seen>0){
+      double edge = (double)(b+1)*INPUT_LAT_BUCKET_MS;
+      return edge < h->max_ms ? edge : h->max_ms;
+    }
+  }
+  return h->max_ms;
+}
+
+double input_latency_mean(const InputLatency* h){
+  return h->count ? h->sum_ms/(double)h->count : 0.0;
+}
+
+/* -------------------------------- State ---------------------------------- */
+void input_state_init(InputState* s){ memset(s, 0, sizeof(*s)); }
+
+static void hold(InputState* s, uint32_t actions, int delta){
+  for(int b=0;b<32;b++){
+    if(!(actions & (1u<<b))) continue;
+    if(delta>0) s->holders[b]++;
+    else if(s->holders[b]) s->holders[b]--;
+    if(s->holders[b]) s->held |= 1u<<b; else s->held &= ~(1u<<b);
+  }
+}
+
+Input input_step(InputState* s, InputRing* r, double until_ms, uint32_t* pressed){
+  uint32_t tail = r->tail;                 /* only we write it */
+  uint32_t head = PONG_LOAD_ACQ(&r->head);
+  uint32_t during = 0;
+  for(; tail!=head; tail++){
+    const InputEvent* e = &r->ev[tail & (INPUT_RING_CAP-1u)];
+    if(e->t_ms > until_ms) break;          /* belongs to a later step */
+    if(e->down){
+      if(!s->down[e->key]){ s->down[e->key] = 1; hold(s, e->actions, +1); during |= e->actions; }
+    } else if(s->down[e->key]){
+      s->down[e->key] = 0; hold(s, e->actions, -1);
+    }
+    if(s->nPending<INPUT_MAX_PENDING) s->pending[s->nPending++] = e->t_ms;
+  }
+  PONG_STORE_REL(&r->tail, tail);
+
+  if(pressed) *pressed = during;
+  Input in; in.buttons = (s->held | during) & INPUT_SIM_MASK;
+  return in;
+}
+
+void input_frame_submitted(InputState* s, double now_ms){
+  for(int i=0;i<s->nPending;i++) input_latency_add(&s->latency, now_ms - s->pending[i]);
+  s->nPending = 0;
+}
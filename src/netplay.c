@@ -0,0 +1,200 @@
+/* netplay.c — rollback session, packet codec, in-process loopback link */
+
+#include "netplay.h"
+
+#include <string.h>
+
+#include "bytes_internal.h"
+
+#define RING_MASK (NET_RING-1)
+#define NO_ROLLBACK INT32_MAX
+
+/* ------------------------------- Loopback ------------------------------- */
+static double loop_uniform(NetLoopback* l){
+  l->rng ^= l->rng<<13; l->rng ^= l->rng>>17; l->rng ^= l->rng<<5;
+  return (double)(l->rng >> 8) / 16777216.0;
+}
+
+static void loop_send(NetTransport* self, const uint8_t* data, int len){
+  NetLoopEnd* e = (NetLoopEnd*)self;
+  NetLoopback* l = e->link;
+  int to = 1 - e->side;
+  l->sent++;
+  if(l->p.loss > 0.0 && loop_uniform(l) < l->p.loss){ l->dropped++; return; }
+  if(l->n[to] >= NET_LOOP_QUEUE || len > NET_MAX_PACKET){ l->overflow++; return; }
+  NetLoopPacket* pk = &l->q[to][l->n[to]++];
+  pk->deliver_ms = l->now_ms + l->p.latency_ms + l->p.jitter_ms*loop_uniform(l);
+  pk->len = len;
+  memcpy(pk->data, data, (size_t)len);
+}
+
+static int loop_recv(NetTransport* self, uint8_t* buf, int cap){
+  NetLoopEnd* e = (NetLoopEnd*)self;
+  NetLoopback* l = e->link;
+  NetLoopPacket* q = l->q[e->side];
+  int best = -1;
+  for(int i=0;i<l->n[e->side];i++)
+    if(q[i].deliver_ms <= l->now_ms && (best<0 || q[i].deliver_ms < q[best].deliver_ms)) best = i;
+  if(best<0) return 0;
+  int len = q[best].len < cap ? q[best].len : cap;
+  memcpy(buf, q[best].data, (size_t)len);
+  q[best] = q[--l->n[e->side]];
+  return len;
+}
+
+void net_loopback_init(NetLoopback* l, const NetLinkParams* p){
+  memset(l, 0, sizeof(*l));
+  l->p = *p;
+  l->rng = p->seed ? p->seed : 0x2545F491u;
+  for(int i=0;i<2;i++){
+    l->end[i].base.name = "loopback";
+    l->end[i].base.send = loop_send;
+    l->end[i].base.recv = loop_recv;
+    l->end[i].link = l; l->end[i].side = i;
+  }
+}
+
+void net_loopback_set_time(NetLoopback* l, double now_ms){ l->now_ms = now_ms; }
+
+/* -------------------------------- Packets -------------------------------- */
+/* 'N' | start u32 | count u8 | ack+1 u32 | check frame u32 | check hash u32
+ * | count 2-bit inputs, four per byte. Little-endian. */
+
+static void send_inputs(NetSession* s){
+  uint8_t pk[NET_MAX_PACKET];
+  int32_t start = s->remote_ack + 1;
+  if(start < s->local_last - RING_MASK) start = s->local_last - RING_MASK;
+  int count = (int)(s->local_last - start + 1);
+  if(count < 0) count = 0;
+  if(count > NET_MAX_SEND) count = NET_MAX_SEND;
+
+  pk[0] = 'N';
+  put_u32(pk+1, (uint32_t)start);
+  pk[5] = (uint8_t)count;
+  put_u32(pk+6,  (uint32_t)(s->confirmed + 1));
+  put_u32(pk+10, (uint32_t)s->check_last);
+  put_u32(pk+14, s->check_last ? s->check_hash[(s->check_last/NET_CHECK_EVERY) % NET_CHECKS] : 0u);
+  memset(pk+18, 0, (size_t)(count+3)/4u);
+  for(int i=0;i<count;i++) pk[18 + i/4] |= (uint8_t)(s->local[(start+i) & RING_MASK] << (2*(i%4)));
+  s->tr->send(s->tr, pk, 18 + (count+3)/4);
+  s->stats.packets_sent++;
+}
+
+/* ------------------------------- Checksums ------------------------------- */
+static void compare_check(NetSession* s, int32_t frame, uint32_t peer){
+  uint32_t mine = s->check_hash[(frame/NET_CHECK_EVERY) % NET_CHECKS];
+  s->stats.checks++;
+  if(mine != peer && s->stats.desync_frame < 0) s->stats.desync_frame = frame;
+  s->peer_checked = frame;
+  if(s->peer_frame <= frame) s->peer_frame = 0;
+}
+
+/* Hash every checkpoint whose state is final: all inputs before it are
+ * confirmed and it has been simulated (and re-simulated if need be). */
+static void update_checks(NetSession* s){
+  for(int32_t f = s->check_last + NET_CHECK_EVERY; f <= s->frame && f-1 <= s->confirmed; f += NET_CHECK_EVERY){
+    const Game* st = f==s->frame ? &s->g : &s->snap[f & RING_MASK];
+    int slot = (f/NET_CHECK_EVERY) % NET_CHECKS;
+    s->check_frame[slot] = f; s->check_hash[slot] = sim_state_hash(st);
+    s->check_last = f;
+    if(s->peer_frame == f) compare_check(s, f, s->peer_hash);
+  }
+}
+
+/* The peer sends its newest checkpoint in every packet. */
+static void on_peer_check(NetSession* s, int32_t frame, uint32_t hash){
+  if(frame <= s->peer_checked) return;
+  if(frame > s->check_last){
+    if(frame > s->peer_frame){ s->peer_frame = frame; s->peer_hash = hash; }
+    return;
+  }
+  if(s->check_frame[(frame/NET_CHECK_EVERY) % NET_CHECKS] == frame) compare_check(s, frame, hash);
+}
+
+/* -------------------------------- Session -------------------------------- */
+int net_session_init(NetSession* s, const NetConfig* cfg, NetTransport* tr, const Game* g){
+  if(cfg->side<0 || cfg->side>1 || cfg->input_delay<0 || cfg->input_delay>8 ||
+     cfg->max_rollback<1 || cfg->max_rollback>NET_MAX_ROLLBACK) return 0;
+  memset(s, 0, sizeof(*s));
+  s->cfg = *cfg; s->tr = tr; s->g = *g;
+  s->confirmed = -1; s->remote_ack = -1;
+  s->local_last = cfg->input_delay - 1;   /* the first `delay` frames are idle */
+  s->rollback_from = NO_ROLLBACK;
+  for(int i=0;i<NET_RING;i++) s->remote_frame[i] = -1;
+  for(int i=0;i<NET_CHECKS;i++) s->check_frame[i] = -1;
+  s->stats.desync_frame = -1;
+  return 1;
+}
+
+static unsigned predict(const NetSession* s){
+  return s->confirmed >= 0 ? s->remote[s->confirmed & RING_MASK] : 0u;
+}
+
+static void step_frame(NetSession* s, int32_t f){
+  int k = f & RING_MASK;
+  if(s->remote_frame[k] != f || !s->remote_conf[k]){
+    s->remote[k] = (uint8_t)predict(s); s->remote_frame[k] = f; s->remote_conf[k] = 0;
+  }
+  unsigned l = s->local[k], r = s->remote[k];
+  Input in; in.buttons = s->cfg.side==0 ? (l | r<<2) : (r | l<<2);
+  s->snap[k] = s->g;
+  sim_step(&s->g, &in, NULL);
+}
+
+static void on_remote_input(NetSession* s, int32_t f, unsigned v){
+  if(f <= s->confirmed || f >= s->confirmed + NET_RING) return;
+  int k = f & RING_MASK;
+  if(s->remote_frame[k] == f && s->remote_conf[k]) return;
+  if(f < s->frame && s->remote[k] != v && f < s->rollback_from) s->rollback_from = f;
+  s->remote[k] = (uint8_t)v; s->remote_frame[k] = f; s->remote_conf[k] = 1;
+  while(s->remote_frame[(s->confirmed+1) & RING_MASK] == s->confirmed+1 && s->remote_conf[(s->confirmed+1) & RING_MASK])
+    s->confirmed++;
+}
+
+static void poll(NetSession* s){
+  uint8_t pk[NET_MAX_PACKET];
+  int len;
+  while((len = s->tr->recv(s->tr, pk, (int)sizeof pk)) > 0){
+    if(len < 18 || pk[0] != 'N') continue;
+    int32_t start = (int32_t)get_u32(pk+1);
+    int count = pk[5];
+    if(count > NET_MAX_SEND || len < 18 + (count+3)/4) continue;
+    s->stats.packets_recv++;
+    int32_t ack = (int32_t)get_u32(pk+6) - 1;
+    if(ack > s->remote_ack) s->remote_ack = ack;
+    for(int i=0;i<count;i++) on_remote_input(s, start+i, (pk[18 + i/4] >> (2*(i%4))) & 3u);
+    on_peer_check(s, (int32_t)get_u32(pk+10), get_u32(pk+14));
+  }
+}
+
+static void rollback(NetSession* s){
+  int32_t from = s->rollback_from;
+  s->rollback_from = NO_ROLLBACK;
+  if(from >= s->frame) return;
+  int depth = (int)(s->frame - from);
+  s->g = s->snap[from & RING_MASK];
+  for(int32_t f=from; f<s->frame; f++) step_frame(s, f);
+  s->stats.rollbacks++;
+  s->stats.resim_frames += depth;
+  if(depth > s->stats.max_depth) s->stats.max_depth = depth;
+}
+
+int net_advance(NetSession* s, unsigned buttons){
+  poll(s);
+  rollback(s);
+  update_checks(s);
+
+  if(s->frame - s->confirmed > s->cfg.max_rollback){
+    s->stats.stalls++;
+    send_inputs(s);   /* keep acks flowing */
+    return 0;
+  }
+  s->local_last = s->frame + s->cfg.input_delay;
+  s->local[s->local_last & RING_MASK] = (uint8_t)(buttons & (IN_P1_UP|IN_P1_DOWN));
+  step_frame(s, s->frame);
+  s->frame++;
+  s->stats.frames++;
+  update_checks(s);
+  send_inputs(s);
+  return 1;
+}
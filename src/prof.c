@@ -0,0 +1,208 @@
+/* prof.c — frame ring, zone/counter recording, Chrome trace JSON,
+ * frame-time graph */
+
+#ifndef __EMSCRIPTEN__
+#  ifndef _POSIX_C_SOURCE
+#    define _POSIX_C_SOURCE 199309L   /* clock_gettime */
+#  endif
+#  include <time.h>
+#else
+#  include <emscripten.h>
+#endif
+
+#include "prof.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+const char* const PROF_ZONE_NAME[PZ_COUNT] = {
+  "frame", "input", "sim", "audio", "render", "scene", "submit", "hud"
+};
+const char* const PROF_COUNTER_NAME[PC_COUNT] = {
+  "sim_steps", "microsteps", "events", "particles", "sfx", "js_calls", "draw_calls", "gl_state", "instances"
+};
+
+uint64_t prof_now_ns(void){
+#ifdef __EMSCRIPTEN__
+  return (uint64_t)(emscripten_get_now()*1e6);
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec*1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/* ---------------------------------- Ring --------------------------------- */
+/* One spare slot: the frame being recorded never overwrites one that
+ * prof_frame() can still hand out. */
+#define RING (PROF_FRAMES + 1)
+
+static ProfFrame ring[RING];
+static uint32_t  total;          /* completed frames */
+static ProfFrame* cur;           /* recording, or NULL */
+static int       stack[PROF_DEPTH], sp, deep;
+static int       enabled = 1;
+
+void prof_reset(void){
+  total = 0; cur = NULL; sp = deep = 0; enabled = 1;
+}
+
+void prof_enable(int on){
+  enabled = on != 0;
+  if(!enabled){ cur = NULL; sp = deep = 0; }
+}
+
+int prof_enabled(void){ return enabled; }
+
+void prof_frame_begin(void){
+  if(!enabled) return;
+  if(cur) prof_frame_end();
+  cur = &ring[total % RING];
+  cur->n = cur->dropped = 0; cur->dur = 0;
+  memset(cur->counter, 0, sizeof(cur->counter));
+  sp = deep = 0;
+  cur->t0 = prof_now_ns();
+}
+
+void prof_frame_end(void){
+  if(!cur) return;
+  cur->dur = (uint32_t)(prof_now_ns() - cur->t0);
+  cur = NULL; sp = deep = 0;
+  total++;
+}
+
+void prof_zone_begin(ProfZone z){
+  if(!cur) return;
+  if(sp == PROF_DEPTH){ deep++; return; }
+  int i = -1;
+  if(cur->n < PROF_FRAME_ZONES){
+    ProfRec* r = &cur->rec[i = cur->n++];
+    r->zone = (uint8_t)z; r->depth = (uint8_t)(sp + 1); r->dur = 0;
+    r->start = (uint32_t)(prof_now_ns() - cur->t0);
+  } else cur->dropped++;
+  stack[sp++] = i;
+}
+
+void prof_zone_end(void){
+  if(!cur) return;
+  if(deep){ deep--; return; }
+  if(!sp) return;
+  int i = stack[--sp];
+  if(i >= 0){ ProfRec* r = &cur->rec[i]; r->dur = (uint32_t)(prof_now_ns() - cur->t0) - r->start; }
+}
+
+void prof_count(ProfCounter c, int n){
+  if(cur) cur->counter[c] += n;
+}
+
+int prof_frame_count(void){ return total < PROF_FRAMES ? (int)total : PROF_FRAMES; }
+
+const ProfFrame* prof_frame(int back){
+  if(back < 0 || back >= prof_frame_count()) return NULL;
+  return &ring[(total - 1u - (uint32_t)back) % RING];
+}
+
+void prof_zone_stats(ProfZone z, ProfStats* s){
+  double sum = 0;
+  memset(s, 0, sizeof(*s));
+  for(int b=0;b<prof_frame_count();b++){
+    const ProfFrame* f = prof_frame(b);
+    uint64_t ns = 0; int ran = z == PZ_FRAME;
+    if(ran) ns = f->dur;
+    else for(int i=0;i<f->n;i++) if(f->rec[i].zone == z){ ns += f->rec[i].dur; ran = 1; }
+    if(!ran) continue;
+    double ms = (double)ns/1e6;
+    sum += ms; s->frames++;
+    if(ms > s->max_ms) s->max_ms = ms;
+  }
+  if(s->frames) s->avg_ms = sum/s->frames;
+}
+
+/* ---------------------------------- Trace -------------------------------- */
+typedef struct { char* out; size_t cap, len; } Buf;
+
+static void put(Buf* b, const char* fmt, ...){
+  va_list ap; va_start(ap, fmt);
+  int n = vsnprintf(b->len < b->cap ? b->out + b->len : NULL, b->len < b->cap ? b->cap - b->len : 0, fmt, ap);
+  va_end(ap);
+  if(n > 0) b->len += (size_t)n;
+}
+
+size_t prof_trace_json(char* out, size_t cap){
+  Buf b = { out, cap, 0 };
+  if(cap) out[0] = 0;
+  int n = prof_frame_count();
+  uint64_t base = n ? prof_frame(n-1)->t0 : 0;
+  uint32_t dropped = 0;
+  put(&b, "{\"traceEvents\":[\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"main\"}}");
+  for(int k=n-1;k>=0;k--){   /* oldest first */
+    const ProfFrame* f = prof_frame(k);
+    double t0 = (double)(f->t0 - base)/1e3;
+    put(&b, ",\n{\"name\":\"frame\",\"cat\":\"pong\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+        t0, (double)f->dur/1e3);
+    for(int i=0;i<f->n;i++){
+      const ProfRec* r = &f->rec[i];
+      put(&b, ",\n{\"name\":\"%s\",\"cat\":\"pong\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+          PROF_ZONE_NAME[r->zone], t0 + (double)r->start/1e3, (double)r->dur/1e3);
+    }
+    put(&b, ",\n{\"name\":\"counters\",\"ph\":\"C\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"args\":{", t0);
+    for(int c=0;c<PC_COUNT;c++) put(&b, "%s\"%s\":%d", c ? "," : "", PROF_COUNTER_NAME[c], (int)f->counter[c]);
+    put(&b, "}}");
+    dropped += f->dropped;
+  }
+  put(&b, "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"frames\":%d,\"dropped_zones\":%u}}\n", n, (unsigned)dropped);
+  return b.len;
+}
+
+/* ---------------------------------- Graph -------------------------------- */
+static const float ZONE_COL[PZ_COUNT][4] = {
+  { 0.5f, 0.5f, 0.5f, 0.6f },   /* frame interval */
+  { 0.3f, 0.9f, 0.9f, 0.9f },   /* input */
+  { 1.0f, 0.85f, 0.2f, 0.9f },  /* sim */
+  { 0.9f, 0.4f, 0.9f, 0.9f },   /* audio */
+  { 0.3f, 0.55f, 1.0f, 0.9f },  /* render */
+  { 0.3f, 0.55f, 1.0f, 0.9f },
+  { 0.3f, 0.55f, 1.0f, 0.9f },
+  { 0.3f, 0.55f, 1.0f, 0.9f },
+};
+static const float COL_BACK[4]  = { 0.0f, 0.0f, 0.0f, 0.55f };
+static const float COL_SLOW[4]  = { 0.9f, 0.2f, 0.2f, 0.7f };
+static const float COL_LINE[4]  = { 1.0f, 1.0f, 1.0f, 0.8f };
+
+static int rect(ShapeInstance* out, int n, int cap, float x0, float y0, float x1, float y1, const float c[4]){
+  if(n >= cap) return n;
+  ShapeInstance* s = &out[n];
+  s->x = 0.5f*(x0 + x1); s->y = 0.5f*(y0 + y1); s->w = x1 - x0; s->h = y1 - y0;
+  memcpy(s->color, c, sizeof(s->color));
+  s->outline = 0.0f; s->kind = (float)SHAPE_RECT;
+  return n + 1;
+}
+
+int prof_graph_build(ShapeInstance* out, int cap, float x, float y, float w, float h, float full_ms){
+  const float budget = 1000.0f/60.0f, col = w/PROF_GRAPH_COLUMNS, bottom = y + h;
+  const float px_ns = h/(full_ms*1e6f);
+  int n = rect(out, 0, cap, x, y, x + w, bottom, COL_BACK);
+  int frames = prof_frame_count();
+  for(int b=0; b<frames && b<PROF_GRAPH_COLUMNS; b++){
+    const ProfFrame* f = prof_frame(b);
+    const ProfFrame* prev = prof_frame(b + 1);
+    float x1 = x + w - (float)b*col, x0 = x1 - col + (col > 2.0f ? 1.0f : 0.0f);
+    float gap = prev ? (float)(f->t0 - prev->t0) : (float)f->dur;
+    float top = bottom - (gap*px_ns < h ? gap*px_ns : h);
+    n = rect(out, n, cap, x0, top, x1, bottom, gap > 2e6f*budget ? COL_SLOW : ZONE_COL[PZ_FRAME]);
+    /* top-level zones stacked, one bar per zone kind */
+    uint32_t ns[PZ_COUNT] = { 0 };
+    for(int i=0;i<f->n;i++) if(f->rec[i].depth == 1) ns[f->rec[i].zone] += f->rec[i].dur;
+    float at = bottom;
+    for(int z=1; z<PZ_COUNT; z++){
+      if(!ns[z]) continue;
+      float hz = (float)ns[z]*px_ns, top_z = at - hz < y ? y : at - hz;
+      n = rect(out, n, cap, x0, top_z, x1, at, ZONE_COL[z]);
+      at = top_z;
+    }
+  }
+  float line = bottom - budget*1e6f*px_ns;
+  if(line > y) n = rect(out, n, cap, x, line - 0.5f, x + w, line + 0.5f, COL_LINE);
+  return n;
+}
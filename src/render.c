@@ -2,12 +2,29 @@
  * Features:
  *  - States: MENU, PLAY, GAME_OVER
  *  - 1P/2P toggle with UP/DOWN in MENU; SPACE to start / return
- *  - P1 controls: A/Z or ArrowUp/ArrowDown;  P2: K/M (in 2P)
+ *  - P1 controls: A/Z or ArrowUp/ArrowDown;  P2: K/M (in 2P); keys go
+ *    through a keyCode table into a timestamped ring consumed per sim step
  *  - AI paddle mirrors original blend-target logic
- *  - Ripple VFX on hits/walls; paddle flash; dashed center line
- *  - Score to 10; HUD via DOM overlay (mode, scores, prompts)
- *  - WebAudio SFX loading & playback using Emscripten FS (preload @ /sounds)
- *  - Optional music: /music/theme.ogg if present
+ *  - Particle VFX (vfx.c): hit sparks + ripples, ball trail, goal flash;
+ *    paddle flash; dashed center line
+ *    (recorded as a GfxFrame by scene.c, replayed by gfx_gles.c)
+ *  - Score to 10; HUD via DOM overlay (mode, scores, prompts), flushed only
+ *    for changed fields, or drawn in-canvas from a bitmap font (setHudMode)
+ *  - WebAudio SFX loading & playback, streamed from assets.pak (asset_pack.c)
+ *    or, without it, from Emscripten FS (preload @ /sounds); sounds are
+ *    queued per frame (audio_queue.c) and drained by one JS call
+ *  - Optional music: music/theme.ogg if present
+ *  - Gameplay itself lives in sim.c (headless); this file maps its Events
+ *    to SFX/HUD and draws the resulting Game state
+ *  - Multiball party mode (sim_party.c, setPartyBalls): shared paddles,
+ *    ball–ball contacts through a uniform grid
+ *  - Sim runs at a fixed SIM_TICK_HZ off an accumulator (sim_clock.c);
+ *    rendering interpolates between the last two states
+ *  - -DPONG_PROFILE: timed zones + counters per frame (prof.c), exported
+ *    as Chrome trace JSON (Module.profTrace()) and drawn as a frame graph
+ *  - -DPONG_SIM_THREAD: the sim side runs on a pthread at the sim rate
+ *    (sim_thread.c) and hands the main thread a snapshot per step through
+ *    a triple buffer, its events through a ring (handoff.c)
  *
  * Build note: this file uses EM_ASM/EM_JS. Compile as -std=gnu99.
  */
@@ -20,149 +37,102 @@
 #include <stdio.h>
 #include <string.h>
 
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
+#include "ai.h"
+#include "asset_pack.h"
+#include "audio_mixer.h"
+#include "audio_queue.h"
+#include "gfx.h"
+#include "handoff.h"
+#include "hud.h"
+#include "input.h"
+#include "pong_atomic.h"
+#include "prof.h"
+#include "replay.h"
+#include "scene.h"
+#include "shapes.h"
+#include "sim.h"
+#include "sim_clock.h"
+#include "sim_party.h"
+#ifdef PONG_SIM_THREAD
+#include "sim_thread.h"
 #endif
+#include "vfx.h"
 
-/* ---------------------------- Config / Colors ---------------------------- */
-static const int WIDTH  = 800;
-static const int HEIGHT = 480;
-
-static const float PLAYER_SPEED  = 6.0f;
-static const float MAX_AI_SPEED  = 6.0f;
-
-static const float WHITE[4]  = {1.0f, 1.0f, 1.0f, 1.0f};
-static const float GREEN[4]  = {30/255.0f, 128/255.0f, 30/255.0f, 1.0f};
-static const float YELLOW[4] = {240/255.0f,240/255.0f, 50/255.0f,1.0f};
-static const float RED[4]    = {240/255.0f, 50/255.0f, 50/255.0f,1.0f};
-static const float BLUE[4]   = { 50/255.0f, 50/255.0f,240/255.0f,1.0f};
-
-/* ------------------------------ GL Program ------------------------------ */
-static GLuint prog = 0;
-static GLint  uResolution, uScale, uTranslate, uColor;
-
-static GLuint vaoRect = 0, vboRect = 0;  /* unit rectangle */
-static GLuint vaoCirc = 0, vboCirc = 0;  /* unit circle fan (center + ring) */
-static GLsizei circleCount = 0;
-
-static const char* VERT_SRC =
-"#version 300 es\n"
-"layout(location=0) in vec2 aPos;\n"
-"uniform vec2 uResolution;\n"
-"uniform vec2 uScale;\n"
-"uniform vec2 uTranslate;\n"
-"void main(){\n"
-"  vec2 pos = aPos * uScale + uTranslate; /* pixels */\n"
-"  vec2 ndc = (pos / uResolution * 2.0 - 1.0) * vec2(1.0, -1.0);\n"
-"  gl_Position = vec4(ndc,0.0,1.0);\n"
-"}\n";
-
-static const char* FRAG_SRC =
-"#version 300 es\n"
-"precision mediump float;\n"
-"uniform vec4 uColor;\n"
-"out vec4 outColor;\n"
-"void main(){ outColor = uColor; }\n";
-
-static GLuint compile(GLenum type, const char* src){
-  GLuint sh = glCreateShader(type);
-  glShaderSource(sh, 1, &src, NULL);
-  glCompileShader(sh);
-#ifdef DEBUG
-  GLint ok=0; glGetShaderiv(sh, GL_COMPILE_STATUS, &ok);
-  if(!ok){ char log[1024]; GLsizei n=0; glGetShaderInfoLog(sh,1024,&n,log); printf("shader:\n%.*s\n",n,log); }
-#endif
-  return sh;
-}
-
-static int makeProgram(){
-  GLuint vs = compile(GL_VERTEX_SHADER, VERT_SRC);
-  GLuint fs = compile(GL_FRAGMENT_SHADER, FRAG_SRC);
-  prog = glCreateProgram();
-  glAttachShader(prog, vs); glAttachShader(prog, fs);
-  glLinkProgram(prog);
-  glDeleteShader(vs); glDeleteShader(fs);
-#ifdef DEBUG
-  GLint ok=0; glGetProgramiv(prog, GL_LINK_STATUS, &ok);
-  if(!ok){ char log[1024]; GLsizei n=0; glGetProgramInfoLog(prog,1024,&n,log); printf("program:\n%.*s\n",n,log); return 0; }
-#endif
-  uResolution = glGetUniformLocation(prog, "uResolution");
-  uScale      = glGetUniformLocation(prog, "uScale");
-  uTranslate  = glGetUniformLocation(prog, "uTranslate");
-  uColor      = glGetUniformLocation(prog, "uColor");
-  return 1;
-}
-
-static void makeUnitRect(){
-  if(vaoRect) return;
-  const float verts[] = {
-    -0.5f,-0.5f,  -0.5f, 0.5f,   0.5f, 0.5f,
-    -0.5f,-0.5f,   0.5f, 0.5f,   0.5f,-0.5f
-  };
-  glGenVertexArrays(1,&vaoRect);
-  glGenBuffers(1,&vboRect);
-  glBindVertexArray(vaoRect);
-  glBindBuffer(GL_ARRAY_BUFFER, vboRect);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
-  glEnableVertexAttribArray(0);
-  glVertexAttribPointer(0,2,GL_FLOAT,GL_FALSE,2*sizeof(float),(void*)0);
-}
+/* -------------------------------- Config -------------------------------- */
+static const int WIDTH  = SIM_WIDTH;
+static const int HEIGHT = SIM_HEIGHT;
 
-static void makeUnitCircle(int segments){
-  if(vaoCirc) return;
-  circleCount = segments + 2; /* center + segments+1 */
-  float* v = (float*)malloc(sizeof(float)*2*circleCount);
-  v[0]=0.0f; v[1]=0.0f; /* center */
-  for(int i=0;i<=segments;++i){
-    float t = (float)i/(float)segments;
-    float th = 2.0f*(float)M_PI*t;
-    v[(i+1)*2+0] = cosf(th)*0.5f;
-    v[(i+1)*2+1] = sinf(th)*0.5f;
-  }
-  glGenVertexArrays(1,&vaoCirc);
-  glGenBuffers(1,&vboCirc);
-  glBindVertexArray(vaoCirc);
-  glBindBuffer(GL_ARRAY_BUFFER, vboCirc);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(float)*2*circleCount, v, GL_STATIC_DRAW);
-  glEnableVertexAttribArray(0);
-  glVertexAttribPointer(0,2,GL_FLOAT,GL_FALSE,2*sizeof(float),(void*)0);
-  free(v);
-}
+/* ------------------------------ Frame / GPU ----------------------------- */
+static GfxFrame frame;   /* recorded by scene_record(), replayed by gles */
+static GfxBackend gles;
 
 /* ------------------------------ UI (DOM) -------------------------------- */
-static void ui_set_score(int s0, int s1){
-  EM_ASM({
-    var l = document.getElementById('scoreL');
-    var r = document.getElementById('scoreR');
-    if(l) l.textContent = ($0<10?"0":"")+$0;
-    if(r) r.textContent = ($1<10?"0":"")+$1;
-  }, s0, s1);
-}
-static void ui_set_msg(const char* msg){
-  EM_ASM({ var el=document.getElementById('msg'); if(el) el.textContent=UTF8ToString($0); }, msg);
-}
-static void ui_set_mode_1p2p(int n){
-  EM_ASM({ var el=document.getElementById('mode'); if(el) el.textContent = ($0==1?"1 Player":"2 Players"); }, n);
-}
-static void ui_set_title(const char* t){
-  EM_ASM({ var el=document.getElementById('title'); if(el) el.textContent = UTF8ToString($0); }, t);
-}
-static void ui_set_score_colors(const float* cL, const float* cR){
-  EM_ASM({
-    function css(r,g,b){return `rgb(${Math.round(r*255)},${Math.round(g*255)},${Math.round(b*255)})`;}
-    var l=document.getElementById('scoreL'); var r=document.getElementById('scoreR');
-    if(l) l.style.color = css(HEAPF32[($0>>2)], HEAPF32[(($0>>2)+1)], HEAPF32[(($0>>2)+2)]);
-    if(r) r.style.color = css(HEAPF32[($1>>2)], HEAPF32[(($1>>2)+1)], HEAPF32[(($1>>2)+2)]);
-  }, cL, cR);
-}
+/* Push the dirty fields of a Hud (layout in hud.h) to the overlay. */
+EM_JS(void, js_hud_flush, (const void* hud, unsigned dirty), {
+  var i=hud>>2;
+  function $(id){ return document.getElementById(id); }
+  function pad(v){ return (v<10?"0":"")+v; }
+  function css(c){ return `rgb(${(c>>16)&255},${(c>>8)&255},${c&255})`; }
+  var el;
+  if(dirty&1){ el=$('title'); if(el) el.textContent = UTF8ToString(hud+24); }
+  if(dirty&2){ el=$('mode');  if(el) el.textContent = (HEAP32[i+3]==1?"1 Player":"2 Players"); }
+  if(dirty&4){ el=$('scoreL'); if(el) el.textContent = pad(HEAP32[i+1]); el=$('scoreR'); if(el) el.textContent = pad(HEAP32[i+2]); }
+  if(dirty&8){ el=$('scoreL'); if(el) el.style.color = css(HEAPU32[i+4]); el=$('scoreR'); if(el) el.style.color = css(HEAPU32[i+5]); }
+  if(dirty&16){ el=$('msg'); if(el) el.textContent = UTF8ToString(hud+88); }
+});
+
+EM_JS(void, js_hud_show_dom, (int show), {
+  var el=document.getElementById('hud'); if(el) el.style.display = show ? '' : 'none';
+});
 
 /* ------------------------------ WebAudio -------------------------------- */
-EM_JS(void, js_audio_init, (), {
-  if(!Module.audio) Module.audio = { ctx:null, ready:false, lists:{}, music:null, unlocked:false };
-  if(!Module.audio.ctx){
-    try{ Module.audio.ctx = new (window.AudioContext||window.webkitAudioContext)(); }
-    catch(e){ console.error('AudioContext failed', e); }
+/* SFX are indexed by the Sfx enum (audio_queue.h). Each voice keeps its
+ * GainNode for the whole session; only the one-shot BufferSource is new. */
+EM_JS(void, js_audio_init, (int voices), {
+  if(!Module.audio) Module.audio = { ctx:null, ready:false, defs:[], lists:[], voices:[], music:null, unlocked:false };
+  var A=Module.audio;
+  if(!A.ctx){
+    try{ A.ctx = new (window.AudioContext||window.webkitAudioContext)(); }
+    catch(e){ console.error('AudioContext failed', e); return; }
+  }
+  if(!A.voices.length){
+    for(var i=0;i<voices;i++){ var g=A.ctx.createGain(); g.connect(A.ctx.destination); A.voices.push({ gain:g, src:null, t:0 }); }
   }
+  /* the C mixer needs the worklet to see wasm memory: shared memory only
+     (PONG_AUDIO_WORKLET build, cross-origin isolated page) */
+  A.canMix = !!(A.ctx.audioWorklet && typeof SharedArrayBuffer!=='undefined' && HEAPF32.buffer instanceof SharedArrayBuffer);
+  /* Hand the decoded PCM to the C mixer (one arena, one copy per clip, at
+     load) and start a worklet that pulls from its MixRing (layout in
+     audio_mixer.h). Until it runs, SFX keep going through js_audio_drain. */
+  A.startMixer = function(){
+    if(A.mixerBegun) return; A.mixerBegun=true;
+    var total=0;
+    A.lists.forEach(function(l){ if(l) l.forEach(function(b){ total+=b.length; }); });
+    if(!total || !Module._audioMixerBegin(A.ctx.sampleRate, total)) return;
+    A.lists.forEach(function(l, id){
+      if(l) l.forEach(function(b, v){ var p=Module._audioMixerClip(id, v, b.length); if(p) HEAPF32.set(b.getChannelData(0), p>>2); });
+    });
+    var ring=Module._audioMixerRing();
+    var code = "class PongMixer extends AudioWorkletProcessor{" +
+      "constructor(o){super();var p=o.processorOptions;this.u=new Uint32Array(p.buffer);this.f=new Float32Array(p.buffer);this.r=p.ring>>2;}" +
+      "process(ins,outs){var u=this.u,r=this.r,o=outs[0],n=o[0].length,head=Atomics.load(u,r),tail=u[r+1],mask=u[r+2]," +
+      "k=Math.min(n,(head-tail)>>>0),i,c;for(i=0;i<k;i++)o[0][i]=this.f[r+4+((tail+i)&mask)];" +
+      "for(i=k;i<n;i++)o[0][i]=0;for(c=1;c<o.length;c++)o[c].set(o[0]);if(k<n)u[r+3]++;" +
+      "Atomics.store(u,r+1,(tail+k)>>>0);return true;}}registerProcessor('pong-mixer',PongMixer);";
+    var url=URL.createObjectURL(new Blob([code], { type:'application/javascript' }));
+    A.ctx.audioWorklet.addModule(url).then(function(){
+      var node=new AudioWorkletNode(A.ctx, 'pong-mixer', { numberOfInputs:0, outputChannelCount:[2],
+        processorOptions:{ buffer:HEAPF32.buffer, ring:ring } });
+      node.connect(A.ctx.destination);
+      A.mixer=node; Module._audioMixerStart();
+      console.log('SFX: C mixer via AudioWorklet');
+    }).catch(function(e){ console.warn('AudioWorklet unavailable, WebAudio voices', e); });
+  };
+});
+
+EM_JS(void, js_audio_define, (int id, const char* name, int variants), {
+  var A=Module.audio; if(!A) return;
+  A.defs[id] = { name:UTF8ToString(name), variants:variants };
 });
 
 EM_JS(void, js_audio_resume, (), {
@@ -173,304 +143,519 @@ EM_JS(void, js_audio_resume, (), {
 
 EM_JS(void, js_audio_load_all, (), {
   var A=Module.audio; if(!A||!A.ctx) return;
-  const multi = { hit:5, bounce:5 };
-  const singles = ["hit_slow","hit_medium","hit_fast","hit_veryfast","bounce_synth","score_goal","up","down"];
   function decode(path){
     try{ var data = FS.readFile(path); return A.ctx.decodeAudioData(data.buffer.slice(0)); }
     catch(e){ return Promise.reject(e); }
   }
-  var ps=[]; A.lists={};
-  Object.keys(multi).forEach(function(k){ A.lists[k]=[]; for(var i=0;i<multi[k];i++){ let p=`/sounds/${k}${i}.ogg`; ps.push(decode(p).then(b=>A.lists[k].push(b)).catch(()=>{})); }});
-  singles.forEach(function(k){ let p0=`/sounds/${k}0.ogg`, p1=`/sounds/${k}.ogg`; let pick=null;
+  var ps=[]; A.lists=[];
+  A.defs.forEach(function(d, id){
+    if(d.variants>1){
+      A.lists[id]=[];
+      for(var i=0;i<d.variants;i++){ let p=`/sounds/${d.name}${i}.ogg`; ps.push(decode(p).then(b=>A.lists[id].push(b)).catch(()=>{})); }
+      return;
+    }
+    let p0=`/sounds/${d.name}0.ogg`, p1=`/sounds/${d.name}.ogg`; let pick=null;
     try{ FS.lookupPath(p0); pick=p0; }catch(_){} if(!pick){ try{ FS.lookupPath(p1); pick=p1; }catch(__){} }
-    if(pick){ ps.push(decode(pick).then(b=>A.lists[k]=[b]).catch(()=>{})); }
+    if(pick){ ps.push(decode(pick).then(b=>A.lists[id]=[b]).catch(()=>{})); }
   });
-  Promise.all(ps).then(()=>{ A.ready=true; console.log('SFX loaded'); }).catch(()=>{ A.ready=true; });
+  Promise.all(ps).then(()=>{ A.ready=true; console.log('SFX loaded'); if(A.canMix) A.startMixer(); }).catch(()=>{ A.ready=true; });
 });
 
-EM_JS(void, js_audio_play, (const char* cname, int count), {
-  var A=Module.audio; if(!A||!A.ctx||!A.ready||!A.unlocked) return;
-  var name=UTF8ToString($0); var arr=A.lists[name]; if(!arr||!arr.length) return;
-  for(var i=0;i<$1;i++){
-    var buf = arr[(Math.random()*arr.length)|0];
-    var src=A.ctx.createBufferSource(); src.buffer=buf; src.connect(A.ctx.destination); src.start();
+/* Streamed archive (asset_pack.h), instead of the preloaded bundle: the
+ * bytes land in wasm memory as they arrive, asset_pack_received() says
+ * which entries are whole, and each is decoded right away. Entries come in
+ * first-needed order, so SFX go live with the first decoded one; music
+ * (ASSET_FLAG_STREAM) is last, decoded whole once it has all arrived, and
+ * only kept for js_music_try_play. */
+EM_JS(void, js_audio_load_pak, (const char* url), {
+  var A=Module.audio; if(!A||!A.ctx) return;
+  var byName={};   /* "sounds/hit2" -> Sfx */
+  A.defs.forEach(function(d, id){
+    for(var v=0;v<d.variants;v++) byName[`sounds/${d.name}${v}`]=id;
+    if(d.variants===1) byName[`sounds/${d.name}`]=id;
+  });
+  A.lists=[]; A.pak=true;
+  var ptr=0, total=0, have=0, done=0, pending=0, sfxIssued=false;
+  function settle(){ if(sfxIssued && !pending && A.canMix && !A.mixer) A.startMixer(); }
+  function decode(name, buf, stream){
+    if(stream){
+      sfxIssued=true; settle();
+      A.ctx.decodeAudioData(buf).then(function(b){ A.musicBuf=b; if(A.musicWanted) A.musicWanted(b); }).catch(()=>{});
+      return;
+    }
+    var id=byName[name.replace(/\.[^.\/]*$/, '')]; if(id===undefined) return;
+    pending++;
+    A.ctx.decodeAudioData(buf).then(function(b){
+      (A.lists[id]=A.lists[id]||[]).push(b);
+      if(!A.ready){ A.ready=true; console.log('SFX: first playable'); }
+    }).catch(()=>{}).then(function(){ pending--; settle(); });
   }
+  /* AssetEntry (asset_pack.h), wasm32: u32 hash, offset, size; u8 codec,
+     flags; char* name at +16 */
+  function take(ready){
+    for(; done<ready; done++){
+      var e=Module._assetsEntry(done), w=e>>2, off=ptr+HEAPU32[w+1];
+      /* decodeAudioData detaches its input: hand it a copy */
+      decode(UTF8ToString(HEAPU32[w+4]), HEAPU8.slice(off, off+HEAPU32[w+2]).buffer, HEAPU8[e+13]&1);
+    }
+  }
+  fetch(UTF8ToString(url)).then(function(res){
+    if(!res.ok||!res.body) throw new Error('HTTP '+res.status);
+    var reader=res.body.getReader(), head=new Uint8Array(0);
+    function pump(){
+      return reader.read().then(function(r){
+        if(r.done){ sfxIssued=true; settle(); return; }
+        var c=r.value;
+        if(!ptr){   /* the header carries the archive size (u32 at +16) */
+          var t=new Uint8Array(head.length+c.length); t.set(head); t.set(c, head.length); head=t;
+          if(head.length<20) return pump();
+          total=new DataView(head.buffer).getUint32(16, true);
+          ptr=Module._assetsAlloc(total); if(!ptr) throw new Error('out of memory');
+          c=head; head=null;
+        }
+        if(have+c.length>total) throw new Error('archive longer than its header');
+        HEAPU8.set(c, ptr+have); have+=c.length;
+        var ready=Module._assetsReceived(have);
+        if(ready<0) throw new Error('malformed archive');
+        take(ready);
+        return pump();
+      });
+    }
+    return pump();
+  }).catch(function(e){ console.error('assets.pak', e); sfxIssued=true; settle(); });
+});
+
+/* Drain the AudioRing (see audio_queue.h for the layout): one call per
+ * frame. Entries are consumed even while audio is locked or loading. */
+EM_JS(void, js_audio_drain, (const void* ring), {
+  var A=Module.audio;
+  var h=ring>>2, head=HEAPU32[h], tail=HEAPU32[h+1], mask=HEAPU32[h+2], slots=(ring+16)>>1;
+  var live = A && A.ctx && A.ready && A.unlocked;
+  for(; tail!==head; tail=(tail+1)>>>0){
+    if(!live) continue;
+    var e=HEAPU16[slots+(tail&mask)], arr=A.lists[e&255];
+    if(!arr||!arr.length) continue;
+    for(var l=e>>8; l>0; l--){
+      /* free voice, else steal the oldest */
+      var v=null, vs=A.voices;
+      for(var i=0;i<vs.length;i++){ if(!vs[i].src){ v=vs[i]; break; } if(!v||vs[i].t<v.t) v=vs[i]; }
+      if(v.src){ try{ v.src.stop(); }catch(_){} }
+      var src=A.ctx.createBufferSource(); src.buffer=arr[(Math.random()*arr.length)|0];
+      src.connect(v.gain); v.src=src; v.t=A.ctx.currentTime;
+      src.onended=(function(v,src){ return function(){ if(v.src===src) v.src=null; src.disconnect(); }; })(v,src);
+      src.start();
+    }
+  }
+  HEAPU32[h+1]=head;
 });
 
 EM_JS(void, js_music_try_play, (), {
   var A=Module.audio; if(!A||!A.ctx||A.music||!A.unlocked) return;
+  function play(buf){
+    if(A.music) return;
+    var src=A.ctx.createBufferSource(); src.buffer=buf; src.loop=true;
+    var gain=A.ctx.createGain(); gain.gain.value=0.3; src.connect(gain); gain.connect(A.ctx.destination);
+    A.music=src; A.musicGain=gain; src.start();
+  }
+  /* archive: music may still be on its way; play it when it lands */
+  if(A.pak){ A.musicWanted=play; if(A.musicBuf) play(A.musicBuf); return; }
   try{
     var data = FS.readFile('/music/theme.ogg');
-    A.ctx.decodeAudioData(data.buffer.slice(0)).then(function(buf){
-      var src=A.ctx.createBufferSource(); src.buffer=buf; src.loop=true;
-      var gain=A.ctx.createGain(); gain.gain.value=0.3; src.connect(gain); gain.connect(A.ctx.destination);
-      A.music=src; A.musicGain=gain; src.start();
-    }).catch(()=>{});
+    A.ctx.decodeAudioData(data.buffer.slice(0)).then(play).catch(()=>{});
   }catch(e){}
 });
 
-static void sfx_play(const char* name, int count){ js_audio_play(name, count); }
+#define AUDIO_VOICES 24  /* simultaneous SFX; the oldest is stolen beyond this */
 
-/* ---------------------------- Game Structures --------------------------- */
-typedef enum { ST_MENU=1, ST_PLAY=2, ST_OVER=3 } State;
+static AudioQueue AQ;   /* filled during tick(), drained by JS at its end */
 
-typedef struct { float x,y; int score; int timer; int isAI; } Bat;
-typedef struct { float x,y, dx,dy; int speed; float prev_x; } Ball;
-typedef struct { float x,y; int time; } Impact;
+/* C mixer path (A.startMixer): the ring stays this far ahead of the
+ * worklet, enough to ride out one late frame at 60 Hz */
+#define MIX_AHEAD_FRAMES 2048u
+static MixBank bank;
+static Mixer   mixer;
+static MixRing pcmRing;
+static int     mixerOn = 0;
 
-#define MAX_IMPACTS 64
-
-typedef struct {
-  Bat  bats[2];
-  Ball ball;
-  Impact impacts[MAX_IMPACTS]; int nImpacts;
-  int  numPlayers; /* 1 or 2 */
-  int  ai_offset;  /* -10..10 */
-  int  music_started;
-  State state;
-} Game;
+static void audio_flush(void){
+  audio_queue_flush(&AQ);
+  PROF_COUNT(PC_SFX, (int)audio_ring_count(&AQ.ring));
+  if(mixerOn){
+    mixer_drain(&mixer, &AQ.ring);
+    mix_ring_fill(&pcmRing, &mixer, MIX_AHEAD_FRAMES);
+  }
+  else if(audio_ring_count(&AQ.ring)){ js_audio_drain(&AQ.ring); PROF_COUNT(PC_JS_CALLS, 1); }
+}
 
+/* ------------------------------ Game State ------------------------------ */
 static Game G;
+static Hud  H;            /* HUD state; DOM or canvas, see setHudMode() */
+static int  hudCanvas = 0;
+static Game prevG;        /* G before the last sim step (interpolation) */
+static Vfx  fx;           /* particles, stepped with the sim */
+#define VFX_PARTICLES 2048  /* pool size; fits GFX_MAX_INSTANCES with the rest */
+static SimClock simClock; /* fixed-rate steps, independent of rAF rate */
+static int simHz = SIM_TICK_HZ;
+static int music_started = 0;
+static const char* const MENU_MSG = "UP/DOWN to select 1P/2P — SPACE to start";
+
+/* ------------------------------ Sim thread ------------------------------ */
+#ifdef PONG_SIM_THREAD
+static SimThread* simThread = NULL;   /* NULL: the sim side runs in tick() */
+#endif
+
+/* Clock of key timestamps and sim steps: the sim thread's when it runs. */
+static double clock_ms(void){
+#ifdef PONG_SIM_THREAD
+  if(simThread) return sim_thread_now_ms();
+#endif
+  return emscripten_get_now();
+}
 
 /* ----------------------------- Input State ------------------------------ */
-static int key_a=0,key_z=0,key_up=0,key_down=0,key_k=0,key_m=0;
-static int space_down=0; /* latched on keydown */
+static InputKeyMap keymap;
+static InputRing   inputRing;   /* key callbacks -> sim side, timestamped */
+static InputState  inputState;
 
 static EM_BOOL on_key(int type, const EmscriptenKeyboardEvent* e, void* user){
-  int down = (type==EMSCRIPTEN_EVENT_KEYDOWN);
-  if(!strcmp(e->key, "ArrowUp"))   { key_up   = down; return EM_TRUE; }
-  if(!strcmp(e->key, "ArrowDown")) { key_down = down; return EM_TRUE; }
-  if(!strcmp(e->key, "a") || !strcmp(e->key, "A")) { key_a = down; return EM_TRUE; }
-  if(!strcmp(e->key, "z") || !strcmp(e->key, "Z")) { key_z = down; return EM_TRUE; }
-  if(!strcmp(e->key, "k") || !strcmp(e->key, "K")) { key_k = down; return EM_TRUE; }
-  if(!strcmp(e->key, "m") || !strcmp(e->key, "M")) { key_m = down; return EM_TRUE; }
-  if(!strcmp(e->key, " ") || !strcmp(e->code,"Space") || !strcmp(e->key,"Spacebar")) { if(down) space_down=1; return EM_TRUE; }
-  return EM_FALSE;
+  unsigned code = (unsigned)e->keyCode;
+  if(e->repeat) return (code<INPUT_KEYS && keymap.action[code]) ? EM_TRUE : EM_FALSE;
+  return input_key_event(&inputRing, &keymap, code, type==EMSCRIPTEN_EVENT_KEYDOWN, clock_ms()) ? EM_TRUE : EM_FALSE;
 }
 
-/* ------------------------------ Math Utils ------------------------------ */
-static void normalised(float* x, float* y){
-  float len = sqrtf((*x)*(*x) + (*y)*(*y));
-  if(len<=0.0f){ *x=0; *y=0; return; }
-  *x /= len; *y /= len;
+/* -------------------------------- Replay -------------------------------- */
+static ReplayRecorder rec;           /* current match, reset on start */
+static uint8_t* lastReplay = NULL;   /* last finished match, see replayData() */
+static size_t   lastReplaySize = 0;
+/* sim side -> main thread: a finished match waiting to become lastReplay */
+static uint8_t* doneReplay = NULL;
+static size_t   doneReplaySize = 0;
+static int      doneReady = 0;
+
+static void replay_keep(void){   /* sim side */
+  if(PONG_LOAD_ACQ(&doneReady)) return;   /* the previous one isn't collected yet */
+  doneReplaySize = replay_rec_finish(&rec, &G, &doneReplay);
+  PONG_STORE_REL(&doneReady, 1);
 }
 
-/* ----------------------------- Game Helpers ----------------------------- */
-static void impact_add(float x,float y){
-  if(G.nImpacts<MAX_IMPACTS){ G.impacts[G.nImpacts].x=x; G.impacts[G.nImpacts].y=y; G.impacts[G.nImpacts].time=0; G.nImpacts++; }
-}
-static void impacts_update(){
-  int w=0; for(int i=0;i<G.nImpacts;i++){ Impact im=G.impacts[i]; im.time++; if(im.time<10){ G.impacts[w++]=im; } }
-  G.nImpacts=w;
+static void replay_collect(void){   /* main thread */
+  if(!PONG_LOAD_ACQ(&doneReady)) return;
+  free(lastReplay);
+  lastReplay = doneReplay; lastReplaySize = doneReplaySize; doneReplay = NULL;
+  PONG_STORE_REL(&doneReady, 0);
 }
 
-static void reset_ball_toward(int loser){
-  G.ball.x = WIDTH/2.0f; G.ball.y = HEIGHT/2.0f;
-  G.ball.dx = (loser==0? -1.0f : 1.0f);
-  G.ball.dy = 0.0f; G.ball.speed = 5; G.ball.prev_x = G.ball.x;
-}
+/* ---------------------------------- AI ---------------------------------- */
+static int     aiTier = 0;   /* 0: built-in blend AI, 1..4: AI_TIERS[aiTier-1] */
+static AiAgent agent;        /* drives P2 in 1P when aiTier > 0 ... */
+static int     agentOn = 0;  /* ... for the current match */
+
+/* ------------------------------- Multiball ------------------------------- */
+#define PARTY_MAX_BALLS 1000
+static SimParty party;
+static int partyBalls = 0;   /* setPartyBalls(); 0: the normal one-ball game */
+static int partyOn = 0;      /* the current match is a party (sim side) */
+
+/* ------------------------------- Snapshots ------------------------------- */
+#ifdef PONG_SIM_THREAD
+/* What the sim thread publishes after each step: everything render() and
+ * the HUD read, copied so the main thread never touches live sim state. */
+typedef struct {
+  Game     g, prev;        /* after / before the step (interpolation) */
+  uint32_t tick;           /* steps run so far */
+  double   t_ms;           /* time the step stands for (sim_thread_now_ms) */
+  int      party;          /* draw the balls below rather than g's */
+  int      nballs;
+  Bat      pbats[2];
+  Ball     balls[PARTY_MAX_BALLS];
+  InputLatency latency;    /* the sim side's histogram, for the exports */
+} RenderSnap;
+
+static RenderSnap snapSlot[3];
+static TripleBuf  snapBuf;
+static uint32_t   simTicks;      /* sim side */
+static uint32_t   shownTick;     /* main thread: tick of the last frame's snapshot */
+static const RenderSnap* shownSnap;   /* main thread: that snapshot (NULL: none yet) */
+static int        latencyResetReq;    /* main thread -> sim side: inputLatencyReset() */
+static SimParty   partyView;     /* snapshot balls in the shape scene_record_party() reads */
+static uint32_t   framesShown;   /* main thread -> sim side: rAF is alive */
+static uint32_t   seenFrames;    /* sim side */
+static double     seenAt;
+#define FRAME_STALL_MS 250.0     /* no frames for this long: hold the match */
+#endif
 
-static void new_game(){
-  G.bats[0].x = 40;        G.bats[0].y = HEIGHT/2.0f; G.bats[0].score=0; G.bats[0].timer=0; G.bats[0].isAI = 0;
-  G.bats[1].x = WIDTH-40;  G.bats[1].y = HEIGHT/2.0f; G.bats[1].score=0; G.bats[1].timer=0; G.bats[1].isAI = (G.numPlayers==1);
-  G.ai_offset = 0; G.nImpacts=0; reset_ball_toward(1);
-  ui_set_score(0,0);
+/* ------------------------------- Sim side -------------------------------- */
+/* Everything that changes G: menu keys, match start, steps. With a sim
+ * thread this runs there, so it reaches the rest of the frontend only
+ * through frontRing: the sim's Events for each step followed by FE_STEP,
+ * plus the menu's FE_* below (typed after EventType's values). */
+enum {
+  FE_STEP = EV_GAME_OVER + 1,   /* a step ended; side 1: trail at x,y (speed) */
+  FE_SELECT,                    /* menu: `side` players picked */
+  FE_START,                     /* match started */
+  FE_MENU                       /* back to the menu */
+};
+
+static EventRing frontRing;   /* sim side -> main thread */
+/* A step's SFX/particle events only fill the ring to 7/8: the rest is kept
+ * for FE_SELECT/START/MENU and game over, so a stalled main thread loses
+ * effects, never a state change. */
+#define FRONT_SHED_AT (EVENT_RING_CAP - EVENT_RING_CAP/8u)
+
+static void front_push(int type, int side, const Ball* b){
+  Event e = { (EventType)type, side, b ? b->speed : 0, b ? b->x : 0.0f, b ? b->y : 0.0f };
+  event_ring_push(&frontRing, &e);
 }
 
-static float p1_controls(){
-  if(key_z || key_down) return  PLAYER_SPEED;
-  if(key_a || key_up)   return -PLAYER_SPEED;
-  return 0.0f;
-}
-static float p2_controls(){
-  if(key_m) return  PLAYER_SPEED;
-  if(key_k) return -PLAYER_SPEED;
-  return 0.0f;
-}
-static float ai_control(int right){
-  float xdist = fabsf(G.ball.x - (right? G.bats[1].x : G.bats[0].x));
-  float t1 = HEIGHT/2.0f;
-  float t2 = G.ball.y + (float)G.ai_offset;
-  float w1 = fmaxf(0.0f, fminf(1.0f, xdist / (WIDTH/2.0f)));
-  float target = w1*t1 + (1.0f - w1)*t2;
-  float delta = target - (right? G.bats[1].y : G.bats[0].y);
-  if(delta >  MAX_AI_SPEED) delta =  MAX_AI_SPEED;
-  if(delta < -MAX_AI_SPEED) delta = -MAX_AI_SPEED;
-  return delta;
+static void front_push_step(const Events* ev, const Ball* trail){
+  int shed = event_ring_count(&frontRing) + (uint32_t)ev->n + 1u > FRONT_SHED_AT;
+  for(int i=0;i<ev->n;i++)
+    if(!shed || ev->ev[i].type==EV_GAME_OVER) event_ring_push(&frontRing, &ev->ev[i]);
+  if(!shed) front_push(FE_STEP, trail!=NULL, trail);   /* missed steps fade as idle ones */
 }
 
-static void update_game(){
-  /* paddles */
-  float dy0 = p1_controls();
-  float dy1 = (G.numPlayers==2? p2_controls() : ai_control(1));
-  G.bats[0].y += dy0; if(G.bats[0].y<80) G.bats[0].y=80; if(G.bats[0].y>400) G.bats[0].y=400;
-  G.bats[1].y += dy1; if(G.bats[1].y<80) G.bats[1].y=80; if(G.bats[1].y>400) G.bats[1].y=400;
-  G.bats[0].timer--; G.bats[1].timer--;
-
-  /* ball: integrate in 'speed' microsteps to emulate pygame cadence */
-  int steps = G.ball.speed;
-  for(int s=0;s<steps;++s){
-    G.ball.prev_x = G.ball.x;
-    G.ball.x += G.ball.dx;
-    G.ball.y += G.ball.dy;
-
-    const float halfW = 9.0f;   /* paddle half width */
-    const float halfH = 64.0f;  /* paddle half height */
-    const float R     = 7.0f;   /* ball radius */
-
-    /* left paddle */
-    if(G.ball.x - R <= G.bats[0].x + halfW && G.ball.prev_x - R > G.bats[0].x + halfW){
-      float diff_y = G.ball.y - G.bats[0].y;
-      if(diff_y>-halfH && diff_y<halfH){
-        G.ball.dx = -G.ball.dx;
-        G.ball.dy += diff_y / 128.0f; if(G.ball.dy>1.0f) G.ball.dy=1.0f; if(G.ball.dy<-1.0f) G.ball.dy=-1.0f;
-        normalised(&G.ball.dx,&G.ball.dy);
-        G.ball.x = G.bats[0].x + halfW + R;
-        G.ball.speed++;
-        G.ai_offset = (rand()%21)-10;
-        G.bats[0].timer = 10;
-        impact_add(G.ball.x - G.ball.dx*10.0f, G.ball.y);
-        sfx_play("hit",5);
-        if(G.ball.speed<=10) sfx_play("hit_slow",1); else if(G.ball.speed<=12) sfx_play("hit_medium",1); else if(G.ball.speed<=16) sfx_play("hit_fast",1); else sfx_play("hit_veryfast",1);
-      }
-    }
-    /* right paddle */
-    if(G.ball.x + R >= G.bats[1].x - halfW && G.ball.prev_x + R < G.bats[1].x - halfW){
-      float diff_y = G.ball.y - G.bats[1].y;
-      if(diff_y>-halfH && diff_y<halfH){
-        G.ball.dx = -G.ball.dx;
-        G.ball.dy += diff_y / 128.0f; if(G.ball.dy>1.0f) G.ball.dy=1.0f; if(G.ball.dy<-1.0f) G.ball.dy=-1.0f;
-        normalised(&G.ball.dx,&G.ball.dy);
-        G.ball.x = G.bats[1].x - halfW - R;
-        G.ball.speed++;
-        G.ai_offset = (rand()%21)-10;
-        G.bats[1].timer = 10;
-        impact_add(G.ball.x - G.ball.dx*10.0f, G.ball.y);
-        sfx_play("hit",5);
-        if(G.ball.speed<=10) sfx_play("hit_slow",1); else if(G.ball.speed<=12) sfx_play("hit_medium",1); else if(G.ball.speed<=16) sfx_play("hit_fast",1); else sfx_play("hit_veryfast",1);
+/* MENU / OVER: keys up to `now`. */
+static void sim_menu(double now){
+  uint32_t pressed = 0;
+  input_step(&inputState, &inputRing, now, &pressed);
+  if(G.state==ST_MENU){
+    if(pressed & ACT_MENU_UP){ G.numPlayers=1; front_push(FE_SELECT, 1, NULL); }
+    if(pressed & ACT_MENU_DOWN){ G.numPlayers=2; front_push(FE_SELECT, 2, NULL); }
+
+    if(pressed & ACT_START){
+      int tier = PONG_LOAD_RLX(&aiTier), balls = PONG_LOAD_RLX(&partyBalls);
+      /* a tiered agent plays P2 through its input bits: a 2P sim match */
+      agentOn = G.numPlayers==1 && tier>0 && !balls;
+      replay_rec_begin(&rec, &G, agentOn ? 2 : G.numPlayers, REPLAY_HASH_EVERY, PONG_LOAD_RLX(&simHz));
+      if(agentOn) ai_agent_init(&agent, (AiTierId)(tier-1), 1, G.rng ^ 0xA5A5A5A5u);
+      /* party: G only carries the state machine and the scores for the HUD */
+      partyOn = balls>0;
+      if(partyOn){
+        party.rng = G.rng;
+        sim_party_new_game(&party, balls, G.numPlayers);
+        party.win = SIM_WIN_SCORE*balls;
       }
+      prevG = G;
+      front_push(FE_START, 0, NULL);
     }
-
-    /* walls */
-    if(G.ball.y - R <= 0){ G.ball.dy = fabsf(G.ball.dy); G.ball.y = R; impact_add(G.ball.x, G.ball.y); sfx_play("bounce",5); sfx_play("bounce_synth",1); }
-    if(G.ball.y + R >= HEIGHT){ G.ball.dy = -fabsf(G.ball.dy); G.ball.y = HEIGHT - R; impact_add(G.ball.x, G.ball.y); sfx_play("bounce",5); sfx_play("bounce_synth",1); }
   }
-
-  impacts_update();
-
-  /* scoring */
-  int out_left  = (G.ball.x + 7.0f) < 0.0f;
-  int out_right = (G.ball.x - 7.0f) > (float)WIDTH;
-  if(out_left || out_right){
-    int scorer = out_left ? 1 : 0;
-    int loser  = 1 - scorer;
-    if(G.bats[loser].timer < 0){
-      G.bats[scorer].score += 1; ui_set_score(G.bats[0].score, G.bats[1].score);
-      G.bats[loser].timer = 20; sfx_play("score_goal",1);
-    } else if(G.bats[loser].timer == 0){
-      reset_ball_toward(loser);
-    }
+  else if(G.state==ST_OVER && (pressed & ACT_START)){
+    G.state = ST_MENU; G.numPlayers=1;
+    front_push(FE_MENU, 0, NULL);
   }
+}
 
-  /* win */
-  if(G.bats[0].score>=10 || G.bats[1].score>=10){
-    G.state = ST_OVER; ui_set_msg("Game Over — SPACE to return to menu");
+/* One PLAY step; it sees the keys that went down/up by its own time `t`. */
+static void sim_play(double t){
+  Input in = input_step(&inputState, &inputRing, t, NULL);
+  Events ev; ev.n = 0;
+  if(partyOn){
+    sim_party_step(&party, &in, &ev);
+    G.bats[0].score = party.bats[0].score; G.bats[1].score = party.bats[1].score;
+    G.state = party.state;
+    front_push_step(&ev, NULL);
+    return;
   }
+  if(agentOn) in.buttons = (in.buttons & (IN_P1_UP|IN_P1_DOWN)) | ai_agent_buttons(&agent, &G);
+  prevG = G;
+  sim_step(&G, &in, &ev);
+  replay_rec_step(&rec, &in, &G);
+  front_push_step(&ev, &G.ball);
+  if(G.state!=ST_PLAY) replay_keep();
 }
 
-/* ------------------------------ Rendering ------------------------------- */
-static void setColor(const float c[4]){ glUniform4f(uColor, c[0],c[1],c[2],c[3]); }
-static void drawRect(float cx,float cy,float w,float h,const float col[4]){
-  glBindVertexArray(vaoRect);
-  glUniform2f(uScale, w, h);
-  glUniform2f(uTranslate, cx, cy);
-  setColor(col);
-  glDrawArrays(GL_TRIANGLES, 0, 6);
-}
-static void drawCircleFilled(float cx,float cy,float r,const float col[4]){
-  glBindVertexArray(vaoCirc);
-  glUniform2f(uScale, 2*r, 2*r);
-  glUniform2f(uTranslate, cx, cy);
-  setColor(col);
-  glDrawArrays(GL_TRIANGLE_FAN, 0, circleCount);
-}
-static void drawCircleOutline(float cx,float cy,float r,const float col[4]){
-  glBindVertexArray(vaoCirc);
-  glUniform2f(uScale, 2*r, 2*r);
-  glUniform2f(uTranslate, cx, cy);
-  setColor(col);
-  /* WebGL2 line width is effectively 1; this is fine for the ripple */
-  glDrawArrays(GL_LINE_LOOP, 1, circleCount-1); /* skip center */
+#ifdef PONG_SIM_THREAD
+/* The sim thread's step: run, then publish what the frame will draw. */
+static void sim_thread_step(void* user, double t){
+  (void)user;
+  /* a hidden tab stops rAF; hold the match as the frame loop would */
+  uint32_t shown = PONG_LOAD_ACQ(&framesShown);
+  if(shown!=seenFrames){ seenFrames = shown; seenAt = t; }
+  if(t - seenAt > FRAME_STALL_MS) return;
+
+  if(G.state==ST_PLAY) sim_play(t); else sim_menu(t);
+
+  RenderSnap* s = (RenderSnap*)triple_back(&snapBuf);
+  s->g = G; s->prev = prevG;
+  s->tick = ++simTicks; s->t_ms = t;
+  s->party = partyOn;
+  if(partyOn){
+    s->pbats[0] = party.bats[0]; s->pbats[1] = party.bats[1];
+    s->nballs = party.n;
+    memcpy(s->balls, party.balls, (size_t)party.n*sizeof(Ball));
+  }
+  /* key-to-publish: the main thread picks it up at its next frame */
+  if(PONG_LOAD_ACQ(&latencyResetReq)){
+    input_latency_reset(&inputState.latency);
+    PONG_STORE_REL(&latencyResetReq, 0);
+  }
+  input_frame_submitted(&inputState, sim_thread_now_ms());
+  s->latency = inputState.latency;
+  triple_publish(&snapBuf);
 }
+#endif
 
-static void draw_center_line(){
-  for(int y=0;y<HEIGHT;y+=20){
-    drawRect(WIDTH/2.0f, (float)y+5.0f, 4.0f, 10.0f, WHITE);
+/* ---------------------------- Sim -> SFX / HUD --------------------------- */
+static void play_events(const Events* ev){
+  audio_play_events(&AQ, ev);
+  for(int i=0;i<ev->n;i++){
+    const Event* e = &ev->ev[i];
+    switch(e->type){
+      case EV_GAME_OVER:
+        hud_set_msg(&H, "Game Over — SPACE to return to menu");
+        break;
+      default:
+        break;
+    }
   }
 }
 
-static void draw_impacts(){
-  for(int i=0;i<G.nImpacts;i++){
-    float r = 2.0f + G.impacts[i].time * 1.5f;
-    float a = fmaxf(0.0f, 1.0f - G.impacts[i].time * 0.1f);
-    float col[4] = {1.0f,1.0f,1.0f,a};
-    drawCircleOutline(G.impacts[i].x, G.impacts[i].y, r, col);
+/* Main thread: apply what the sim side did since the last frame (SFX,
+ * HUD, particles per step). Returns the steps it covered. */
+static int front_drain(void){
+  Events ev; ev.n = 0;
+  Event e;
+  int steps = 0;
+  while(event_ring_pop(&frontRing, &e)){
+    switch((int)e.type){
+      case FE_STEP:
+        play_events(&ev);
+        vfx_emit_events(&fx, &ev);
+        if(e.side){ Ball b = { e.x, e.y, 0.0f, 0.0f, e.speed, e.x }; vfx_emit_trail(&fx, &b); }
+        vfx_step(&fx); steps++;
+        PROF_COUNT(PC_SIM_STEPS, 1); PROF_COUNT(PC_EVENTS, ev.n); PROF_COUNT(PC_MICROSTEPS, e.speed);
+        ev.n = 0;
+        break;
+      case FE_SELECT:
+        hud_set_players(&H, e.side); audio_play(&AQ, e.side==1 ? SFX_UP : SFX_DOWN, 1);
+        break;
+      case FE_START:
+        js_audio_resume(); if(!music_started){ js_music_try_play(); music_started=1; }
+        PROF_COUNT(PC_JS_CALLS, 2);
+        hud_set_msg(&H, "");
+        vfx_clear(&fx);
+        break;
+      case FE_MENU:
+        hud_set_players(&H, 1); hud_set_msg(&H, MENU_MSG);
+        break;
+      default:   /* the sim's own, ahead of their step's FE_STEP */
+        if(ev.n<SIM_MAX_EVENTS) ev.ev[ev.n++] = e;
+        break;
+    }
   }
+  if(ev.n){ play_events(&ev); vfx_emit_events(&fx, &ev); }   /* step not in yet, or shed */
+  replay_collect();
+  return steps;
 }
 
-static void render(){
-  glClearColor(GREEN[0],GREEN[1],GREEN[2],1.0f);
-  glClear(GL_COLOR_BUFFER_BIT);
-  glUseProgram(prog);
-  glUniform2f(uResolution, (float)WIDTH, (float)HEIGHT);
-
-  draw_center_line();
-  draw_impacts();
-
-  const float *col0 = (G.bats[0].timer>0 && (G.ball.x<0||G.ball.x>WIDTH)) ? RED : WHITE;
-  const float *col1 = (G.bats[1].timer>0 && (G.ball.x<0||G.ball.x>WIDTH)) ? BLUE: WHITE;
-  drawRect(G.bats[0].x, G.bats[0].y, 18.0f, 128.0f, col0);
-  drawRect(G.bats[1].x, G.bats[1].y, 18.0f, 128.0f, col1);
-
-  drawCircleFilled(G.ball.x, G.ball.y, 7.0f, WHITE);
+/* ------------------------------ Rendering ------------------------------- */
+static int profGraph = 0;   /* frame-time overlay (PONG_PROFILE builds) */
+
+/* `g` and `prev` are the states after / before the last step; `pv` the
+ * party to draw instead, if any. */
+static void render(const Game* g, const Game* prev, const SimParty* pv, float alpha){
+  /* draw between the last two sim states so motion is smooth at any refresh */
+  Game view; sim_lerp(prev, g, alpha, &view);
+
+  /* scores + goal tint (pygame behaviour); only changes reach the DOM */
+  hud_sync_game(&H, g);
+
+  /* record the playfield, then replay it: one upload + one instanced draw */
+  PROF_ZONE(PZ_SCENE){
+    if(pv) scene_record_party(pv, &fx, hudCanvas ? &H : NULL, &frame);  /* latest state */
+    else   scene_record(&view, &fx, hudCanvas ? &H : NULL, &frame);
+#ifdef PONG_PROFILE
+    if(profGraph){   /* second draw, bottom left, 50 ms full scale */
+      int cap; ShapeInstance* dst = gfx_shapes_reserve(&frame, &cap);
+      gfx_shapes_commit(&frame, prof_graph_build(dst, cap, 8.0f, (float)HEIGHT - 88.0f, 240.0f, 80.0f, 50.0f));
+    }
+#endif
+  }
+  PROF_ZONE(PZ_SUBMIT) gfx_submit(&gles, &frame);
+  PROF_COUNT(PC_DRAW_CALLS, gles.stats.draw_calls);
+  PROF_COUNT(PC_GL_STATE, gles.stats.state_changes + gles.stats.uniform_uploads);
+  PROF_COUNT(PC_INSTANCES, gles.stats.instances);
 
-  /* tint HUD scores similar to pygame behavior */
-  const float *scL = (G.bats[1].timer>0 && (G.ball.x<0||G.ball.x>WIDTH)) ? RED : WHITE;
-  const float *scR = (G.bats[0].timer>0 && (G.ball.x<0||G.ball.x>WIDTH)) ? BLUE: WHITE;
-  ui_set_score_colors(scL, scR);
+  unsigned dirty = hud_take_dirty(&H);
+  if(dirty && !hudCanvas) PROF_ZONE(PZ_HUD){ js_hud_flush(&H, dirty); PROF_COUNT(PC_JS_CALLS, 1); }
 }
 
+/* Console helpers over profTraceJson(): Module.profTrace() returns the
+ * trace as a string, Module.profDownload() saves it as a file. */
+EM_JS(void, js_prof_install, (), {
+  Module.profTrace = function(){ return UTF8ToString(Module._profTraceJson()); };
+  Module.profDownload = function(name){
+    var url=URL.createObjectURL(new Blob([Module.profTrace()], { type:'application/json' }));
+    var a=document.createElement('a'); a.href=url; a.download=name||'pong-trace.json'; a.click();
+    setTimeout(function(){ URL.revokeObjectURL(url); }, 0);
+  };
+});
+
 /* --------------------------- Main Loop / State --------------------------- */
+static int fxOwed = 0;   /* idle particle steps: sim steps minus steps drained */
+
 static void tick(void){
-  if(G.state==ST_MENU){
-    static int last_up=0, last_down=0;
-    if(key_up && !last_up){ G.numPlayers=1; ui_set_mode_1p2p(1); sfx_play("up",1); }
-    if(key_down && !last_down){ G.numPlayers=2; ui_set_mode_1p2p(2); sfx_play("down",1); }
-    last_up=key_up; last_down=key_down;
-
-    if(space_down){
-      space_down=0;
-      js_audio_resume(); if(!G.music_started){ js_music_try_play(); G.music_started=1; }
-      G.state = ST_PLAY; new_game(); G.bats[1].isAI = (G.numPlayers==1); ui_set_msg("");
+  PROF_FRAME_BEGIN();
+  const Game *cur = &G, *prev = &prevG;
+  const SimParty* pv = NULL;
+  float alpha = 1.0f;
+  int ticks;   /* sim steps since the last frame */
+#ifdef PONG_SIM_THREAD
+  if(simThread){
+    /* latest snapshot, never waiting on the sim */
+    const RenderSnap* s = (const RenderSnap*)triple_take(&snapBuf, NULL);
+    PONG_STORE_REL(&framesShown, framesShown + 1u);
+    if(!s){ PROF_FRAME_END(); return; }
+    ticks = (int)(s->tick - shownTick); shownTick = s->tick; shownSnap = s;
+    cur = &s->g; prev = &s->prev;
+    if(s->party){
+      partyView.bats[0] = s->pbats[0]; partyView.bats[1] = s->pbats[1];
+      partyView.n = s->nballs; partyView.balls = (Ball*)s->balls;
+      pv = &partyView;
     }
-  }
-  else if(G.state==ST_PLAY){
-    update_game();
-  }
-  else if(G.state==ST_OVER){
-    if(space_down){
-      space_down=0; G.state = ST_MENU; G.numPlayers=1; ui_set_mode_1p2p(1);
-      ui_set_msg("UP/DOWN to select 1P/2P — SPACE to start");
+    if(cur->state==ST_PLAY){
+      double a = (sim_thread_now_ms() - s->t_ms) * (double)PONG_LOAD_RLX(&simHz) / 1000.0;
+      alpha = a<0.0 ? 0.0f : a>1.0 ? 1.0f : (float)a;
     }
+  } else
+#endif
+  {
+    double now = emscripten_get_now();
+    ticks = sim_clock_advance(&simClock, now);
+    if(G.state==ST_PLAY){
+      PROF_ZONE(PZ_SIM)
+        for(int i=0; i<ticks && G.state==ST_PLAY; i++) sim_play(sim_clock_step_time(&simClock, i, ticks));
+    } else {
+      PROF_ZONE(PZ_INPUT) sim_menu(now);
+      if(G.state==ST_PLAY) sim_clock_reset(&simClock);  /* menu time doesn't count */
+    }
+    if(G.state==ST_PLAY) alpha = sim_clock_alpha(&simClock);
+    if(partyOn) pv = &party;
   }
 
-  render();
+  /* effects fade out on the game-over screen at the same rate; with a sim
+   * thread the ring can run a step ahead of the snapshot, hence the carry */
+  fxOwed += ticks - front_drain();
+  for(; fxOwed>0 && (fx.n || fx.flash>0.0f); fxOwed--) vfx_step(&fx);
+  if(fxOwed>0) fxOwed = 0;
+  PROF_COUNT(PC_PARTICLES, fx.n);
+
+  PROF_ZONE(PZ_AUDIO) audio_flush();
+  PROF_ZONE(PZ_RENDER) render(cur, prev, pv, alpha);
+#ifdef PONG_SIM_THREAD
+  if(!simThread)
+#endif
+    input_frame_submitted(&inputState, emscripten_get_now());
+  PROF_FRAME_END();
 }
 
 /* ------------------------------- Exports -------------------------------- */
 EMSCRIPTEN_KEEPALIVE
 int initWebGL(void){
   static EMSCRIPTEN_WEBGL_CONTEXT_HANDLE ctx = 0;
+#ifdef PONG_SIM_THREAD
+  sim_thread_stop(simThread); simThread = NULL;   /* re-init: the sim side is ours again */
+#endif
   if(!ctx){
     EmscriptenWebGLContextAttributes attr; emscripten_webgl_init_context_attributes(&attr);
     attr.majorVersion=2; attr.minorVersion=0; attr.depth=EM_FALSE;
@@ -488,20 +673,166 @@ int initWebGL(void){
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
   }
 
-  if(!makeProgram()) return 0;
-  makeUnitRect();
-  makeUnitCircle(64);
-
-  G.state = ST_MENU; G.numPlayers=1; ui_set_mode_1p2p(1); G.music_started=0; G.nImpacts=0;
-  ui_set_score(0,0);
-  ui_set_title("Pong!");
-  ui_set_msg("UP/DOWN to select 1P/2P — SPACE to start");
-
-  js_audio_init();
+  if(!gfx_gles_init(&gles)) return 0;
+
+  input_keymap_default(&keymap); input_ring_init(&inputRing); input_state_init(&inputState);
+  event_ring_init(&frontRing); fxOwed = 0;
+  sim_init(&G, (uint32_t)emscripten_get_now()); music_started=0;
+  prevG = G; sim_clock_init(&simClock, simHz, SIM_MAX_CATCHUP);
+  hud_init(&H);
+  if(!fx.block && !vfx_init(&fx, VFX_PARTICLES)) return 0;
+  if(!party.block && !sim_party_init(&party, PARTY_MAX_BALLS, 1u)) return 0;
+  vfx_clear(&fx);
+  hud_set_title(&H, "Pong!");
+  hud_set_msg(&H, MENU_MSG);
+
+  prof_reset(); js_prof_install();
+  audio_queue_init(&AQ, AUDIO_VOICES_PER_FRAME);
+  js_audio_init(AUDIO_VOICES);
+  for(int i=0;i<SFX_COUNT;i++) js_audio_define(i, AUDIO_SFX_NAME[i], AUDIO_SFX_VARIANTS[i]);
+#ifdef PONG_ASSET_PAK
+  js_audio_load_pak("assets.pak");
+#else
   js_audio_load_all();
+#endif
 
+#ifdef PONG_SIM_THREAD
+  triple_init(&snapBuf, &snapSlot[0], &snapSlot[1], &snapSlot[2]);
+  simTicks = shownTick = 0; shownSnap = NULL; latencyResetReq = 0; seenFrames = framesShown; seenAt = sim_thread_now_ms();
+  simThread = sim_thread_start(simHz, sim_thread_step, NULL);   /* NULL: tick() steps it */
+#endif
   return 1;
 }
 
 EMSCRIPTEN_KEEPALIVE
 void startMainLoop(void){ emscripten_set_main_loop(tick, 0, 1); }
+
+EMSCRIPTEN_KEEPALIVE
+void setSimHz(int hz){
+  PONG_STORE_REL(&simHz, hz<1 ? SIM_TICK_HZ : hz);
+  sim_clock_set_hz(&simClock, hz);
+#ifdef PONG_SIM_THREAD
+  if(simThread) sim_thread_set_hz(simThread, hz);
+#endif
+}
+
+/* Multiball from the next match on: `n` balls (up to 1000), 0 for the
+ * normal game. Party matches are not recorded as replays. */
+EMSCRIPTEN_KEEPALIVE
+void setPartyBalls(int n){ PONG_STORE_REL(&partyBalls, n<0 ? 0 : n>PARTY_MAX_BALLS ? PARTY_MAX_BALLS : n); }
+
+/* Key-to-frame-submit latency, e.g. Module._inputLatencyPercentile(99).
+ * With a sim thread: key to published snapshot, as of the snapshot the
+ * last frame drew (the live histogram belongs to the sim thread). */
+static const InputLatency* latency_view(void){
+#ifdef PONG_SIM_THREAD
+  static const InputLatency none;
+  if(simThread) return shownSnap ? &shownSnap->latency : &none;
+#endif
+  return &inputState.latency;
+}
+
+EMSCRIPTEN_KEEPALIVE
+double inputLatencyPercentile(double p){ return input_latency_percentile(latency_view(), p); }
+
+EMSCRIPTEN_KEEPALIVE
+int inputLatencyCount(void){ return (int)latency_view()->count; }
+
+/* With a sim thread: done by its next step. */
+EMSCRIPTEN_KEEPALIVE
+void inputLatencyReset(void){
+#ifdef PONG_SIM_THREAD
+  if(simThread){ PONG_STORE_REL(&latencyResetReq, 1); return; }
+#endif
+  input_latency_reset(&inputState.latency);
+}
+
+/* Last finished match in the replay format (replay.h), for replay_play:
+ * Module.HEAPU8.slice(p, p + Module._replaySize()), p = Module._replayData().
+ * 0/0 before the first match ends. */
+EMSCRIPTEN_KEEPALIVE
+uint8_t* replayData(void){ return lastReplay; }
+
+EMSCRIPTEN_KEEPALIVE
+int replaySize(void){ return (int)lastReplaySize; }
+
+/* C mixer setup, called from A.startMixer(): arena for `frames`
+ * samples at the context's rate, then one clip per decoded buffer. */
+EMSCRIPTEN_KEEPALIVE
+int audioMixerBegin(int rate, int frames){
+  if(frames<=0 || !mix_bank_init(&bank, (uint32_t)frames)) return 0;
+  mixer_init(&mixer, &bank, rate);
+  mix_ring_init(&pcmRing);
+  return 1;
+}
+
+EMSCRIPTEN_KEEPALIVE
+float* audioMixerClip(int sfx, int variant, int frames){
+  return frames>0 ? mix_bank_add(&bank, (Sfx)sfx, variant, (uint32_t)frames) : NULL;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void* audioMixerRing(void){ return &pcmRing; }
+
+EMSCRIPTEN_KEEPALIVE
+void audioMixerStart(void){ mixerOn = 1; }
+
+/* Asset archive download (js_audio_load_pak): one buffer for the whole
+ * file, filled by JS as chunks arrive. assetsReceived() returns the number
+ * of complete entries, 0 before the index is whole, -1 if malformed. */
+static uint8_t*   pakBuf;
+static AssetPack  pak;
+static AssetEntry pakEntry;
+static int        pakOpen = 0;
+
+EMSCRIPTEN_KEEPALIVE
+uint8_t* assetsAlloc(int total){
+  free(pakBuf); pakOpen = 0;
+  pakBuf = total>0 ? (uint8_t*)malloc((size_t)total) : NULL;
+  return pakBuf;
+}
+
+EMSCRIPTEN_KEEPALIVE
+int assetsReceived(int have){
+  if(!pakOpen){
+    int r = asset_pack_open(&pak, pakBuf, (size_t)have);
+    if(r <= 0) return r;
+    pakOpen = 1;
+  }
+  return (int)asset_pack_received(&pak, (size_t)have);
+}
+
+EMSCRIPTEN_KEEPALIVE
+const AssetEntry* assetsEntry(int i){ asset_pack_entry(&pak, (uint32_t)i, &pakEntry); return &pakEntry; }
+
+/* Chrome trace JSON of the last PROF_FRAMES frames (chrome://tracing,
+ * Perfetto), NUL-terminated; valid until the next call. Without
+ * PONG_PROFILE the trace is empty. */
+EMSCRIPTEN_KEEPALIVE
+const char* profTraceJson(void){
+  static char* buf; static size_t cap;
+  size_t need = prof_trace_json(buf, cap) + 1;
+  if(need > cap){
+    char* nb = (char*)realloc(buf, need);
+    if(!nb) return "";
+    buf = nb; cap = need;
+    prof_trace_json(buf, cap);
+  }
+  return buf;
+}
+
+/* Frame-time graph overlay on the canvas (PONG_PROFILE builds). */
+EMSCRIPTEN_KEEPALIVE
+void profSetGraph(int on){ profGraph = on!=0; }
+
+/* 1P opponent: 0 = classic blend AI, 1..4 = easy/medium/hard/expert.
+ * Takes effect at the next start. */
+EMSCRIPTEN_KEEPALIVE
+void setAiTier(int tier){ PONG_STORE_REL(&aiTier, tier<0 ? 0 : tier>AI_TIER_COUNT ? AI_TIER_COUNT : tier); }
+
+EMSCRIPTEN_KEEPALIVE
+void setHudMode(int canvas){
+  hudCanvas = canvas!=0;
+  js_hud_show_dom(!hudCanvas);
+  if(!hudCanvas) H.dirty = HUD_DIRTY_ALL;  /* DOM missed every change meanwhile */
+}
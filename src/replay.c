@@ -0,0 +1,170 @@
+/* replay.c — match recorder, binary replay format, headless player
+ * See replay.h for the layout. Everything is serialised byte by byte, so
+ * files move between the wasm build and native tools unchanged.
+ */
+
+#include "replay.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bytes_internal.h"
+
+const char* replay_status_name(ReplayStatus s){
+  switch(s){
+    case REPLAY_OK:         return "ok";
+    case REPLAY_ERR_FORMAT: return "bad format";
+    case REPLAY_ERR_INPUT:  return "input stream mismatch";
+    case REPLAY_ERR_DESYNC: return "desync";
+  }
+  return "?";
+}
+
+/* -------------------------------- Buffers -------------------------------- */
+static int grow(void** buf, uint32_t* cap, uint32_t need, size_t elem){
+  if(need <= *cap) return 1;
+  uint32_t n = *cap ? *cap : 256u;
+  while(n < need) n *= 2u;
+  void* p = realloc(*buf, (size_t)n*elem);
+  if(!p) return 0;
+  *buf = p; *cap = n;
+  return 1;
+}
+
+/* ------------------------------- Recorder ------------------------------- */
+void replay_rec_free(ReplayRecorder* r){
+  free(r->in); free(r->hash);
+  memset(r, 0, sizeof(*r));
+}
+
+void replay_rec_begin(ReplayRecorder* r, Game* g, int numPlayers, int hash_every, int tick_hz){
+  memset(&r->hdr, 0, sizeof(r->hdr));
+  r->hdr.magic = REPLAY_MAGIC; r->hdr.version = REPLAY_VERSION;
+  r->hdr.tick_hz = (uint16_t)tick_hz;
+  r->hdr.seed = g->rng;
+  r->hdr.numPlayers = (uint8_t)numPlayers;
+  r->hdr.solver = (uint8_t)g->solver;
+  r->hdr.hash_every = (uint16_t)(hash_every>0 ? hash_every : 0);
+  r->in_len = 0; r->hash_len = 0; r->run_len = 0; r->run_buttons = 0; r->failed = 0;
+  sim_new_game(g, numPlayers);
+}
+
+static void put_run(ReplayRecorder* r){
+  if(!r->run_len) return;
+  uint32_t n = r->run_len - 1u;
+  if(!grow((void**)&r->in, &r->in_cap, r->in_len + 6u, 1)){ r->failed = 1; return; }
+  if(n < 15u){ r->in[r->in_len++] = (uint8_t)(r->run_buttons | n<<4); return; }
+  r->in[r->in_len++] = (uint8_t)(r->run_buttons | 15u<<4);
+  n -= 15u;
+  do{ uint8_t b = (uint8_t)(n & 0x7Fu); n >>= 7; r->in[r->in_len++] = (uint8_t)(b | (n ? 0x80u : 0u)); }while(n);
+}
+
+void replay_rec_step(ReplayRecorder* r, const Input* in, const Game* after){
+  unsigned b = in->buttons & 15u;
+  if(r->run_len && b != r->run_buttons){ put_run(r); r->run_len = 0; }
+  r->run_buttons = b; r->run_len++;
+  r->hdr.steps++;
+  if(r->hdr.hash_every && r->hdr.steps % r->hdr.hash_every == 0){
+    if(!grow((void**)&r->hash, &r->hash_cap, r->hash_len + 1u, sizeof(uint32_t))){ r->failed = 1; return; }
+    r->hash[r->hash_len++] = sim_state_hash(after);
+  }
+}
+
+size_t replay_rec_finish(ReplayRecorder* r, const Game* g, uint8_t** out){
+  put_run(r); r->run_len = 0;
+  *out = NULL;
+  if(r->failed) return 0;
+  ReplayHeader* h = &r->hdr;
+  h->input_bytes = r->in_len;
+  h->final_hash = sim_state_hash(g);
+  h->final_state = (uint8_t)g->state;
+
+  size_t size = REPLAY_HEADER_BYTES + (size_t)r->in_len + 4u*(size_t)r->hash_len;
+  uint8_t* p = (uint8_t*)calloc(1, size);
+  if(!p) return 0;
+  put_u32(p+0, h->magic); put_u16(p+4, h->version); put_u16(p+6, h->tick_hz);
+  put_u32(p+8, h->seed);  p[12] = h->numPlayers; p[13] = h->solver; put_u16(p+14, h->hash_every);
+  put_u32(p+16, h->steps); put_u32(p+20, h->input_bytes); put_u32(p+24, h->final_hash);
+  p[28] = h->final_state;  /* 29..31 reserved, zero */
+  if(r->in_len) memcpy(p + REPLAY_HEADER_BYTES, r->in, r->in_len);
+  for(uint32_t i=0;i<r->hash_len;i++) put_u32(p + REPLAY_HEADER_BYTES + r->in_len + 4u*i, r->hash[i]);
+  *out = p;
+  return size;
+}
+
+/* -------------------------------- Player -------------------------------- */
+ReplayStatus replay_parse(Replay* r, const uint8_t* data, size_t len){
+  memset(r, 0, sizeof(*r));
+  if(len < REPLAY_HEADER_BYTES) return REPLAY_ERR_FORMAT;
+  ReplayHeader* h = &r->hdr;
+  h->magic = get_u32(data+0); h->version = (uint16_t)get_u16(data+4); h->tick_hz = (uint16_t)get_u16(data+6);
+  h->seed = get_u32(data+8); h->numPlayers = data[12]; h->solver = data[13];
+  h->hash_every = (uint16_t)get_u16(data+14);
+  h->steps = get_u32(data+16); h->input_bytes = get_u32(data+20); h->final_hash = get_u32(data+24);
+  h->final_state = data[28];
+  if(h->magic != REPLAY_MAGIC || h->version != REPLAY_VERSION) return REPLAY_ERR_FORMAT;
+  if(h->numPlayers < 1 || h->numPlayers > 2 || h->solver > SIM_SOLVER_MICROSTEP) return REPLAY_ERR_FORMAT;
+
+  r->n_hash = h->hash_every ? h->steps / h->hash_every : 0u;
+  size_t body = len - REPLAY_HEADER_BYTES;
+  if((size_t)h->input_bytes > body || body - h->input_bytes != 4u*(size_t)r->n_hash) return REPLAY_ERR_FORMAT;
+  r->in = data + REPLAY_HEADER_BYTES;
+  r->hashes = r->in + h->input_bytes;
+  return REPLAY_OK;
+}
+
+void replay_cursor_init(ReplayCursor* c, const Replay* r){
+  c->r = r; c->pos = 0; c->left = 0; c->buttons = 0;
+}
+
+int replay_cursor_next(ReplayCursor* c, Input* in){
+  if(!c->left){
+    const uint8_t* p = c->r->in;
+    uint32_t end = c->r->hdr.input_bytes;
+    if(c->pos >= end) return 0;
+    uint8_t t = p[c->pos++];
+    uint32_t n = (uint32_t)(t >> 4);
+    if(n == 15u){
+      uint32_t extra = 0; int shift = 0; uint8_t b;
+      do{
+        if(c->pos >= end || shift > 28) return 0;
+        b = p[c->pos++];
+        extra |= (uint32_t)(b & 0x7Fu) << shift; shift += 7;
+      }while(b & 0x80u);
+      n += extra;
+    }
+    c->buttons = t & 15u;
+    c->left = n + 1u;
+  }
+  c->left--;
+  in->buttons = c->buttons;
+  return 1;
+}
+
+void replay_start(const Replay* r, Game* g){
+  sim_init(g, r->hdr.seed);
+  g->solver = r->hdr.solver;
+  sim_new_game(g, r->hdr.numPlayers);
+}
+
+ReplayStatus replay_run(const Replay* r, Game* g, uint32_t* bad_step){
+  ReplayCursor c; Input in;
+  uint32_t every = r->hdr.hash_every, next_hash = every;
+  const uint8_t* hp = r->hashes;
+  replay_start(r, g);
+  replay_cursor_init(&c, r);
+  for(uint32_t s=1; s<=r->hdr.steps; s++){
+    if(!replay_cursor_next(&c, &in)){ if(bad_step) *bad_step = s; return REPLAY_ERR_INPUT; }
+    sim_step(g, &in, NULL);
+    if(s == next_hash){
+      if(sim_state_hash(g) != get_u32(hp)){ if(bad_step) *bad_step = s; return REPLAY_ERR_DESYNC; }
+      hp += 4; next_hash += every;
+    }
+  }
+  if(c.left || c.pos != r->hdr.input_bytes){ if(bad_step) *bad_step = r->hdr.steps; return REPLAY_ERR_INPUT; }
+  if(sim_state_hash(g) != r->hdr.final_hash || (uint32_t)g->state != r->hdr.final_state){
+    if(bad_step) *bad_step = r->hdr.steps;
+    return REPLAY_ERR_DESYNC;
+  }
+  return REPLAY_OK;
+}
@@ -0,0 +1,30 @@
+/* scene.c — Game -> recorded GfxFrame */
+
+#include "scene.h"
+
+#include "shapes.h"
+
+static ShapeInstance* begin(GfxFrame* f, int* cap){
+  gfx_frame_begin(f);
+  gfx_clear(f, COL_GREEN);
+  gfx_set_pipeline(f, GFX_PIPE_SHAPES);
+  gfx_set_resolution(f, (float)SIM_WIDTH, (float)SIM_HEIGHT);
+  return gfx_shapes_reserve(f, cap);
+}
+
+/* particles and HUD on top of the `n` playfield instances, one draw */
+static void finish(GfxFrame* f, ShapeInstance* dst, int n, int cap, const Vfx* fx, const Hud* hud){
+  if(fx) n += vfx_build(fx, dst + n, cap - n);
+  if(hud) n += hud_build(hud, dst + n, cap - n);
+  gfx_shapes_commit(f, n);
+}
+
+void scene_record(const Game* g, const Vfx* fx, const Hud* hud, GfxFrame* f){
+  int cap; ShapeInstance* dst = begin(f, &cap);
+  finish(f, dst, shapes_build(g, dst, cap), cap, fx, hud);
+}
+
+void scene_record_party(const SimParty* p, const Vfx* fx, const Hud* hud, GfxFrame* f){
+  int cap; ShapeInstance* dst = begin(f, &cap);
+  finish(f, dst, shapes_build_party(p, dst, cap), cap, fx, hud);
+}
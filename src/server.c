@@ -0,0 +1,616 @@
+/* server.c — UDP match server: epoll I/O thread, tick workers, match slab */
+
+#define _GNU_SOURCE   /* recvmmsg / sendmmsg */
+
+#include "server.h"
+
+#ifndef __linux__
+#  error "server.c needs Linux (epoll, recvmmsg/sendmmsg)"
+#endif
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/random.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bytes_internal.h"
+#include "pong_atomic.h"
+#include "sim_clock.h"
+
+#define IO_BATCH   64    /* datagrams per recvmmsg */
+#define SEND_BATCH 64    /* STATEs per sendmmsg */
+#define SWEEP_MS   100   /* reclaim / timeout scan */
+#define SOCK_BUF   (4<<20)
+
+/* --------------------------------- Wire ---------------------------------- */
+static void put_f32(uint8_t* p, float f){ uint32_t u; memcpy(&u, &f, 4); put_u32(p, u); }
+static float get_f32(const uint8_t* p){ uint32_t u = get_u32(p); float f; memcpy(&f, &u, 4); return f; }
+
+/* body size per type, after the 4-byte header */
+static size_t body_size(int type){
+  switch(type){
+    case SRV_JOIN:      return 5;
+    case SRV_INPUT:     return 9;
+    case SRV_STATE:     return 42;
+    case SRV_LEAVE:     return 5;
+    case SRV_STATS_REQ: return 4;
+    case SRV_STATS:     return 48;
+    case SRV_COOKIE:    return 4;
+    default:            return 0;
+  }
+}
+
+size_t srv_msg_encode(const SrvMsg* m, uint8_t* buf, size_t cap){
+  if(m->type < SRV_JOIN || m->type > SRV_COOKIE) return 0;
+  size_t n = 4 + body_size(m->type);
+  if(cap < n) return 0;
+  buf[0] = 'P'; buf[1] = 'S'; buf[2] = SRV_VERSION; buf[3] = m->type;
+  uint8_t* p = buf + 4;
+  switch(m->type){
+    case SRV_JOIN: p[0] = m->mode; put_u32(p+1, m->cookie); break;
+    case SRV_STATS_REQ: case SRV_COOKIE: put_u32(p, m->cookie); break;
+    case SRV_INPUT: put_u32(p, m->match); p[4] = m->side; put_u32(p+5, m->buttons); break;
+    case SRV_LEAVE: put_u32(p, m->match); p[4] = m->side; break;
+    case SRV_STATE: {
+      const SrvState* s = &m->st;
+      put_u32(p, s->match); put_u32(p+4, s->tick); put_u32(p+8, s->sent_us);
+      p[12] = s->side; p[13] = s->state; p[14] = s->score[0]; p[15] = s->score[1];
+      put_f32(p+16, s->bat_y[0]); put_f32(p+20, s->bat_y[1]);
+      put_f32(p+24, s->ball_x); put_f32(p+28, s->ball_y);
+      put_f32(p+32, s->ball_dx); put_f32(p+36, s->ball_dy);
+      put_u16(p+40, s->speed);
+      break;
+    }
+    case SRV_STATS: {
+      const ServerStats* s = &m->stats;
+      put_u32(p, s->active); put_u32(p+4, s->started); put_u32(p+8, s->ticks);
+      put_u32(p+12, (uint32_t)s->steps); put_u32(p+16, (uint32_t)(s->steps>>32));
+      put_u32(p+20, s->workers); put_u32(p+24, s->late_p50_us); put_u32(p+28, s->late_p99_us);
+      put_u32(p+32, s->late_max_us); put_u32(p+36, s->cpu_ns_per_step);
+      put_u32(p+40, s->send_drops); put_u32(p+44, s->overruns);
+      break;
+    }
+    default: break;
+  }
+  return n;
+}
+
+int srv_msg_decode(SrvMsg* m, const uint8_t* buf, size_t len){
+  if(len < 4 || buf[0] != 'P' || buf[1] != 'S' || buf[2] != SRV_VERSION) return 0;
+  int type = buf[3];
+  if(type < SRV_JOIN || type > SRV_COOKIE || len != 4 + body_size(type)) return 0;
+  memset(m, 0, sizeof(*m));
+  m->type = (uint8_t)type;
+  const uint8_t* p = buf + 4;
+  switch(type){
+    case SRV_JOIN: m->mode = p[0]; m->cookie = get_u32(p+1); break;
+    case SRV_STATS_REQ: case SRV_COOKIE: m->cookie = get_u32(p); break;
+    case SRV_INPUT: m->match = get_u32(p); m->side = p[4]; m->buttons = get_u32(p+5); break;
+    case SRV_LEAVE: m->match = get_u32(p); m->side = p[4]; break;
+    case SRV_STATE: {
+      SrvState* s = &m->st;
+      s->match = get_u32(p); s->tick = get_u32(p+4); s->sent_us = get_u32(p+8);
+      s->side = p[12]; s->state = p[13]; s->score[0] = p[14]; s->score[1] = p[15];
+      s->bat_y[0] = get_f32(p+16); s->bat_y[1] = get_f32(p+20);
+      s->ball_x = get_f32(p+24); s->ball_y = get_f32(p+28);
+      s->ball_dx = get_f32(p+32); s->ball_dy = get_f32(p+36);
+      s->speed = (uint16_t)get_u16(p+40);
+      break;
+    }
+    case SRV_STATS: {
+      ServerStats* s = &m->stats;
+      s->active = get_u32(p); s->started = get_u32(p+4); s->ticks = get_u32(p+8);
+      s->steps = (uint64_t)get_u32(p+12) | (uint64_t)get_u32(p+16)<<32;
+      s->workers = get_u32(p+20); s->late_p50_us = get_u32(p+24); s->late_p99_us = get_u32(p+28);
+      s->late_max_us = get_u32(p+32); s->cpu_ns_per_step = get_u32(p+36);
+      s->send_drops = get_u32(p+40); s->overruns = get_u32(p+44);
+      break;
+    }
+    default: break;
+  }
+  return 1;
+}
+
+/* --------------------------------- State --------------------------------- */
+enum { SRV_FREE = 0, SRV_RUNNING, SRV_ENDED };
+
+typedef struct {
+  Game g;                       /* worker only while running */
+  struct sockaddr_in addr[2];   /* set before publish, then read-only */
+  int humans;                   /* 1 (vs AI) or 2 */
+  uint32_t tick;                /* worker only */
+  unsigned buttons[2];          /* I/O thread writes, worker reads */
+  int live;                     /* SRV_FREE / SRV_RUNNING / SRV_ENDED */
+  int stop;                     /* I/O thread asks the worker to end it */
+  uint64_t seen_ms[2];          /* I/O thread only */
+  int next_free;                /* I/O thread only */
+} Match;
+
+/* I/O thread only: open addressing, linear probing, key 0 = empty */
+typedef struct {
+  uint64_t key;                 /* ip_key() or seat_key() */
+  uint32_t n;                   /* ip: seats held; seat: its slot */
+} Peer;
+
+typedef struct {
+  struct mmsghdr msg[SEND_BATCH];
+  struct iovec iov[SEND_BATCH];
+  uint8_t buf[SEND_BATCH][SRV_MSG_MAX];
+  int n;
+  uint32_t drops;
+} SendBatch;
+
+typedef struct {
+  Server* s;
+  int id;
+  SendBatch batch;              /* this wake's STATEs */
+  pthread_t thr;
+  pthread_mutex_t lock;         /* guards the totals below */
+  uint64_t steps, cpu_ns;
+  uint32_t ticks, drops, overruns, late_max;
+  uint32_t late[SRV_LATE_BUCKETS];
+} Worker;
+
+struct Server {
+  int fd, ep;
+  uint16_t port;
+  int max, nworkers;
+  uint32_t seed;
+  Match* slab;
+  int free_head;
+  uint32_t active, started;
+  int pending;                  /* a mode-2 JOIN waiting for an opponent */
+  struct sockaddr_in pending_addr;
+  uint64_t pending_ms;
+  uint64_t key[2];              /* cookie secret */
+  Peer* peers;                  /* seats by address and per IP */
+  uint32_t peer_mask;
+  int max_per_addr;
+  uint64_t stats_ms;            /* last STATS reply */
+  uint64_t t0_ns;
+  int quit;
+  Worker w[SRV_MAX_WORKERS];
+};
+
+static uint64_t now_ns(clockid_t c){
+  struct timespec ts;
+  clock_gettime(c, &ts);
+  return (uint64_t)ts.tv_sec*1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int same_addr(const struct sockaddr_in* a, const struct sockaddr_in* b){
+  return a->sin_addr.s_addr == b->sin_addr.s_addr && a->sin_port == b->sin_port;
+}
+
+/* -------------------------------- Workers -------------------------------- */
+static void batch_flush(Server* s, SendBatch* b){
+  int off = 0;
+  while(off < b->n){
+    int r = sendmmsg(s->fd, b->msg + off, (unsigned)(b->n - off), MSG_DONTWAIT);
+    if(r <= 0){ if(r < 0 && errno == EINTR) continue; break; }
+    off += r;
+  }
+  b->drops += (uint32_t)(b->n - off);
+  b->n = 0;
+}
+
+static void send_state(Server* s, SendBatch* b, const Match* m, int idx, int side, uint32_t sent_us){
+  SrvMsg msg;
+  msg.type = SRV_STATE;
+  SrvState* st = &msg.st;
+  st->match = (uint32_t)idx; st->tick = m->tick; st->sent_us = sent_us;
+  st->side = (uint8_t)side; st->state = (uint8_t)m->g.state;
+  st->score[0] = (uint8_t)m->g.bats[0].score; st->score[1] = (uint8_t)m->g.bats[1].score;
+  st->bat_y[0] = m->g.bats[0].y; st->bat_y[1] = m->g.bats[1].y;
+  st->ball_x = m->g.ball.x; st->ball_y = m->g.ball.y;
+  st->ball_dx = m->g.ball.dx; st->ball_dy = m->g.ball.dy;
+  st->speed = (uint16_t)m->g.ball.speed;
+  int k = b->n++;
+  b->iov[k].iov_base = b->buf[k];
+  b->iov[k].iov_len = srv_msg_encode(&msg, b->buf[k], SRV_MSG_MAX);
+  memset(&b->msg[k].msg_hdr, 0, sizeof(b->msg[k].msg_hdr));
+  b->msg[k].msg_hdr.msg_name = (void*)&m->addr[side];
+  b->msg[k].msg_hdr.msg_namelen = sizeof(m->addr[side]);
+  b->msg[k].msg_hdr.msg_iov = &b->iov[k];
+  b->msg[k].msg_hdr.msg_iovlen = 1;
+  if(b->n == SEND_BATCH) batch_flush(s, b);
+}
+
+/* side 1 sends IN_P1_* bits too: move them to the right paddle */
+static unsigned match_buttons(const Match* m){
+  unsigned b = PONG_LOAD_RLX(&m->buttons[0]) & (IN_P1_UP|IN_P1_DOWN);
+  if(m->humans == 2){
+    unsigned r = PONG_LOAD_RLX(&m->buttons[1]);
+    b |= (r & IN_P1_UP ? IN_P2_UP : 0) | (r & IN_P1_DOWN ? IN_P2_DOWN : 0);
+  }
+  return b;
+}
+
+static void* worker_main(void* arg){
+  Worker* w = (Worker*)arg;
+  Server* s = w->s;
+  const uint64_t period = 1000000000ull / SIM_TICK_HZ / SRV_SUBTICKS;
+  const int stride = s->nworkers * SRV_SUBTICKS;
+  SendBatch* batch = &w->batch;
+  uint64_t deadline = s->t0_ns;
+  int phase = 0;
+  while(!PONG_LOAD_ACQ(&s->quit)){
+    deadline += period;
+    struct timespec ts = { (time_t)(deadline / 1000000000ull), (long)(deadline % 1000000000ull) };
+    while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR){}
+    uint64_t woke = now_ns(CLOCK_MONOTONIC);
+    uint64_t late_ns = woke > deadline ? woke - deadline : 0;
+    uint32_t overrun = 0;
+    if(late_ns > period*SRV_SUBTICKS){   /* a whole tick behind: don't try to catch up */
+      deadline = woke;
+      overrun = 1;
+    }
+    uint64_t cpu0 = now_ns(CLOCK_THREAD_CPUTIME_ID);
+    uint32_t sent_us = (uint32_t)((woke - s->t0_ns) / 1000);
+    uint64_t steps = 0;
+    batch->n = 0; batch->drops = 0;
+    for(int i = w->id + s->nworkers*phase; i < s->max; i += stride){
+      Match* m = &s->slab[i];
+      if(PONG_LOAD_ACQ(&m->live) != SRV_RUNNING) continue;
+      if(PONG_LOAD_ACQ(&m->stop)){ PONG_STORE_REL(&m->live, SRV_ENDED); continue; }
+      Input in = { match_buttons(m) };
+      sim_step(&m->g, &in, NULL);
+      m->tick++; steps++;
+      for(int k=0;k<m->humans;k++) send_state(s, batch, m, i, k, sent_us);
+      if(m->g.state != ST_PLAY) PONG_STORE_REL(&m->live, SRV_ENDED);
+    }
+    batch_flush(s, batch);
+    uint64_t cpu = now_ns(CLOCK_THREAD_CPUTIME_ID) - cpu0;
+    uint32_t late_us = (uint32_t)(late_ns / 1000);
+
+    pthread_mutex_lock(&w->lock);
+    w->steps += steps; w->cpu_ns += cpu;
+    w->drops += batch->drops; w->overruns += overrun;
+    w->late[late_us < SRV_LATE_BUCKETS ? late_us : SRV_LATE_BUCKETS-1]++;
+    if(late_us > w->late_max) w->late_max = late_us;
+    if(phase == SRV_SUBTICKS-1) w->ticks++;
+    pthread_mutex_unlock(&w->lock);
+    phase = (phase + 1) % SRV_SUBTICKS;
+  }
+  return NULL;
+}
+
+/* -------------------------------- Cookies -------------------------------- */
+static uint64_t rotl(uint64_t x, int b){ return (x << b) | (x >> (64 - b)); }
+
+#define SIPROUND do{ \
+    v0 += v1; v1 = rotl(v1, 13); v1 ^= v0; v0 = rotl(v0, 32); \
+    v2 += v3; v3 = rotl(v3, 16); v3 ^= v2; \
+    v0 += v3; v3 = rotl(v3, 21); v3 ^= v0; \
+    v2 += v1; v1 = rotl(v1, 17); v1 ^= v2; v2 = rotl(v2, 32); }while(0)
+
+/* SipHash-2-4 of a 16-byte message (m0, m1 little endian) */
+static uint64_t siphash16(const uint64_t k[2], uint64_t m0, uint64_t m1){
+  uint64_t v0 = k[0] ^ 0x736f6d6570736575ull, v1 = k[1] ^ 0x646f72616e646f6dull;
+  uint64_t v2 = k[0] ^ 0x6c7967656e657261ull, v3 = k[1] ^ 0x7465646279746573ull;
+  const uint64_t m[3] = { m0, m1, 16ull << 56 };
+  for(int i=0;i<3;i++){ v3 ^= m[i]; SIPROUND; SIPROUND; v0 ^= m[i]; }
+  v2 ^= 0xff;
+  SIPROUND; SIPROUND; SIPROUND; SIPROUND;
+  return v0 ^ v1 ^ v2 ^ v3;
+}
+
+static uint32_t cookie_for(const Server* s, const struct sockaddr_in* a, uint64_t bucket){
+  uint64_t m0 = (uint64_t)a->sin_addr.s_addr | (uint64_t)a->sin_port << 32;
+  uint32_t c = (uint32_t)siphash16(s->key, m0, bucket);
+  return c ? c : 1u;   /* 0 means "no cookie" on the wire */
+}
+
+static int cookie_ok(const Server* s, uint32_t c, const struct sockaddr_in* a, uint64_t now_ms){
+  uint64_t b = now_ms / SRV_COOKIE_MS;
+  return c != 0 && (c == cookie_for(s, a, b) || (b > 0 && c == cookie_for(s, a, b - 1)));
+}
+
+/* the reply to an unproven request: 8 bytes, never more than it */
+static void send_cookie(Server* s, const struct sockaddr_in* to, uint64_t now_ms){
+  SrvMsg out; uint8_t b[SRV_MSG_MAX];
+  memset(&out, 0, sizeof out);
+  out.type = SRV_COOKIE;
+  out.cookie = cookie_for(s, to, now_ms / SRV_COOKIE_MS);
+  size_t n = srv_msg_encode(&out, b, sizeof b);
+  sendto(s->fd, b, n, MSG_DONTWAIT, (const struct sockaddr*)to, sizeof(*to));
+}
+
+/* --------------------------------- Peers --------------------------------- */
+static uint64_t ip_key(const struct sockaddr_in* a){ return 1ull << 48 | a->sin_addr.s_addr; }
+static uint64_t seat_key(const struct sockaddr_in* a){
+  return 2ull << 48 | (uint64_t)a->sin_addr.s_addr << 16 | a->sin_port;
+}
+
+/* the key's entry, or the empty one where it would go */
+static Peer* peer_find(Server* s, uint64_t key){
+  uint32_t i = (uint32_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & s->peer_mask;
+  while(s->peers[i].key && s->peers[i].key != key) i = (i + 1) & s->peer_mask;
+  return &s->peers[i];
+}
+
+/* backward-shift delete, so probes never need tombstones */
+static void peer_remove(Server* s, Peer* p){
+  uint32_t hole = (uint32_t)(p - s->peers), i = hole;
+  for(;;){
+    i = (i + 1) & s->peer_mask;
+    if(!s->peers[i].key) break;
+    uint32_t home = (uint32_t)((s->peers[i].key * 0x9E3779B97F4A7C15ull) >> 32) & s->peer_mask;
+    /* movable if its home is not in (hole, i] */
+    if(((i - home) & s->peer_mask) >= ((i - hole) & s->peer_mask)){
+      s->peers[hole] = s->peers[i];
+      hole = i;
+    }
+  }
+  s->peers[hole].key = 0; s->peers[hole].n = 0;
+}
+
+static uint32_t ip_seats(Server* s, const struct sockaddr_in* a){ return peer_find(s, ip_key(a))->n; }
+
+static void seat_take(Server* s, const struct sockaddr_in* a, int slot){
+  Peer* p = peer_find(s, ip_key(a));
+  p->key = ip_key(a); p->n++;
+  p = peer_find(s, seat_key(a));
+  p->key = seat_key(a); p->n = (uint32_t)slot;
+}
+
+static void seat_give_back(Server* s, const struct sockaddr_in* a){
+  Peer* p = peer_find(s, seat_key(a));
+  if(p->key) peer_remove(s, p);
+  p = peer_find(s, ip_key(a));
+  if(p->key && --p->n == 0) peer_remove(s, p);
+}
+
+/* ------------------------------- I/O thread ------------------------------ */
+static void match_free(Server* s, int i){
+  Match* m = &s->slab[i];
+  for(int k=0;k<m->humans;k++) seat_give_back(s, &m->addr[k]);
+  PONG_STORE_REL(&m->live, SRV_FREE);
+  m->next_free = s->free_head; s->free_head = i;
+  s->active--;
+}
+
+/* `a` may take `extra` more seats: it holds none (a slot that ended but
+ * was not swept yet is freed now) and its IP stays within the cap */
+static int may_seat(Server* s, const struct sockaddr_in* a, uint32_t extra){
+  Peer* p = peer_find(s, seat_key(a));
+  if(p->key){
+    if(PONG_LOAD_ACQ(&s->slab[p->n].live) != SRV_ENDED) return 0;
+    match_free(s, (int)p->n);
+  }
+  return ip_seats(s, a) + extra <= (uint32_t)s->max_per_addr;
+}
+
+static int match_open(Server* s, int humans, const struct sockaddr_in* a0, const struct sockaddr_in* a1, uint64_t now_ms){
+  int i = s->free_head;
+  if(i < 0) return -1;
+  Match* m = &s->slab[i];
+  s->free_head = m->next_free;
+  sim_init(&m->g, (s->seed ^ (s->started * 0x9E3779B9u)) | 1u);
+  sim_new_game(&m->g, humans);
+  memset(m->addr, 0, sizeof(m->addr));
+  m->addr[0] = *a0;
+  if(a1) m->addr[1] = *a1;
+  m->humans = humans;
+  m->tick = 0;
+  m->buttons[0] = m->buttons[1] = 0;
+  m->seen_ms[0] = m->seen_ms[1] = now_ms;
+  m->stop = 0;
+  for(int k=0;k<humans;k++) seat_take(s, &m->addr[k], i);
+  s->active++; s->started++;
+  PONG_STORE_REL(&m->live, SRV_RUNNING);
+  return i;
+}
+
+/* the slot's player, if `from` is who it claims to be */
+static Match* match_player(Server* s, const SrvMsg* msg, const struct sockaddr_in* from){
+  if(msg->match >= (uint32_t)s->max) return NULL;
+  Match* m = &s->slab[msg->match];
+  if(msg->side >= m->humans || PONG_LOAD_ACQ(&m->live) != SRV_RUNNING) return NULL;
+  return same_addr(&m->addr[msg->side], from) ? m : NULL;
+}
+
+static void on_datagram(Server* s, const uint8_t* buf, size_t len, const struct sockaddr_in* from, uint64_t now_ms){
+  SrvMsg msg;
+  if(!srv_msg_decode(&msg, buf, len)) return;
+  switch(msg.type){
+    case SRV_JOIN:
+      if(!cookie_ok(s, msg.cookie, from, now_ms)){ send_cookie(s, from, now_ms); break; }
+      if(msg.mode != 1 && msg.mode != 2) break;
+      if(!may_seat(s, from, 1)) break;   /* a retransmit, or the IP is at its cap */
+      if(msg.mode == 1){ match_open(s, 1, from, NULL, now_ms); break; }
+      if(s->pending && now_ms - s->pending_ms > SRV_TIMEOUT_MS) s->pending = 0;
+      if(s->pending && !same_addr(&s->pending_addr, from)){
+        int same_ip = s->pending_addr.sin_addr.s_addr == from->sin_addr.s_addr;
+        if(!may_seat(s, &s->pending_addr, 1u + (same_ip ? 1u : 0u))){
+          s->pending_addr = *from; s->pending_ms = now_ms;   /* the waiting one can't play now */
+        } else if(match_open(s, 2, &s->pending_addr, from, now_ms) >= 0) s->pending = 0;
+      } else {
+        s->pending = 1; s->pending_addr = *from; s->pending_ms = now_ms;
+      }
+      break;
+    case SRV_INPUT: {
+      Match* m = match_player(s, &msg, from);
+      if(!m) break;
+      PONG_STORE_REL(&m->buttons[msg.side], msg.buttons);
+      m->seen_ms[msg.side] = now_ms;
+      break;
+    }
+    case SRV_LEAVE: {
+      Match* m = match_player(s, &msg, from);
+      if(m) PONG_STORE_REL(&m->stop, 1);
+      break;
+    }
+    case SRV_STATS_REQ: {
+      if(!cookie_ok(s, msg.cookie, from, now_ms)){ send_cookie(s, from, now_ms); break; }
+      if(s->stats_ms && now_ms - s->stats_ms < SRV_STATS_MIN_MS) break;
+      s->stats_ms = now_ms;
+      SrvMsg out; uint8_t b[SRV_MSG_MAX];
+      memset(&out, 0, sizeof out);
+      out.type = SRV_STATS;
+      server_stats(s, &out.stats);
+      size_t n = srv_msg_encode(&out, b, sizeof b);
+      sendto(s->fd, b, n, MSG_DONTWAIT, (const struct sockaddr*)from, sizeof(*from));
+      break;
+    }
+    default: break;
+  }
+}
+
+/* free ended slots, stop matches whose players went quiet */
+static void sweep(Server* s, uint64_t now_ms){
+  for(int i=0;i<s->max;i++){
+    Match* m = &s->slab[i];
+    int live = PONG_LOAD_ACQ(&m->live);
+    if(live == SRV_ENDED){
+      match_free(s, i);
+    } else if(live == SRV_RUNNING){
+      for(int k=0;k<m->humans;k++)
+        if(now_ms - m->seen_ms[k] > SRV_TIMEOUT_MS) PONG_STORE_REL(&m->stop, 1);
+    }
+  }
+}
+
+void server_run(Server* s){
+  struct mmsghdr msg[IO_BATCH];
+  struct iovec iov[IO_BATCH];
+  uint8_t buf[IO_BATCH][SRV_MSG_MAX];
+  struct sockaddr_in from[IO_BATCH];
+  uint64_t last_sweep = 0;
+  while(!PONG_LOAD_ACQ(&s->quit)){
+    struct epoll_event ev[4];
+    int n = epoll_wait(s->ep, ev, 4, 50);
+    uint64_t now_ms = now_ns(CLOCK_MONOTONIC) / 1000000ull;
+    if(n > 0){
+      for(;;){
+        for(int i=0;i<IO_BATCH;i++){
+          iov[i].iov_base = buf[i]; iov[i].iov_len = SRV_MSG_MAX;
+          memset(&msg[i].msg_hdr, 0, sizeof(msg[i].msg_hdr));
+          msg[i].msg_hdr.msg_name = &from[i]; msg[i].msg_hdr.msg_namelen = sizeof(from[i]);
+          msg[i].msg_hdr.msg_iov = &iov[i]; msg[i].msg_hdr.msg_iovlen = 1;
+        }
+        int r = recvmmsg(s->fd, msg, IO_BATCH, MSG_DONTWAIT, NULL);
+        if(r <= 0) break;
+        for(int i=0;i<r;i++)
+          if(!(msg[i].msg_hdr.msg_flags & MSG_TRUNC))
+            on_datagram(s, buf[i], msg[i].msg_len, &from[i], now_ms);
+        if(r < IO_BATCH) break;
+      }
+    }
+    if(now_ms - last_sweep >= SWEEP_MS){ sweep(s, now_ms); last_sweep = now_ms; }
+  }
+}
+
+/* --------------------------------- API ---------------------------------- */
+Server* server_start(const ServerConfig* cfg){
+  if(cfg->max_matches <= 0 || cfg->max_matches > (1<<24) || cfg->workers <= 0 || cfg->workers > SRV_MAX_WORKERS){
+    fprintf(stderr, "server: bad config\n");
+    return NULL;
+  }
+  Server* s = (Server*)calloc(1, sizeof(Server));
+  if(!s) return NULL;
+  s->fd = s->ep = -1;
+  s->max = cfg->max_matches; s->nworkers = cfg->workers; s->seed = cfg->seed;
+  s->max_per_addr = cfg->max_per_addr > 0 ? cfg->max_per_addr : SRV_MAX_PER_ADDR;
+  s->slab = (Match*)calloc((size_t)s->max, sizeof(Match));
+  /* at most two entries per seat, two seats per slot: keep it under half full */
+  uint32_t np = 16;
+  while(np < 8u*(uint32_t)s->max) np <<= 1;
+  s->peers = (Peer*)calloc(np, sizeof(Peer));
+  s->peer_mask = np - 1;
+  if(!s->slab || !s->peers){ fprintf(stderr, "server: out of memory\n"); free(s->slab); free(s->peers); free(s); return NULL; }
+  if(getrandom(s->key, sizeof s->key, 0) != (ssize_t)sizeof s->key){
+    perror("server: getrandom"); free(s->slab); free(s->peers); free(s); return NULL;
+  }
+  for(int i=0;i<s->max;i++) s->slab[i].next_free = i+1 < s->max ? i+1 : -1;
+  s->free_head = 0;
+
+  s->fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if(s->fd < 0){ perror("server: socket"); goto fail; }
+  int one = 1, sz = SOCK_BUF;
+  setsockopt(s->fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one);
+  setsockopt(s->fd, SOL_SOCKET, SO_RCVBUF, &sz, sizeof sz);
+  setsockopt(s->fd, SOL_SOCKET, SO_SNDBUF, &sz, sizeof sz);
+  struct sockaddr_in a;
+  memset(&a, 0, sizeof a);
+  a.sin_family = AF_INET; a.sin_addr.s_addr = htonl(INADDR_ANY); a.sin_port = htons(cfg->port);
+  if(bind(s->fd, (struct sockaddr*)&a, sizeof a) < 0){ perror("server: bind"); goto fail; }
+  socklen_t al = sizeof a;
+  getsockname(s->fd, (struct sockaddr*)&a, &al);
+  s->port = ntohs(a.sin_port);
+
+  s->ep = epoll_create1(EPOLL_CLOEXEC);
+  struct epoll_event ev = { .events = EPOLLIN };
+  if(s->ep < 0 || epoll_ctl(s->ep, EPOLL_CTL_ADD, s->fd, &ev) < 0){ perror("server: epoll"); goto fail; }
+
+  s->t0_ns = now_ns(CLOCK_MONOTONIC);
+  for(int i=0;i<s->nworkers;i++){
+    Worker* w = &s->w[i];
+    w->s = s; w->id = i;
+    pthread_mutex_init(&w->lock, NULL);
+    if(pthread_create(&w->thr, NULL, worker_main, w) != 0){
+      fprintf(stderr, "server: can't start worker %d\n", i);
+      s->nworkers = i;
+      server_shutdown(s); server_free(s);
+      return NULL;
+    }
+  }
+  return s;
+fail:
+  if(s->ep >= 0) close(s->ep);
+  if(s->fd >= 0) close(s->fd);
+  free(s->slab); free(s->peers); free(s);
+  return NULL;
+}
+
+uint16_t server_port(const Server* s){ return s->port; }
+
+void server_shutdown(Server* s){ PONG_STORE_REL(&s->quit, 1); }
+
+void server_free(Server* s){
+  if(!s) return;
+  PONG_STORE_REL(&s->quit, 1);
+  for(int i=0;i<s->nworkers;i++){
+    pthread_join(s->w[i].thr, NULL);
+    pthread_mutex_destroy(&s->w[i].lock);
+  }
+  close(s->ep); close(s->fd);
+  free(s->slab); free(s->peers); free(s);
+}
+
+static uint32_t late_pct(const uint32_t* h, uint64_t total, double q){
+  uint64_t want = (uint64_t)((double)total * q), acc = 0;
+  for(int i=0;i<SRV_LATE_BUCKETS;i++){ acc += h[i]; if(acc > want) return (uint32_t)i; }
+  return SRV_LATE_BUCKETS-1;
+}
+
+void server_stats(Server* s, ServerStats* out){
+  uint32_t hist[SRV_LATE_BUCKETS] = { 0 };
+  memset(out, 0, sizeof(*out));
+  out->active = s->active; out->started = s->started;
+  out->workers = (uint32_t)s->nworkers;
+  uint64_t cpu = 0, wakes = 0;
+  for(int i=0;i<s->nworkers;i++){
+    Worker* w = &s->w[i];
+    pthread_mutex_lock(&w->lock);
+    out->steps += w->steps; cpu += w->cpu_ns;
+    out->send_drops += w->drops; out->overruns += w->overruns;
+    if(w->ticks > out->ticks) out->ticks = w->ticks;
+    if(w->late_max > out->late_max_us) out->late_max_us = w->late_max;
+    for(int b=0;b<SRV_LATE_BUCKETS;b++){ hist[b] += w->late[b]; wakes += w->late[b]; }
+    pthread_mutex_unlock(&w->lock);
+  }
+  if(wakes){
+    out->late_p50_us = late_pct(hist, wakes, 0.50);
+    out->late_p99_us = late_pct(hist, wakes, 0.99);
+  }
+  if(out->steps) out->cpu_ns_per_step = (uint32_t)(cpu / out->steps);
+}
@@ -0,0 +1,53 @@
+/* shapes.c — Game state -> ShapeInstance list
+ * Same draw order and colours as the old per-primitive render(): dashed
+ * centre line, paddles (flashing after a goal), ball. Hit ripples and the
+ * other effects are particles (vfx.c), drawn on top.
+ */
+
+#include "shapes.h"
+
+/* ---------------------------- Config / Colors ---------------------------- */
+const float COL_WHITE[4]  = {1.0f, 1.0f, 1.0f, 1.0f};
+const float COL_GREEN[4]  = {30/255.0f, 128/255.0f, 30/255.0f, 1.0f};
+const float COL_YELLOW[4] = {240/255.0f,240/255.0f, 50/255.0f,1.0f};
+const float COL_RED[4]    = {240/255.0f, 50/255.0f, 50/255.0f,1.0f};
+const float COL_BLUE[4]   = { 50/255.0f, 50/255.0f,240/255.0f,1.0f};
+
+static int push(ShapeInstance* out, int n, int cap, ShapeKind kind,
+                float x, float y, float w, float h, const float col[4], float outline){
+  if(n>=cap) return n;
+  ShapeInstance* s = &out[n];
+  s->x=x; s->y=y; s->w=w; s->h=h;
+  s->color[0]=col[0]; s->color[1]=col[1]; s->color[2]=col[2]; s->color[3]=col[3];
+  s->outline=outline; s->kind=(float)kind;
+  return n+1;
+}
+
+int shapes_build(const Game* g, ShapeInstance* out, int cap){
+  int n = 0;
+
+  /* centre line */
+  for(int y=0;y<SIM_HEIGHT;y+=20)
+    n = push(out, n, cap, SHAPE_RECT, SIM_WIDTH/2.0f, (float)y+5.0f, 4.0f, 10.0f, COL_WHITE, 0.0f);
+
+  /* paddles flash the scorer's colour while the ball is off the field */
+  int ball_out = (g->ball.x<0 || g->ball.x>SIM_WIDTH);
+  const float *col0 = (g->bats[0].timer>0 && ball_out) ? COL_RED  : COL_WHITE;
+  const float *col1 = (g->bats[1].timer>0 && ball_out) ? COL_BLUE : COL_WHITE;
+  n = push(out, n, cap, SHAPE_RECT, g->bats[0].x, g->bats[0].y, 2*SIM_BAT_HALF_W, 2*SIM_BAT_HALF_H, col0, 0.0f);
+  n = push(out, n, cap, SHAPE_RECT, g->bats[1].x, g->bats[1].y, 2*SIM_BAT_HALF_W, 2*SIM_BAT_HALF_H, col1, 0.0f);
+
+  n = push(out, n, cap, SHAPE_CIRCLE, g->ball.x, g->ball.y, 2*SIM_BALL_R, 2*SIM_BALL_R, COL_WHITE, 0.0f);
+  return n;
+}
+
+int shapes_build_party(const SimParty* p, ShapeInstance* out, int cap){
+  int n = 0;
+  for(int y=0;y<SIM_HEIGHT;y+=20)
+    n = push(out, n, cap, SHAPE_RECT, SIM_WIDTH/2.0f, (float)y+5.0f, 4.0f, 10.0f, COL_WHITE, 0.0f);
+  for(int k=0;k<2;k++)
+    n = push(out, n, cap, SHAPE_RECT, p->bats[k].x, p->bats[k].y, 2*SIM_BAT_HALF_W, 2*SIM_BAT_HALF_H, COL_WHITE, 0.0f);
+  for(int i=0;i<p->n && n<cap;i++)
+    n = push(out, n, cap, SHAPE_CIRCLE, p->balls[i].x, p->balls[i].y, 2*SIM_BALL_R, 2*SIM_BALL_R, COL_WHITE, 0.0f);
+  return n;
+}
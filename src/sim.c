@@ -0,0 +1,209 @@
+/* sim.c — headless Pong simulation (no GL / DOM / audio)
+ * Gameplay is a straight lift of the old update_game()/ai_control() from
+ * render.c, with the global `G` replaced by a Game* and the sfx/ui side
+ * effects replaced by Events. Keep the float math in the same order: the
+ * browser build, the benches and any recorded matches depend on it.
+ */
+
+#include "sim.h"
+#include "sim_internal.h"
+
+#include <math.h>
+#include <string.h>
+
+/* ------------------------------ Math Utils ------------------------------ */
+uint32_t sim_rand(Game* g){ return sim_xorshift(&g->rng); }
+
+static void emit(Events* ev, EventType type, int side, int speed, float x, float y){
+  if(!ev || ev->n>=SIM_MAX_EVENTS) return;
+  Event* e = &ev->ev[ev->n++];
+  e->type=type; e->side=side; e->speed=speed; e->x=x; e->y=y;
+}
+
+/* ----------------------------- Game Helpers ----------------------------- */
+static void reset_ball_toward(Game* g, int loser){
+  g->ball.x = SIM_WIDTH/2.0f; g->ball.y = SIM_HEIGHT/2.0f;
+  g->ball.dx = (loser==0? -1.0f : 1.0f);
+  g->ball.dy = 0.0f; g->ball.speed = 5; g->ball.prev_x = g->ball.x;
+}
+
+void sim_init(Game* g, uint32_t seed){
+  memset(g, 0, sizeof(*g));
+  g->rng = seed ? seed : 0x9E3779B9u;
+  g->state = ST_MENU; g->numPlayers = 1;
+}
+
+void sim_new_game(Game* g, int numPlayers){
+  g->numPlayers = numPlayers;
+  g->bats[0].x = 40;            g->bats[0].y = SIM_HEIGHT/2.0f; g->bats[0].score=0; g->bats[0].timer=0; g->bats[0].isAI = 0;
+  g->bats[1].x = SIM_WIDTH-40;  g->bats[1].y = SIM_HEIGHT/2.0f; g->bats[1].score=0; g->bats[1].timer=0; g->bats[1].isAI = (numPlayers==1);
+  g->ai_offset = 0; reset_ball_toward(g, 1);
+  g->state = ST_PLAY;
+}
+
+/* ------------------------------- Controls ------------------------------- */
+static float ai_control(const Game* g, int side){
+  return sim_ai_delta(g->ball.x, g->ball.y, g->bats[side].x, g->bats[side].y, g->ai_offset);
+}
+
+/* ------------------------------- Collision ------------------------------ */
+static void paddle_hit(Game* g, int side, float diff_y, Events* ev){
+  Ball* b = &g->ball;
+  sim_deflect(&b->dx, &b->dy, diff_y);
+  b->x = side==0 ? g->bats[0].x + SIM_BAT_HALF_W + SIM_BALL_R
+                 : g->bats[1].x - SIM_BAT_HALF_W - SIM_BALL_R;
+  b->speed++;
+  g->ai_offset = sim_next_ai_offset(&g->rng);
+  g->bats[side].timer = 10;
+  emit(ev, EV_HIT, side, b->speed, b->x, b->y);
+}
+
+static void wall_bounce(Game* g, int bottom, Events* ev){
+  Ball* b = &g->ball;
+  if(bottom){ b->dy = -fabsf(b->dy); b->y = SIM_HEIGHT - SIM_BALL_R; }
+  else      { b->dy =  fabsf(b->dy); b->y = SIM_BALL_R; }
+  emit(ev, EV_BOUNCE, bottom, b->speed, b->x, b->y);
+}
+
+/* Paddle/wall checks for the microstep that just moved the ball. */
+void sim_ball_collide(Game* g, Events* ev){
+  Ball* b = &g->ball;
+  const float R = SIM_BALL_R;
+  /* left paddle */
+  if(b->x - R <= g->bats[0].x + SIM_BAT_HALF_W && b->prev_x - R > g->bats[0].x + SIM_BAT_HALF_W){
+    float diff_y = b->y - g->bats[0].y;
+    if(diff_y>-SIM_BAT_HALF_H && diff_y<SIM_BAT_HALF_H) paddle_hit(g, 0, diff_y, ev);
+  }
+  /* right paddle */
+  if(b->x + R >= g->bats[1].x - SIM_BAT_HALF_W && b->prev_x + R < g->bats[1].x - SIM_BAT_HALF_W){
+    float diff_y = b->y - g->bats[1].y;
+    if(diff_y>-SIM_BAT_HALF_H && diff_y<SIM_BAT_HALF_H) paddle_hit(g, 1, diff_y, ev);
+  }
+
+  /* walls */
+  if(b->y - R <= 0)          wall_bounce(g, 0, ev);
+  if(b->y + R >= SIM_HEIGHT) wall_bounce(g, 1, ev);
+}
+
+/* ball: integrate in 'speed' microsteps to emulate pygame cadence */
+static void ball_update(Game* g, Events* ev){
+  Ball* b = &g->ball;
+  int steps = b->speed;
+  for(int s=0;s<steps;++s){
+    b->prev_x = b->x;
+    b->x += b->dx;
+    b->y += b->dy;
+    sim_ball_collide(g, ev);
+  }
+}
+
+/* Swept version of ball_update(). Each test in sim_ball_collide() is
+ * monotone along a straight segment, so the first microstep at which any
+ * of them fires can be solved for directly; jump there and let
+ * sim_ball_collide() decide and respond exactly as the loop would. The
+ * solve is checked with the same float expression the jump uses (p + j*v),
+ * so it agrees with where the ball actually lands; it can only differ from
+ * the loop's running sum by rounding. */
+static int reaches(float p, float v, int j, float off, float edge, int ge){
+  float q = (p + (float)j*v) + off;
+  return ge ? q >= edge : q <= edge;
+}
+
+/* First j in 1..limit with (p + j*v) + off past `edge` (>= if ge, else <=);
+ * limit+1 if the segment never gets there. */
+static int first_step(float p, float v, float off, float edge, int ge, int limit){
+  if(reaches(p, v, 1, off, edge, ge)) return 1;
+  if(ge ? v<=0.0f : v>=0.0f) return limit+1;  /* moving away */
+  float k = ceilf((edge - (p + off)) / v);
+  if(!(k < (float)limit + 2.0f)) return limit+1;
+  int j = k<2.0f ? 2 : (int)k;
+  while(j>2 && reaches(p, v, j-1, off, edge, ge)) j--;
+  while(j<=limit && !reaches(p, v, j, off, edge, ge)) j++;
+  return j;
+}
+
+static void ball_sweep(Game* g, Events* ev){
+  Ball* b = &g->ball;
+  const float R = SIM_BALL_R;
+  const float face0 = g->bats[0].x + SIM_BAT_HALF_W, face1 = g->bats[1].x - SIM_BAT_HALF_W;
+  int left = b->speed;
+  while(left>0){
+    int k = left+1, t;
+    /* paddles fire only on the step that crosses the face (prev_x test) */
+    if(b->dx<0.0f && b->x - R > face0){ t = first_step(b->x, b->dx, -R, face0, 0, left); if(t<k) k = t; }
+    if(b->dx>0.0f && b->x + R < face1){ t = first_step(b->x, b->dx,  R, face1, 1, left); if(t<k) k = t; }
+    /* walls are a plain inside test, so they may already hold at step 1 */
+    t = first_step(b->y, b->dy, -R, 0.0f, 0, left);               if(t<k) k = t;
+    t = first_step(b->y, b->dy,  R, (float)SIM_HEIGHT, 1, left);  if(t<k) k = t;
+
+    int n = k<=left ? k : left;
+    b->prev_x = b->x + (float)(n-1)*b->dx;
+    b->x      = b->x + (float)n*b->dx;
+    b->y      = b->y + (float)n*b->dy;
+    left -= n;
+    if(k<=n) sim_ball_collide(g, ev);
+  }
+}
+
+void sim_ball_advance(Game* g, Events* ev){
+  if(g->solver==SIM_SOLVER_MICROSTEP) ball_update(g, ev);
+  else                                ball_sweep(g, ev);
+}
+
+/* --------------------------------- Step --------------------------------- */
+void sim_step(Game* g, const Input* in, Events* ev){
+  if(g->state!=ST_PLAY) return;
+  unsigned buttons = in ? in->buttons : 0u;
+
+  /* paddles */
+  float dy0 = g->bats[0].isAI ? ai_control(g, 0) : sim_player_delta(buttons, IN_P1_UP, IN_P1_DOWN);
+  float dy1 = g->bats[1].isAI ? ai_control(g, 1) : sim_player_delta(buttons, IN_P2_UP, IN_P2_DOWN);
+  g->bats[0].y = sim_clamp_bat(g->bats[0].y + dy0);
+  g->bats[1].y = sim_clamp_bat(g->bats[1].y + dy1);
+  g->bats[0].timer--; g->bats[1].timer--;
+
+  sim_ball_advance(g, ev);
+
+  /* scoring */
+  int out_left  = (g->ball.x + SIM_BALL_R) < 0.0f;
+  int out_right = (g->ball.x - SIM_BALL_R) > (float)SIM_WIDTH;
+  if(out_left || out_right){
+    int scorer = out_left ? 1 : 0;
+    int loser  = 1 - scorer;
+    if(g->bats[loser].timer < 0){
+      g->bats[scorer].score += 1;
+      g->bats[loser].timer = 20;
+      emit(ev, EV_GOAL, scorer, g->ball.speed, g->ball.x, g->ball.y);
+    } else if(g->bats[loser].timer == 0){
+      reset_ball_toward(g, loser);
+    }
+  }
+
+  /* win */
+  if(g->bats[0].score>=SIM_WIN_SCORE || g->bats[1].score>=SIM_WIN_SCORE){
+    g->state = ST_OVER;
+    emit(ev, EV_GAME_OVER, g->bats[0].score>=SIM_WIN_SCORE ? 0 : 1, g->ball.speed, g->ball.x, g->ball.y);
+  }
+}
+
+/* --------------------------------- Hash --------------------------------- */
+static uint32_t fnv_u32(uint32_t h, uint32_t v){
+  for(int i=0;i<4;i++){ h ^= (v >> (8*i)) & 0xFFu; h *= 16777619u; }
+  return h;
+}
+static uint32_t fnv_f32(uint32_t h, float f){ uint32_t v; memcpy(&v, &f, sizeof v); return fnv_u32(h, v); }
+
+uint32_t sim_state_hash(const Game* g){
+  uint32_t h = 2166136261u;
+  h = fnv_f32(h, g->ball.x);  h = fnv_f32(h, g->ball.y);
+  h = fnv_f32(h, g->ball.dx); h = fnv_f32(h, g->ball.dy);
+  h = fnv_f32(h, g->ball.prev_x); h = fnv_u32(h, (uint32_t)g->ball.speed);
+  for(int k=0;k<2;k++){
+    h = fnv_f32(h, g->bats[k].x); h = fnv_f32(h, g->bats[k].y);
+    h = fnv_u32(h, (uint32_t)g->bats[k].score); h = fnv_u32(h, (uint32_t)g->bats[k].timer);
+    h = fnv_u32(h, (uint32_t)g->bats[k].isAI);
+  }
+  h = fnv_u32(h, (uint32_t)g->numPlayers); h = fnv_u32(h, (uint32_t)g->ai_offset);
+  h = fnv_u32(h, g->rng); h = fnv_u32(h, (uint32_t)g->state);
+  return h;
+}
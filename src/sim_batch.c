@@ -0,0 +1,303 @@
+/* sim_batch.c — structure-of-arrays multi-game stepper
+ * Per frame: paddles (scalar, O(1) per lane), then the ball microstep kernel
+ * (vectorised across lanes, masked by each lane's speed), then scoring.
+ * Any lane whose vector collision test fires is handed to the scalar
+ * sim_ball_collide() for that microstep, which keeps the floats identical.
+ */
+
+#include "sim_batch.h"
+#include "sim_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* --------------------------- Vector Abstraction -------------------------- */
+#if defined(__AVX__)
+#  include <immintrin.h>
+#  define VW 8
+typedef __m256 vf;
+#  define vf_load(p)       _mm256_load_ps(p)
+#  define vf_store(p,v)    _mm256_store_ps(p,v)
+#  define vf_set1(x)       _mm256_set1_ps(x)
+#  define vf_add(a,b)      _mm256_add_ps(a,b)
+#  define vf_sub(a,b)      _mm256_sub_ps(a,b)
+#  define vf_le(a,b)       _mm256_cmp_ps(a,b,_CMP_LE_OQ)
+#  define vf_lt(a,b)       _mm256_cmp_ps(a,b,_CMP_LT_OQ)
+#  define vf_and(a,b)      _mm256_and_ps(a,b)
+#  define vf_or(a,b)       _mm256_or_ps(a,b)
+#  define vf_select(m,a,b) _mm256_blendv_ps(b,a,m)
+#  define vf_mask(m)       _mm256_movemask_ps(m)
+#elif defined(__SSE2__) || defined(_M_X64)
+#  include <emmintrin.h>
+#  define VW 4
+typedef __m128 vf;
+#  define vf_load(p)       _mm_load_ps(p)
+#  define vf_store(p,v)    _mm_store_ps(p,v)
+#  define vf_set1(x)       _mm_set1_ps(x)
+#  define vf_add(a,b)      _mm_add_ps(a,b)
+#  define vf_sub(a,b)      _mm_sub_ps(a,b)
+#  define vf_le(a,b)       _mm_cmple_ps(a,b)
+#  define vf_lt(a,b)       _mm_cmplt_ps(a,b)
+#  define vf_and(a,b)      _mm_and_ps(a,b)
+#  define vf_or(a,b)       _mm_or_ps(a,b)
+#  define vf_select(m,a,b) _mm_or_ps(_mm_and_ps(m,a), _mm_andnot_ps(m,b))
+#  define vf_mask(m)       _mm_movemask_ps(m)
+#elif defined(__wasm_simd128__)
+#  include <wasm_simd128.h>
+#  define VW 4
+typedef v128_t vf;
+#  define vf_load(p)       wasm_v128_load(p)
+#  define vf_store(p,v)    wasm_v128_store(p,v)
+#  define vf_set1(x)       wasm_f32x4_splat(x)
+#  define vf_add(a,b)      wasm_f32x4_add(a,b)
+#  define vf_sub(a,b)      wasm_f32x4_sub(a,b)
+#  define vf_le(a,b)       wasm_f32x4_le(a,b)
+#  define vf_lt(a,b)       wasm_f32x4_lt(a,b)
+#  define vf_and(a,b)      wasm_v128_and(a,b)
+#  define vf_or(a,b)       wasm_v128_or(a,b)
+#  define vf_select(m,a,b) wasm_v128_bitselect(a,b,m)
+#  define vf_mask(m)       ((int)wasm_i32x4_bitmask(m))
+#else
+#  define VW 1
+#endif
+
+int sim_batch_width(void){ return VW; }
+
+/* ------------------------------ Allocation ------------------------------ */
+int sim_batch_init(SimBatch* b, int n){
+  memset(b, 0, sizeof(*b));
+  int cap = (n + SIM_BATCH_ALIGN-1) / SIM_BATCH_ALIGN * SIM_BATCH_ALIGN;
+  if(cap<=0) cap = SIM_BATCH_ALIGN;
+  enum { NARRAYS = 21 };
+  /* every array is 4-byte elements; the extra 64 bytes staggers the arrays
+     so power-of-two capacities don't 4K-alias between x/y/dx/... streams */
+  size_t lane_bytes = (size_t)cap * 4u + 64u;
+  b->block = calloc(1, lane_bytes*NARRAYS + 32);
+  if(!b->block) return 0;
+  char* p = (char*)(((uintptr_t)b->block + 31u) & ~(uintptr_t)31u);
+#define TAKE(dst, T) do{ dst = (T*)p; p += lane_bytes; }while(0)
+  TAKE(b->ball_x, float); TAKE(b->ball_y, float); TAKE(b->ball_dx, float); TAKE(b->ball_dy, float);
+  TAKE(b->ball_prev_x, float); TAKE(b->ball_speed, int);
+  for(int k=0;k<2;k++){
+    TAKE(b->bat_x[k], float); TAKE(b->bat_y[k], float);
+    TAKE(b->bat_score[k], int); TAKE(b->bat_timer[k], int); TAKE(b->bat_isAI[k], int);
+  }
+  TAKE(b->ai_offset, int); TAKE(b->rng, uint32_t); TAKE(b->state, int); TAKE(b->numPlayers, int);
+  TAKE(b->steps, float);
+#undef TAKE
+  b->n = n; b->cap = cap;
+  for(int i=0;i<cap;i++){
+    Game g; sim_init(&g, (uint32_t)i+1u);
+    sim_batch_load(b, i, &g);
+  }
+  return 1;
+}
+
+void sim_batch_free(SimBatch* b){
+  free(b->block);
+  memset(b, 0, sizeof(*b));
+}
+
+void sim_batch_load(SimBatch* b, int i, const Game* g){
+  b->ball_x[i]=g->ball.x; b->ball_y[i]=g->ball.y; b->ball_dx[i]=g->ball.dx; b->ball_dy[i]=g->ball.dy;
+  b->ball_prev_x[i]=g->ball.prev_x; b->ball_speed[i]=g->ball.speed;
+  for(int k=0;k<2;k++){
+    b->bat_x[k][i]=g->bats[k].x; b->bat_y[k][i]=g->bats[k].y;
+    b->bat_score[k][i]=g->bats[k].score; b->bat_timer[k][i]=g->bats[k].timer; b->bat_isAI[k][i]=g->bats[k].isAI;
+  }
+  b->ai_offset[i]=g->ai_offset; b->rng[i]=g->rng; b->state[i]=(int)g->state; b->numPlayers[i]=g->numPlayers;
+  b->steps[i]=0.0f;
+}
+
+void sim_batch_store(const SimBatch* b, int i, Game* g){
+  memset(g, 0, sizeof(*g));
+  g->ball.x=b->ball_x[i]; g->ball.y=b->ball_y[i]; g->ball.dx=b->ball_dx[i]; g->ball.dy=b->ball_dy[i];
+  g->ball.prev_x=b->ball_prev_x[i]; g->ball.speed=b->ball_speed[i];
+  for(int k=0;k<2;k++){
+    g->bats[k].x=b->bat_x[k][i]; g->bats[k].y=b->bat_y[k][i];
+    g->bats[k].score=b->bat_score[k][i]; g->bats[k].timer=b->bat_timer[k][i]; g->bats[k].isAI=b->bat_isAI[k][i];
+  }
+  g->ai_offset=b->ai_offset[i]; g->rng=b->rng[i]; g->state=(State)b->state[i]; g->numPlayers=b->numPlayers[i];
+  g->solver = SIM_SOLVER_MICROSTEP;
+}
+
+/* --------------------------- Scalar Collision --------------------------- */
+/* Run the scalar response for one lane's current microstep. */
+static void lane_collide(SimBatch* b, int i, Events* ev){
+  Game g;
+  g.ball.x=b->ball_x[i]; g.ball.y=b->ball_y[i]; g.ball.dx=b->ball_dx[i]; g.ball.dy=b->ball_dy[i];
+  g.ball.prev_x=b->ball_prev_x[i]; g.ball.speed=b->ball_speed[i];
+  for(int k=0;k<2;k++){ g.bats[k].x=b->bat_x[k][i]; g.bats[k].y=b->bat_y[k][i]; g.bats[k].timer=b->bat_timer[k][i]; }
+  g.ai_offset=b->ai_offset[i]; g.rng=b->rng[i];
+
+  sim_ball_collide(&g, ev);
+
+  b->ball_x[i]=g.ball.x; b->ball_y[i]=g.ball.y; b->ball_dx[i]=g.ball.dx; b->ball_dy[i]=g.ball.dy;
+  b->ball_speed[i]=g.ball.speed;
+  for(int k=0;k<2;k++) b->bat_timer[k][i]=g.bats[k].timer;
+  b->ai_offset[i]=g.ai_offset; b->rng[i]=g.rng;
+}
+
+/* ------------------------------ Ball Kernel ----------------------------- */
+#define SIM_BATCH_TILE 64  /* lanes per tile; multiple of SIM_BATCH_ALIGN */
+
+/* Microsteps [from, to) of one lane, scalar. */
+static void lane_run(SimBatch* b, int i, int from, int to, Events* ev){
+  const float R = SIM_BALL_R;
+  const float faceL = b->bat_x[0][i] + SIM_BAT_HALF_W;
+  const float faceR = b->bat_x[1][i] - SIM_BAT_HALF_W;
+  for(int s=from;s<to;++s){
+    float px = b->ball_x[i];
+    float x  = px + b->ball_dx[i];
+    float y  = b->ball_y[i] + b->ball_dy[i];
+    b->ball_prev_x[i]=px; b->ball_x[i]=x; b->ball_y[i]=y;
+    if((x - R <= faceL && px - R > faceL) || (x + R >= faceR && px + R < faceR) ||
+       y - R <= 0 || y + R >= SIM_HEIGHT)
+      lane_collide(b, i, ev ? &ev[i] : NULL);
+  }
+}
+
+static void ball_kernel(SimBatch* b, Events* ev){
+  const float R = SIM_BALL_R;
+#if VW > 1
+  const vf vR = vf_set1(R), vZero = vf_set1(0.0f), vH = vf_set1((float)SIM_HEIGHT);
+  const vf vHW = vf_set1(SIM_BAT_HALF_W);
+  /* local copies so the compiler needn't reload them after every store */
+  float* const bx  = b->ball_x;  float* const by  = b->ball_y;  float* const bpx = b->ball_prev_x;
+  const float* const bdx = b->ball_dx; const float* const bdy = b->ball_dy;
+  const float* const batL = b->bat_x[0]; const float* const batR = b->bat_x[1];
+  const float* const steps = b->steps;
+  /* Tiles of SIM_BATCH_TILE lanes: microsteps outer, vectors inner. Each
+     vector's state round-trips through L1, but consecutive updates of the
+     same lanes are a whole tile apart, so the x+=dx chains of different
+     vectors overlap instead of serialising on add latency. */
+  for(int t=0;t<b->n;t+=SIM_BATCH_TILE){
+    int tend = t+SIM_BATCH_TILE < b->n ? t+SIM_BATCH_TILE : b->n;
+    /* Per-vector budgets, so one long rally only keeps its own vector busy,
+       and a per-vector "quiet" flag: every lane is further from each paddle
+       face and wall than it can travel this frame (|d| <= 1 per microstep),
+       so the collision predicates cannot fire and are skipped. */
+    float vmax[SIM_BATCH_TILE/VW];
+    unsigned char vquiet[SIM_BATCH_TILE/VW];
+    int tail_lane[SIM_BATCH_TILE/VW];
+    for(int i=t;i<tend;i+=VW){
+      float m = 0.0f, m2 = 0.0f; int q = 1, top = -1;
+      for(int l=0;l<VW;l++){
+        int k = i+l;
+        float reach = steps[k] + 2.0f;
+        if(steps[k]>m){ m2 = m; m = steps[k]; top = k; }
+        else if(steps[k]>m2) m2 = steps[k];
+        if(steps[k]>0.0f){
+          q &= fabsf(bx[k] - R - (batL[k] + SIM_BAT_HALF_W)) > reach;
+          q &= fabsf(bx[k] + R - (batR[k] - SIM_BAT_HALF_W)) > reach;
+          q &= (by[k] - R) > reach && ((float)SIM_HEIGHT - (by[k] + R)) > reach;
+        }
+      }
+      /* A lone long rally would drag its whole vector along: when the leader
+         needs more than twice the runner-up, the vector stops at the
+         runner-up's budget and the leader finishes scalar. */
+      if(top>=0 && m > 2.0f*m2){ vmax[(i-t)/VW] = m2; tail_lane[(i-t)/VW] = top; }
+      else                { vmax[(i-t)/VW] = m;  tail_lane[(i-t)/VW] = -1; }
+      vquiet[(i-t)/VW] = (unsigned char)q;
+    }
+    /* vectors ordered by budget (desc): the live set is always a prefix */
+    int order[SIM_BATCH_TILE/VW], nlive = 0;
+    for(int c=0;c<(tend-t+VW-1)/VW;c++){
+      if(vmax[c]<=0.0f) continue;
+      int j = nlive++;
+      while(j>0 && vmax[order[j-1]] < vmax[c]){ order[j] = order[j-1]; j--; }
+      order[j] = c;
+    }
+
+    for(int s=0; nlive>0; ++s){
+      while(nlive>0 && vmax[order[nlive-1]] <= (float)s) nlive--;
+      const vf vs = vf_set1((float)s);
+      for(int c=0;c<nlive;c++){
+        const int i = t + order[c]*VW;
+        if(vquiet[order[c]]){
+          vf act = vf_lt(vs, vf_load(steps+i));
+          vf x = vf_load(bx+i), y = vf_load(by+i);
+          vf_store(bpx+i, vf_select(act, x, vf_load(bpx+i)));
+          vf_store(bx+i,  vf_select(act, vf_add(x, vf_load(bdx+i)), x));
+          vf_store(by+i,  vf_select(act, vf_add(y, vf_load(bdy+i)), y));
+          continue;
+        }
+        vf act = vf_lt(vs, vf_load(steps+i));
+        vf x  = vf_load(bx+i), y = vf_load(by+i);
+        vf px = vf_select(act, x, vf_load(bpx+i));
+        x = vf_select(act, vf_add(x, vf_load(bdx+i)), x);
+        y = vf_select(act, vf_add(y, vf_load(bdy+i)), y);
+        vf_store(bpx+i, px); vf_store(bx+i, x); vf_store(by+i, y);
+
+        /* same predicates as sim_ball_collide(); the paddle y-range is left to it */
+        const vf faceL = vf_add(vf_load(batL+i), vHW);
+        const vf faceR = vf_sub(vf_load(batR+i), vHW);
+        vf hitL = vf_and(vf_le(vf_sub(x,vR), faceL), vf_lt(faceL, vf_sub(px,vR)));
+        vf hitR = vf_and(vf_le(faceR, vf_add(x,vR)), vf_lt(vf_add(px,vR), faceR));
+        vf wall = vf_or(vf_le(vf_sub(y,vR), vZero), vf_le(vH, vf_add(y,vR)));
+        int m = vf_mask(vf_and(act, vf_or(vf_or(hitL,hitR), wall)));
+        if(m){
+          for(int l=0;l<VW;l++) if(m & (1<<l)) lane_collide(b, i+l, ev ? &ev[i+l] : NULL);
+        }
+      }
+    }
+
+    for(int c=0;c<(tend-t+VW-1)/VW;c++){
+      int k = tail_lane[c];
+      if(k>=0) lane_run(b, k, (int)vmax[c], (int)steps[k], ev);
+    }
+  }
+#else
+  for(int i=0;i<b->n;i++) lane_run(b, i, 0, (int)b->steps[i], ev);
+#endif
+}
+
+/* --------------------------------- Step --------------------------------- */
+static void emit_lane(Events* ev, EventType type, int side, int speed, float x, float y){
+  if(!ev || ev->n>=SIM_MAX_EVENTS) return;
+  Event* e = &ev->ev[ev->n++];
+  e->type=type; e->side=side; e->speed=speed; e->x=x; e->y=y;
+}
+
+void sim_batch_step(SimBatch* b, const Input* in, Events* ev){
+  /* paddles + microstep budget */
+  for(int i=0;i<b->n;i++){
+    if(b->state[i]!=ST_PLAY){ b->steps[i]=0.0f; continue; }
+    unsigned buttons = in ? in[i].buttons : 0u;
+    float dy0 = b->bat_isAI[0][i] ? sim_ai_delta(b->ball_x[i], b->ball_y[i], b->bat_x[0][i], b->bat_y[0][i], b->ai_offset[i])
+                                  : sim_player_delta(buttons, IN_P1_UP, IN_P1_DOWN);
+    float dy1 = b->bat_isAI[1][i] ? sim_ai_delta(b->ball_x[i], b->ball_y[i], b->bat_x[1][i], b->bat_y[1][i], b->ai_offset[i])
+                                  : sim_player_delta(buttons, IN_P2_UP, IN_P2_DOWN);
+    b->bat_y[0][i] = sim_clamp_bat(b->bat_y[0][i] + dy0);
+    b->bat_y[1][i] = sim_clamp_bat(b->bat_y[1][i] + dy1);
+    b->bat_timer[0][i]--; b->bat_timer[1][i]--;
+    b->steps[i] = (float)b->ball_speed[i];
+  }
+
+  ball_kernel(b, ev);
+
+  /* scoring + win */
+  for(int i=0;i<b->n;i++){
+    if(b->state[i]!=ST_PLAY) continue;
+    Events* e = ev ? &ev[i] : NULL;
+    int out_left  = (b->ball_x[i] + SIM_BALL_R) < 0.0f;
+    int out_right = (b->ball_x[i] - SIM_BALL_R) > (float)SIM_WIDTH;
+    if(out_left || out_right){
+      int scorer = out_left ? 1 : 0;
+      int loser  = 1 - scorer;
+      if(b->bat_timer[loser][i] < 0){
+        b->bat_score[scorer][i] += 1;
+        b->bat_timer[loser][i] = 20;
+        emit_lane(e, EV_GOAL, scorer, b->ball_speed[i], b->ball_x[i], b->ball_y[i]);
+      } else if(b->bat_timer[loser][i] == 0){
+        b->ball_x[i] = SIM_WIDTH/2.0f; b->ball_y[i] = SIM_HEIGHT/2.0f;
+        b->ball_dx[i] = (loser==0? -1.0f : 1.0f);
+        b->ball_dy[i] = 0.0f; b->ball_speed[i] = 5; b->ball_prev_x[i] = b->ball_x[i];
+      }
+    }
+    if(b->bat_score[0][i]>=SIM_WIN_SCORE || b->bat_score[1][i]>=SIM_WIN_SCORE){
+      b->state[i] = ST_OVER;
+      emit_lane(e, EV_GAME_OVER, b->bat_score[0][i]>=SIM_WIN_SCORE ? 0 : 1, b->ball_speed[i], b->ball_x[i], b->ball_y[i]);
+    }
+  }
+}
@@ -0,0 +1,66 @@
+/* sim_clock.c — fixed-timestep accumulator + render interpolation */
+
+#include "sim_clock.h"
+
+#include <math.h>
+
+/* rAF deltas on a display running at the tick rate wobble around one step;
+ * treat anything this close as exactly one step so such displays get one
+ * sim step per frame instead of alternating 0 and 2. */
+#define SIM_CLOCK_SNAP_MS 0.5
+
+void sim_clock_init(SimClock* c, int hz, int max_steps){
+  c->acc_ms = 0.0; c->last_ms = -1.0;
+  c->max_steps = max_steps>0 ? max_steps : 1;
+  c->ticks = 0; c->dropped_ms = 0.0;
+  sim_clock_set_hz(c, hz);
+}
+
+void sim_clock_set_hz(SimClock* c, int hz){
+  if(hz<1) hz = SIM_TICK_HZ;
+  c->step_ms = 1000.0/(double)hz;
+}
+
+void sim_clock_reset(SimClock* c){ c->acc_ms = 0.0; }
+
+int sim_clock_advance(SimClock* c, double now_ms){
+  if(c->last_ms<0.0){ c->last_ms = now_ms; return 0; }
+  double dt = now_ms - c->last_ms;
+  c->last_ms = now_ms;
+  if(dt<0.0) dt = 0.0;
+  if(fabs(dt - c->step_ms) < SIM_CLOCK_SNAP_MS) dt = c->step_ms;
+
+  c->acc_ms += dt;
+  int n = (int)(c->acc_ms / c->step_ms);
+  if(n > c->max_steps){
+    double drop = (double)(n - c->max_steps) * c->step_ms;
+    c->acc_ms -= drop; c->dropped_ms += drop;
+    n = c->max_steps;
+  }
+  c->acc_ms -= (double)n * c->step_ms;
+  if(c->acc_ms<0.0) c->acc_ms = 0.0;
+  c->ticks += n;
+  return n;
+}
+
+float sim_clock_alpha(const SimClock* c){
+  float a = (float)(c->acc_ms / c->step_ms);
+  return a<0.0f ? 0.0f : (a>=1.0f ? 0.999f : a);
+}
+
+double sim_clock_step_time(const SimClock* c, int i, int n){
+  return c->last_ms - c->acc_ms - (double)(n-1-i)*c->step_ms;
+}
+
+static float lerpf(float a, float b, float t){ return a + (b - a)*t; }
+
+void sim_lerp(const Game* a, const Game* b, float t, Game* out){
+  *out = *b;
+  if(a->state!=b->state) return;
+  /* reset_ball_toward() leaves prev_x == x; a moving ball never does */
+  if(b->ball.x==b->ball.prev_x) return;
+  out->ball.x = lerpf(a->ball.x, b->ball.x, t);
+  out->ball.y = lerpf(a->ball.y, b->ball.y, t);
+  out->bats[0].y = lerpf(a->bats[0].y, b->bats[0].y, t);
+  out->bats[1].y = lerpf(a->bats[1].y, b->bats[1].y, t);
+}
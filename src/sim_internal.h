@@ -0,0 +1,77 @@
+#ifndef SIM_INTERNAL_H
+#define SIM_INTERNAL_H
+
+/* Rule formulas shared by the scalar sim (sim.c) and the batch engine
+ * (sim_batch.c). Both must produce bit-identical floats, so every
+ * expression lives here exactly once and is evaluated in the same order.
+ * pong_sim is built with -ffp-contract=off for the same reason. */
+
+#include <math.h>
+#include <stdint.h>
+
+#include "sim.h"
+
+static inline uint32_t sim_xorshift(uint32_t* state){
+  uint32_t s = *state;
+  s ^= s << 13; s ^= s >> 17; s ^= s << 5;
+  *state = s;
+  return s;
+}
+
+static inline float sim_player_delta(unsigned buttons, unsigned up, unsigned down){
+  if(buttons & down) return  SIM_PLAYER_SPEED;
+  if(buttons & up)   return -SIM_PLAYER_SPEED;
+  return 0.0f;
+}
+
+/* Blend between screen centre and ball.y+offset by horizontal distance:
+ * all centre at blend_dist or further, all ball at the paddle. The built-in
+ * AI is sim_ai_delta(); ai_blend_delta() (ai.h) tunes the constants. */
+static inline float sim_ai_delta_tuned(float ball_x, float ball_y, float bat_x, float bat_y,
+                                       float offset, float blend_dist, float max_speed){
+  float xdist = fabsf(ball_x - bat_x);
+  float t1 = SIM_HEIGHT/2.0f;
+  float t2 = ball_y + offset;
+  float w1 = fmaxf(0.0f, fminf(1.0f, xdist / blend_dist));
+  float target = w1*t1 + (1.0f - w1)*t2;
+  float delta = target - bat_y;
+  if(delta >  max_speed) delta =  max_speed;
+  if(delta < -max_speed) delta = -max_speed;
+  return delta;
+}
+
+static inline float sim_ai_delta(float ball_x, float ball_y, float bat_x, float bat_y, int ai_offset){
+  return sim_ai_delta_tuned(ball_x, ball_y, bat_x, bat_y, (float)ai_offset, SIM_WIDTH/2.0f, SIM_MAX_AI_SPEED);
+}
+
+static inline float sim_clamp_bat(float y){
+  if(y<80) y=80; if(y>400) y=400;
+  return y;
+}
+
+static inline void sim_normalised(float* x, float* y){
+  float len = sqrtf((*x)*(*x) + (*y)*(*y));
+  if(len<=0.0f){ *x=0; *y=0; return; }
+  *x /= len; *y /= len;
+}
+
+/* Paddle hit response: reflect, add english from the hit offset, renormalise. */
+static inline void sim_deflect(float* dx, float* dy, float diff_y){
+  *dx = -*dx;
+  *dy += diff_y / 128.0f; if(*dy>1.0f) *dy=1.0f; if(*dy<-1.0f) *dy=-1.0f;
+  sim_normalised(dx, dy);
+}
+
+static inline int sim_next_ai_offset(uint32_t* rng){
+  return (int)(sim_xorshift(rng)%21)-10;
+}
+
+/* Paddle/wall checks + response for the microstep that just moved g->ball
+ * (sim.c). The batch engine calls it for lanes whose vector test fired. */
+void sim_ball_collide(Game* g, Events* ev);
+
+/* One step of g->ball under g->solver, paddle hits and wall bounces
+ * included (sim.c). Party mode runs it once per ball. */
+void sim_ball_advance(Game* g, Events* ev);
+
+#endif /* SIM_INTERNAL_H */
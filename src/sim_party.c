@@ -0,0 +1,252 @@
+/* sim_party.c — multiball mode: per-ball single-ball rules, incremental
+ * uniform grid, ball–ball contacts */
+
+#include "sim_party.h"
+#include "sim_internal.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CELLS (SIM_PARTY_GX*SIM_PARTY_GY)
+
+/* ---------------------------------- Grid --------------------------------- */
+static int cell_of(float x, float y){
+  int cx = (int)floorf(x*(1.0f/SIM_PARTY_CELL)), cy = (int)floorf(y*(1.0f/SIM_PARTY_CELL));
+  if(cx < 0) cx = 0; if(cx >= SIM_PARTY_GX) cx = SIM_PARTY_GX-1;
+  if(cy < 0) cy = 0; if(cy >= SIM_PARTY_GY) cy = SIM_PARTY_GY-1;
+  return cy*SIM_PARTY_GX + cx;
+}
+
+static void grid_link(SimParty* p, int i, int c){
+  p->cell[i] = c; p->prev[i] = -1; p->next[i] = p->head[c];
+  if(p->head[c] >= 0) p->prev[p->head[c]] = i;
+  p->head[c] = i;
+}
+
+static void grid_unlink(SimParty* p, int i){
+  int c = p->cell[i];
+  if(p->prev[i] >= 0) p->next[p->prev[i]] = p->next[i]; else p->head[c] = p->next[i];
+  if(p->next[i] >= 0) p->prev[p->next[i]] = p->prev[i];
+}
+
+static void grid_rebuild(SimParty* p){
+  for(int c=0;c<CELLS;c++) p->head[c] = -1;
+  for(int i=0;i<p->n;i++) grid_link(p, i, cell_of(p->balls[i].x, p->balls[i].y));
+}
+
+/* relink only the balls that moved to another cell */
+static void grid_update(SimParty* p){
+  for(int i=0;i<p->n;i++){
+    int c = cell_of(p->balls[i].x, p->balls[i].y);
+    if(c == p->cell[i]) continue;
+    grid_unlink(p, i); grid_link(p, i, c);
+    p->relinks++;
+  }
+}
+
+/* ---------------------------------- Pool --------------------------------- */
+int sim_party_init(SimParty* p, int cap, uint32_t seed){
+  memset(p, 0, sizeof(*p));
+  if(cap < 1) cap = 1;
+  p->block = malloc((size_t)cap*(sizeof(Ball) + 3*sizeof(int)));
+  if(!p->block) return 0;
+  p->balls = (Ball*)p->block;
+  p->cell = (int*)(p->balls + cap); p->next = p->cell + cap; p->prev = p->next + cap;
+  p->cap = cap;
+  p->rng = seed ? seed : 0x9E3779B9u;
+  p->collide = 1; p->broadphase = SIM_PARTY_GRID;
+  p->state = ST_MENU; p->numPlayers = 1;
+  for(int c=0;c<CELLS;c++) p->head[c] = -1;
+  return 1;
+}
+
+void sim_party_free(SimParty* p){
+  free(p->block);
+  memset(p, 0, sizeof(*p));
+}
+
+/* ---------------------------------- Serve -------------------------------- */
+static float unit(uint32_t* rng){ return (float)(sim_xorshift(rng) >> 8) * (1.0f/16777216.0f); }
+
+/* keep balls crossing the field: a near-vertical ball would never score */
+static void min_dx(Ball* b){
+  if(fabsf(b->dx) >= 0.3f) return;
+  b->dx = b->dx < 0.0f ? -0.3f : 0.3f;
+  sim_normalised(&b->dx, &b->dy);
+}
+
+static void serve(Ball* b, int loser, uint32_t* rng){
+  b->x = SIM_WIDTH/2.0f; b->y = SIM_HEIGHT/4.0f + unit(rng)*(SIM_HEIGHT/2.0f);
+  b->dx = loser==0 ? -1.0f : 1.0f; b->dy = 0.8f*unit(rng) - 0.4f;
+  sim_normalised(&b->dx, &b->dy);
+  b->speed = 5; b->prev_x = b->x;
+}
+
+void sim_party_new_game(SimParty* p, int balls, int numPlayers){
+  p->numPlayers = numPlayers;
+  p->bats[0].x = 40;            p->bats[0].y = SIM_HEIGHT/2.0f; p->bats[0].score=0; p->bats[0].timer=0; p->bats[0].isAI = 0;
+  p->bats[1].x = SIM_WIDTH-40;  p->bats[1].y = SIM_HEIGHT/2.0f; p->bats[1].score=0; p->bats[1].timer=0; p->bats[1].isAI = (numPlayers==1);
+  p->ai_offset = 0;
+  p->n = balls < 1 ? 1 : balls > p->cap ? p->cap : balls;
+  /* ball 0: sim_new_game()'s serve */
+  Ball* b = &p->balls[0];
+  b->x = SIM_WIDTH/2.0f; b->y = SIM_HEIGHT/2.0f; b->dx = 1.0f; b->dy = 0.0f; b->speed = 5; b->prev_x = b->x;
+  for(int i=1;i<p->n;i++){
+    b = &p->balls[i];
+    b->x = SIM_WIDTH/2.0f + 300.0f*(unit(&p->rng) - 0.5f);
+    b->y = SIM_BALL_R + unit(&p->rng)*(SIM_HEIGHT - 2.0f*SIM_BALL_R);
+    b->dx = 2.0f*unit(&p->rng) - 1.0f; b->dy = 2.0f*unit(&p->rng) - 1.0f;
+    sim_normalised(&b->dx, &b->dy);
+    min_dx(b);
+    b->speed = 5; b->prev_x = b->x;
+  }
+  grid_rebuild(p);
+  p->state = ST_PLAY;
+}
+
+/* --------------------------------- Contacts ------------------------------ */
+static float clamp_y(float y){
+  if(y < SIM_BALL_R) y = SIM_BALL_R;
+  if(y > SIM_HEIGHT - SIM_BALL_R) y = SIM_HEIGHT - SIM_BALL_R;
+  return y;
+}
+
+/* Overlapping pair: separate along the centre line, then, if closing,
+ * swap the velocities' normal parts and renormalise the directions. */
+static int contact(SimParty* p, Ball* a, Ball* b){
+  const float D = 2.0f*SIM_BALL_R;
+  float nx = b->x - a->x, ny = b->y - a->y, d2 = nx*nx + ny*ny;
+  if(d2 >= D*D) return 0;
+  float d = sqrtf(d2);
+  if(d > 0.0f){ nx /= d; ny /= d; } else { nx = 1.0f; ny = 0.0f; }
+  float push = 0.5f*(D - d);
+  a->x -= nx*push; a->y = clamp_y(a->y - ny*push);
+  b->x += nx*push; b->y = clamp_y(b->y + ny*push);
+
+  float sa = (float)a->speed, sb = (float)b->speed;
+  float va = (a->dx*nx + a->dy*ny)*sa, vb = (b->dx*nx + b->dy*ny)*sb;
+  if(va > vb){
+    float ax = a->dx*sa + (vb - va)*nx, ay = a->dy*sa + (vb - va)*ny;
+    float bx = b->dx*sb + (va - vb)*nx, by = b->dy*sb + (va - vb)*ny;
+    sim_normalised(&ax, &ay); sim_normalised(&bx, &by);
+    if(ax != 0.0f || ay != 0.0f){ a->dx = ax; a->dy = ay; } else { a->dx = -a->dx; a->dy = -a->dy; }
+    if(bx != 0.0f || by != 0.0f){ b->dx = bx; b->dy = by; } else { b->dx = -b->dx; b->dy = -b->dy; }
+    min_dx(a); min_dx(b);
+  }
+  p->contacts++;
+  return 1;
+}
+
+static int contacts_grid(SimParty* p){
+  int hits = 0;
+  for(int i=0;i<p->n;i++){
+    int cx = p->cell[i] % SIM_PARTY_GX, cy = p->cell[i] / SIM_PARTY_GX;
+    for(int y=cy-1;y<=cy+1;y++){
+      if(y < 0 || y >= SIM_PARTY_GY) continue;
+      for(int x=cx-1;x<=cx+1;x++){
+        if(x < 0 || x >= SIM_PARTY_GX) continue;
+        for(int j=p->head[y*SIM_PARTY_GX + x]; j>=0; j=p->next[j])
+          if(j > i) hits += contact(p, &p->balls[i], &p->balls[j]);
+      }
+    }
+  }
+  return hits;
+}
+
+static int contacts_all_pairs(SimParty* p){
+  int hits = 0;
+  for(int i=0;i<p->n;i++)
+    for(int j=i+1;j<p->n;j++) hits += contact(p, &p->balls[i], &p->balls[j]);
+  return hits;
+}
+
+int sim_party_overlaps(const SimParty* p, int (*pairs)[2], int max){
+  const float D2 = 4.0f*SIM_BALL_R*SIM_BALL_R;
+  int n = 0;
+  for(int i=0;i<p->n;i++){
+    int cx = p->cell[i] % SIM_PARTY_GX, cy = p->cell[i] / SIM_PARTY_GX;
+    for(int y=cy-1;y<=cy+1;y++){
+      if(y < 0 || y >= SIM_PARTY_GY) continue;
+      for(int x=cx-1;x<=cx+1;x++){
+        if(x < 0 || x >= SIM_PARTY_GX) continue;
+        for(int j=p->head[y*SIM_PARTY_GX + x]; j>=0; j=p->next[j]){
+          if(j <= i) continue;
+          float dx = p->balls[j].x - p->balls[i].x, dy = p->balls[j].y - p->balls[i].y;
+          if(dx*dx + dy*dy >= D2) continue;
+          if(n < max){ pairs[n][0] = i; pairs[n][1] = j; }
+          n++;
+        }
+      }
+    }
+  }
+  return n;
+}
+
+/* ---------------------------------- Step --------------------------------- */
+static void emit(Events* ev, EventType type, int side, int speed, float x, float y){
+  if(!ev || ev->n>=SIM_MAX_EVENTS) return;
+  Event* e = &ev->ev[ev->n++];
+  e->type=type; e->side=side; e->speed=speed; e->x=x; e->y=y;
+}
+
+/* The nearest ball heading for the paddle, else the nearest ball. */
+static float ai_control(const SimParty* p, int side){
+  const Bat* bat = &p->bats[side];
+  const Ball *in = NULL, *any = NULL;
+  float din = 1e30f, dany = 1e30f;
+  for(int i=0;i<p->n;i++){
+    const Ball* b = &p->balls[i];
+    float d = fabsf(b->x - bat->x);
+    if(d < dany){ dany = d; any = b; }
+    if((side==0 ? b->dx < 0.0f : b->dx > 0.0f) && d < din){ din = d; in = b; }
+  }
+  const Ball* t = in ? in : any;
+  return sim_ai_delta(t->x, t->y, bat->x, bat->y, p->ai_offset);
+}
+
+void sim_party_step(SimParty* p, const Input* in, Events* ev){
+  if(p->state!=ST_PLAY) return;
+  unsigned buttons = in ? in->buttons : 0u;
+
+  /* paddles */
+  float dy0 = p->bats[0].isAI ? ai_control(p, 0) : sim_player_delta(buttons, IN_P1_UP, IN_P1_DOWN);
+  float dy1 = p->bats[1].isAI ? ai_control(p, 1) : sim_player_delta(buttons, IN_P2_UP, IN_P2_DOWN);
+  p->bats[0].y = sim_clamp_bat(p->bats[0].y + dy0);
+  p->bats[1].y = sim_clamp_bat(p->bats[1].y + dy1);
+  p->bats[0].timer--; p->bats[1].timer--;
+
+  /* balls: the single-ball solver against the shared bats, one at a time;
+     hits update the bats' timers, the AI offset and the PRNG in `g` */
+  Game g;
+  memcpy(g.bats, p->bats, sizeof g.bats);
+  g.ai_offset = p->ai_offset; g.rng = p->rng; g.solver = p->solver;
+  for(int i=0;i<p->n;i++){
+    g.ball = p->balls[i];
+    sim_ball_advance(&g, ev);
+    int out_left  = (g.ball.x + SIM_BALL_R) < 0.0f;
+    int out_right = (g.ball.x - SIM_BALL_R) > (float)SIM_WIDTH;
+    if(out_left || out_right){
+      int scorer = out_left ? 1 : 0;
+      g.bats[scorer].score += 1;
+      emit(ev, EV_GOAL, scorer, g.ball.speed, g.ball.x, g.ball.y);
+      serve(&g.ball, 1 - scorer, &g.rng);
+    }
+    p->balls[i] = g.ball;
+  }
+  memcpy(p->bats, g.bats, sizeof p->bats);
+  p->ai_offset = g.ai_offset; p->rng = g.rng;
+
+  /* ball–ball */
+  grid_update(p);
+  if(p->collide){
+    int hits = p->broadphase==SIM_PARTY_ALL_PAIRS ? contacts_all_pairs(p) : contacts_grid(p);
+    if(hits) grid_update(p);   /* separation can cross a cell edge */
+  }
+
+  /* win */
+  if(p->win > 0 && (p->bats[0].score>=p->win || p->bats[1].score>=p->win)){
+    p->state = ST_OVER;
+    emit(ev, EV_GAME_OVER, p->bats[0].score>=p->win ? 0 : 1, p->balls[0].speed, p->balls[0].x, p->balls[0].y);
+  }
+}
@@ -0,0 +1,92 @@
+/* sim_thread.c — fixed-rate step runner on a pthread */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "sim_thread.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "pong_atomic.h"
+#include "sim_clock.h"
+
+struct SimThread {
+  pthread_t     th;
+  SimThreadStep step;
+  void*         user;
+  int           hz;      /* set by any thread */
+  int           quit;
+  /* written by the runner, read by anyone */
+  uint32_t      steps, dropped, late_max_us;
+  uint64_t      late_sum_us;
+};
+
+double sim_thread_now_ms(void){
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec*1000.0 + (double)ts.tv_nsec*1e-6;
+}
+
+static void sleep_ms(double ms){
+  struct timespec ts;
+  ts.tv_sec = (time_t)(ms*1e-3);
+  ts.tv_nsec = (long)((ms - (double)ts.tv_sec*1000.0)*1e6);
+  nanosleep(&ts, NULL);   /* an early wake just loops once more */
+}
+
+static void* run(void* arg){
+  SimThread* t = (SimThread*)arg;
+  double next = sim_thread_now_ms();
+  while(!PONG_LOAD_ACQ(&t->quit)){
+    double period = 1000.0 / (double)PONG_LOAD_RLX(&t->hz);
+    next += period;
+    double now = sim_thread_now_ms();
+    while(now < next){
+      sleep_ms(next - now);
+      now = sim_thread_now_ms();
+    }
+    double late = now - next;
+    if(late > SIM_MAX_CATCHUP*period){
+      uint32_t skip = (uint32_t)(late / period);
+      PONG_STORE_REL(&t->dropped, t->dropped + skip);
+      next += (double)skip * period;
+      late = now - next;
+    }
+    uint32_t late_us = (uint32_t)(late*1000.0);
+    if(late_us > t->late_max_us) PONG_STORE_REL(&t->late_max_us, late_us);
+    PONG_STORE_REL(&t->late_sum_us, t->late_sum_us + late_us);
+
+    t->step(t->user, next);
+    PONG_STORE_REL(&t->steps, t->steps + 1u);
+  }
+  return NULL;
+}
+
+SimThread* sim_thread_start(int hz, SimThreadStep step, void* user){
+  SimThread* t = (SimThread*)calloc(1, sizeof(*t));
+  if(!t) return NULL;
+  t->step = step; t->user = user;
+  t->hz = hz>0 ? hz : SIM_TICK_HZ;
+  if(pthread_create(&t->th, NULL, run, t)!=0){ free(t); return NULL; }
+  return t;
+}
+
+void sim_thread_set_hz(SimThread* t, int hz){
+  PONG_STORE_REL(&t->hz, hz>0 ? hz : SIM_TICK_HZ);
+}
+
+void sim_thread_stats(const SimThread* t, SimThreadStats* out){
+  out->steps       = PONG_LOAD_ACQ(&t->steps);
+  out->dropped     = PONG_LOAD_ACQ(&t->dropped);
+  out->late_max_us = PONG_LOAD_ACQ(&t->late_max_us);
+  uint64_t sum     = PONG_LOAD_ACQ(&t->late_sum_us);
+  out->late_mean_us = out->steps ? (uint32_t)(sum / out->steps) : 0;
+}
+
+void sim_thread_stop(SimThread* t){
+  if(!t) return;
+  PONG_STORE_REL(&t->quit, 1);
+  pthread_join(t->th, NULL);
+  free(t);
+}
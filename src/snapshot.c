@@ -0,0 +1,237 @@
+/* snapshot.c — quantized match snapshots, bit-packed delta codec
+ * See snapshot.h for the packet layout.
+ */
+
+#include "snapshot.h"
+
+#include <math.h>
+#include <string.h>
+
+#define BASE_LO_BITS 16
+#define BASE_LO_MASK 0xFFFFu
+#define AGE_BITS     5
+
+const char* snap_status_name(SnapStatus s){
+  switch(s){
+    case SNAP_OK:         return "ok";
+    case SNAP_ERR_FORMAT: return "bad format";
+    case SNAP_ERR_BASE:   return "missing baseline";
+  }
+  return "?";
+}
+
+/* ------------------------------ Quantize -------------------------------- */
+static int16_t quant(float v, float scale){
+  float q = floorf(v*scale + 0.5f);
+  if(!(q > -32768.0f)) return -32768;   /* also NaN */
+  if(q > 32767.0f) return 32767;
+  return (int16_t)q;
+}
+
+void snap_capture(Snap* s, const Game* g, uint32_t tick){
+  s->tick = tick;
+  s->state = (uint8_t)g->state;
+  for(int k=0;k<2;k++){
+    int sc = g->bats[k].score;
+    s->score[k] = (uint8_t)(sc < 0 ? 0 : sc > 255 ? 255 : sc);
+    s->bat_y[k] = quant(g->bats[k].y, SNAP_POS_SCALE);
+  }
+  s->ball_x  = quant(g->ball.x,  SNAP_POS_SCALE);
+  s->ball_y  = quant(g->ball.y,  SNAP_POS_SCALE);
+  s->ball_dx = quant(g->ball.dx, SNAP_DIR_SCALE);
+  s->ball_dy = quant(g->ball.dy, SNAP_DIR_SCALE);
+  s->speed = (uint16_t)(g->ball.speed < 0 ? 0 : g->ball.speed > 65535 ? 65535 : g->ball.speed);
+}
+
+void snap_apply(const Snap* s, Game* g){
+  g->state = (State)s->state;
+  for(int k=0;k<2;k++){
+    g->bats[k].score = s->score[k];
+    g->bats[k].y = (float)s->bat_y[k] / SNAP_POS_SCALE;
+  }
+  g->ball.x  = (float)s->ball_x / SNAP_POS_SCALE;
+  g->ball.y  = (float)s->ball_y / SNAP_POS_SCALE;
+  g->ball.dx = (float)s->ball_dx / SNAP_DIR_SCALE;
+  g->ball.dy = (float)s->ball_dy / SNAP_DIR_SCALE;
+  g->ball.speed = s->speed;
+  g->ball.prev_x = g->ball.x;
+}
+
+/* --------------------------------- Ring --------------------------------- */
+void snap_ring_init(SnapRing* r){ memset(r, 0, sizeof(*r)); }
+
+void snap_ring_put(SnapRing* r, const Snap* s){
+  int i = (int)(s->tick % SNAP_WINDOW);
+  r->s[i] = *s;
+  r->valid[i] = 1;
+}
+
+const Snap* snap_ring_get(const SnapRing* r, uint32_t tick){
+  int i = (int)(tick % SNAP_WINDOW);
+  return r->valid[i] && r->s[i].tick == tick ? &r->s[i] : NULL;
+}
+
+/* --------------------------------- Bits --------------------------------- */
+typedef struct { uint8_t* p; size_t cap, bit; int over; } BitW;
+typedef struct { const uint8_t* p; size_t len, bit; int over; } BitR;
+
+/* a byte-sized chunk at a time: up to 8 - (bit & 7) bits per pass */
+static void put_bits(BitW* w, uint32_t v, int n){
+  while(n > 0){
+    size_t byte = w->bit >> 3;
+    int off = (int)(w->bit & 7), take = 8 - off < n ? 8 - off : n;
+    if(byte >= w->cap){ w->over = 1; return; }
+    if(off == 0) w->p[byte] = 0;
+    w->p[byte] |= (uint8_t)((v & ((1u << take) - 1u)) << off);
+    v >>= take; n -= take; w->bit += (size_t)take;
+  }
+}
+
+static uint32_t get_bits(BitR* r, int n){
+  uint32_t v = 0;
+  int got = 0;
+  while(got < n){
+    size_t byte = r->bit >> 3;
+    int off = (int)(r->bit & 7), take = 8 - off < n - got ? 8 - off : n - got;
+    if(byte >= r->len){ r->over = 1; return 0; }
+    v |= (uint32_t)((r->p[byte] >> off) & ((1u << take) - 1u)) << got;
+    got += take; r->bit += (size_t)take;
+  }
+  return v;
+}
+
+static int32_t sign_extend(uint32_t v, int n){
+  uint32_t m = 1u << (n-1);
+  return (int32_t)((v ^ m) - m);
+}
+
+/* ------------------------------- Residuals ------------------------------ */
+static void put_field(BitW* w, int32_t cur, int32_t pred){
+  int32_t r = cur - pred;
+  if(r == 0){ put_bits(w, 0, 1); return; }
+  if(r > -16 && r < 16){ put_bits(w, 1, 2); put_bits(w, (uint32_t)r & 0x1Fu, 5); return; }
+  if(r > -256 && r < 256){ put_bits(w, 3, 3); put_bits(w, (uint32_t)r & 0x1FFu, 9); return; }
+  put_bits(w, 7, 3); put_bits(w, (uint32_t)cur & 0xFFFFu, 16);
+}
+
+/* `is_signed`: the raw 16 bits are an int16 (else a uint16) */
+static int32_t get_field(BitR* r, int32_t pred, int is_signed){
+  if(!get_bits(r, 1)) return pred;
+  if(!get_bits(r, 1)) return pred + sign_extend(get_bits(r, 5), 5);
+  if(!get_bits(r, 1)) return pred + sign_extend(get_bits(r, 9), 9);
+  uint32_t v = get_bits(r, 16);
+  return is_signed ? sign_extend(v, 16) : (int32_t)v;
+}
+
+/* where the baseline's velocity carries the ball after `age` steps, in
+ * position units: dir/1024 * speed * age * 8 */
+static int32_t predict(int16_t pos, int16_t dir, uint16_t speed, uint32_t age){
+  int64_t num = (int64_t)dir * speed * (int64_t)age;
+  int64_t d = num >= 0 ? (num + 64) / 128 : -((-num + 64) / 128);
+  int64_t p = pos + d;
+  return (int32_t)(p < -32768 ? -32768 : p > 32767 ? 32767 : p);
+}
+
+static int fits16(int32_t v, int is_signed){
+  return is_signed ? v >= -32768 && v <= 32767 : v >= 0 && v <= 65535;
+}
+
+/* ---------------------------------- Codec -------------------------------- */
+size_t snap_encode(const Snap* cur, const Snap* base, uint8_t* out, size_t cap){
+  BitW w = { out, cap, 0, 0 };
+  uint32_t age = base ? cur->tick - base->tick : 0;
+  if(age == 0 || age >= SNAP_WINDOW) base = NULL;
+  if(!base){
+    put_bits(&w, 1, 1);
+    put_bits(&w, cur->tick, 32);
+    put_bits(&w, cur->state, 2);
+    put_bits(&w, cur->score[0], 8); put_bits(&w, cur->score[1], 8);
+    put_bits(&w, (uint16_t)cur->bat_y[0], 16); put_bits(&w, (uint16_t)cur->bat_y[1], 16);
+    put_bits(&w, (uint16_t)cur->ball_x, 16);   put_bits(&w, (uint16_t)cur->ball_y, 16);
+    put_bits(&w, (uint16_t)cur->ball_dx, 16);  put_bits(&w, (uint16_t)cur->ball_dy, 16);
+    put_bits(&w, cur->speed, 16);
+  } else {
+    put_bits(&w, 0, 1);
+    put_bits(&w, base->tick & BASE_LO_MASK, BASE_LO_BITS);
+    put_bits(&w, age, AGE_BITS);
+    int meta = cur->state != base->state || cur->score[0] != base->score[0] || cur->score[1] != base->score[1];
+    put_bits(&w, (uint32_t)meta, 1);
+    if(meta){ put_bits(&w, cur->state, 2); put_bits(&w, cur->score[0], 8); put_bits(&w, cur->score[1], 8); }
+    put_field(&w, cur->bat_y[0], base->bat_y[0]);
+    put_field(&w, cur->bat_y[1], base->bat_y[1]);
+    put_field(&w, cur->ball_x, predict(base->ball_x, base->ball_dx, base->speed, age));
+    put_field(&w, cur->ball_y, predict(base->ball_y, base->ball_dy, base->speed, age));
+    put_field(&w, cur->ball_dx, base->ball_dx);
+    put_field(&w, cur->ball_dy, base->ball_dy);
+    put_field(&w, cur->speed, base->speed);
+  }
+  return w.over ? 0 : (w.bit + 7) >> 3;
+}
+
+SnapStatus snap_decode(Snap* out, const uint8_t* buf, size_t len, const SnapRing* have){
+  BitR r = { buf, len, 0, 0 };
+  Snap s;
+  if(get_bits(&r, 1)){
+    s.tick = get_bits(&r, 32);
+    s.state = (uint8_t)get_bits(&r, 2);
+    s.score[0] = (uint8_t)get_bits(&r, 8); s.score[1] = (uint8_t)get_bits(&r, 8);
+    s.bat_y[0] = (int16_t)sign_extend(get_bits(&r, 16), 16);
+    s.bat_y[1] = (int16_t)sign_extend(get_bits(&r, 16), 16);
+    s.ball_x   = (int16_t)sign_extend(get_bits(&r, 16), 16);
+    s.ball_y   = (int16_t)sign_extend(get_bits(&r, 16), 16);
+    s.ball_dx  = (int16_t)sign_extend(get_bits(&r, 16), 16);
+    s.ball_dy  = (int16_t)sign_extend(get_bits(&r, 16), 16);
+    s.speed = (uint16_t)get_bits(&r, 16);
+  } else {
+    uint32_t lo = get_bits(&r, BASE_LO_BITS), age = get_bits(&r, AGE_BITS);
+    if(r.over || age == 0) return SNAP_ERR_FORMAT;
+    const Snap* b = have ? &have->s[lo % SNAP_WINDOW] : NULL;
+    if(!b || !have->valid[lo % SNAP_WINDOW] || (b->tick & BASE_LO_MASK) != lo) return SNAP_ERR_BASE;
+    s = *b;
+    s.tick = b->tick + age;
+    if(get_bits(&r, 1)){
+      s.state = (uint8_t)get_bits(&r, 2);
+      s.score[0] = (uint8_t)get_bits(&r, 8); s.score[1] = (uint8_t)get_bits(&r, 8);
+    }
+    int32_t v[7];
+    v[0] = get_field(&r, b->bat_y[0], 1);
+    v[1] = get_field(&r, b->bat_y[1], 1);
+    v[2] = get_field(&r, predict(b->ball_x, b->ball_dx, b->speed, age), 1);
+    v[3] = get_field(&r, predict(b->ball_y, b->ball_dy, b->speed, age), 1);
+    v[4] = get_field(&r, b->ball_dx, 1);
+    v[5] = get_field(&r, b->ball_dy, 1);
+    v[6] = get_field(&r, b->speed, 0);
+    for(int i=0;i<6;i++) if(!fits16(v[i], 1)) return SNAP_ERR_FORMAT;
+    if(!fits16(v[6], 0)) return SNAP_ERR_FORMAT;
+    s.bat_y[0] = (int16_t)v[0]; s.bat_y[1] = (int16_t)v[1];
+    s.ball_x = (int16_t)v[2]; s.ball_y = (int16_t)v[3];
+    s.ball_dx = (int16_t)v[4]; s.ball_dy = (int16_t)v[5];
+    s.speed = (uint16_t)v[6];
+  }
+  if(r.over || s.state < ST_MENU || s.state > ST_OVER) return SNAP_ERR_FORMAT;
+  /* exactly the bytes the fields need, zero padding */
+  if(len != (r.bit + 7) >> 3) return SNAP_ERR_FORMAT;
+  if((r.bit & 7) && (buf[len-1] >> (r.bit & 7)) != 0) return SNAP_ERR_FORMAT;
+  *out = s;
+  return SNAP_OK;
+}
+
+/* -------------------------------- Sender --------------------------------- */
+void snap_sender_init(SnapSender* s){
+  memset(s, 0, sizeof(*s));
+  snap_ring_init(&s->sent);
+}
+
+void snap_sender_ack(SnapSender* s, uint32_t tick){
+  if(!s->has_ack || (int32_t)(tick - s->acked) > 0){ s->acked = tick; s->has_ack = 1; }
+}
+
+size_t snap_sender_encode(SnapSender* s, const Snap* cur, uint8_t* out, size_t cap){
+  const Snap* base = s->has_ack ? snap_ring_get(&s->sent, s->acked) : NULL;
+  if(base && (cur->tick - base->tick == 0 || cur->tick - base->tick >= SNAP_WINDOW)) base = NULL;
+  size_t n = snap_encode(cur, base, out, cap);
+  if(!n) return 0;
+  if(base) s->deltas++; else s->keys++;
+  snap_ring_put(&s->sent, cur);
+  return n;
+}
@@ -0,0 +1,198 @@
+/* vfx.c — pooled SoA particles: event emitters, SIMD step, swap-remove,
+ * packed instance build */
+
+#include "vfx.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE__) || defined(_M_X64)
+#  include <xmmintrin.h>
+#  define VFX_W 4
+#elif defined(__wasm_simd128__)
+#  include <wasm_simd128.h>
+#  define VFX_W 4
+#else
+#  define VFX_W 1
+#endif
+
+int vfx_width(void){ return VFX_W; }
+
+/* straight RGBA, indexed by VfxColor */
+static const float PAL[VFX_PAL_COUNT][4] = {
+  { 1.0f, 1.0f, 1.0f, 1.0f },
+  { 240/255.0f, 240/255.0f,  50/255.0f, 1.0f },
+  { 240/255.0f,  50/255.0f,  50/255.0f, 1.0f },
+  {  50/255.0f,  50/255.0f, 240/255.0f, 1.0f },
+  { 1.0f, 1.0f, 1.0f, 0.35f },
+};
+
+#define FLOAT_ARRAYS 9   /* x y vx vy age life size grow drag */
+
+/* ---------------------------------- Pool --------------------------------- */
+int vfx_init(Vfx* v, int cap){
+  memset(v, 0, sizeof(*v));
+  if(cap < 1) cap = 1;
+  cap = (cap + 3) & ~3;
+  v->block = calloc((size_t)cap, FLOAT_ARRAYS*sizeof(float) + 2);
+  if(!v->block) return 0;
+  float* f = (float*)v->block;
+  v->x = f;  f += cap;  v->y = f;    f += cap;
+  v->vx = f; f += cap;  v->vy = f;   f += cap;
+  v->age = f; f += cap; v->life = f; f += cap;
+  v->size = f; f += cap; v->grow = f; f += cap;
+  v->drag = f; f += cap;
+  v->shape = (uint8_t*)f; v->color = v->shape + cap;
+  v->cap = cap;
+  v->rng = 0x6C8E9CF5u;
+  return 1;
+}
+
+void vfx_free(Vfx* v){
+  free(v->block);
+  memset(v, 0, sizeof(*v));
+}
+
+void vfx_clear(Vfx* v){ v->n = 0; v->flash = 0.0f; }
+
+int vfx_spawn(Vfx* v, float x, float y, float vx, float vy, float life,
+              float size, float grow, float drag, ShapeKind shape, VfxColor color){
+  if(v->n >= v->cap){ v->dropped++; return 0; }
+  int i = v->n++;
+  v->x[i] = x; v->y[i] = y; v->vx[i] = vx; v->vy[i] = vy;
+  v->age[i] = 0.0f; v->life[i] = life;
+  v->size[i] = size; v->grow[i] = grow; v->drag[i] = drag;
+  v->shape[i] = (uint8_t)shape; v->color[i] = (uint8_t)color;
+  v->spawned++;
+  return 1;
+}
+
+/* ------------------------------- Emitters -------------------------------- */
+static float frand(Vfx* v){
+  v->rng ^= v->rng<<13; v->rng ^= v->rng>>17; v->rng ^= v->rng<<5;
+  return (float)(v->rng >> 8) * (1.0f/16777216.0f);
+}
+
+/* `count` sparks from (x, y), headed `angle` +- `spread` radians */
+static void sparks(Vfx* v, float x, float y, int count, float angle, float spread,
+                   float speed, float life, VfxColor color){
+  for(int k=0;k<count;k++){
+    float a = angle + (2.0f*frand(v) - 1.0f)*spread;
+    float s = speed*(0.4f + 0.6f*frand(v));
+    vfx_spawn(v, x, y, s*cosf(a), s*sinf(a), life*(0.6f + 0.4f*frand(v)),
+              2.5f + 1.5f*frand(v), -0.08f, 0.9f, SHAPE_CIRCLE, (k%3) ? color : VFX_WHITE);
+  }
+}
+
+/* The old impact ripple: diameter 2*(2 + 1.5*age), gone after 10 steps. */
+static void ripple(Vfx* v, float x, float y){
+  vfx_spawn(v, x, y, 0.0f, 0.0f, 10.0f, 4.0f, 3.0f, 1.0f, SHAPE_RING, VFX_WHITE);
+}
+
+void vfx_emit_events(Vfx* v, const Events* ev){
+  const float PI = 3.14159265f;
+  for(int i=0;i<ev->n;i++){
+    const Event* e = &ev->ev[i];
+    switch(e->type){
+      case EV_HIT: {
+        float dir = e->side==0 ? 1.0f : -1.0f;   /* away from the paddle */
+        int n = 4 + e->speed; if(n > 24) n = 24;
+        ripple(v, e->x - 10.0f*dir, e->y);
+        sparks(v, e->x, e->y, n, e->side==0 ? 0.0f : PI, 1.0f,
+               2.0f + 0.35f*(float)e->speed, 22.0f, VFX_YELLOW);
+      } break;
+      case EV_BOUNCE:
+        ripple(v, e->x, e->y);
+        sparks(v, e->x, e->y, 4, e->side ? -0.5f*PI : 0.5f*PI, 1.2f, 2.5f, 14.0f, VFX_WHITE);
+        break;
+      case EV_GOAL: {
+        VfxColor c = e->side==0 ? VFX_RED : VFX_BLUE;   /* paddle flash colours */
+        float x = e->x < 0.0f ? 0.0f : e->x > (float)SIM_WIDTH ? (float)SIM_WIDTH : e->x;
+        v->flash = 1.0f; v->flash_color = (uint8_t)c;
+        sparks(v, x, e->y, 32, 0.0f, PI, 5.0f, 34.0f, c);
+      } break;
+      default:
+        break;
+    }
+  }
+}
+
+void vfx_emit_trail(Vfx* v, const Ball* b){
+  if(b->speed < 8 || b->x < 0.0f || b->x > (float)SIM_WIDTH) return;
+  vfx_spawn(v, b->x, b->y, 0.0f, 0.0f, 8.0f, 1.6f*SIM_BALL_R, -1.2f, 1.0f, SHAPE_CIRCLE, VFX_GHOST);
+}
+
+/* ---------------------------------- Step --------------------------------- */
+static void step_scalar(Vfx* v, int i0, int n){
+  for(int i=i0;i<n;i++){
+    v->x[i] += v->vx[i]; v->y[i] += v->vy[i];
+    v->vx[i] *= v->drag[i]; v->vy[i] *= v->drag[i];
+    v->age[i] += 1.0f;
+    v->size[i] = fmaxf(v->size[i] + v->grow[i], 0.0f);
+  }
+}
+
+void vfx_step(Vfx* v){
+  int n = v->n, i = 0;
+#if VFX_W == 4 && !defined(__wasm_simd128__)
+  const __m128 one = _mm_set1_ps(1.0f), zero = _mm_setzero_ps();
+  for(; i + 4 <= n; i += 4){
+    __m128 d = _mm_loadu_ps(v->drag + i), vx = _mm_loadu_ps(v->vx + i), vy = _mm_loadu_ps(v->vy + i);
+    _mm_storeu_ps(v->x + i, _mm_add_ps(_mm_loadu_ps(v->x + i), vx));
+    _mm_storeu_ps(v->y + i, _mm_add_ps(_mm_loadu_ps(v->y + i), vy));
+    _mm_storeu_ps(v->vx + i, _mm_mul_ps(vx, d));
+    _mm_storeu_ps(v->vy + i, _mm_mul_ps(vy, d));
+    _mm_storeu_ps(v->age + i, _mm_add_ps(_mm_loadu_ps(v->age + i), one));
+    _mm_storeu_ps(v->size + i, _mm_max_ps(_mm_add_ps(_mm_loadu_ps(v->size + i), _mm_loadu_ps(v->grow + i)), zero));
+  }
+#elif VFX_W == 4
+  const v128_t one = wasm_f32x4_splat(1.0f), zero = wasm_f32x4_splat(0.0f);
+  for(; i + 4 <= n; i += 4){
+    v128_t d = wasm_v128_load(v->drag + i), vx = wasm_v128_load(v->vx + i), vy = wasm_v128_load(v->vy + i);
+    wasm_v128_store(v->x + i, wasm_f32x4_add(wasm_v128_load(v->x + i), vx));
+    wasm_v128_store(v->y + i, wasm_f32x4_add(wasm_v128_load(v->y + i), vy));
+    wasm_v128_store(v->vx + i, wasm_f32x4_mul(vx, d));
+    wasm_v128_store(v->vy + i, wasm_f32x4_mul(vy, d));
+    wasm_v128_store(v->age + i, wasm_f32x4_add(wasm_v128_load(v->age + i), one));
+    wasm_v128_store(v->size + i, wasm_f32x4_pmax(wasm_f32x4_add(wasm_v128_load(v->size + i), wasm_v128_load(v->grow + i)), zero));
+  }
+#endif
+  step_scalar(v, i, n);
+
+  /* swap-remove the dead: the last live particle fills the hole */
+  for(i=0;i<n;){
+    if(v->age[i] < v->life[i]){ i++; continue; }
+    n--;
+    v->x[i] = v->x[n]; v->y[i] = v->y[n]; v->vx[i] = v->vx[n]; v->vy[i] = v->vy[n];
+    v->age[i] = v->age[n]; v->life[i] = v->life[n];
+    v->size[i] = v->size[n]; v->grow[i] = v->grow[n]; v->drag[i] = v->drag[n];
+    v->shape[i] = v->shape[n]; v->color[i] = v->color[n];
+  }
+  v->n = n;
+
+  v->flash *= 0.85f;
+  if(v->flash < 0.02f) v->flash = 0.0f;
+}
+
+/* ---------------------------------- Draw --------------------------------- */
+int vfx_build(const Vfx* v, ShapeInstance* out, int cap){
+  int n = v->n < cap ? v->n : cap;
+  for(int i=0;i<n;i++){
+    ShapeInstance* s = &out[i];
+    const float* c = PAL[v->color[i]];
+    s->x = v->x[i]; s->y = v->y[i]; s->w = s->h = v->size[i];
+    s->color[0] = c[0]; s->color[1] = c[1]; s->color[2] = c[2];
+    s->color[3] = c[3]*(1.0f - v->age[i]/v->life[i]);
+    s->outline = v->shape[i]==SHAPE_RING ? SHAPES_RING_WIDTH : 0.0f;
+    s->kind = (float)v->shape[i];
+  }
+  if(v->flash > 0.0f && n < cap){
+    ShapeInstance* s = &out[n++];
+    const float* c = PAL[v->flash_color];
+    s->x = SIM_WIDTH/2.0f; s->y = SIM_HEIGHT/2.0f; s->w = (float)SIM_WIDTH; s->h = (float)SIM_HEIGHT;
+    s->color[0] = c[0]; s->color[1] = c[1]; s->color[2] = c[2]; s->color[3] = 0.3f*v->flash;
+    s->outline = 0.0f; s->kind = (float)SHAPE_RECT;
+  }
+  return n;
+}